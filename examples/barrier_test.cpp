@@ -0,0 +1,123 @@
+/** @file barrier_test.cpp
+ *    This file contains a program which measures how long it takes a group
+ *    of tasks to meet at a @c Barrier. For each number of tasks from 2 to 8,
+ *    a measuring task creates a barrier and enough worker tasks to make up
+ *    the group, then all of them go through the barrier @c CYCLES times in
+ *    a row, doing nothing else. The program prints the average time taken
+ *    by each cycle, which is the overhead a barrier adds to each cycle of a
+ *    set of phase-synchronized control tasks. The workers delete themselves
+ *    when they're done, so the measurements don't affect each other.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "eventgroup.h"
+
+
+/// The number of times the tasks go through the barrier for each group size
+const uint32_t CYCLES = 2000;
+
+/// The largest group of tasks to be measured
+const uint8_t MAX_TASKS = 8;
+
+
+/// Parameters given to each worker task
+struct WorkerParams
+{
+    Barrier* p_barrier;                   ///< The barrier at which to wait
+    uint32_t cycles;                      ///< How many times to wait there
+};
+
+
+/** @brief   Task which waits at a barrier a given number of times, then
+ *           deletes itself.
+ *  @param   p_params A pointer to a @c WorkerParams structure
+ */
+void task_worker (void* p_params)
+{
+    WorkerParams* p_work = (WorkerParams*)p_params;
+
+    for (uint32_t cycle = 0; cycle < p_work->cycles; cycle++)
+    {
+        p_work->p_barrier->wait ();
+    }
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   Task which runs the measurements and prints the results.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_measure (void* p_params)
+{
+    static WorkerParams params[MAX_TASKS];
+    char name[16];
+
+    Serial << "Tasks\tus/cycle" << endl;
+    for (uint8_t n_tasks = 2; n_tasks <= MAX_TASKS; n_tasks++)
+    {
+        // Each size gets its own barrier, so they all show up in the list
+        snprintf (name, sizeof (name), "Barrier %u", n_tasks);
+        Barrier* p_barrier = new Barrier (n_tasks, name);
+        params[n_tasks - 1].p_barrier = p_barrier;
+        params[n_tasks - 1].cycles = CYCLES + 1;
+
+        // Workers run at this task's priority, as peer control tasks would
+        for (uint8_t index = 1; index < n_tasks; index++)
+        {
+            xTaskCreate (task_worker, "Worker", 2048, &params[n_tasks - 1],
+                         uxTaskPriorityGet (NULL), NULL);
+        }
+
+        // The first trip through the barrier waits for the workers to start
+        p_barrier->wait ();
+        uint32_t start = micros ();
+        for (uint32_t cycle = 0; cycle < CYCLES; cycle++)
+        {
+            p_barrier->wait ();
+        }
+        uint32_t elapsed = micros () - start;
+
+        Serial << n_tasks << '\t' << (float)elapsed / CYCLES << endl;
+
+        // Let the workers delete themselves before starting the next group
+        vTaskDelay (10);
+    }
+    Serial << endl;
+    print_all_shares (Serial);
+
+    for (;;)
+    {
+        vTaskDelay (1000);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void) 
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Barrier Round Trip Time" << endl;
+
+    xTaskCreate (task_measure, "Measure", 4096, NULL, 3, NULL);
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -0,0 +1,184 @@
+/** @file blockfilter_test.cpp
+ *    This file contains a program which filters samples a block at a time.
+ *    A timer interrupt makes @c SAMPLE_RATE samples per second of a
+ *    simulated sensor signal, a slow 5 Hz wave plus 1 kHz interference, and
+ *    puts them into the blocks of a @c BlockChannel. A task takes each full
+ *    block, decimates it by 4 with a @c BlockDecimator whose low pass filter
+ *    removes the interference, smooths it with a two stage
+ *    @c BlockBiquadCascade, and puts the newest smoothed sample into a share.
+ *    Every second the program prints the number of blocks filtered, the
+ *    average time taken per block, and how far the smoothed signal was from
+ *    the 5 Hz wave alone.
+ *
+ *    On an STM32 with CMSIS-DSP installed, the filters use it; otherwise
+ *    they use the portable code. The program also runs in the host
+ *    simulation, where the times printed are zero.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+    #include <HardwareTimer.h>
+#endif
+#include "taskshare.h"
+#include "blockchannel.h"
+#include "blockfilter.h"
+
+
+/// The number of samples per second made by the timer interrupt
+const uint32_t SAMPLE_RATE = 4000;
+
+/// The number of samples in each block
+const uint16_t BLOCK_SIZE = 64;
+
+/// The decimation factor, giving 1000 filtered samples per second
+const uint8_t FACTOR = 4;
+
+/// The number of seconds the test runs in the host simulation
+const uint32_t SIM_SECONDS = 5;
+
+/// Anti-aliasing low pass filter for 4 kHz sampling, a windowed sinc which
+/// passes 5 Hz unchanged and cuts 1 kHz by a factor of 400
+const float ANTI_ALIAS[16] =
+{
+    0.00592f, 0.01041f, 0.02297f, 0.04361f, 0.06976f, 0.09675f, 0.11900f,
+    0.13158f, 0.13158f, 0.11900f, 0.09675f, 0.06976f, 0.04361f, 0.02297f,
+    0.01041f, 0.00592f
+};
+
+/// Two Butterworth low pass stages at 20 Hz, sampled at 1 kHz
+const float SMOOTHING[10] =
+{
+    0.0036217f, 0.0072434f, 0.0036217f, -1.8226935f, 0.8371802f,
+    0.0036217f, 0.0072434f, 0.0036217f, -1.8226935f, 0.8371802f
+};
+
+/// Blocks of samples from the timer interrupt to the filtering task
+BlockChannel<Q15> sample_blocks (3, BLOCK_SIZE, "Samples");
+
+/// The newest smoothed sample
+Share<Q15> smoothed ("Smoothed");
+
+/// The number of samples made by the interrupt
+volatile uint32_t samples_made = 0;
+
+
+/** @brief   Interrupt service routine which makes one sample and puts it into
+ *           the block being filled.
+ */
+#if defined ESP32 && !defined HOST_SIM
+void IRAM_ATTR timer_ISR (void)
+#else
+void timer_ISR (void)
+#endif
+{
+    static uint16_t filled = 0;
+
+    // The 5 Hz wave and the 1 kHz interference are each 0.4 of full scale
+    uint32_t count = samples_made++;
+    float wave = 0.4f * sinf (2.0f * (float)PI * 5.0f * count / SAMPLE_RATE);
+    float hum = (count & 2) ? 0.4f : -0.4f;
+    sample_blocks.write_block ()[filled] = Q15::from (wave + hum);
+    if (++filled == BLOCK_SIZE)
+    {
+        sample_blocks.ISR_commit ();
+        filled = 0;
+    }
+}
+
+
+/** @brief   Set up a timer to run @c timer_ISR() at the sample rate.
+ */
+void set_up_timer (void)
+{
+    #if defined HOST_SIM
+        sim_attach_interrupt (1000000 / SAMPLE_RATE, timer_ISR);
+    #elif defined ESP32
+        hw_timer_t* p_timer = timerBegin (0, 80, true);   // 1 MHz count
+        timerAttachInterrupt (p_timer, timer_ISR, true);
+        timerAlarmWrite (p_timer, 1000000 / SAMPLE_RATE, true);
+        timerAlarmEnable (p_timer);
+    #else
+        HardwareTimer* p_timer = new HardwareTimer (TIM3);
+        p_timer->setOverflow (SAMPLE_RATE, HERTZ_FORMAT);
+        p_timer->attachInterrupt (timer_ISR);
+        p_timer->resume ();
+    #endif
+}
+
+
+/** @brief   Task which filters each block of samples and reports once per
+ *           second.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_filter (void* p_params)
+{
+    BlockDecimator<Q15, 16, FACTOR> decimator (ANTI_ALIAS);
+    BlockBiquadCascade<Q15, 2> smoother (SMOOTHING);
+    Q15 slow[BLOCK_SIZE / FACTOR];
+
+    uint32_t blocks = 0, busy_us = 0, outputs = 0;
+    float worst = 0.0f;
+    for (;;)
+    {
+        Span<Q15> samples = sample_blocks.acquire ();
+        uint32_t start = micros ();
+        size_t count = decimator.process (samples, slow);
+        smoother.process (Span<Q15> (slow, count), slow);
+        busy_us += micros () - start;
+        sample_blocks.release (samples);
+        smoothed.put (slow[count - 1]);
+        blocks++;
+
+        // After the filters settle, compare with the wave alone; the filters
+        // delay it by about 25 ms, which is allowed for here
+        for (size_t index = 0; index < count; index++)
+        {
+            float ms = (float)outputs++ - 24.8f;
+            float wave = 0.4f * sinf (2.0f * (float)PI * 0.005f * ms);
+            float error = fabsf (slow[index].to_float () - wave);
+            worst = (outputs > 500 && error > worst) ? error : worst;
+        }
+
+        if (outputs % 1000 < count)
+        {
+            Serial << blocks << " blocks, " << (float)busy_us / blocks
+                   << " us per block, largest error " << worst << endl;
+            if (outputs >= SIM_SECONDS * 1000)
+            {
+                #ifdef HOST_SIM
+                    print_all_shares (Serial);
+                    sim_stop (worst < 0.05f ? 0 : 1);
+                #endif
+            }
+        }
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Block Filter Test" << endl;
+
+    xTaskCreate (task_filter, "Filter", 4096, NULL, 4, NULL);
+    set_up_timer ();
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
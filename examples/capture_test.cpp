@@ -0,0 +1,150 @@
+/** @file capture_test.cpp
+ *    This file contains a program which tests a @c Capture, a software
+ *    oscilloscope which records the values put into shares around a trigger.
+ *    A control task runs a simple simulated speed loop at 1 kHz, putting the
+ *    speed error and the motor duty cycle into shares. Every so often a load
+ *    disturbance makes the error jump, which triggers the capture; a low
+ *    priority task then dumps the captured window as CSV and re-arms the
+ *    capture. At startup the program also measures how much longer a put
+ *    takes when the share is being recorded.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskshare.h"
+#include "capture.h"
+
+
+/// The number of puts timed when measuring the cost of recording
+const uint32_t TIMING_PUTS = 10000;
+
+/// The speed error, which triggers the capture
+Share<float> speed_error ("Speed Error");
+
+/// The duty cycle sent to the motor driver
+Share<int16_t> motor_duty ("Motor Duty");
+
+/// A share which isn't recorded, used to time puts
+Share<float> plain_share ("Not Recorded");
+
+/// The capture which records both of the speed loop's shares
+Capture scope (1024, "Speed Scope");
+
+
+/** @brief   Measure the time taken by puts with and without recording.
+ *  @details This is run before the scheduler starts, so nothing else gets in
+ *           the way of the timing.
+ */
+void time_puts (void)
+{
+    uint32_t start = micros ();
+    for (uint32_t count = 0; count < TIMING_PUTS; count++)
+    {
+        plain_share.put ((float)count);
+    }
+    uint32_t plain_us = micros () - start;
+
+    scope.set_external_trigger ();
+    scope.arm ();
+    start = micros ();
+    for (uint32_t count = 0; count < TIMING_PUTS; count++)
+    {
+        speed_error.put ((float)count);
+    }
+    uint32_t recorded_us = micros () - start;
+    scope.stop ();
+
+    Serial << "Put without capture: " << plain_us * 1000 / TIMING_PUTS
+           << " ns, with capture: " << recorded_us * 1000 / TIMING_PUTS
+           << " ns" << endl;
+}
+
+
+/** @brief   Task which runs a simulated speed control loop.
+ *  @details The motor is modeled as a first order lag. A load torque which
+ *           comes and goes every couple of seconds disturbs it.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_control (void* p_params)
+{
+    const float SETPOINT = 1000.0f;
+    const float KP = 2.0f;
+    const float KI = 0.05f;
+    float speed = 0.0f;
+    float integral = 0.0f;
+    uint32_t ticks = 0;
+
+    TickType_t last_wake = xTaskGetTickCount ();
+    for (;;)
+    {
+        float load = ((ticks % 2000) < 50) ? 400.0f : 0.0f;
+        float error = SETPOINT - speed;
+        integral = constrain (integral + KI * error, -1000.0f, 1000.0f);
+        int16_t duty = (int16_t)constrain (KP * error + integral, -1000.0f,
+                                           1000.0f);
+        speed += 0.02f * (2.0f * duty - speed - load);
+
+        speed_error.put (error);
+        motor_duty.put (duty);
+        ticks++;
+
+        vTaskDelayUntil (&last_wake, 1);
+    }
+}
+
+
+/** @brief   Task which dumps each captured window and re-arms the capture.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_dump (void* p_params)
+{
+    scope.set_trigger (speed_error, CAPTURE_RISING, 50.0f, 0.25f);
+    scope.arm ();
+
+    for (;;)
+    {
+        if (scope.is_done ())
+        {
+            scope.dump (Serial);
+            print_all_shares (Serial);
+            Serial << endl;
+            scope.arm ();
+        }
+        vTaskDelay (100);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Capture Test" << endl;
+
+    scope.add (speed_error);
+    scope.add (motor_duty);
+    time_puts ();
+
+    xTaskCreate (task_control, "Control", 2048, NULL, 5, NULL);
+    xTaskCreate (task_dump, "Dump", 4096, NULL, 1, NULL);
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
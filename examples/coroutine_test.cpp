@@ -0,0 +1,185 @@
+/** @file coroutine_test.cpp
+ *    This file contains a program which compares coroutines run by a 
+ *    @c CoScheduler with ordinary FreeRTOS tasks. It measures the time taken
+ *    to switch between two coroutines and between two tasks, and it shows
+ *    the RAM used by coroutine frames next to the stack space which tasks
+ *    doing the same jobs would need. 
+ *
+ *    This program needs C++20; in @c platformio.ini, add @c -std=gnu++20 to
+ *    @c build_flags and @c -std=gnu++11 (or whatever the platform's default
+ *    is) to @c build_unflags. To run it in the host simulation, use the
+ *    @c native_sim_cpp20 environment, which is set up that way.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskcoro.h"
+
+
+/// The number of switches timed for coroutines and for tasks
+const uint32_t N_SWITCHES = 10000;
+
+/// The number of small blinker-like coroutines used to measure RAM use
+const uint8_t N_BLINKERS = 10;
+
+/// The stack size which each task in this program is given
+const uint32_t TASK_STACK = 2048;
+
+/// The scheduler which runs all the coroutines in this program
+CoScheduler scheduler ("Coroutines");
+
+/// Count of switches made by the ping-pong coroutines
+uint32_t coro_switches = 0;
+
+/// Handles used by the ping-pong tasks to wake each other
+TaskHandle_t ping_handle = NULL;
+TaskHandle_t pong_handle = NULL;
+
+
+/** @brief   Coroutine which hands control to its partner over and over.
+ */
+CoTask ping_pong (void)
+{
+    while (coro_switches < N_SWITCHES)
+    {
+        coro_switches++;
+        co_await co_yield_now ();
+    }
+}
+
+
+/** @brief   Coroutine which acts like a small, mostly idle state machine.
+ *  @param   period The number of ticks between state changes
+ */
+CoTask blinker (TickType_t period)
+{
+    bool state = false;
+    for (;;)
+    {
+        state = !state;
+        co_await co_sleep (period);
+    }
+}
+
+
+/** @brief   Coroutine which times the other coroutines and prints results.
+ */
+CoTask coro_report (void)
+{
+    co_await co_sleep (10);
+    uint32_t start = micros ();
+    coro_switches = 0;
+    scheduler.spawn (ping_pong ());
+    scheduler.spawn (ping_pong ());
+    while (coro_switches < N_SWITCHES)
+    {
+        co_await co_yield_now ();
+    }
+    uint32_t elapsed = micros () - start;
+
+    Serial << "Coroutines: " << N_SWITCHES << " switches in " << elapsed 
+           << " us" << endl;
+
+    uint32_t before = CoScheduler::get_frame_bytes ();
+    for (uint8_t count = 0; count < N_BLINKERS; count++)
+    {
+        scheduler.spawn (blinker (100 + count));
+    }
+    uint32_t per_coro = (CoScheduler::get_frame_bytes () - before) 
+                        / N_BLINKERS;
+    Serial << N_BLINKERS << " blinkers use " << per_coro 
+           << " bytes each as coroutines, " << TASK_STACK 
+           << " bytes of stack each as tasks" << endl;
+}
+
+
+/** @brief   Task in which all the coroutines are run.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_coroutines (void* p_params)
+{
+    // Let the task test finish first so the printouts don't mix
+    vTaskDelay (500);
+    scheduler.spawn (coro_report ());
+    scheduler.run ();
+}
+
+
+/** @brief   Task which times switches to and from another task.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_ping (void* p_params)
+{
+    vTaskDelay (10);
+    uint32_t start = micros ();
+    for (uint32_t count = 0; count < N_SWITCHES; count += 2)
+    {
+        xTaskNotifyGive (pong_handle);
+        ulTaskNotifyTake (pdTRUE, portMAX_DELAY);
+    }
+    uint32_t elapsed = micros () - start;
+
+    Serial << "Tasks:      " << N_SWITCHES << " switches in " << elapsed 
+           << " us" << endl;
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   Task which answers the ping task.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_pong (void* p_params)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake (pdTRUE, portMAX_DELAY);
+        xTaskNotifyGive (ping_handle);
+    }
+}
+
+
+/** @brief   Task which prints the status of the scheduler now and then.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_print (void* p_params)
+{
+    for (;;)
+    {
+        vTaskDelay (5000);
+        print_all_shares (Serial);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void) 
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Coroutine vs. Task Switching Test" << endl;
+
+    // The ping-pong tasks have the same priority, as do the coroutines
+    xTaskCreate (task_ping, "Ping", TASK_STACK, NULL, 4, &ping_handle);
+    xTaskCreate (task_pong, "Pong", TASK_STACK, NULL, 4, &pong_handle);
+    xTaskCreate (task_coroutines, "Coros", TASK_STACK, NULL, 4, NULL);
+    xTaskCreate (task_print, "Print", TASK_STACK, NULL, 1, NULL);
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
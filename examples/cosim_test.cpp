@@ -0,0 +1,152 @@
+/** @file cosim_test.cpp
+ *    This file contains a program which runs a motor speed controller in
+ *    the host simulation against a model of the motor in another process,
+ *    connected through a @c CosimBridge. The control task is written just as
+ *    it would be for a real motor: it gets the speed from a share and puts
+ *    a duty cycle into another. A second task counts turns of the shaft by
+ *    getting index pulses from a queue. The setpoint changes every two
+ *    seconds; after ten seconds of virtual time the program prints how well
+ *    the speed followed it.
+ *
+ *    This program only runs in the host simulation. Start it, then start
+ *    @c host/cosim_plant in another terminal; see those files' headers and
+ *    @c host/sim/sim_main.cpp for how to compile them. Add
+ *    @c host/sim/cosim.cpp to this program's files.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#include "taskshare.h"
+#include "taskqueue.h"
+#include "cosim.h"
+
+
+/// The length of the test in milliseconds of virtual time
+const uint32_t TEST_MS = 10000;
+
+
+/// The motor's duty cycle in percent, from the controller to the plant
+Share<float> duty ("Motor Duty");
+
+/// The motor's speed in RPM, from the plant
+Share<float> speed ("Motor Speed");
+
+/// The encoder count, from the plant
+Share<int32_t> encoder ("Encoder");
+
+/// Encoder counts at which the shaft passed its index mark
+Queue<int32_t> index_pulses (32, "Index Pulses");
+
+/// The speed wanted, in RPM
+Share<float> setpoint ("Setpoint");
+
+/// The bridge to the plant model
+CosimBridge plant;
+
+
+/** @brief   Task which runs a PI speed controller every millisecond.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_control (void* p_params)
+{
+    const float KP = 0.02f;               // Percent per RPM
+    const float KI = 0.5f;                // Percent per RPM-second
+    float integral = 0.0f;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        float error = setpoint.get () - speed.get ();
+        float output = KP * error + KI * integral;
+        if (output > 100.0f || output < -100.0f)
+        {
+            output = constrain (output, -100.0f, 100.0f);
+        }
+        else
+        {
+            integral += error * 0.001f;
+        }
+        duty.put (output);
+        vTaskDelayUntil (&wake_time, 1);
+    }
+}
+
+
+/** @brief   Task which counts turns of the shaft from its index pulses.
+ *  @param   p_params A pointer to a variable in which to count the turns
+ */
+void task_turns (void* p_params)
+{
+    uint32_t* p_turns = (uint32_t*)p_params;
+    for (;;)
+    {
+        index_pulses.get ();
+        (*p_turns)++;
+    }
+}
+
+
+/** @brief   Task which changes the setpoint, measures how well the speed
+ *           follows it, and ends the test.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_test (void* p_params)
+{
+    const float SPEEDS[] = { 1500.0f, 4000.0f, -2500.0f, 0.0f, 3000.0f };
+    static uint32_t turns = 0;
+    xTaskCreate (task_turns, "Turns", 2048, &turns, 3, NULL);
+
+    double sum_squares = 0.0;
+    uint32_t samples = 0;
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (uint32_t ms = 0; ms < TEST_MS; ms += 10)
+    {
+        setpoint.put (SPEEDS[(ms / 2000) % 5]);
+
+        // Skip the first half second after each change when scoring
+        if (ms % 2000 >= 500)
+        {
+            float error = setpoint.get () - speed.get ();
+            sum_squares += error * error;
+            samples++;
+        }
+        vTaskDelayUntil (&wake_time, 10);
+    }
+
+    Serial << "After " << millis () << " ms: RMS speed error "
+           << sqrt (sum_squares / samples) << " RPM, " << turns
+           << " turns, encoder at " << encoder.get () << endl;
+    print_all_shares (Serial);
+    plant.close ();
+    sim_stop (0);
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    Serial << "Co-simulation Test: waiting for host/cosim_plant" << endl;
+
+    duty.put (0.0f);
+    plant.add_actuator (duty);
+    plant.add_sensor (speed);
+    plant.add_sensor (encoder);
+    plant.add_sensor (index_pulses);
+    plant.begin (1);
+
+    xTaskCreate (task_control, "Control", 2048, NULL, 4, NULL);
+    xTaskCreate (task_test, "Test", 4096, NULL, 2, NULL);
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
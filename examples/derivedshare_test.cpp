@@ -0,0 +1,244 @@
+/** @file derivedshare_test.cpp
+ *    This file contains a program which computes values from shares only
+ *    when they're needed, using derived shares. A sensor task puts simulated
+ *    wheel encoder counts and motor current into shares every millisecond and
+ *    the battery voltage every 100 ms. From these come derived shares for
+ *    the distance travelled and heading, from the two encoders; the power
+ *    drawn, from the voltage and current; the load as a fraction of the
+ *    motor's rating, from the power; and the battery's state of charge, from
+ *    the voltage.
+ *
+ *    A control task reads the state of charge every millisecond, but it's
+ *    computed only when a new voltage comes in, ten times a second. A
+ *    display task reads the distance, power and load ten times a second, and
+ *    the heading once a second, and these are computed only then, not every
+ *    time an encoder count or current comes in. The list of shares printed
+ *    at the end shows how many times each derived value was computed and
+ *    read. In the host simulation the program checks the values and exits.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskshare.h"
+#include "derivedshare.h"
+
+
+/// Distance travelled per encoder count, in millimeters
+const float MM_PER_COUNT = 0.05f;
+
+/// Distance between the wheels, in millimeters
+const float TRACK_MM = 150.0f;
+
+/// The power at which the motors are fully loaded, in watts
+const float RATED_WATTS = 20.0f;
+
+/// The number of seconds the test runs in the host simulation
+const uint32_t SIM_SECONDS = 3;
+
+/// The left wheel's encoder count
+Share<int32_t> left_count ("Left Count");
+
+/// The right wheel's encoder count
+Share<int32_t> right_count ("Right Count");
+
+/// The battery voltage, in volts
+Share<float> voltage ("Voltage");
+
+/// The motors' current, in amperes
+Share<float> current ("Current");
+
+
+/** @brief   Compute the distance the robot has travelled.
+ *  @param   left The left encoder count
+ *  @param   right The right encoder count
+ *  @returns The distance travelled by the middle of the robot, in mm
+ */
+float distance_mm (int32_t left, int32_t right)
+{
+    return 0.5f * (left + right) * MM_PER_COUNT;
+}
+
+
+/** @brief   Compute the direction in which the robot is heading.
+ *  @param   left The left encoder count
+ *  @param   right The right encoder count
+ *  @returns The heading in radians, counterclockwise from the start
+ */
+float heading_rad (int32_t left, int32_t right)
+{
+    return (right - left) * MM_PER_COUNT / TRACK_MM;
+}
+
+
+/** @brief   Compute the power drawn by the motors.
+ *  @param   volts The battery voltage
+ *  @param   amps The motors' current
+ *  @returns The power in watts
+ */
+float power_watts (float volts, float amps)
+{
+    return volts * amps;
+}
+
+
+/** @brief   Compute the motors' load as a fraction of their rating.
+ *  @param   watts The power drawn
+ */
+float load_fraction (float watts)
+{
+    return watts / RATED_WATTS;
+}
+
+
+/** @brief   Estimate a lithium battery's state of charge from its voltage.
+ *  @param   volts The voltage of the two-cell battery
+ *  @returns The state of charge in percent
+ */
+uint8_t charge_percent (float volts)
+{
+    float percent = (volts - 6.4f) * 100.0f / 2.0f;
+    return (percent < 0.0f) ? 0 : (percent > 100.0f) ? 100 : (uint8_t)percent;
+}
+
+
+/// The distance travelled, in millimeters
+DerivedShare<float, Share<int32_t>, Share<int32_t>>
+    distance ("Distance", distance_mm, left_count, right_count);
+
+/// The heading, in radians
+DerivedShare<float, Share<int32_t>, Share<int32_t>>
+    heading ("Heading", heading_rad, left_count, right_count);
+
+/// The power drawn by the motors, in watts
+DerivedShare<float, Share<float>, Share<float>>
+    power ("Power", power_watts, voltage, current);
+
+/// The load on the motors, computed from the power
+DerivedShare<float, decltype (power)> load ("Load", load_fraction, power);
+
+/// The battery's state of charge, in percent
+DerivedShare<uint8_t, Share<float>> charge ("Charge", charge_percent,
+                                            voltage);
+
+
+/** @brief   Task which simulates the sensors, putting new data into the
+ *           encoder and current shares every millisecond and into the
+ *           voltage share every 100 ms.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_sensors (void* p_params)
+{
+    uint32_t ms = 0;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        // The robot drives in a gentle curve to the left
+        left_count.put (ms * 10);
+        right_count.put (ms * 11);
+        current.put (1.0f + 0.5f * sinf (ms * 0.01f));
+        if (ms % 100 == 0)
+        {
+            voltage.put (8.4f - 0.0001f * ms);
+        }
+        ms++;
+        vTaskDelayUntil (&wake_time, 1);
+    }
+}
+
+
+/** @brief   Task which reads the state of charge every millisecond, as a
+ *           control task which limits the motors' power might.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_control (void* p_params)
+{
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        if (charge.get () < 5)
+        {
+            Serial << "Battery low" << endl;
+        }
+        vTaskDelayUntil (&wake_time, 1);
+    }
+}
+
+
+/** @brief   Task which reads the distance, power and load ten times a second
+ *           and the heading once a second, and prints them.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_display (void* p_params)
+{
+    uint32_t tenths = 0;
+    bool good = true;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        vTaskDelayUntil (&wake_time, 100);
+        float now_mm = distance.get ();
+        float now_watts = power.get ();
+        float now_load = load.get ();
+
+        // Each value must match its inputs as they are now
+        float expected_mm = distance_mm (left_count.get (),
+                                         right_count.get ());
+        float expected_watts = voltage.get () * current.get ();
+        good = good && now_mm == expected_mm && now_watts == expected_watts
+               && now_load == expected_watts / RATED_WATTS;
+
+        if (++tenths % 10 == 0)
+        {
+            Serial << tenths / 10 << " s: " << now_mm << " mm, heading "
+                   << heading.get () << " rad, " << now_watts << " W, load "
+                   << now_load << ", charge " << charge.get () << '%'
+                   << endl;
+            if (tenths >= SIM_SECONDS * 10)
+            {
+                print_all_shares (Serial);
+                #ifdef HOST_SIM
+                    // Each value must be computed no more than once per read
+                    // and, for the charge, once per new voltage
+                    good = good && charge.get_compute_count () <= 1 + tenths
+                           && power.get_compute_count ()
+                              <= power.get_read_count ()
+                           && heading.get_compute_count () == tenths / 10;
+                    sim_stop (good ? 0 : 1);
+                #endif
+            }
+        }
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Derived Share Test" << endl;
+
+    xTaskCreate (task_sensors, "Sensors", 2048, NULL, 5, NULL);
+    xTaskCreate (task_control, "Control", 2048, NULL, 4, NULL);
+    xTaskCreate (task_display, "Display", 4096, NULL, 2, NULL);
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
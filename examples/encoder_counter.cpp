@@ -62,7 +62,7 @@ STM32Encoder::STM32Encoder (TIM_TypeDef* timer, uint8_t pin1, uint8_t pin2)
     // Set registers which control the counting mode directly. This has to be
     // done because the HardwareTimer library doesn't handle encoders (lame...)
     // The reference in this function's comment sort of explains how it works
-    timer->SMCR |= TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1;
-    timer->CR1 |= TIM_CR1_CEN;
+    timer->SMCR = timer->SMCR | TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1;
+    timer->CR1 = timer->CR1 | TIM_CR1_CEN;
 }
 
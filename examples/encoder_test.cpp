@@ -5,8 +5,12 @@
  *    References:
  *    @c https://www.edwinfairchild.com/2019/04/interface-rotary-encoder-right-way.html
  *
+ *    This program also runs on a PC in the host simulation, where the
+ *    timers are modeled and simulated encoders turn them back and forth.
+ *
  *  @author JR Ridgely
  *  @date   2020-Nov-15 Original file, based on stuff from the Interwebs
+ *  @date   2026-Oct-17 Runs in the host simulation with simulated encoders
  */
 
 #include <Arduino.h>
@@ -16,6 +20,25 @@
 // #include "encoder3.h"          // Artifact from some previously done testing
 #include "encoder_counter.h"
 
+#ifdef HOST_SIM
+    #include "quadrature.h"
+
+    /// Simulated encoders on the shafts of the X and Y motors
+    QuadratureGenerator shaft_X (TIM3);
+    QuadratureGenerator shaft_Y (TIM8);
+
+    /** @brief   Simulated interrupt which turns the shafts, X back and forth
+     *           and Y slowly one way with some noise, each millisecond.
+     */
+    void turn_shafts (void)
+    {
+        uint64_t now_ns = (uint64_t)micros () * 1000;
+        shaft_X.set_speed (8000.0 * sin (now_ns * 1.0e-9));
+        shaft_X.run_until (now_ns);
+        shaft_Y.run_until (now_ns);
+    }
+#endif
+
 
 /** @brief   Task which tests the reading of encoders using the @c STM32Encoder
  *           class.
@@ -48,6 +71,12 @@ void setup (void)
     delay (1000);
     Serial << "\033[2JTimer/Counter Test in Encoder Mode" << endl;
 
+    #ifdef HOST_SIM
+        shaft_Y.set_speed (-1500.0);
+        shaft_Y.set_noise (0.05, 100, 200);
+        sim_attach_interrupt (1000, turn_shafts);
+    #endif
+
     // Create the task that tests the encoder interface class
     xTaskCreate (task_read_encoders,     // Task function
                  "Encoders",             // Name in diagnostic printouts
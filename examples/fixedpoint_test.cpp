@@ -0,0 +1,276 @@
+/** @file fixedpoint_test.cpp
+ *    This file contains a program which times the fixed-point PID controller
+ *    and biquad filter from @c fixedcontrol.h on a microcontroller, next to
+ *    the same blocks written with @c float and @c double. On a Cortex-M4,
+ *    whose FPU does only single precision, and on an ESP32, the @c double
+ *    versions are done by a software library and take many times longer;
+ *    the fixed-point versions take a handful of cycles which are the same
+ *    every time. Each block is run many times and the time per step is
+ *    printed.
+ *
+ *    Then a controller runs in a loop once per millisecond with its
+ *    setpoint, measurement and output in shares, as a real control task
+ *    would, around a simple model of a motor. The shares can be watched
+ *    with @c print_all_shares().
+ *
+ *    The numbers from a PC are printed by @c host/fixedpoint_bench.cpp;
+ *    in the host simulation, time stands still while a task computes, so
+ *    the times printed here are zero.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskshare.h"
+#include "fixedcontrol.h"
+
+
+/// The number of steps timed for each block
+const uint32_t BENCH_STEPS = 20000;
+
+
+/// Gains for a speed loop run every millisecond
+struct SpeedGains
+{
+    static constexpr double KP = 2.0;     ///< Proportional gain
+    static constexpr double KI = 0.02;    ///< Integral gain times 1 ms
+    static constexpr double KD = 0.5;     ///< Derivative gain over 1 ms
+};
+
+
+/// A Butterworth low pass filter at 10 Hz, sampled at 1 kHz
+struct LowPass
+{
+    static constexpr double B0 = 0.0009446918438401619;  ///< Input gain
+    static constexpr double B1 = 0.0018893836876803238;  ///< Last input
+    static constexpr double B2 = 0.0009446918438401619;  ///< Input before
+    static constexpr double A1 = -1.9111970674260732;    ///< Last output
+    static constexpr double A2 = 0.9149758348014339;     ///< Output before
+};
+
+
+/// The speed wanted, as a fraction of full speed
+Share<Q15> setpoint ("Setpoint");
+
+/// The measured speed, as a fraction of full speed
+Share<Q15> speed ("Speed");
+
+/// The motor's duty cycle, from -1 to 1
+Share<Q15> duty ("Duty");
+
+
+/** @brief   A PID controller in floating point with the same equations as
+ *           @c FixedPID, for timing.
+ *  @tparam  Real @c float or @c double
+ */
+template <class Real>
+class FloatPID
+{
+protected:
+    Real integral = 0;                    ///< Sum of KI * error
+    Real last_measurement = 0;            ///< Measurement at the last step
+
+public:
+    /// Run the controller for one sample
+    Real step (Real setpoint, Real measurement)
+    {
+        Real error = setpoint - measurement;
+        Real output = (Real)SpeedGains::KP * error + integral
+                      - (Real)SpeedGains::KD * (measurement
+                                                - last_measurement);
+        last_measurement = measurement;
+        Real limited = (output > 1) ? 1 : (output < -1) ? -1 : output;
+        if (!((output > limited && error > 0)
+              || (output < limited && error < 0)))
+        {
+            integral += (Real)SpeedGains::KI * error;
+        }
+        return limited;
+    }
+};
+
+
+/** @brief   A biquad filter in floating point, for timing.
+ *  @tparam  Real @c float or @c double
+ */
+template <class Real>
+class FloatBiquad
+{
+protected:
+    Real x1 = 0, x2 = 0, y1 = 0, y2 = 0;  ///< Past inputs and outputs
+
+public:
+    /// Filter one sample
+    Real step (Real input)
+    {
+        Real output = (Real)LowPass::B0 * input + (Real)LowPass::B1 * x1
+                      + (Real)LowPass::B2 * x2 - (Real)LowPass::A1 * y1
+                      - (Real)LowPass::A2 * y2;
+        x2 = x1;
+        x1 = input;
+        y2 = y1;
+        y1 = output;
+        return output;
+    }
+};
+
+
+/** @brief   Print the time per step of a block which was timed.
+ *  @param   title What was timed
+ *  @param   start_us The time from @c micros() when timing began
+ */
+void print_time (const char* title, uint32_t start_us)
+{
+    uint32_t ns = (micros () - start_us) * 1000UL / BENCH_STEPS;
+    Serial.printf ("  %-16s %6lu ns\n", title, (unsigned long)ns);
+}
+
+
+/** @brief   Time each kind of PID controller and filter.
+ *  @details The inputs change from step to step, and the outputs are added
+ *           up into a @c volatile variable, so that the compiler can't skip
+ *           any of the work.
+ */
+void run_benchmarks (void)
+{
+    volatile float sink = 0.0f;
+    uint32_t start;
+
+    Serial << "Time per step for " << BENCH_STEPS << " steps:" << endl;
+
+    FixedPID<Q15, SpeedGains> pid_15;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        Q15 input = Q15::from_raw ((int16_t)(step * 13));
+        sink = sink + pid_15.step (Q15::from (0.5), input).raw;
+    }
+    print_time ("PID, Q15", start);
+
+    FixedPID<Q31, SpeedGains> pid_31;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        Q31 input = Q31::from_raw ((int32_t)(step * 851968));
+        sink = sink + pid_31.step (Q31::from (0.5), input).raw;
+    }
+    print_time ("PID, Q31", start);
+
+    FloatPID<float> pid_f;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        float input = (int16_t)(step * 13) * (1.0f / 32768.0f);
+        sink = sink + pid_f.step (0.5f, input);
+    }
+    print_time ("PID, float", start);
+
+    FloatPID<double> pid_d;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        double input = (int16_t)(step * 13) * (1.0 / 32768.0);
+        sink = sink + (float)pid_d.step (0.5, input);
+    }
+    print_time ("PID, double", start);
+
+    FixedBiquad<Q15, LowPass> bq_15;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        sink = sink + bq_15.step (Q15::from_raw ((int16_t)(step * 13))).raw;
+    }
+    print_time ("Biquad, Q15", start);
+
+    FixedBiquad<Q31, LowPass> bq_31;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        sink = sink + bq_31.step (Q31::from_raw ((int32_t)(step * 851968)))
+                      .raw;
+    }
+    print_time ("Biquad, Q31", start);
+
+    FloatBiquad<float> bq_f;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        sink = sink + bq_f.step ((int16_t)(step * 13) * (1.0f / 32768.0f));
+    }
+    print_time ("Biquad, float", start);
+
+    FloatBiquad<double> bq_d;
+    start = micros ();
+    for (uint32_t step = 0; step < BENCH_STEPS; step++)
+    {
+        sink = sink + (float)bq_d.step ((int16_t)(step * 13)
+                                        * (1.0 / 32768.0));
+    }
+    print_time ("Biquad, double", start);
+}
+
+
+/** @brief   Task which times the blocks, then runs a speed controller around
+ *           a model of a motor once per millisecond.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_control (void* p_params)
+{
+    run_benchmarks ();
+
+    FixedPID<Q15, SpeedGains> controller;
+    FixedBiquad<Q15, LowPass> smoother;
+    Q15 motor = Q15::from (0.0);
+    uint32_t ms = 0;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        // Every two seconds the setpoint changes, through a smoothing filter
+        Q15 target = ((ms / 2000) % 2) ? Q15::from (0.6) : Q15::from (-0.3);
+        setpoint.put (smoother.step (target));
+
+        // The control law reads and writes shares, as in a real program
+        speed.put (motor);
+        controller.run (setpoint, speed, duty);
+
+        // The motor's speed follows its duty cycle with a 100 ms lag
+        motor += (duty.get () - motor) * Q15::from (0.01);
+
+        if (++ms % 1000 == 0)
+        {
+            Serial << ms << " ms: setpoint " << setpoint.get ().to_float ()
+                   << ", speed " << speed.get ().to_float () << ", duty "
+                   << duty.get ().to_float () << endl;
+        }
+        vTaskDelayUntil (&wake_time, 1);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (2000);
+    Serial << "Fixed-Point Control Test" << endl;
+
+    xTaskCreate (task_control, "Control", 4096, NULL, 3, NULL);
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -0,0 +1,475 @@
+/** @file histogram_test.cpp
+ *    This file contains a program which checks @c HistogramShare with both of
+ *    its bin layouts. It first puts samples at and around the bins' edges
+ *    into a histogram of each layout and checks the bin each one lands in
+ *    and the edges reported. It then exports a histogram with
+ *    @c export_binary() into a buffer and reads the record back, checking
+ *    the header, the name and every count, including counts which take two
+ *    and three bytes.
+ *
+ *    Then come checks of the switch between the two banks of counts which a
+ *    snapshot with reset makes. A put which began counting in the old bank
+ *    is held up, as if preempted, while a snapshot is taken; the snapshot
+ *    must wait for it and include its sample. Last, a timer interrupt and
+ *    two tasks put samples into the histograms for two seconds while a
+ *    checking task takes a snapshot with reset every few milliseconds. The
+ *    snapshots added up must match, bin for bin, the samples which the
+ *    interrupt and the tasks say they put in.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+    #include <HardwareTimer.h>
+#endif
+#include "histogramshare.h"
+
+
+/// The number of bins in the latency histogram, which doubles bin widths
+const uint16_t LATENCY_BINS = 20;
+
+/// The number of bins in the current histogram, which has equal widths
+const uint16_t CURRENT_BINS = 40;
+
+/// The layout of the current histogram, from -2000 mA in 100 mA bins
+typedef LinearBins<-2000, 100> CurrentLayout;
+
+/// The time between samples put in by the timer interrupt, in microseconds
+const uint32_t ISR_PERIOD_US = 37;
+
+/// The number of milliseconds for which samples are put in at once
+const uint32_t BUSY_MS = 2000;
+
+
+/** @brief   A histogram in which a put can be held up after it has chosen a
+ *           bank, as if it had been preempted there.
+ */
+class HeldHistogram : public HistogramShare<CURRENT_BINS, CurrentLayout>
+{
+public:
+    /** @brief   Create a histogram with all its counts zero.
+     *  @param   p_name A name for the histogram
+     */
+    HeldHistogram (const char* p_name)
+        : HistogramShare<CURRENT_BINS, CurrentLayout> (p_name)
+    {
+    }
+
+    /** @brief   Count a sample as @c put() does, but wait after choosing the
+     *           bank in which to count it.
+     *  @param   value The sample to be counted
+     *  @param   pause The time to wait, in RTOS ticks
+     */
+    void held_put (int32_t value, TickType_t pause)
+    {
+        uint16_t index = CurrentLayout::bin (value, CURRENT_BINS);
+        uint8_t bank;
+        for (;;)
+        {
+            bank = active.load ();
+            putting[bank].fetch_add (1);
+            if (active.load () == bank)
+            {
+                break;
+            }
+            putting[bank].fetch_sub (1);
+        }
+        vTaskDelay (pause);
+        counts[bank][index].fetch_add (1);
+        putting[bank].fetch_sub (1);
+    }
+};
+
+
+/** @brief   A @c Print object which keeps what's written in a buffer.
+ */
+class ByteBuffer : public Print
+{
+public:
+    uint8_t bytes[256];                   ///< The bytes written
+    size_t length = 0;                    ///< The number of bytes written
+
+    /// Keep one byte, if there's room
+    size_t write (uint8_t a_byte)
+    {
+        if (length >= sizeof (bytes))
+        {
+            return 0;
+        }
+        bytes[length++] = a_byte;
+        return 1;
+    }
+};
+
+
+/// Times taken by something, in microseconds, in bins of doubling width
+HistogramShare<LATENCY_BINS> latency ("Latency");
+
+/// Motor currents in milliamperes
+HeldHistogram current ("Current");
+
+/// Set while the interrupt and the producer tasks should put samples in
+volatile bool busy = false;
+
+/// The samples which the interrupt has put into each latency bin
+uint32_t isr_counted[LATENCY_BINS];
+
+/// The samples which each producer task has put into each current bin
+uint32_t task_counted[2][CURRENT_BINS];
+
+/// Handle of the task which holds up a put on request
+TaskHandle_t holder_handle = NULL;
+
+/// The tick count at which the held put finished
+volatile TickType_t held_done_tick = 0;
+
+
+/** @brief   Interrupt service routine which puts a pseudo-random latency into
+ *           its histogram while the busy test runs.
+ */
+#if defined ESP32 && !defined HOST_SIM
+void IRAM_ATTR timer_ISR (void)
+#else
+void timer_ISR (void)
+#endif
+{
+    static uint32_t state = 12345;
+
+    if (!busy)
+    {
+        return;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    uint32_t value = state >> (state & 31);
+    latency.put (value);
+    isr_counted[Log2Bins::bin (value, LATENCY_BINS)]++;
+}
+
+
+/** @brief   Set up a timer to run @c timer_ISR() every @c ISR_PERIOD_US.
+ */
+void set_up_timer (void)
+{
+    #if defined HOST_SIM
+        sim_attach_interrupt (ISR_PERIOD_US, timer_ISR);
+    #elif defined ESP32
+        hw_timer_t* p_timer = timerBegin (0, 80, true);   // 1 MHz count
+        timerAttachInterrupt (p_timer, timer_ISR, true);
+        timerAlarmWrite (p_timer, ISR_PERIOD_US, true);
+        timerAlarmEnable (p_timer);
+    #else
+        HardwareTimer* p_timer = new HardwareTimer (TIM3);
+        p_timer->setOverflow (ISR_PERIOD_US, MICROSEC_FORMAT);
+        p_timer->attachInterrupt (timer_ISR);
+        p_timer->resume ();
+    #endif
+}
+
+
+/** @brief   Task which puts a held-up sample into the current histogram each
+ *           time it's notified.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_holder (void* p_params)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake (pdTRUE, portMAX_DELAY);
+        current.held_put (150, 5);
+        held_done_tick = xTaskGetTickCount ();
+    }
+}
+
+
+/** @brief   Task which puts currents into their histogram in bursts while
+ *           the busy test runs; the lower priority one holds some puts up.
+ *  @param   p_params A pointer to this producer's number, 0 or 1
+ */
+void task_producer (void* p_params)
+{
+    uint8_t me = *(uint8_t*)p_params;
+    int32_t value = me * 777;
+
+    for (;;)
+    {
+        if (busy)
+        {
+            for (uint8_t count = 0; count < 20; count++)
+            {
+                value = (value * 1103 + 12345) % 5000 - 2500;
+                if (me == 0 && count == 0)
+                {
+                    current.held_put (value, 1);
+                }
+                else
+                {
+                    current.put (value);
+                }
+                task_counted[me][CurrentLayout::bin (value, CURRENT_BINS)]++;
+            }
+        }
+        vTaskDelay (1 + me);
+    }
+}
+
+
+/** @brief   Check where samples at and around the bins' edges are counted.
+ *  @returns @c true if every sample went into the right bin
+ */
+bool check_edges (void)
+{
+    uint32_t values[CURRENT_BINS];
+    bool good = true;
+
+    // Each layout's edges, including both ends
+    good = good && latency.lower_edge (0) == 0 && latency.lower_edge (1) == 1
+           && latency.lower_edge (2) == 2 && latency.lower_edge (5) == 16
+           && latency.lower_edge (19) == (1UL << 18);
+    good = good && current.lower_edge (0) == -2000
+           && current.lower_edge (1) == -1900
+           && current.lower_edge (20) == 0
+           && current.lower_edge (39) == 1900;
+
+    // Samples and the bins they belong in, out of range ones at the ends
+    const uint32_t LOG2_IN[] = { 0, 1, 2, 3, 4, 7, 8, 65535, 65536,
+                                 0xFFFFFFFFUL };
+    const uint16_t LOG2_BIN[] = { 0, 1, 2, 2, 3, 3, 4, 16, 17, 19 };
+    const int32_t LINEAR_IN[] = { -100000, -2001, -2000, -1901, -1900, -1,
+                                  0, 99, 1899, 1900, 1999, 2000, 100000 };
+    const uint16_t LINEAR_BIN[] = { 0, 0, 0, 0, 1, 19, 20, 20, 38, 39, 39,
+                                    39, 39 };
+
+    uint32_t expected[CURRENT_BINS] = { 0 };
+    for (uint8_t index = 0; index < sizeof (LOG2_IN) / 4; index++)
+    {
+        latency.put (LOG2_IN[index]);
+        expected[LOG2_BIN[index]]++;
+    }
+    good = good && latency.snapshot (values, false) == sizeof (LOG2_IN) / 4;
+    good = good && latency.snapshot (values, true) == sizeof (LOG2_IN) / 4;
+    for (uint16_t bin = 0; bin < LATENCY_BINS; bin++)
+    {
+        good = good && values[bin] == expected[bin];
+        expected[bin] = 0;
+    }
+
+    for (uint8_t index = 0; index < sizeof (LINEAR_IN) / 4; index++)
+    {
+        current.put (LINEAR_IN[index]);
+        expected[LINEAR_BIN[index]]++;
+    }
+    good = good && current.snapshot (values, true) == sizeof (LINEAR_IN) / 4;
+    for (uint16_t bin = 0; bin < CURRENT_BINS; bin++)
+    {
+        good = good && values[bin] == expected[bin];
+    }
+    return good;
+}
+
+
+/** @brief   Read a little-endian number from an exported record.
+ *  @param   p_bytes Pointer to the number's first byte
+ *  @param   n_bytes The number of bytes in the number
+ */
+uint32_t read_le (const uint8_t* p_bytes, uint8_t n_bytes)
+{
+    uint32_t value = 0;
+    for (uint8_t count = 0; count < n_bytes; count++)
+    {
+        value |= (uint32_t)p_bytes[count] << (8 * count);
+    }
+    return value;
+}
+
+
+/** @brief   Export the histograms and read the records back.
+ *  @returns @c true if the records held what was put in
+ */
+bool check_export (void)
+{
+    ByteBuffer record;
+    bool good = true;
+
+    // Counts of one, two and three bytes
+    latency.put (0);
+    for (uint32_t count = 0; count < 300; count++)
+    {
+        latency.put (5);
+    }
+    for (uint32_t count = 0; count < 20000; count++)
+    {
+        latency.put (1000);
+    }
+    size_t written = latency.export_binary (record);
+    const uint8_t NAME[] = "Latency";
+    const uint8_t COUNTS[] = { 1, 0, 0, 0xAC, 0x02, 0, 0, 0, 0, 0, 0,
+                               0xA0, 0x9C, 0x01 };
+    const uint8_t* p_byte = record.bytes;
+    good = good && written == record.length && p_byte[0] == 'H'
+           && p_byte[1] == Log2Bins::LAYOUT_ID
+           && read_le (p_byte + 2, 2) == LATENCY_BINS
+           && read_le (p_byte + 4, 4) == 0 && read_le (p_byte + 8, 4) == 1
+           && p_byte[12] == sizeof (NAME) - 1
+           && memcmp (p_byte + 13, NAME, sizeof (NAME) - 1) == 0;
+    p_byte += 13 + sizeof (NAME) - 1;
+    good = good && memcmp (p_byte, COUNTS, sizeof (COUNTS)) == 0;
+
+    // The rest of the bins are empty, one byte each, and nothing follows
+    p_byte += sizeof (COUNTS);
+    uint16_t rest = LATENCY_BINS - 11;
+    good = good && (size_t)(p_byte - record.bytes) + rest == record.length;
+    for (uint16_t bin = 0; bin < rest; bin++)
+    {
+        good = good && p_byte[bin] == 0;
+    }
+
+    // Exporting resets the counts
+    uint32_t values[LATENCY_BINS];
+    good = good && latency.snapshot (values, true) == 0;
+
+    // A linear layout's first edges are negative numbers
+    record.length = 0;
+    current.put (-1950);
+    current.export_binary (record);
+    good = good && record.bytes[1] == CurrentLayout::LAYOUT_ID
+           && (int32_t)read_le (record.bytes + 4, 4) == -2000
+           && (int32_t)read_le (record.bytes + 8, 4) == -1900
+           && record.bytes[13 + strlen ("Current")] == 1;
+    return good;
+}
+
+
+/** @brief   Take a snapshot while a put which chose the old bank is held up.
+ *  @returns @c true if the snapshot waited for the put and counted it
+ */
+bool check_held_put (void)
+{
+    uint32_t values[CURRENT_BINS];
+
+    xTaskNotifyGive (holder_handle);
+    vTaskDelay (1);                       // The holder begins its put
+    uint32_t total = current.snapshot (values, true);
+    TickType_t taken_tick = xTaskGetTickCount ();
+
+    return total == 1 && values[CurrentLayout::bin (150, CURRENT_BINS)] == 1
+           && held_done_tick != 0 && held_done_tick <= taken_tick
+           && current.snapshot (values, true) == 0;
+}
+
+
+/** @brief   Take snapshots with reset while samples pour in and add them up.
+ *  @returns @c true if the snapshots add up to what was put in
+ */
+bool check_busy (void)
+{
+    static uint32_t latency_sum[LATENCY_BINS];
+    static uint32_t current_sum[CURRENT_BINS];
+    uint32_t values[CURRENT_BINS];
+    uint32_t snapshots = 0;
+
+    busy = true;
+    TickType_t start = xTaskGetTickCount ();
+    while (busy)
+    {
+        busy = (xTaskGetTickCount () - start < BUSY_MS);
+        vTaskDelay (3);
+        if (!busy)
+        {
+            // Let the producers finish their bursts
+            vTaskDelay (10);
+        }
+        latency.snapshot (values, true);
+        for (uint16_t bin = 0; bin < LATENCY_BINS; bin++)
+        {
+            latency_sum[bin] += values[bin];
+        }
+        current.snapshot (values, true);
+        for (uint16_t bin = 0; bin < CURRENT_BINS; bin++)
+        {
+            current_sum[bin] += values[bin];
+        }
+        snapshots++;
+    }
+
+    bool good = true;
+    uint32_t isr_total = 0, task_total = 0;
+    for (uint16_t bin = 0; bin < LATENCY_BINS; bin++)
+    {
+        good = good && latency_sum[bin] == isr_counted[bin];
+        isr_total += isr_counted[bin];
+    }
+    for (uint16_t bin = 0; bin < CURRENT_BINS; bin++)
+    {
+        good = good && current_sum[bin]
+                       == task_counted[0][bin] + task_counted[1][bin];
+        task_total += task_counted[0][bin] + task_counted[1][bin];
+    }
+    Serial << snapshots << " snapshots of " << isr_total
+           << " samples from the interrupt and " << task_total
+           << " from tasks" << endl;
+    return good && isr_total > 0 && task_total > 0;
+}
+
+
+/** @brief   Task which runs the checks and prints the results.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_check (void* p_params)
+{
+    bool edges = check_edges ();
+    Serial << "Bin edges: " << (edges ? "good" : "WRONG") << endl;
+    bool exported = check_export ();
+    Serial << "Binary export: " << (exported ? "good" : "WRONG") << endl;
+    bool held = check_held_put ();
+    Serial << "Snapshot during a put: " << (held ? "good" : "WRONG") << endl;
+    bool counted = check_busy ();
+    Serial << "Snapshots while busy: " << (counted ? "good" : "WRONG")
+           << endl;
+    print_all_shares (Serial);
+
+    #ifdef HOST_SIM
+        sim_stop ((edges && exported && held && counted) ? 0 : 1);
+    #endif
+    for (;;)
+    {
+        vTaskDelay (1000);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    static uint8_t producer_numbers[2] = { 0, 1 };
+
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Histogram Share Test" << endl;
+
+    // The checking task outranks the tasks which put samples in
+    xTaskCreate (task_check, "Check", 4096, NULL, 4, NULL);
+    xTaskCreate (task_holder, "Holder", 2048, NULL, 1, &holder_handle);
+    xTaskCreate (task_producer, "Prod. 0", 2048, &producer_numbers[0], 2,
+                 NULL);
+    xTaskCreate (task_producer, "Prod. 1", 2048, &producer_numbers[1], 3,
+                 NULL);
+    set_up_timer ();
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
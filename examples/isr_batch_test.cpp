@@ -0,0 +1,178 @@
+/** @file isr_batch_test.cpp
+ *    This file contains a program which compares two ways of getting data
+ *    from an interrupt service routine to a task. A timer interrupt runs at
+ *    @c SAMPLE_RATE times per second and puts the time at which it ran into
+ *    both a @c Queue, using @c ISR_put() for each item, and an @c IsrBatch.
+ *    A task reads each one. Every few seconds the program prints, for each
+ *    method, the number of items received and the number of times the
+ *    receiving task woke up per second, which is the number of pairs of
+ *    context switches caused, and the longest time an item waited between
+ *    the ISR and the task. 
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+    #include <HardwareTimer.h>
+#endif
+#include "taskqueue.h"
+#include "isrbatch.h"
+
+
+/// The number of interrupts per second
+const uint32_t SAMPLE_RATE = 5000;
+
+/// The number of items in a batch which wakes the batch receiving task
+const uint16_t BATCH_SIZE = 50;
+
+/// The number of seconds between printouts of results
+const uint32_t REPORT_SECONDS = 5;
+
+/// Queue which carries one item at a time; it wakes its task for each one
+Queue<uint32_t> item_queue (BATCH_SIZE * 4, "Per item");
+
+/// Channel which carries items in batches, with a 20 ms maximum latency
+IsrBatch<uint32_t> item_batch (BATCH_SIZE * 4, BATCH_SIZE, 20, "Batched");
+
+/// Number of times the queue's receiving task had to wait for an item
+volatile uint32_t queue_wakes = 0;
+
+/// Number of items received from the queue
+volatile uint32_t queue_items = 0;
+
+/// Longest time an item spent in the queue, in microseconds
+volatile uint32_t queue_max_us = 0;
+
+
+/** @brief   Interrupt service routine which sends the time to both tasks.
+ */
+#ifdef ESP32
+void IRAM_ATTR timer_ISR (void)
+#else
+void timer_ISR (void)
+#endif
+{
+    uint32_t now = micros ();
+    item_queue.ISR_put (now);
+    item_batch.ISR_put (now);
+}
+
+
+/** @brief   Set up a hardware timer to run @c timer_ISR() at the sample rate.
+ */
+void set_up_timer (void)
+{
+    #ifdef ESP32
+        hw_timer_t* p_timer = timerBegin (0, 80, true);   // 1 MHz count
+        timerAttachInterrupt (p_timer, timer_ISR, true);
+        timerAlarmWrite (p_timer, 1000000 / SAMPLE_RATE, true);
+        timerAlarmEnable (p_timer);
+    #else
+        HardwareTimer* p_timer = new HardwareTimer (TIM3);
+        p_timer->setOverflow (SAMPLE_RATE, HERTZ_FORMAT);
+        p_timer->attachInterrupt (timer_ISR);
+        p_timer->resume ();
+    #endif
+}
+
+
+/** @brief   Task which receives items from the queue one at a time.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_per_item (void* p_params)
+{
+    uint32_t sent_time;
+    for (;;)
+    {
+        if (item_queue.is_empty ())
+        {
+            queue_wakes++;
+        }
+        item_queue.get (sent_time);
+        uint32_t waited = micros () - sent_time;
+        if (waited > queue_max_us)
+        {
+            queue_max_us = waited;
+        }
+        queue_items++;
+    }
+}
+
+
+/** @brief   Task which receives items from the batching channel.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_batched (void* p_params)
+{
+    uint32_t sent_times[BATCH_SIZE];
+    for (;;)
+    {
+        item_batch.get_batch (sent_times, BATCH_SIZE);
+    }
+}
+
+
+/** @brief   Task which prints the results every few seconds.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_report (void* p_params)
+{
+    uint32_t last_queue_wakes = 0, last_queue_items = 0;
+    uint32_t last_batch_wakes = 0, last_batch_items = 0;
+
+    for (;;)
+    {
+        vTaskDelay (REPORT_SECONDS * configTICK_RATE_HZ);
+
+        uint32_t wakes = queue_wakes, items = queue_items;
+        Serial << "Per item: " << (items - last_queue_items) / REPORT_SECONDS
+               << " items/s, " << (wakes - last_queue_wakes) / REPORT_SECONDS
+               << " wakes/s, max. latency " << queue_max_us << " us" << endl;
+        last_queue_wakes = wakes;
+        last_queue_items = items;
+
+        wakes = item_batch.get_wakes ();
+        items = item_batch.get_items ();
+        Serial << "Batched:  " << (items - last_batch_items) / REPORT_SECONDS
+               << " items/s, " << (wakes - last_batch_wakes) / REPORT_SECONDS
+               << " wakes/s, max. latency " << item_batch.get_max_wait_us ()
+               << " us" << endl;
+        last_batch_wakes = wakes;
+        last_batch_items = items;
+
+        print_all_shares (Serial);
+        Serial << endl;
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void) 
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "ISR to Task: Per Item vs. Batched" << endl;
+
+    // Both receiving tasks have the same priority so neither has an edge
+    xTaskCreate (task_per_item, "Per Item", 2048, NULL, 5, NULL);
+    xTaskCreate (task_batched, "Batched", 2048, NULL, 5, NULL);
+    xTaskCreate (task_report, "Report", 4096, NULL, 1, NULL);
+    set_up_timer ();
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -8,6 +8,7 @@
  * 
  *  @date 28 Sep 2020  Original file
  *  @date  9 Oct 2020  Added another task because I got bored
+ *  @date 17 Oct 2026  Made the interrupt counter a @c CounterShare
  */
 
 #include <Arduino.h>
@@ -18,6 +19,7 @@
 #include <PrintStream.h>
 #include "taskqueue.h"
 #include "taskshare.h"
+#include "atomicshare.h"
 #include "task_receive.h"
 
 
@@ -37,7 +39,9 @@ uint32_t bad_global_0;
 
 #if (defined STM32L4xx || defined STM32F4xx)
 
-    volatile uint32_t irq_counter = 0UL;
+    /// A count of timer interrupts, which is safe to change in the ISR and
+    /// read in tasks at the same time
+    CounterShare<uint32_t> irq_counter ("IRQ Count");
 
     /// An interrupt service routine which creates malarkey data
     void timer_ISR (void)
@@ -130,7 +134,7 @@ void setup ()
     // Serial << "Timer test..." << endl;
     // for (uint32_t count = 0; count < 1000; count++)
     // {
-    //     Serial << "IRQ: " << irq_counter << ", count: " << count << "      \r";
+    //     Serial << "IRQ: " << irq_counter.get () << ", count: " << count << "      \r";
     //     delay (150);
     // }
     // Serial << endl << "done." << endl << endl;
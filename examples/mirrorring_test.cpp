@@ -0,0 +1,186 @@
+/** @file mirrorring_test.cpp
+ *    This file contains a program which runs a sliding window over samples
+ *    sent through a queue. A timer interrupt makes @c SAMPLE_RATE samples per
+ *    second of a simulated 50 Hz signal, such as the current in a motor's
+ *    supply, and puts them into a @c Queue. A task moves the samples from the
+ *    queue into a @c MirrorRing, and every @c HOP samples finds the RMS value
+ *    and peak of the newest @c WINDOW samples, reading them straight from the
+ *    ring with no copying. The signal's amplitude changes every second, and
+ *    once per second the program prints the RMS value found, the one
+ *    expected, and the largest error so far in windows which didn't span a
+ *    change.
+ *
+ *    The program also runs in the host simulation, where the ring's two
+ *    halves are mapped to the same memory rather than written twice.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+    #include <HardwareTimer.h>
+#endif
+#include "taskshare.h"
+#include "taskqueue.h"
+#include "mirrorring.h"
+
+
+/// The number of samples per second made by the timer interrupt
+const uint32_t SAMPLE_RATE = 2000;
+
+/// The number of samples in each window, 5 cycles of the 50 Hz signal
+const uint32_t WINDOW = 200;
+
+/// The number of samples between windows
+const uint32_t HOP = 50;
+
+/// The number of seconds the test runs in the host simulation
+const uint32_t SIM_SECONDS = 4;
+
+/// Samples from the timer interrupt to the windowing task
+Queue<int16_t> samples (64, "Samples");
+
+/// The RMS value of the newest window
+Share<float> rms_value ("RMS");
+
+/// The largest sample in the newest window
+Share<int16_t> peak_value ("Peak");
+
+/// The number of samples made by the interrupt
+volatile uint32_t samples_made = 0;
+
+
+/** @brief   Return the amplitude of the signal during a given second.
+ *  @param   second The number of whole seconds since the signal began
+ */
+float amplitude (uint32_t second)
+{
+    return 4000.0f + 6000.0f * (second % 3);
+}
+
+
+/** @brief   Interrupt service routine which makes one sample and puts it into
+ *           the queue.
+ */
+#if defined ESP32 && !defined HOST_SIM
+void IRAM_ATTR timer_ISR (void)
+#else
+void timer_ISR (void)
+#endif
+{
+    uint32_t count = samples_made++;
+    float phase = 2.0f * (float)PI * 50.0f * count / SAMPLE_RATE;
+    samples.ISR_put ((int16_t)(amplitude (count / SAMPLE_RATE)
+                               * sinf (phase)));
+}
+
+
+/** @brief   Set up a timer to run @c timer_ISR() at the sample rate.
+ */
+void set_up_timer (void)
+{
+    #if defined HOST_SIM
+        sim_attach_interrupt (1000000 / SAMPLE_RATE, timer_ISR);
+    #elif defined ESP32
+        hw_timer_t* p_timer = timerBegin (0, 80, true);   // 1 MHz count
+        timerAttachInterrupt (p_timer, timer_ISR, true);
+        timerAlarmWrite (p_timer, 1000000 / SAMPLE_RATE, true);
+        timerAlarmEnable (p_timer);
+    #else
+        HardwareTimer* p_timer = new HardwareTimer (TIM3);
+        p_timer->setOverflow (SAMPLE_RATE, HERTZ_FORMAT);
+        p_timer->attachInterrupt (timer_ISR);
+        p_timer->resume ();
+    #endif
+}
+
+
+/** @brief   Task which finds the RMS value and peak of each window of
+ *           samples and reports once per second.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_window (void* p_params)
+{
+    MirrorRing<int16_t> history (WINDOW);
+    uint32_t taken = 0, windows = 0;
+    float worst = 0.0f;
+
+    for (;;)
+    {
+        // Wait for a sample, then take any others which are waiting
+        history.put (samples.get ());
+        taken += 1 + history.take_all (samples);
+        if (taken < HOP)
+        {
+            continue;
+        }
+        taken -= HOP;
+
+        Span<int16_t> window = history.window (WINDOW);
+        if (window.size () < WINDOW)
+        {
+            continue;
+        }
+        float sum = 0.0f;
+        int16_t peak = 0;
+        for (int16_t sample : window)
+        {
+            sum += (float)sample * sample;
+            peak = (sample > peak) ? sample : peak;
+        }
+        rms_value.put (sqrtf (sum / WINDOW));
+        peak_value.put (peak);
+
+        // Windows which lie within one second should match its amplitude
+        uint32_t newest = samples_made - samples.available ();
+        uint32_t second = newest / SAMPLE_RATE;
+        float expected = amplitude (second) / sqrtf (2.0f);
+        if ((newest - WINDOW) / SAMPLE_RATE == second)
+        {
+            float error = fabsf (rms_value.get () - expected) / expected;
+            worst = (error > worst) ? error : worst;
+        }
+
+        // Report in the middle of each second, when the amplitude is steady
+        if (++windows % (SAMPLE_RATE / HOP) == SAMPLE_RATE / HOP / 2)
+        {
+            Serial << "RMS " << rms_value.get () << ", expected " << expected
+                   << ", peak " << peak_value.get () << ", largest error "
+                   << 100.0f * worst << '%' << endl;
+            if (windows >= SIM_SECONDS * SAMPLE_RATE / HOP)
+            {
+                #ifdef HOST_SIM
+                    print_all_shares (Serial);
+                    sim_stop (worst < 0.01f ? 0 : 1);
+                #endif
+            }
+        }
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Mirrored Ring Buffer Test" << endl;
+
+    xTaskCreate (task_window, "Window", 4096, NULL, 4, NULL);
+    set_up_timer ();
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -0,0 +1,212 @@
+/** @file mission_test.cpp
+ *    This file contains a ten-minute "mission" for a simulated positioning
+ *    motor, meant to be run in the host simulation in @c host/sim. A mission
+ *    task sends thirty target positions through a queue, twenty seconds
+ *    apart; a control task runs a PD loop and a model of the motor every
+ *    millisecond; and a monitor task checks the position ten times per
+ *    second, keeping score in variables which it shares with the mission
+ *    task under a mutex. At the end the score and a
+ *    checksum of every position seen by the monitor are printed.
+ *
+ *    On a microcontroller the mission takes ten minutes. In the simulation,
+ *    where the clock jumps ahead whenever every task is waiting, it takes a
+ *    few seconds, and the checksum is the same on every run. Build it with
+ *    the @c native_sim environment in @c platformio.ini, or by hand as
+ *    shown in @c host/sim/sim_main.cpp.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskqueue.h"
+#include "taskshare.h"
+#include "mutex.h"
+
+
+/// The number of target positions in the mission
+const uint8_t N_TARGETS = 30;
+
+/// The time allowed to reach each target, in milliseconds
+const uint32_t TARGET_MS = 20000;
+
+/// How close to its target, in degrees, the motor must be to have arrived
+const float CLOSE_ENOUGH = 0.5f;
+
+
+/// Target positions from the mission task to the control task
+Queue<float> targets (4, "Targets");
+
+/// The motor's position in degrees, from the control task
+Share<float> position ("Position");
+
+/// The target the control task is working toward
+Share<float> target ("Target");
+
+/// Guards the mission's score, which two tasks change
+Mutex score_mutex;
+
+/// Targets reached within the time allowed
+uint8_t reached = 0;
+
+/// The longest time taken to reach a target, in milliseconds
+uint32_t slowest_ms = 0;
+
+/// The largest error while holding a target after reaching it, in degrees
+float worst_hold = 0.0f;
+
+/// Whether the motor has reached the latest target
+bool arrived = false;
+
+/// Targets which hadn't been reached when the next one was sent
+uint8_t late = 0;
+
+
+/** @brief   Task which sends the targets, one every @c TARGET_MS.
+ *  @details The targets are made by a pseudorandom sequence, so each run
+ *           of the mission has the same ones.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_mission (void* p_params)
+{
+    uint32_t seed = 507;
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (uint8_t count = 0; count < N_TARGETS; count++)
+    {
+        seed = seed * 1103515245UL + 12345UL;
+        float angle = (float)((seed >> 16) % 3600) / 10.0f - 180.0f;
+        score_mutex.take ();
+        if (count > 0 && !arrived)
+        {
+            late++;
+        }
+        score_mutex.give ();
+        targets.put (angle);
+        vTaskDelayUntil (&wake_time, pdMS_TO_TICKS (TARGET_MS));
+    }
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   Task which runs the motor's PD controller and a model of the
+ *           motor and its load every millisecond.
+ *  @details The model stands in for the real motor, encoder and driver.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_control (void* p_params)
+{
+    const float DT = 0.001f;              // Time step in seconds
+    const float KP = 0.8f;                // Proportional gain, %/degree
+    const float KD = 0.045f;              // Derivative gain, %/(degree/s)
+    const float TORQUE = 40.0f;           // Motor acceleration, deg/s^2/%
+    const float DRAG = 8.0f;              // Viscous drag, 1/s
+
+    float angle = 0.0f;                   // Modeled position, degrees
+    float speed = 0.0f;                   // Modeled speed, degrees/s
+    float goal = 0.0f;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        if (targets.any ())
+        {
+            goal = targets.get ();
+            target.put (goal);
+        }
+        float duty = KP * (goal - angle) - KD * speed;
+        duty = constrain (duty, -100.0f, 100.0f);
+
+        speed += (TORQUE * duty - DRAG * speed) * DT;
+        angle += speed * DT;
+        position.put (angle);
+
+        vTaskDelayUntil (&wake_time, 1);
+    }
+}
+
+
+/** @brief   Task which checks the motor's progress ten times per second.
+ *  @details It times how long the motor takes to reach each target and how
+ *           far it wanders once there, and keeps a checksum of every
+ *           position it sees so that runs can be compared.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_monitor (void* p_params)
+{
+    uint32_t checksum = 2166136261UL;
+    uint32_t start_ms = 0;
+    float goal = 0.0f;
+    const uint32_t MISSION_MS = N_TARGETS * TARGET_MS;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    while (millis () < MISSION_MS + 100)
+    {
+        vTaskDelayUntil (&wake_time, pdMS_TO_TICKS (100));
+
+        float now_at = position.get ();
+        float new_goal = target.get ();
+        float error = fabsf (new_goal - now_at);
+        checksum = (checksum ^ (uint32_t)(int32_t)(now_at * 1000.0f))
+                   * 16777619UL;
+
+        score_mutex.take ();
+        if (new_goal != goal)
+        {
+            goal = new_goal;
+            arrived = false;
+            start_ms = millis ();
+        }
+        if (!arrived && error < CLOSE_ENOUGH)
+        {
+            arrived = true;
+            reached++;
+            uint32_t took = millis () - start_ms;
+            slowest_ms = (took > slowest_ms) ? took : slowest_ms;
+        }
+        else if (arrived && error > worst_hold)
+        {
+            worst_hold = error;
+        }
+        score_mutex.give ();
+    }
+
+    Serial << "Mission over at " << millis () << " ms: " << reached << '/'
+           << N_TARGETS << " targets reached (" << late << " late), slowest "
+           << "in " << slowest_ms << " ms, worst hold error " << worst_hold
+           << " degrees" << endl;
+    Serial << "Position checksum " << hex << checksum << dec << endl;
+    #ifdef HOST_SIM
+        sim_stop (reached == N_TARGETS && late == 0 ? 0 : 1);
+    #endif
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Ten Minute Mission Test" << endl;
+
+    xTaskCreate (task_control, "Control", 2048, NULL, 4, NULL);
+    xTaskCreate (task_mission, "Mission", 2048, NULL, 3, NULL);
+    xTaskCreate (task_monitor, "Monitor", 2048, NULL, 2, NULL);
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
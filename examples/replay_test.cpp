@@ -0,0 +1,238 @@
+/** @file replay_test.cpp
+ *    This file contains a program which tests recording and playing back
+ *    the traffic between tasks. A producer task sends commands through a
+ *    queue and temperatures through a share, at uneven times, to a consumer
+ *    task which folds everything it gets into a checksum. A 
+ *    @c ShareRecorder records the traffic into a buffer in RAM. The 
+ *    recording is then played back into the same queue and share with a
+ *    @c ShareReplay, as fast as possible and then at the recorded speed,
+ *    and the consumer's checksums are compared with the one from the live
+ *    run. They should all match, since the consumer sees the same items in
+ *    the same order.
+ *
+ *    On a real system the recording would go to an SD card file or serial
+ *    port, and be played back on the bench or on a PC running FreeRTOS.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskqueue.h"
+#include "taskshare.h"
+#include "recorder.h"
+#include "replay.h"
+
+
+/// The number of commands the producer sends
+const uint16_t N_COMMANDS = 2000;
+
+/// The size of the RAM buffer which holds the recording
+const size_t RECORDING_SIZE = 24000;
+
+
+/** @brief   A stream which writes into and reads back from a RAM buffer.
+ */
+class RamStream : public Stream
+{
+protected:
+    uint8_t* p_buffer;                    ///< The buffer
+    size_t size;                          ///< Size of the buffer
+    size_t length;                        ///< Bytes written
+    size_t position;                      ///< Next byte to be read
+
+public:
+    /// Create a stream with a buffer of the given size
+    RamStream (size_t buffer_size)
+        : size (buffer_size), length (0), position (0)
+    {
+        p_buffer = new uint8_t[buffer_size];
+    }
+
+    /// Write a byte into the buffer, if there's room
+    size_t write (uint8_t a_byte)
+    {
+        if (length >= size)
+        {
+            return 0;
+        }
+        p_buffer[length++] = a_byte;
+        return 1;
+    }
+
+    using Print::write;
+
+    /// Return the number of bytes which haven't been read yet
+    int available (void)
+    {
+        return length - position;
+    }
+
+    /// Read a byte, or return -1 if all have been read
+    int read (void)
+    {
+        return (position < length) ? p_buffer[position++] : -1;
+    }
+
+    /// Look at the next byte without reading it
+    int peek (void)
+    {
+        return (position < length) ? p_buffer[position] : -1;
+    }
+
+    /// Go back to the start of the buffer to read it again
+    void rewind (void)
+    {
+        position = 0;
+    }
+
+    /// Return the number of bytes written
+    size_t get_length (void)
+    {
+        return length;
+    }
+};
+
+
+/// Commands from the producer to the consumer
+Queue<int16_t> commands (16, "Commands");
+
+/// The latest temperature, from the producer
+Share<float> temperature ("Temperature");
+
+/// The buffer holding the recording
+RamStream recording (RECORDING_SIZE);
+
+/// The recorder
+ShareRecorder recorder (recording, 256);
+
+/// A player which plays the recording as fast as the consumer can go
+ShareReplay fast_replay (recording, 0.0f, "Fast Replay");
+
+/// A player which plays the recording at the speed it was recorded
+ShareReplay timed_replay (recording, 1.0f, "Timed Replay");
+
+/// The consumer's checksum of everything it has received
+volatile uint32_t checksum = 0;
+
+/// The number of commands the consumer has received
+volatile uint32_t received = 0;
+
+
+/** @brief   Task which gets commands and folds them into a checksum.
+ *  @details It reads the latest temperature with each command, so the
+ *           checksum depends on the order in which commands and
+ *           temperatures arrive as well as on their values.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_consumer (void* p_params)
+{
+    int16_t command;
+    for (;;)
+    {
+        commands.get (command);
+        int32_t tenths = (int32_t)(temperature.get () * 10.0f);
+        checksum = checksum * 31 + command + tenths;
+        received++;
+    }
+}
+
+
+/** @brief   Task which sends commands and temperatures at uneven times.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_producer (void* p_params)
+{
+    for (uint16_t count = 0; count < N_COMMANDS; count++)
+    {
+        commands.put ((int16_t)(count * 7 % 1000));
+        temperature.put (20.0f + (count % 50) * 0.1f);
+        if (count % 3 == 0)
+        {
+            vTaskDelay (1);
+        }
+    }
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   Start a run with the consumer's checksum and the temperature
+ *           cleared, so each run starts from the same state.
+ */
+void start_run (void)
+{
+    temperature.put (0.0f);
+    vTaskDelay (2);
+    checksum = 0;
+    received = 0;
+}
+
+
+/** @brief   Task which runs the test: record, then play back twice.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_test (void* p_params)
+{
+    start_run ();
+    recorder.add_all ();
+    recorder.begin (5);
+    recorder.start ();
+    xTaskCreate (task_producer, "Producer", 2048, NULL, 3, NULL);
+    while (received < N_COMMANDS)
+    {
+        vTaskDelay (10);
+    }
+    recorder.stop ();
+    vTaskDelay (20);
+    uint32_t live_checksum = checksum;
+    Serial << "Live: " << received << " commands, checksum " 
+           << live_checksum << ", " << recording.get_length ()
+           << " bytes recorded" << endl;
+
+    // Players are shares, so they're made once rather than on the stack
+    ShareReplay* const p_players[] = { &fast_replay, &timed_replay };
+    for (ShareReplay* p_replay : p_players)
+    {
+        start_run ();
+        recording.rewind ();
+        uint32_t start_ms = millis ();
+        p_replay->play ();
+        vTaskDelay (2);
+        Serial << p_replay->get_name () << ": " << received 
+               << " commands in " << (millis () - start_ms) 
+               << " ms, checksum " << checksum
+               << (checksum == live_checksum ? " (matches)" : " (DIFFERS)")
+               << endl;
+    }
+    print_all_shares (Serial);
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Record and Replay Test" << endl;
+
+    xTaskCreate (task_consumer, "Consumer", 2048, NULL, 4, NULL);
+    xTaskCreate (task_test, "Test", 4096, NULL, 2, NULL);
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
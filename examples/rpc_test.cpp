@@ -0,0 +1,183 @@
+/** @file rpc_test.cpp
+ *    This file contains a program which checks that a call given up on at
+ *    any moment leaves its reply slot ready for the next call. A client task
+ *    makes calls through an @c RpcEndpoint with just one reply slot, so every
+ *    call reuses the slot of the one before, and a server task answers them.
+ *    In each round the client gives up on one call while the server is in
+ *    the middle of replying, after it has marked the slot done but before it
+ *    has woken the client; it gives up on another before the server has
+ *    replied at all; and after each of these it makes a call whose reply it
+ *    waits for and checks. A reply which belonged to a call given up on would
+ *    show up as a wrong answer to the next call.
+ *
+ *    The server is normally held up between the two steps of a reply only
+ *    when it runs on the other core or is preempted, which happens rarely;
+ *    here it pauses there on purpose every round.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskrpc.h"
+
+
+/// The number of rounds of calls made by the client
+const uint32_t ROUNDS = 200;
+
+/// Kinds of calls, given by the request modulo 4
+enum CallKind : uint32_t
+{
+    CALL_STEPPED,       ///< Server pauses between the steps of its reply
+    CALL_SLOW,          ///< Server works a while before replying
+    CALL_CHECKED        ///< Server replies at once; client checks the reply
+};
+
+
+/** @brief   An endpoint which can reply in two steps with a pause between
+ *           them.
+ *  @details @c RpcEndpoint::reply() marks the slot done and then gives the
+ *           slot's semaphore. This class does the same, but waits between
+ *           the two so that a client can give up on its call right then.
+ */
+class SteppedEndpoint : public RpcEndpoint<uint32_t, uint32_t>
+{
+public:
+    /** @brief   Create an endpoint with one reply slot.
+     *  @param   p_name A name for the endpoint
+     */
+    SteppedEndpoint (const char* p_name)
+        : RpcEndpoint<uint32_t, uint32_t> (4, 1, p_name)
+    {
+    }
+
+    /** @brief   Send a reply, pausing after the slot has been marked done.
+     *  @param   call The request, as it was received from @c receive()
+     *  @param   answer The reply to be sent to the client
+     *  @param   pause The time to wait between the steps, in RTOS ticks
+     */
+    void reply_in_steps (const RpcRequest<uint32_t>& call, uint32_t answer,
+                         TickType_t pause)
+    {
+        RpcSlot<uint32_t>& slot = p_slots[call.slot];
+        slot.reply = answer;
+        uint8_t expected = RPC_PENDING;
+        if (slot.state.compare_exchange_strong (expected, RPC_DONE))
+        {
+            vTaskDelay (pause);
+            xSemaphoreGive (slot.done);
+        }
+        else
+        {
+            slot.state.store (RPC_FREE, std::memory_order_release);
+        }
+    }
+};
+
+
+/// Calls from the client task to the server task
+SteppedEndpoint calls ("Calls");
+
+
+/** @brief   Task which answers each call with ten times its request.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_server (void* p_params)
+{
+    RpcRequest<uint32_t> call;
+
+    for (;;)
+    {
+        calls.receive (call);
+        uint32_t answer = call.request * 10;
+        switch (call.request % 4)
+        {
+            case CALL_STEPPED:
+                calls.reply_in_steps (call, answer, 2);
+                break;
+            case CALL_SLOW:
+                vTaskDelay (2);
+                calls.reply (call, answer);
+                break;
+            default:
+                calls.reply (call, answer);
+                break;
+        }
+    }
+}
+
+
+/** @brief   Make a call, wait for its reply, and check the reply.
+ *  @param   request The request to send
+ *  @returns @c true if the correct reply came back in time
+ */
+bool checked_call (uint32_t request)
+{
+    uint32_t reply = 0;
+    return calls.call (request, reply, 50) && reply == request * 10;
+}
+
+
+/** @brief   Task which makes the calls and checks the replies.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_client (void* p_params)
+{
+    uint32_t wrong = 0;
+
+    for (uint32_t round = 1; round <= ROUNDS; round++)
+    {
+        // Give up while the server is between the two steps of its reply
+        Future<uint32_t> stepped = calls.call (round * 4 + CALL_STEPPED);
+        vTaskDelay (1);
+        stepped.cancel ();
+        wrong += checked_call (round * 4 + CALL_CHECKED) ? 0 : 1;
+
+        // Give up before the server has replied; it frees the slot later
+        Future<uint32_t> slow = calls.call (round * 4 + CALL_SLOW);
+        slow.cancel ();
+        vTaskDelay (3);
+        wrong += checked_call (round * 4 + CALL_CHECKED) ? 0 : 1;
+    }
+
+    Serial << 2 * ROUNDS << " checked calls, " << wrong << " wrong" << endl;
+    print_all_shares (Serial);
+    #ifdef HOST_SIM
+        sim_stop (wrong == 0 ? 0 : 1);
+    #endif
+
+    for (;;)
+    {
+        vTaskDelay (1000);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "RPC Cancel Test" << endl;
+
+    // The client outranks the server, so a signal left over from a reply it
+    // gave up on would wake it before the server could send the next reply
+    xTaskCreate (task_server, "Server", 2048, NULL, 2, NULL);
+    xTaskCreate (task_client, "Client", 4096, NULL, 3, NULL);
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
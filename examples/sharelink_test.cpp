@@ -0,0 +1,125 @@
+/** @file sharelink_test.cpp
+ *    This file contains a program which tests a @c ShareLink between two
+ *    microcontrollers whose second UARTs are wired together, TX to RX and RX
+ *    to TX, with a common ground. The same program runs on both; build it
+ *    with @c -DLINK_NODE_B for the second one. Node A runs a simulated motor
+ *    and puts its speed and a loop count into remote shares; node B puts a
+ *    setpoint, which changes every few seconds, into a remote share which
+ *    node A's motor follows. Each node prints the shares every second.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "sharelink.h"
+
+
+#ifdef ESP32
+    /// The serial port wired to the other processor
+    #define LINK_SERIAL Serial2
+#else
+    /// The serial port wired to the other processor
+    HardwareSerial link_serial (PA10, PA9);
+    #define LINK_SERIAL link_serial
+#endif
+
+/// The link to the other processor
+ShareLink share_link (LINK_SERIAL);
+
+/// The motor's speed, put in by node A
+RemoteShare<float> speed (share_link, 0, "Speed");
+
+/// The number of times node A's control loop has run
+RemoteShare<uint32_t> loops (share_link, 1, "Loops");
+
+/// The speed setpoint, put in by node B
+RemoteShare<int16_t> setpoint (share_link, 2, "Setpoint");
+
+
+#ifndef LINK_NODE_B
+/** @brief   Task which runs a simulated motor at 500 Hz on node A.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_motor (void* p_params)
+{
+    float motor_speed = 0.0f;
+    uint32_t count = 0;
+    setpoint.put (0);
+
+    TickType_t last_wake = xTaskGetTickCount ();
+    for (;;)
+    {
+        motor_speed += 0.01f * (setpoint.get () - motor_speed);
+        speed.put (motor_speed);
+        loops.put (++count);
+        vTaskDelayUntil (&last_wake, 2);
+    }
+}
+#else
+/** @brief   Task which changes the setpoint every few seconds on node B.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_setpoint (void* p_params)
+{
+    const int16_t SETPOINTS[] = { 0, 500, 1500, -800 };
+    uint8_t index = 0;
+    for (;;)
+    {
+        setpoint.put (SETPOINTS[index]);
+        index = (index + 1) % 4;
+        vTaskDelay (pdMS_TO_TICKS (4000));
+    }
+}
+#endif
+
+
+/** @brief   Task which prints the linked shares every second.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_print (void* p_params)
+{
+    for (;;)
+    {
+        vTaskDelay (pdMS_TO_TICKS (1000));
+        Serial << "Setpoint " << setpoint.get () << ", speed "
+               << speed.get () << ", loops " << loops.get () << endl;
+        print_all_shares (Serial);
+        Serial << endl;
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    LINK_SERIAL.begin (921600);
+    delay (1000);
+    Serial << endl << "Share Link Test" << endl;
+
+    #ifndef LINK_NODE_B
+        xTaskCreate (task_motor, "Motor", 2048, NULL, 5, NULL);
+    #else
+        xTaskCreate (task_setpoint, "Setpoint", 2048, NULL, 5, NULL);
+    #endif
+    xTaskCreate (task_print, "Print", 4096, NULL, 1, NULL);
+    share_link.begin ();
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -0,0 +1,122 @@
+/** @file shell_test.cpp
+ *    This file contains a program which tests the share shell. A control
+ *    task runs a simulated motor at 200 Hz, reading its setpoint and gain
+ *    from shares and putting its speed into a share, a running statistics
+ *    share and a queue which a slow logging task empties. Commands typed
+ *    into the serial monitor can then read and change the shares while the
+ *    program runs, for example:
+ *    @code
+ *    watch 5 Speed
+ *    set Setpoint 500
+ *    set Gain 0.05
+ *    watch off
+ *    peek Speed Log
+ *    stats Speed Stats
+ *    reset-stats Speed Stats
+ *    @endcode
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+#endif
+#include "taskshare.h"
+#include "taskqueue.h"
+#include "atomicshare.h"
+#include "statsshare.h"
+#include "shareshell.h"
+
+
+/// The speed the motor should run at
+Share<int16_t> setpoint ("Setpoint");
+
+/// The gain of the speed controller
+Share<float> gain ("Gain");
+
+/// The motor's speed
+Share<float> speed ("Speed");
+
+/// Running statistics of the motor's speed
+StatsShare<float> speed_stats ("Speed Stats");
+
+/// Speeds waiting to be logged
+Queue<float> speed_log (32, "Speed Log", 0);
+
+/// The number of times the control loop has run
+CounterShare<uint32_t> loops ("Loops");
+
+/// The shell, which talks on the serial port
+ShareShell shell (Serial);
+
+
+/** @brief   Task which runs a simulated motor under proportional control.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_control (void* p_params)
+{
+    float motor_speed = 0.0f;
+
+    TickType_t last_wake = xTaskGetTickCount ();
+    for (;;)
+    {
+        float duty = gain.get () * (setpoint.get () - motor_speed);
+        motor_speed += 0.05f * (10.0f * duty - motor_speed);
+
+        speed.put (motor_speed);
+        speed_stats.put (motor_speed);
+        speed_log.put (motor_speed);
+        loops++;
+
+        vTaskDelayUntil (&last_wake, 5);
+    }
+}
+
+
+/** @brief   Task which slowly takes speeds from the log queue.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_log (void* p_params)
+{
+    float logged;
+    for (;;)
+    {
+        while (!speed_log.is_empty ())
+        {
+            speed_log.get (logged);
+        }
+        vTaskDelay (100);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Share Shell Test" << endl;
+
+    setpoint.put (1000);
+    gain.put (0.02f);
+
+    xTaskCreate (task_control, "Control", 2048, NULL, 5, NULL);
+    xTaskCreate (task_log, "Log", 2048, NULL, 2, NULL);
+    shell.begin ();
+
+    // If using an STM32, we need to start the scheduler manually
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -0,0 +1,171 @@
+/** @file stats_test.cpp
+ *    This file contains a program which compares the two kinds of statistics
+ *    share on a signal which drifts. A timer interrupt makes one sample of a
+ *    simulated temperature reading every millisecond, puts it into a
+ *    @c FixedStatsShare, as an ISR on the ESP32 must, and sends it through a
+ *    queue to a task which puts it into a @c StatsShare<float> and adds it
+ *    into exact sums of its own. The reading holds near one value, steps up
+ *    and stays there, then creeps upward with a little noise. When all the
+ *    samples have been taken, the program prints the mean and standard
+ *    deviation from each share next to the exact ones.
+ *
+ *    In the host simulation the program checks that the integer share's
+ *    numbers match the exact ones and that the two shares agree, then exits.
+ *
+ *  @author JR Ridgely
+ *  @date   2026-Oct-17 Original file
+ */
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32L4xx || defined STM32F4xx)
+    #include <STM32FreeRTOS.h>
+    #include <HardwareTimer.h>
+#endif
+#include "taskqueue.h"
+#include "statsshare.h"
+
+
+/// The number of samples taken, one per millisecond
+const uint32_t N_SAMPLES = 12000;
+
+/// Statistics kept by the interrupt, in integers
+FixedStatsShare<int16_t> fixed_stats ("Fixed");
+
+/// Statistics kept by the checking task, in floating point
+StatsShare<float> float_stats ("Float");
+
+/// Samples from the timer interrupt to the checking task
+Queue<int16_t> samples (64, "Samples");
+
+/// The number of samples made by the interrupt
+volatile uint32_t samples_made = 0;
+
+
+/** @brief   Make the sample with a given number.
+ *  @details For the first second the reading wavers among 100, 101 and 102;
+ *           for the next two it sits at 103; then it creeps up by one every
+ *           50 ms, wavering by up to 2 either way.
+ *  @param   number The number of the sample, from 0
+ */
+int16_t make_sample (uint32_t number)
+{
+    if (number < 1000)
+    {
+        return 100 + number % 3;
+    }
+    if (number < 3000)
+    {
+        return 103;
+    }
+    return 103 + (number - 3000) / 50 + (number * 7) % 5 - 2;
+}
+
+
+/** @brief   Interrupt service routine which makes one sample and puts it into
+ *           the integer share and the queue.
+ */
+#if defined ESP32 && !defined HOST_SIM
+void IRAM_ATTR timer_ISR (void)
+#else
+void timer_ISR (void)
+#endif
+{
+    if (samples_made < N_SAMPLES)
+    {
+        int16_t sample = make_sample (samples_made++);
+        fixed_stats.put (sample);
+        samples.ISR_put (sample);
+    }
+}
+
+
+/** @brief   Set up a timer to run @c timer_ISR() every millisecond.
+ */
+void set_up_timer (void)
+{
+    #if defined HOST_SIM
+        sim_attach_interrupt (1000, timer_ISR);
+    #elif defined ESP32
+        hw_timer_t* p_timer = timerBegin (0, 80, true);   // 1 MHz count
+        timerAttachInterrupt (p_timer, timer_ISR, true);
+        timerAlarmWrite (p_timer, 1000, true);
+        timerAlarmEnable (p_timer);
+    #else
+        HardwareTimer* p_timer = new HardwareTimer (TIM3);
+        p_timer->setOverflow (1000, HERTZ_FORMAT);
+        p_timer->attachInterrupt (timer_ISR);
+        p_timer->resume ();
+    #endif
+}
+
+
+/** @brief   Task which puts each sample into the floating point share and
+ *           the exact sums, then compares the results.
+ *  @param   p_params A pointer, which is ignored, to no parameters
+ */
+void task_check (void* p_params)
+{
+    int64_t sum = 0, sum_sq = 0;
+
+    for (uint32_t count = 0; count < N_SAMPLES; count++)
+    {
+        int16_t sample = samples.get ();
+        float_stats.put (sample);
+        sum += sample;
+        sum_sq += (int64_t)sample * sample;
+    }
+
+    // The sums are small enough that a double holds them exactly
+    double mean = (double)sum / N_SAMPLES;
+    double sd = sqrt (((double)sum_sq - mean * sum) / (N_SAMPLES - 1));
+    Stats<int16_t> fixed = fixed_stats.get ();
+    Stats<float> floating = float_stats.get ();
+
+    Serial << "Exact: mean=" << (float)mean << " sd=" << (float)sd << endl;
+    Serial << "Fixed: ";
+    print_stats (Serial, fixed);
+    Serial << endl << "Float: ";
+    print_stats (Serial, floating);
+    Serial << endl;
+
+    bool good = fixed.count == N_SAMPLES && floating.count == N_SAMPLES
+                && fabs (fixed.mean - mean) < 1e-4 * mean
+                && fabs (fixed.std_dev () - sd) < 1e-4 * sd
+                && fabsf (fixed.mean - floating.mean) < 1e-3f * fixed.mean
+                && fabsf (fixed.std_dev () - floating.std_dev ())
+                   < 1e-2f * fixed.std_dev ();
+    Serial << (good ? "The shares agree" : "The shares DISAGREE") << endl;
+    #ifdef HOST_SIM
+        sim_stop (good ? 0 : 1);
+    #endif
+
+    for (;;)
+    {
+        vTaskDelay (1000);
+    }
+}
+
+
+/** @brief   The usual Arduino setup function which runs once as we start up.
+ */
+void setup (void)
+{
+    Serial.begin (115200);
+    delay (1000);
+    Serial << endl << "Statistics Share Test" << endl;
+
+    xTaskCreate (task_check, "Check", 4096, NULL, 4, NULL);
+    set_up_timer ();
+
+    #if (defined STM32L4xx || defined STM32F4xx)
+        vTaskStartScheduler ();
+    #endif
+}
+
+
+/** @brief   The Arduino loop function, which is unused in this program.
+ */
+void loop (void)
+{
+}
@@ -0,0 +1,376 @@
+//*****************************************************************************
+/** @file    blockfilter_bench.cpp
+ *  @brief   Checks the block filters in @c blockfilter.h and measures how
+ *           many samples per second each one filters.
+ *  @details A million samples of noise and sine waves are filtered by each
+ *           kind of filter in @c float, @c Q15 and @c Q31, 64 samples at a
+ *           time, as a task would filter blocks from a @c BlockChannel. The
+ *           same samples are also filtered one at a time by the kind of
+ *           simple loop which the block filters replace, with a ring buffer
+ *           for the FIR filter's past inputs. The program checks that:
+ *           - the block FIR filters give exactly the same results as the
+ *             sample-at-a-time loops for fixed-point samples, and nearly the
+ *             same for @c float;
+ *           - each output of the decimating filter is exactly the matching
+ *             output of the FIR filter with the same coefficients;
+ *           - the biquad cascades match one done in @c double.
+ *
+ *           On a PC this runs the portable code, whose FIR loops the
+ *           compiler vectorizes; on an STM32 the same classes call
+ *           CMSIS-DSP instead.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O3 -std=gnu++17 -Isrc host/blockfilter_bench.cpp \
+ *               -o blockfilter_bench
+ *           ./blockfilter_bench
+ *           @endcode
+ *           Adding @c -march=native lets the compiler use AVX2 if the PC has
+ *           it. The program's exit status is 0 if every check passed.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "blockfilter.h"
+
+
+/// The number of samples filtered
+const uint32_t N_SAMPLES = 1 << 20;
+
+/// The number of samples in each block
+const uint16_t BLOCK = 64;
+
+/// The number of taps in the FIR and decimating filters
+const uint16_t TAPS = 32;
+
+/// The decimation factor
+const uint8_t FACTOR = 4;
+
+/// The number of stages in the biquad cascade
+const uint8_t STAGES = 4;
+
+/// The number of times each filter is run over the samples when timing
+const uint16_t REPEATS = 20;
+
+
+/// Low pass FIR coefficients, filled in by @c design_fir()
+static float fir_taps[TAPS];
+
+/// Anti-aliasing coefficients for decimating by @c FACTOR
+static float decimate_taps[TAPS];
+
+/// Biquad stages, filled in by @c design_biquads()
+static float biquad_stages[STAGES * 5];
+
+
+/** @brief   Return the time in seconds from a steady clock.
+ */
+static double seconds (void)
+{
+    using namespace std::chrono;
+    return duration<double> (steady_clock::now ().time_since_epoch ())
+           .count ();
+}
+
+
+/** @brief   Design a windowed-sinc low pass FIR filter whose gain at DC is 1.
+ *  @param   p_taps Where to put the coefficients
+ *  @param   cutoff The cutoff frequency as a fraction of the sample rate
+ */
+static void design_fir (float* p_taps, double cutoff)
+{
+    double sum = 0.0;
+    double taps[TAPS];
+    for (uint16_t tap = 0; tap < TAPS; tap++)
+    {
+        double x = tap - (TAPS - 1) / 2.0;
+        double sinc = (x == 0.0) ? 2.0 * cutoff
+                                 : sin (2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = 0.54 - 0.46 * cos (2.0 * M_PI * tap / (TAPS - 1));
+        taps[tap] = sinc * window;
+        sum += taps[tap];
+    }
+    for (uint16_t tap = 0; tap < TAPS; tap++)
+    {
+        p_taps[tap] = (float)(taps[tap] / sum);
+    }
+}
+
+
+/** @brief   Design a cascade of second order low pass stages, each from the
+ *           "Audio EQ Cookbook", with cutoffs spread out a little.
+ */
+static void design_biquads (void)
+{
+    for (uint8_t stage = 0; stage < STAGES; stage++)
+    {
+        double w0 = 2.0 * M_PI * (0.04 + 0.01 * stage);
+        double alpha = sin (w0) / (2.0 * 0.7071);
+        double a0 = 1.0 + alpha;
+        float* p_c = biquad_stages + stage * 5;
+        p_c[0] = (float)((1.0 - cos (w0)) / 2.0 / a0);
+        p_c[1] = (float)((1.0 - cos (w0)) / a0);
+        p_c[2] = p_c[0];
+        p_c[3] = (float)(-2.0 * cos (w0) / a0);
+        p_c[4] = (float)((1.0 - alpha) / a0);
+    }
+}
+
+
+/** @brief   Filter all the samples one at a time with an FIR filter kept in
+ *           a ring buffer, as a simple filter task would.
+ *  @details Sums are kept in 64 bits and truncated as CMSIS-DSP does, so the
+ *           results should match exactly.
+ */
+template <class Sample>
+static void fir_one_at_a_time (const Sample* p_in, Sample* p_out,
+                               const float* p_taps)
+{
+    Sample coeffs[TAPS];
+    Sample ring[TAPS];
+    for (uint16_t tap = 0; tap < TAPS; tap++)
+    {
+        coeffs[tap] = BlockMath<Sample>::from (p_taps[tap], 0);
+        ring[tap] = BlockMath<Sample>::from (0.0f, 0);
+    }
+    uint16_t newest = 0;
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        newest = (newest + 1) % TAPS;
+        ring[newest] = p_in[index];
+        typename std::conditional<std::is_same<Sample, float>::value,
+                                  float, int64_t>::type sum = 0;
+        for (uint16_t tap = 0; tap < TAPS; tap++)
+        {
+            sum += BlockMath<Sample>::mul (coeffs[tap],
+                                           ring[(newest + TAPS - tap)
+                                                % TAPS]);
+        }
+        p_out[index] = BlockMath<Sample>::finish (sum, 0);
+    }
+}
+
+
+/** @brief   Filter all the samples one at a time with the biquad cascade in
+ *           @c double, as a reference.
+ */
+static void biquads_in_double (const double* p_in, double* p_out)
+{
+    double state[STAGES][4] = { };
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        double value = p_in[index];
+        for (uint8_t stage = 0; stage < STAGES; stage++)
+        {
+            const float* p_c = biquad_stages + stage * 5;
+            double* p_s = state[stage];
+            double output = p_c[0] * value + p_c[1] * p_s[0]
+                            + p_c[2] * p_s[1] - p_c[3] * p_s[2]
+                            - p_c[4] * p_s[3];
+            p_s[1] = p_s[0];
+            p_s[0] = value;
+            p_s[3] = p_s[2];
+            p_s[2] = output;
+            value = output;
+        }
+        p_out[index] = value;
+    }
+}
+
+
+/// Return a sample as a @c double whatever its type
+inline double as_double (float value) { return value; }
+inline double as_double (Q15 value) { return value.to_double (); }
+inline double as_double (Q31 value) { return value.to_double (); }
+
+
+/** @brief   Run a filter over all the samples in blocks.
+ *  @returns The number of output samples
+ */
+template <class Filter, class Sample>
+static size_t run_blocks (Filter& filter, Sample* p_in, Sample* p_out)
+{
+    size_t outputs = 0;
+    for (uint32_t start = 0; start < N_SAMPLES; start += BLOCK)
+    {
+        outputs += filter.process (Span<Sample> (p_in + start, BLOCK),
+                                   Span<Sample> (p_out + outputs, BLOCK));
+    }
+    return outputs;
+}
+
+
+/** @brief   Time a filter and print its throughput.
+ *  @param   title The filter's name
+ *  @param   filter The filter
+ *  @param   p_in The input samples
+ *  @param   p_out Room for the output samples
+ */
+template <class Filter, class Sample>
+static void time_blocks (const char* title, Filter& filter, Sample* p_in,
+                         Sample* p_out)
+{
+    double start = seconds ();
+    for (uint16_t count = 0; count < REPEATS; count++)
+    {
+        run_blocks (filter, p_in, p_out);
+    }
+    double took = seconds () - start;
+    printf ("  %-30s %8.1f M samples/s\n", title,
+            (double)N_SAMPLES * REPEATS / took / 1e6);
+}
+
+
+/** @brief   Time the sample-at-a-time FIR filter and print its throughput.
+ */
+template <class Sample>
+static void time_one_at_a_time (const char* title, Sample* p_in,
+                                Sample* p_out)
+{
+    double start = seconds ();
+    for (uint16_t count = 0; count < REPEATS / 4; count++)
+    {
+        fir_one_at_a_time (p_in, p_out, fir_taps);
+    }
+    double took = seconds () - start;
+    printf ("  %-30s %8.1f M samples/s\n", title,
+            (double)N_SAMPLES * (REPEATS / 4) / took / 1e6);
+}
+
+
+/** @brief   Check and time every filter with one type of sample.
+ *  @param   type_name The name of the sample type
+ *  @param   p_input The input samples
+ *  @param   p_truth The biquad cascade's output in @c double
+ *  @param   fir_tolerance How far the block FIR may be from the one sample
+ *           at a time FIR
+ *  @param   biquad_tolerance How far the biquads may be from @c double
+ *  @returns @c true if every check passed
+ */
+template <class Sample>
+static bool test_type (const char* type_name, Sample* p_input,
+                       const double* p_truth, double fir_tolerance,
+                       double biquad_tolerance)
+{
+    std::vector<Sample> reference (N_SAMPLES), output (N_SAMPLES),
+                        decimated (N_SAMPLES / FACTOR);
+    bool passed = true;
+
+    // FIR in blocks against FIR one sample at a time
+    fir_one_at_a_time (p_input, reference.data (), fir_taps);
+    BlockFIR<Sample, TAPS, BLOCK> fir (fir_taps);
+    run_blocks (fir, p_input, output.data ());
+    double fir_error = 0.0;
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        fir_error = fmax (fir_error, fabs (as_double (output[index])
+                                           - as_double (reference[index])));
+    }
+    passed &= fir_error <= fir_tolerance;
+
+    // Decimator against every FACTOR th output of the same FIR
+    BlockFIR<Sample, TAPS, BLOCK> anti_alias (decimate_taps);
+    BlockDecimator<Sample, TAPS, FACTOR, BLOCK> decimator (decimate_taps);
+    run_blocks (anti_alias, p_input, output.data ());
+    size_t outputs = run_blocks (decimator, p_input, decimated.data ());
+    bool decimate_exact = (outputs == N_SAMPLES / FACTOR);
+    for (uint32_t index = 0; index < outputs; index++)
+    {
+        decimate_exact &= as_double (decimated[index])
+                          == as_double (output[index * FACTOR]);
+    }
+    passed &= decimate_exact;
+
+    // Biquads against double
+    BlockBiquadCascade<Sample, STAGES> biquads (biquad_stages);
+    run_blocks (biquads, p_input, output.data ());
+    double biquad_error = 0.0;
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        biquad_error = fmax (biquad_error, fabs (as_double (output[index])
+                                                 - p_truth[index]));
+    }
+    passed &= biquad_error <= biquad_tolerance;
+
+    printf ("%s: FIR error %.2e, decimator %s, biquad error %.2e "
+            "(shift %u)\n", type_name, fir_error,
+            decimate_exact ? "exact" : "WRONG", biquad_error,
+            biquads.get_shift ());
+
+    char title[40];
+    snprintf (title, sizeof (title), "FIR %u taps, %s", TAPS, type_name);
+    time_blocks (title, fir, p_input, output.data ());
+    snprintf (title, sizeof (title), "Decimate by %u, %s", FACTOR,
+              type_name);
+    time_blocks (title, decimator, p_input, decimated.data ());
+    snprintf (title, sizeof (title), "Biquad x %u, %s", STAGES, type_name);
+    time_blocks (title, biquads, p_input, output.data ());
+    snprintf (title, sizeof (title), "FIR one at a time, %s", type_name);
+    time_one_at_a_time (title, p_input, reference.data ());
+    return passed;
+}
+
+
+int main (void)
+{
+    design_fir (fir_taps, 0.1);
+    design_fir (decimate_taps, 0.4 / FACTOR);
+    design_biquads ();
+
+    // Two sine waves and some noise, within about -0.6 to 0.6
+    std::vector<double> input (N_SAMPLES);
+    std::vector<float> float_input (N_SAMPLES);
+    std::vector<Q15> q15_input (N_SAMPLES);
+    std::vector<Q31> q31_input (N_SAMPLES);
+    uint32_t random = 507;
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        random = random * 1664525 + 1013904223;
+        double noise = ((random >> 8) / 16777216.0 - 0.5) * 0.2;
+        double value = 0.3 * sin (index * 0.01) + 0.2 * sin (index * 0.9)
+                       + noise;
+        float_input[index] = (float)value;
+        q15_input[index] = Q15::from (value);
+        q31_input[index] = Q31::from (value);
+    }
+
+    // The biquads' reference is worked from each type's own input, so only
+    // the filtering itself adds error
+    std::vector<double> truth (N_SAMPLES);
+    bool passed = true;
+
+    printf ("Filtering %u samples in blocks of %u:\n", N_SAMPLES, BLOCK);
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        input[index] = float_input[index];
+    }
+    biquads_in_double (input.data (), truth.data ());
+    passed &= test_type ("float", float_input.data (), truth.data (), 1e-5,
+                         1e-4);
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        input[index] = q15_input[index].to_double ();
+    }
+    biquads_in_double (input.data (), truth.data ());
+    passed &= test_type ("Q15", q15_input.data (), truth.data (), 0.0,
+                         1e-2);
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        input[index] = q31_input[index].to_double ();
+    }
+    biquads_in_double (input.data (), truth.data ());
+    passed &= test_type ("Q31", q31_input.data (), truth.data (), 0.0,
+                         1e-5);
+
+    printf ("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
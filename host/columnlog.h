@@ -0,0 +1,626 @@
+//*****************************************************************************
+/** @file    columnlog.h
+ *  @brief   A binary log file format which stores share values by column,
+ *           with a writer and a memory-mapped reader for use on a PC.
+ *  @details Long captures of telemetry are far too slow to analyze as text.
+ *           A column log stores the rows of values from a set of shares in
+ *           blocks; within each block the times are stored together, then
+ *           all the values of the first share, then all of the second, and
+ *           so on. A program which wants one share's values can then read
+ *           them straight out of the file as an array, with no parsing, and
+ *           never touches the other columns' pages.
+ *
+ *           @section columnlog_format File Format
+ *           All numbers are little endian. The file begins with a header:
+ *           - 8 bytes, the characters @c ME507COL
+ *           - 2 bytes, the format version, now 1
+ *           - 2 bytes, the number of channels
+ *           - 4 bytes, the number of rows in each full block
+ *           - 16 bytes reserved, zero
+ *           - For each channel, 16 bytes: its @c ShareValueType code, then
+ *             its name, padded with zeros (the same names and types which
+ *             @c BaseShare gives)
+ *
+ *           Then come the blocks. Each block has a header:
+ *           - 4 bytes, the characters @c BLK1
+ *           - 4 bytes, the number of rows in this block
+ *           - 8 bytes, the time of the first row in microseconds
+ *           - 8 bytes, the time of the last row
+ *
+ *           which is followed by the columns: the time of each row as an 
+ *           8-byte number, then each channel's values in the channel's own
+ *           type. Each column is padded with zeros to a multiple of 8 bytes,
+ *           so every column of a memory-mapped file is properly aligned. 
+ *           Times must not decrease from one row to the next. Every block
+ *           but the last is full. A last block which was cut short, as when
+ *           the program writing it crashed, is ignored by the reader.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _COLUMNLOG_H_
+#define _COLUMNLOG_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "sharetype.h"
+#include "span.h"
+
+
+/// The characters at the beginning of a column log file
+#define COLUMNLOG_MAGIC         "ME507COL"
+
+/// The version of the format written by this code
+#define COLUMNLOG_VERSION       1
+
+/// The characters at the beginning of each block
+#define COLUMNLOG_BLOCK_MAGIC   "BLK1"
+
+/// The default number of rows in a full block
+#define COLUMNLOG_BLOCK_ROWS    65536
+
+
+/// The header at the beginning of a column log file
+struct ColumnLogHeader
+{
+    char magic[8];                        ///< @c COLUMNLOG_MAGIC
+    uint16_t version;                     ///< @c COLUMNLOG_VERSION
+    uint16_t n_channels;                  ///< Number of channels
+    uint32_t block_rows;                  ///< Rows in each full block
+    uint8_t reserved[16];                 ///< Zeros
+};
+
+
+/// The description of one channel in a column log file
+struct ColumnLogChannel
+{
+    uint8_t type;                         ///< @c ShareValueType code
+    char name[15];                        ///< Name, padded with zeros
+};
+
+
+/// The header at the beginning of each block
+struct ColumnLogBlock
+{
+    char magic[4];                        ///< @c COLUMNLOG_BLOCK_MAGIC
+    uint32_t n_rows;                      ///< Rows in this block
+    uint64_t first_us;                    ///< Time of the first row
+    uint64_t last_us;                     ///< Time of the last row
+};
+
+
+/** @brief   Round a number of bytes up to a multiple of 8.
+ *  @param   bytes The number of bytes
+ *  @returns The rounded number
+ */
+inline size_t columnlog_pad (size_t bytes)
+{
+    return (bytes + 7) & ~(size_t)7;
+}
+
+
+/** @brief   Class which writes a column log file.
+ *  @details Rows are collected in memory until a block is full, then the
+ *           block is written with one call. 
+ */
+class ColumnLogWriter
+{
+protected:
+    FILE* p_file;                         ///< The file being written
+    std::vector<uint8_t> types;           ///< Type of each channel
+    uint32_t block_rows;                  ///< Rows in each full block
+    uint32_t rows;                        ///< Rows in the block so far
+    std::vector<uint64_t> times;          ///< Time column of the block
+    std::vector<std::vector<uint8_t> > columns; ///< Value columns
+    uint64_t total_rows;                  ///< Rows written altogether
+
+public:
+    /** @brief   Create a writer which has no file open.
+     */
+    ColumnLogWriter (void)
+        : p_file (NULL), block_rows (0), rows (0), total_rows (0)
+    {
+    }
+
+    /** @brief   Close the file, if it's open, when the writer is destroyed.
+     */
+    ~ColumnLogWriter (void)
+    {
+        close ();
+    }
+
+    /** @brief   Create a log file and write its header.
+     *  @param   p_path The path of the file
+     *  @param   names The channels' names, of which only 15 characters are
+     *           kept
+     *  @param   channel_types The channels' @c ShareValueType codes
+     *  @param   rows_per_block The number of rows in each full block
+     *  @returns @c true if the file was created
+     */
+    bool open (const char* p_path, const std::vector<std::string>& names,
+               const std::vector<uint8_t>& channel_types,
+               uint32_t rows_per_block = COLUMNLOG_BLOCK_ROWS)
+    {
+        close ();
+        p_file = fopen (p_path, "wb");
+        if (p_file == NULL)
+        {
+            return false;
+        }
+        types = channel_types;
+        block_rows = rows_per_block;
+        rows = 0;
+        total_rows = 0;
+        times.resize (block_rows);
+        columns.assign (types.size (), std::vector<uint8_t> ());
+        for (size_t index = 0; index < types.size (); index++)
+        {
+            columns[index].resize (columnlog_pad (block_rows
+                                   * share_type_size (types[index])));
+        }
+
+        ColumnLogHeader header;
+        memset (&header, 0, sizeof (header));
+        memcpy (header.magic, COLUMNLOG_MAGIC, sizeof (header.magic));
+        header.version = COLUMNLOG_VERSION;
+        header.n_channels = types.size ();
+        header.block_rows = block_rows;
+        fwrite (&header, sizeof (header), 1, p_file);
+        for (size_t index = 0; index < types.size (); index++)
+        {
+            ColumnLogChannel channel;
+            memset (&channel, 0, sizeof (channel));
+            channel.type = types[index];
+            memcpy (channel.name, names[index].c_str (),
+                    std::min (names[index].size (), sizeof (channel.name)));
+            fwrite (&channel, sizeof (channel), 1, p_file);
+        }
+        return !ferror (p_file);
+    }
+
+    /** @brief   Add a row of values to the log.
+     *  @param   time_us The time at which the values were sampled
+     *  @param   p_values Pointer to one value for each channel, widened as
+     *           by @c share_type_widen()
+     */
+    void add_row (uint64_t time_us, const uint64_t* p_values)
+    {
+        times[rows] = time_us;
+        for (size_t index = 0; index < types.size (); index++)
+        {
+            uint8_t size = share_type_size (types[index]);
+            share_type_narrow (types[index], p_values[index],
+                               columns[index].data () + rows * size);
+        }
+        if (++rows == block_rows)
+        {
+            write_block ();
+        }
+    }
+
+    /** @brief   Write the last, partly full block and close the file.
+     */
+    void close (void)
+    {
+        if (p_file != NULL)
+        {
+            write_block ();
+            fclose (p_file);
+            p_file = NULL;
+        }
+    }
+
+    /** @brief   Return the number of rows written so far.
+     *  @returns The number of rows, including those not yet written out
+     */
+    uint64_t get_rows (void)
+    {
+        return total_rows + rows;
+    }
+
+protected:
+    /** @brief   Write the rows collected so far as a block.
+     */
+    void write_block (void)
+    {
+        if (rows == 0)
+        {
+            return;
+        }
+        ColumnLogBlock block;
+        memcpy (block.magic, COLUMNLOG_BLOCK_MAGIC, sizeof (block.magic));
+        block.n_rows = rows;
+        block.first_us = times[0];
+        block.last_us = times[rows - 1];
+        fwrite (&block, sizeof (block), 1, p_file);
+        fwrite (times.data (), sizeof (uint64_t), rows, p_file);
+
+        // Pad each column with zeros to a multiple of 8 bytes
+        for (size_t index = 0; index < types.size (); index++)
+        {
+            size_t bytes = rows * share_type_size (types[index]);
+            size_t padded = columnlog_pad (bytes);
+            memset (columns[index].data () + bytes, 0, padded - bytes);
+            fwrite (columns[index].data (), 1, padded, p_file);
+        }
+        total_rows += rows;
+        rows = 0;
+    }
+};
+
+
+/** @brief   Class which reads a column log file by mapping it into memory.
+ *  @details Opening a file maps it and walks through the block headers to
+ *           build an index of blocks by time. Only the page holding each
+ *           block's header is read, so this is quick even for files of many
+ *           gigabytes. Columns are then returned as
+ *           @c Span objects which point straight into the mapped file, so no
+ *           data is copied; the operating system reads pages from the disk
+ *           as they're first touched.
+ *           @code
+ *           ColumnLogReader log;
+ *           log.open ("run.col");
+ *           int speed = log.find ("Motor Speed");
+ *           double sum = 0.0;
+ *           log.scan<float> (speed, start_us, end_us,
+ *               [&] (Span<const uint64_t> times, Span<const float> values)
+ *               {
+ *                   for (float value : values)
+ *                   {
+ *                       sum += value;
+ *                   }
+ *               });
+ *           @endcode
+ */
+class ColumnLogReader
+{
+protected:
+    /// What the reader knows about each block
+    struct BlockInfo
+    {
+        const uint8_t* p_start;           ///< The block's header
+        uint32_t n_rows;                  ///< Rows in the block
+        uint64_t first_us;                ///< Time of the first row
+        uint64_t last_us;                 ///< Time of the last row
+    };
+
+    const uint8_t* p_map;                 ///< The mapped file
+    size_t map_size;                      ///< Size of the mapped file
+    std::vector<uint8_t> types;           ///< Type of each channel
+    std::vector<std::string> names;       ///< Name of each channel
+    std::vector<BlockInfo> blocks;        ///< Index of the blocks
+    uint64_t total_rows;                  ///< Rows in all the blocks
+
+public:
+    /** @brief   Create a reader which has no file open.
+     */
+    ColumnLogReader (void) : p_map (NULL), map_size (0), total_rows (0)
+    {
+    }
+
+    /** @brief   Unmap the file, if one is open, when the reader is destroyed.
+     */
+    ~ColumnLogReader (void)
+    {
+        close ();
+    }
+
+    /** @brief   Map a log file into memory and index its blocks.
+     *  @param   p_path The path of the file
+     *  @returns @c true if the file was opened and its header is valid
+     */
+    bool open (const char* p_path)
+    {
+        close ();
+        int fd = ::open (p_path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat info;
+        if (fstat (fd, &info) != 0
+            || info.st_size < (off_t)sizeof (ColumnLogHeader))
+        {
+            ::close (fd);
+            return false;
+        }
+        map_size = info.st_size;
+        void* p_mapped = mmap (NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close (fd);
+        if (p_mapped == MAP_FAILED)
+        {
+            map_size = 0;
+            return false;
+        }
+        p_map = (const uint8_t*)p_mapped;
+
+        const ColumnLogHeader* p_header = (const ColumnLogHeader*)p_map;
+        size_t channels_end = sizeof (ColumnLogHeader)
+            + p_header->n_channels * sizeof (ColumnLogChannel);
+        if (memcmp (p_header->magic, COLUMNLOG_MAGIC, 8) != 0
+            || p_header->version != COLUMNLOG_VERSION
+            || channels_end > map_size)
+        {
+            close ();
+            return false;
+        }
+        const ColumnLogChannel* p_channel
+            = (const ColumnLogChannel*)(p_map + sizeof (ColumnLogHeader));
+        for (uint16_t index = 0; index < p_header->n_channels; index++)
+        {
+            types.push_back (p_channel[index].type);
+            names.push_back (std::string (p_channel[index].name,
+                             strnlen (p_channel[index].name,
+                                      sizeof (p_channel[index].name))));
+        }
+
+        // Walk the block headers; each block's size follows from its rows.
+        // Turn off read-ahead meanwhile, or each header read from the disk
+        // would bring in megabytes of the block after it
+        madvise ((void*)p_map, map_size, MADV_RANDOM);
+        size_t offset = channels_end;
+        while (offset + sizeof (ColumnLogBlock) <= map_size)
+        {
+            const ColumnLogBlock* p_block
+                = (const ColumnLogBlock*)(p_map + offset);
+            if (memcmp (p_block->magic, COLUMNLOG_BLOCK_MAGIC, 4) != 0)
+            {
+                break;
+            }
+            size_t size = block_bytes (p_block->n_rows);
+            if (offset + size > map_size)
+            {
+                break;                    // A block cut short; ignore it
+            }
+            BlockInfo block = { p_map + offset, p_block->n_rows,
+                                p_block->first_us, p_block->last_us };
+            blocks.push_back (block);
+            total_rows += p_block->n_rows;
+            offset += size;
+        }
+        madvise ((void*)p_map, map_size, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    /** @brief   Unmap the file and forget about it.
+     */
+    void close (void)
+    {
+        if (p_map != NULL)
+        {
+            munmap ((void*)p_map, map_size);
+        }
+        p_map = NULL;
+        map_size = 0;
+        types.clear ();
+        names.clear ();
+        blocks.clear ();
+        total_rows = 0;
+    }
+
+    /** @brief   Return the number of channels in the file.
+     *  @returns The number of channels
+     */
+    size_t get_channels (void) const
+    {
+        return types.size ();
+    }
+
+    /** @brief   Return a channel's name.
+     *  @param   channel The channel's index
+     *  @returns The name
+     */
+    const std::string& get_name (size_t channel) const
+    {
+        return names[channel];
+    }
+
+    /** @brief   Return a channel's type.
+     *  @param   channel The channel's index
+     *  @returns The channel's @c ShareValueType code
+     */
+    uint8_t get_type (size_t channel) const
+    {
+        return types[channel];
+    }
+
+    /** @brief   Find a channel by its name.
+     *  @param   p_name The name
+     *  @returns The channel's index, or -1 if no channel has that name
+     */
+    int find (const char* p_name) const
+    {
+        for (size_t index = 0; index < names.size (); index++)
+        {
+            if (names[index] == p_name)
+            {
+                return (int)index;
+            }
+        }
+        return -1;
+    }
+
+    /** @brief   Return the number of complete blocks in the file.
+     *  @returns The number of blocks
+     */
+    size_t get_blocks (void) const
+    {
+        return blocks.size ();
+    }
+
+    /** @brief   Return the number of rows in all the complete blocks.
+     *  @returns The number of rows
+     */
+    uint64_t get_rows (void) const
+    {
+        return total_rows;
+    }
+
+    /** @brief   Return the times of the rows in a block.
+     *  @param   block The index of the block
+     *  @returns A span of times in microseconds, within the mapped file
+     */
+    Span<const uint64_t> times (size_t block) const
+    {
+        const BlockInfo& info = blocks[block];
+        return Span<const uint64_t> ((const uint64_t*)(info.p_start
+                                     + sizeof (ColumnLogBlock)), info.n_rows);
+    }
+
+    /** @brief   Return one channel's values in a block.
+     *  @tparam  DataType The type of the channel's values, which must match
+     *           the type in the file
+     *  @param   block The index of the block
+     *  @param   channel The index of the channel
+     *  @returns A span of values within the mapped file, or an empty span if
+     *           @c DataType doesn't match the channel's type
+     */
+    template <class DataType>
+    Span<const DataType> column (size_t block, size_t channel) const
+    {
+        if (channel >= types.size ()
+            || ShareType<DataType>::code != types[channel])
+        {
+            return Span<const DataType> ();
+        }
+        const BlockInfo& info = blocks[block];
+        size_t offset = sizeof (ColumnLogBlock)
+                        + columnlog_pad (info.n_rows * sizeof (uint64_t));
+        for (size_t index = 0; index < channel; index++)
+        {
+            offset += columnlog_pad (info.n_rows
+                                     * share_type_size (types[index]));
+        }
+        return Span<const DataType> ((const DataType*)(info.p_start + offset),
+                                     info.n_rows);
+    }
+
+    /** @brief   Find the first block which may hold rows at or after a time.
+     *  @param   time_us The time
+     *  @returns The index of the block, or the number of blocks if every row
+     *           is earlier than @c time_us
+     */
+    size_t find_block (uint64_t time_us) const
+    {
+        size_t low = 0;
+        size_t high = blocks.size ();
+        while (low < high)
+        {
+            size_t middle = (low + high) / 2;
+            if (blocks[middle].last_us < time_us)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    /** @brief   Visit one channel's values between two times.
+     *  @details The visitor is called once per block which holds rows in the
+     *           range, with spans of the times and values of those rows only.
+     *           The spans point into the mapped file; nothing is copied.
+     *  @tparam  DataType The type of the channel's values
+     *  @tparam  Visitor A function or lambda which takes a 
+     *           @c Span<const @c uint64_t> and a @c Span<const @c DataType>
+     *  @param   channel The index of the channel
+     *  @param   begin_us The time of the first row wanted
+     *  @param   end_us The time after the last row wanted
+     *  @param   visit The visitor
+     *  @returns The number of rows visited, or 0 if @c DataType doesn't match
+     *           the channel's type
+     */
+    template <class DataType, class Visitor>
+    uint64_t scan (size_t channel, uint64_t begin_us, uint64_t end_us,
+                   Visitor visit) const
+    {
+        uint64_t visited = 0;
+        for (size_t block = find_block (begin_us); block < blocks.size ()
+             && blocks[block].first_us < end_us; block++)
+        {
+            Span<const uint64_t> block_times = times (block);
+            Span<const DataType> values = column<DataType> (block, channel);
+            if (values.empty ())
+            {
+                return 0;
+            }
+
+            // Trim the rows outside the range from the ends of the block
+            size_t first = 0;
+            size_t last = block_times.size ();
+            if (blocks[block].first_us < begin_us)
+            {
+                first = lower_bound (block_times, begin_us);
+            }
+            if (blocks[block].last_us >= end_us)
+            {
+                last = lower_bound (block_times, end_us);
+            }
+            if (first < last)
+            {
+                visit (block_times.subspan (first, last - first),
+                       values.subspan (first, last - first));
+                visited += last - first;
+            }
+        }
+        return visited;
+    }
+
+protected:
+    /** @brief   Compute the number of bytes in a block with the given rows.
+     *  @param   n_rows The number of rows
+     *  @returns The size of the block, header included
+     */
+    size_t block_bytes (uint32_t n_rows) const
+    {
+        size_t bytes = sizeof (ColumnLogBlock)
+                       + columnlog_pad (n_rows * sizeof (uint64_t));
+        for (size_t index = 0; index < types.size (); index++)
+        {
+            bytes += columnlog_pad (n_rows * share_type_size (types[index]));
+        }
+        return bytes;
+    }
+
+    /** @brief   Find the first time in a sorted span which isn't earlier than
+     *           a given time.
+     *  @param   sorted The span of times
+     *  @param   time_us The time
+     *  @returns The index of the first time at or after @c time_us
+     */
+    static size_t lower_bound (Span<const uint64_t> sorted, uint64_t time_us)
+    {
+        size_t low = 0;
+        size_t high = sorted.size ();
+        while (low < high)
+        {
+            size_t middle = (low + high) / 2;
+            if (sorted[middle] < time_us)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+};
+
+#endif // _COLUMNLOG_H_
@@ -0,0 +1,308 @@
+//*****************************************************************************
+/** @file    columnlog_bench.cpp
+ *  @brief   Measures how quickly large column log files can be written and
+ *           scanned, and compares scanning with parsing the same data as CSV.
+ *  @details This program writes a synthetic log of eight channels sampled at
+ *           10 kHz, as a motor controller's telemetry might be, until the
+ *           file reaches the requested size. It then asks the operating system
+ *           to drop the file from its cache and measures:
+ *           - The time to open the file and index its blocks
+ *           - A scan of one @c float column, first from the disk (cold) and
+ *             then from the cache (warm)
+ *           - A scan of all four @c float columns
+ *           - Many short queries of 10 ms each at random times
+ *           - The same sum computed by parsing rows of CSV text, the way the
+ *             text logs were analyzed before
+ *
+ *           Every scan's sum is checked against the value expected from the
+ *           synthetic signals.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc -Ihost host/columnlog_bench.cpp \
+ *               -o columnlog_bench
+ *           ./columnlog_bench 4 /tmp/bench.col
+ *           @endcode
+ *           The first argument is the size of the file in gigabytes (default
+ *           2), the second the path of the file, which is deleted at the end.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "columnlog.h"
+
+
+/// Time between rows of the synthetic log, in microseconds
+const uint64_t ROW_US = 100;
+
+/// Names of the synthetic log's channels
+const char* const NAMES[] = { "angle", "speed", "current", "voltage",
+                              "position", "setpoint", "adc", "limit" };
+
+/// Types of the synthetic log's channels
+const uint8_t TYPES[] = { SHARE_FLOAT, SHARE_FLOAT, SHARE_FLOAT, SHARE_FLOAT,
+                          SHARE_I32, SHARE_I32, SHARE_U16, SHARE_BOOL };
+
+/// Number of channels in the synthetic log
+const size_t N_CHANNELS = sizeof (TYPES);
+
+
+/** @brief   Return the time since some fixed moment, in seconds.
+ *  @returns The time in seconds
+ */
+static double now_s (void)
+{
+    return std::chrono::duration<double> (
+        std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
+
+
+/** @brief   Compute one row of the synthetic signals.
+ *  @details The @c float signals take only values which are small multiples
+ *           of 1/8, so sums of them are exact and can be checked.
+ *  @param   row The row number
+ *  @param   p_values Pointer to an array for one widened value per channel
+ */
+static void make_row (uint64_t row, uint64_t* p_values)
+{
+    float angle = (float)(row % 2880) / 8.0f;
+    float speed = (float)(row % 17) - 8.0f;
+    float current = (float)(row % 5) / 8.0f;
+    float voltage = 12.0f;
+    int32_t position = (int32_t)(row * 3);
+    int32_t setpoint = (int32_t)(row / 1000) * 3000;
+    uint16_t adc = (uint16_t)(row % 4096);
+    bool limit = (row % 10000) == 0;
+
+    p_values[0] = share_type_widen (SHARE_FLOAT, &angle);
+    p_values[1] = share_type_widen (SHARE_FLOAT, &speed);
+    p_values[2] = share_type_widen (SHARE_FLOAT, &current);
+    p_values[3] = share_type_widen (SHARE_FLOAT, &voltage);
+    p_values[4] = share_type_widen (SHARE_I32, &position);
+    p_values[5] = share_type_widen (SHARE_I32, &setpoint);
+    p_values[6] = share_type_widen (SHARE_U16, &adc);
+    p_values[7] = share_type_widen (SHARE_BOOL, &limit);
+}
+
+
+/** @brief   Sum the @c current column of the whole log.
+ *  @param   log The log, opened
+ *  @param   p_rows Pointer to a variable in which to put the rows scanned
+ *  @returns The sum
+ */
+static double sum_current (const ColumnLogReader& log, uint64_t* p_rows)
+{
+    double sum = 0.0;
+    *p_rows = log.scan<float> (log.find ("current"), 0, UINT64_MAX,
+        [&] (Span<const uint64_t> times, Span<const float> values)
+        {
+            (void)times;
+            float partial = 0.0f;       // Exact; the block sums are small
+            for (float value : values)
+            {
+                partial += value;
+            }
+            sum += partial;
+        });
+    return sum;
+}
+
+
+int main (int argc, char** argv)
+{
+    double gigabytes = (argc > 1) ? atof (argv[1]) : 2.0;
+    const char* p_path = (argc > 2) ? argv[2] : "/tmp/columnlog_bench.col";
+
+    // Each row holds a time and eight values
+    size_t row_bytes = sizeof (uint64_t);
+    for (size_t index = 0; index < N_CHANNELS; index++)
+    {
+        row_bytes += share_type_size (TYPES[index]);
+    }
+    uint64_t n_rows = (uint64_t)(gigabytes * 1e9 / row_bytes);
+    printf ("Writing %llu rows of %zu channels (%.2f GB) to %s\n",
+            (unsigned long long)n_rows, N_CHANNELS, gigabytes, p_path);
+
+    // Write the log
+    std::vector<std::string> names (NAMES, NAMES + N_CHANNELS);
+    std::vector<uint8_t> types (TYPES, TYPES + N_CHANNELS);
+    ColumnLogWriter writer;
+    if (!writer.open (p_path, names, types))
+    {
+        perror (p_path);
+        return 1;
+    }
+    // Sums of the float channels are kept for checking the scans; they're
+    // exact, as the values are multiples of 1/8
+    double float_sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double start = now_s ();
+    uint64_t values[N_CHANNELS];
+    for (uint64_t row = 0; row < n_rows; row++)
+    {
+        make_row (row, values);
+        writer.add_row (row * ROW_US, values);
+        for (int index = 0; index < 4; index++)
+        {
+            float value;
+            share_type_narrow (SHARE_FLOAT, values[index], &value);
+            float_sums[index] += value;
+        }
+    }
+    writer.close ();
+    double elapsed = now_s () - start;
+    printf ("Write:              %7.2f s, %7.1f MB/s\n", elapsed,
+            n_rows * row_bytes / elapsed / 1e6);
+
+    // Drop the file from the page cache so the first scan reads the disk
+    int fd = open (p_path, O_RDONLY);
+    fdatasync (fd);
+    bool dropped = posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close (fd);
+
+    // Open and index the file
+    ColumnLogReader log;
+    start = now_s ();
+    if (!log.open (p_path))
+    {
+        printf ("Can't open the log\n");
+        return 1;
+    }
+    elapsed = now_s () - start;
+    printf ("Open and index:     %7.3f ms, %zu blocks, %llu rows\n",
+            elapsed * 1e3, log.get_blocks (),
+            (unsigned long long)log.get_rows ());
+
+    // Scan one column, cold and then warm
+    double expected = float_sums[2];
+    bool correct = log.get_rows () == n_rows;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        uint64_t rows;
+        start = now_s ();
+        double sum = sum_current (log, &rows);
+        elapsed = now_s () - start;
+        correct = correct && sum == expected && rows == n_rows;
+        printf ("Scan 1 column %s: %7.3f s, %7.1f M rows/s, %7.1f MB/s of "
+                "column%s\n", pass == 0 ? "cold" : "warm", elapsed,
+                rows / elapsed / 1e6, rows * sizeof (float) / elapsed / 1e6,
+                (pass == 0 && !dropped) ? " (cache not dropped)" : "");
+    }
+
+    // Scan all four float columns
+    uint64_t rows = 0;
+    double total = 0.0;
+    start = now_s ();
+    for (int channel = 0; channel < 4; channel++)
+    {
+        rows += log.scan<float> (channel, 0, UINT64_MAX,
+            [&] (Span<const uint64_t> times, Span<const float> values)
+            {
+                (void)times;
+                double partial = 0.0;
+                for (float value : values)
+                {
+                    partial += value;
+                }
+                total += partial;
+            });
+    }
+    elapsed = now_s () - start;
+    correct = correct && total == float_sums[0] + float_sums[1]
+              + float_sums[2] + float_sums[3];
+    printf ("Scan 4 columns:     %7.3f s, %7.1f M values/s\n", elapsed,
+            rows / elapsed / 1e6);
+
+    // Short queries at random times; each should see 100 rows
+    const uint32_t N_QUERIES = 10000;
+    const uint64_t WINDOW_US = 10000;
+    uint64_t span_us = n_rows * ROW_US;
+    uint64_t seed = 12345;
+    int position = log.find ("position");
+    start = now_s ();
+    for (uint32_t query = 0; query < N_QUERIES; query++)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t begin = ((seed >> 16) % (span_us - WINDOW_US)) / ROW_US
+                         * ROW_US;
+        int64_t sum = 0;
+        uint64_t got = log.scan<int32_t> (position, begin, begin + WINDOW_US,
+            [&] (Span<const uint64_t> times, Span<const int32_t> values)
+            {
+                (void)times;
+                for (int32_t value : values)
+                {
+                    sum += value;
+                }
+            });
+
+        // Rows begin / ROW_US to that plus 99 hold positions 3 * row
+        uint64_t first = begin / ROW_US;
+        int64_t want = 0;
+        for (uint64_t row = first; row < first + WINDOW_US / ROW_US; row++)
+        {
+            want += (int32_t)(row * 3);
+        }
+        correct = correct && got == WINDOW_US / ROW_US && sum == want;
+    }
+    elapsed = now_s () - start;
+    printf ("10 ms queries:      %7.2f us each\n",
+            elapsed / N_QUERIES * 1e6);
+
+    // Parse the same kind of data as CSV text, for comparison
+    const uint64_t CSV_ROWS = 1000000;
+    double csv_expected = 0.0;
+    std::string csv;
+    char line[256];
+    for (uint64_t row = 0; row < CSV_ROWS; row++)
+    {
+        make_row (row, values);
+        float floats[4];
+        for (int index = 0; index < 4; index++)
+        {
+            share_type_narrow (SHARE_FLOAT, values[index], &floats[index]);
+        }
+        csv_expected += floats[2];
+        snprintf (line, sizeof (line), "%llu,%g,%g,%g,%g,%d,%d,%u,%u\n",
+                  (unsigned long long)(row * ROW_US), floats[0], floats[1],
+                  floats[2], floats[3], (int32_t)values[4],
+                  (int32_t)values[5], (unsigned)values[6],
+                  (unsigned)values[7]);
+        csv += line;
+    }
+    start = now_s ();
+    double csv_sum = 0.0;
+    const char* p_char = csv.c_str ();
+    while (*p_char)
+    {
+        char* p_next;
+        strtoull (p_char, &p_next, 10);           // The time
+        for (int field = 0; field < 8; field++)
+        {
+            double value = strtod (p_next + 1, &p_next);
+            if (field == 2)
+            {
+                csv_sum += value;
+            }
+        }
+        p_char = p_next + 1;
+    }
+    elapsed = now_s () - start;
+    correct = correct && csv_sum == csv_expected;
+    printf ("Parse CSV:          %7.3f s for %llu rows, %7.1f M rows/s\n",
+            elapsed, (unsigned long long)CSV_ROWS, CSV_ROWS / elapsed / 1e6);
+
+    log.close ();
+    remove (p_path);
+    printf ("%s\n", correct ? "All sums correct" : "WRONG SUMS");
+    return correct ? 0 : 1;
+}
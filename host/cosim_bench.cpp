@@ -0,0 +1,148 @@
+//*****************************************************************************
+/** @file    cosim_bench.cpp
+ *  @brief   Measures how many lock-step handshakes per second two processes
+ *           can make through the co-simulation's shared memory region.
+ *  @details The program makes a region laid out as in @c cosim_region.h with
+ *           one actuator and one sensor, then forks. The child is a plant
+ *           which does nothing but copy the actuator to the sensor, using
+ *           @c CosimPlant just as a real plant would; the parent plays the
+ *           part of @c CosimBridge, writing the actuator, requesting a step,
+ *           waiting for it and checking the sensor. With no model and no
+ *           simulated tasks in the way, this is the most steps per second
+ *           that a co-simulation can run, and the time per step is the
+ *           overhead which the bridge adds to each step of a real one.
+ *
+ *           The handshake is quickest when each process has a core of its
+ *           own to spin on; with one core, each wait soon gives way to the
+ *           other process, and a step costs two trips through the
+ *           operating system's scheduler instead.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc -Ihost/sim host/cosim_bench.cpp \
+ *               -o cosim_bench
+ *           ./cosim_bench
+ *           @endcode
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "cosim_region.h"
+
+
+/// The name of the region, which differs from the default so that the
+/// benchmark can't be confused with a real co-simulation
+#define BENCH_NAME              "/me507_cosim_bench"
+
+/// The number of steps timed
+const uint64_t BENCH_STEPS = 1000000;
+
+
+/** @brief   The child process, which copies the actuator to the sensor.
+ *  @returns The child's exit status
+ */
+static int plant_process (void)
+{
+    CosimPlant plant;
+    if (!plant.open (BENCH_NAME, 5000))
+    {
+        return 1;
+    }
+    int command = plant.find ("Command");
+    int response = plant.find ("Response");
+    uint64_t time_us;
+    while (plant.wait_step (time_us))
+    {
+        plant.set (response, plant.get (command));
+        plant.finish_step ();
+    }
+    return 0;
+}
+
+
+int main (void)
+{
+    shm_unlink (BENCH_NAME);
+    int fd = shm_open (BENCH_NAME, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate (fd, sizeof (CosimRegion)) != 0)
+    {
+        perror ("Can't make shared memory");
+        return 1;
+    }
+    CosimRegion* p_region = (CosimRegion*)mmap (NULL, sizeof (CosimRegion),
+                                                PROT_READ | PROT_WRITE,
+                                                MAP_SHARED, fd, 0);
+    close (fd);
+    if (p_region == MAP_FAILED)
+    {
+        perror ("Can't map shared memory");
+        return 1;
+    }
+    CosimSignal& command = p_region->signals[0];
+    CosimSignal& response = p_region->signals[1];
+    strcpy (command.name, "Command");
+    command.type = SHARE_I32;
+    command.direction = COSIM_TO_PLANT;
+    strcpy (response.name, "Response");
+    response.type = SHARE_I32;
+    response.direction = COSIM_FROM_PLANT;
+    p_region->n_signals = 2;
+    p_region->step_us = 1000;
+    p_region->magic.store (COSIM_MAGIC);
+
+    pid_t child = fork ();
+    if (child == 0)
+    {
+        return plant_process ();
+    }
+
+    // The first step waits for the child to start, so it isn't timed
+    uint64_t errors = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (uint64_t step = 1; step <= BENCH_STEPS + 1; step++)
+    {
+        if (step == 2)
+        {
+            start = std::chrono::steady_clock::now ();
+        }
+        int32_t sent = (int32_t)(step * 7);
+        cosim_write (command, share_type_widen (SHARE_I32, &sent));
+        p_region->time_us.store (step * 1000, std::memory_order_relaxed);
+        p_region->step_request.store (step, std::memory_order_release);
+        for (uint32_t spins = 0;
+             p_region->step_done.load (std::memory_order_acquire) < step;
+             spins++)
+        {
+            if (spins > 1000)
+            {
+                std::this_thread::yield ();
+            }
+        }
+        int32_t received;
+        share_type_narrow (SHARE_I32, cosim_read (response), &received);
+        errors += (received != sent);
+    }
+    double took = std::chrono::duration<double> (
+                      std::chrono::steady_clock::now () - start).count ();
+
+    p_region->closed.store (1);
+    int status = 0;
+    waitpid (child, &status, 0);
+    shm_unlink (BENCH_NAME);
+
+    printf ("%llu steps in %.3f s: %.0f steps per second, %.2f us per "
+            "step, %llu wrong values\n", (unsigned long long)BENCH_STEPS,
+            took, BENCH_STEPS / took, took * 1e6 / BENCH_STEPS,
+            (unsigned long long)errors);
+    printf ("At 1 ms per step, a co-simulation can run at most %.0f times "
+            "real time\n", BENCH_STEPS / took / 1000.0);
+    return (errors == 0 && WEXITSTATUS (status) == 0) ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+//*****************************************************************************
+/** @file    cosim_plant.cpp
+ *  @brief   A model of a DC motor and its load which runs in lock step with
+ *           a simulated program through a @c CosimBridge.
+ *  @details The program reads the motor's duty cycle, in percent, from the
+ *           share called "Motor Duty" and writes the speed in RPM to
+ *           "Motor Speed" and the encoder count, at 4000 counts per turn, to
+ *           "Encoder". Each time the shaft passes its index mark, the count
+ *           is also written to "Index Pulses", which the simulated program
+ *           may connect to a queue. Any of these which the simulated program
+ *           hasn't connected are skipped. The model is integrated in ten
+ *           small steps per step of the bridge.
+ *
+ *           When the simulation closes the bridge, the program prints how
+ *           many steps it did and how many steps per second of real time
+ *           that was.
+ *
+ *           To compile and run from the top directory of this repository,
+ *           in one terminal with @c examples/cosim_test.cpp running in the
+ *           host simulation in another:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc -Ihost/sim host/cosim_plant.cpp \
+ *               -o cosim_plant
+ *           ./cosim_plant
+ *           @endcode
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <math.h>
+#include "cosim_region.h"
+
+
+/// Supply voltage for the motor driver, in volts
+const double SUPPLY = 12.0;
+
+/// Winding resistance in ohms
+const double RESISTANCE = 2.0;
+
+/// Torque constant in N-m/A, which is also the back EMF constant in V-s/rad
+const double K_MOTOR = 0.02;
+
+/// Rotor and load inertia in kg-m^2
+const double INERTIA = 2.0e-5;
+
+/// Viscous friction in N-m-s/rad
+const double DAMPING = 1.0e-5;
+
+/// Coulomb friction in N-m
+const double FRICTION = 2.0e-3;
+
+/// Encoder counts per turn of the shaft
+const double COUNTS_PER_TURN = 4000.0;
+
+
+int main (int argc, char** argv)
+{
+    const char* p_name = (argc > 1) ? argv[1] : COSIM_DEFAULT_NAME;
+    CosimPlant plant;
+    printf ("Waiting for the simulation at %s\n", p_name);
+    if (!plant.open (p_name))
+    {
+        printf ("The simulation didn't start\n");
+        return 1;
+    }
+    int duty = plant.find ("Motor Duty");
+    int speed = plant.find ("Motor Speed");
+    int encoder = plant.find ("Encoder");
+    int index = plant.find ("Index Pulses");
+    printf ("Connected: %u signals, %u us per step\n", plant.get_signals (),
+            plant.get_step_us ());
+
+    double omega = 0.0;                   // Shaft speed in rad/s
+    double angle = 0.0;                   // Shaft angle in radians
+    const int SUBSTEPS = 10;
+    const double DT = plant.get_step_us () * 1.0e-6 / SUBSTEPS;
+
+    uint64_t steps = 0;
+    uint64_t time_us = 0;
+    auto start = std::chrono::steady_clock::now ();
+    while (plant.wait_step (time_us))
+    {
+        double volts = SUPPLY * plant.get (duty) / 100.0;
+        volts = (volts > SUPPLY) ? SUPPLY : (volts < -SUPPLY ? -SUPPLY
+                                                              : volts);
+        double turns_before = floor (angle / (2.0 * M_PI));
+        for (int sub = 0; sub < SUBSTEPS; sub++)
+        {
+            double current = (volts - K_MOTOR * omega) / RESISTANCE;
+            double torque = K_MOTOR * current - DAMPING * omega;
+
+            // Friction holds the shaft still until the torque overcomes it
+            if (fabs (omega) < 1.0e-3 && fabs (torque) < FRICTION)
+            {
+                omega = 0.0;
+                continue;
+            }
+            torque -= (omega > 0.0 || (omega == 0.0 && torque > 0.0))
+                      ? FRICTION : -FRICTION;
+            omega += torque / INERTIA * DT;
+            angle += omega * DT;
+        }
+
+        double counts = angle / (2.0 * M_PI) * COUNTS_PER_TURN;
+        plant.set (speed, omega * 60.0 / (2.0 * M_PI));
+        plant.set (encoder, counts);
+        if (floor (angle / (2.0 * M_PI)) != turns_before)
+        {
+            plant.set (index, counts);
+        }
+        plant.finish_step ();
+        steps++;
+    }
+    double took = std::chrono::duration<double> (
+                      std::chrono::steady_clock::now () - start).count ();
+
+    printf ("Simulation ended at %.3f s of virtual time\n", time_us * 1e-6);
+    printf ("%llu steps in %.3f s, %.0f steps per second, %.1f times real "
+            "time\n", (unsigned long long)steps, took, steps / took,
+            time_us * 1e-6 / took);
+    return 0;
+}
@@ -0,0 +1,224 @@
+//*****************************************************************************
+/** @file    encoder_bench.cpp
+ *  @brief   Tests @c STM32Encoder against the model of STM32 timers in
+ *           @c host/sim and measures how fast encoders can be read.
+ *  @details A simulated encoder drives a modeled timer set up by the
+ *           unchanged @c STM32Encoder class, and a loop reads the 16-bit
+ *           count as a task would and extends it to a 64-bit position. The
+ *           program checks the position against the shaft's true position:
+ *           - while the shaft speeds up and slows down through zero many
+ *             times, so the count wraps around and reverses often;
+ *           - with glitches on the inputs, with the timer's input filter
+ *             off and on;
+ *           - when reads come too seldom for the speed, which makes the
+ *             16-bit count alias and the position wrong.
+ *
+ *           It then measures how many edges per second the timer model can
+ *           count, and how long each way of reading the count takes.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Ihost/sim -Iexamples \
+ *               host/encoder_bench.cpp host/sim/sim_timer.cpp \
+ *               examples/encoder_counter.cpp \
+ *               -o encoder_bench
+ *           ./encoder_bench
+ *           @endcode
+ *           The program's exit status is 0 if every check passed.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "encoder_counter.h"
+#include "quadrature.h"
+
+
+/// The number of edges counted when measuring the model's speed
+const uint32_t BENCH_EDGES = 50000000;
+
+/// The number of reads timed for each way of reading the count
+const uint32_t BENCH_READS = 100000000;
+
+
+/** @brief   Class which extends a 16-bit encoder count to a 64-bit position,
+ *           as a task which reads an encoder must.
+ *  @details The change since the last reading is taken as a signed 16-bit
+ *           number, which is right as long as the encoder moves less than
+ *           32767 counts between readings.
+ */
+class PositionTracker
+{
+public:
+    uint16_t last;                        ///< Count at the last reading
+    int64_t position;                     ///< The extended position
+
+    PositionTracker (void) : last (0), position (0) { }
+
+    /// Add the change in the count since the last reading
+    void update (uint16_t count)
+    {
+        position += (int16_t)(count - last);
+        last = count;
+    }
+};
+
+
+/** @brief   Return the time in seconds from a steady clock.
+ */
+static double seconds (void)
+{
+    using namespace std::chrono;
+    return duration<double> (steady_clock::now ().time_since_epoch ())
+           .count ();
+}
+
+
+/** @brief   Run a shaft whose speed swings through zero, reading the encoder
+ *           at a steady rate, and check the position at each reading.
+ *  @param   title A title for the printout
+ *  @param   timer The timer to use, which is reset first
+ *  @param   peak The peak speed in edges per second
+ *  @param   read_us The time between readings in microseconds
+ *  @param   glitches The chance of a glitch after each edge
+ *  @param   filter The setting of the input filter bits, 0 to 15
+ *  @returns The largest error, in counts, at any reading
+ */
+static int64_t swing_test (const char* title, TIM_TypeDef* timer,
+                           double peak, uint32_t read_us, double glitches,
+                           uint8_t filter)
+{
+    sim_timer_reset (timer);
+    STM32Encoder encoder (timer, PB4, PB5);
+    timer->CCMR1 = timer->CCMR1 | ((uint32_t)filter << TIM_CCMR1_IC1F_Pos)
+                   | ((uint32_t)filter << TIM_CCMR1_IC2F_Pos);
+    QuadratureGenerator shaft (timer);
+    shaft.set_noise (glitches, 60, 20);
+    PositionTracker tracker;
+
+    // Two seconds in which the speed swings back and forth five times, so
+    // the shaft reverses ten times and wanders far enough to wrap the count
+    const uint64_t RUN_NS = 2000000000ULL;
+    int64_t worst = 0;
+    for (uint64_t time_ns = 0; time_ns < RUN_NS; time_ns += read_us * 1000)
+    {
+        double angle = 2.0 * M_PI * 5.0 * time_ns / RUN_NS;
+        shaft.set_speed (peak * (sin (angle) + 0.3));
+        shaft.run_until (time_ns + read_us * 1000);
+        tracker.update (encoder.getCount ());
+
+        // The filter delays the count a little behind the true position
+        int64_t error = llabs (tracker.position - shaft.get_position ());
+        worst = (error > worst) ? error : worst;
+    }
+    printf ("%-34s %9u %9lld %8u %8u %6lld\n", title, shaft.get_edges (),
+            (long long)shaft.get_position (), shaft.get_glitches (),
+            timer->filtered_out, (long long)worst);
+    return worst;
+}
+
+
+/** @brief   Measure how long one way of reading the count takes.
+ *  @param   title A title for the printout
+ *  @param   p_read The function which reads the count
+ *  @param   p_encoder The encoder whose count is read
+ */
+static void time_reads (const char* title,
+                        uint16_t (*p_read) (STM32Encoder*),
+                        STM32Encoder* p_encoder)
+{
+    PositionTracker tracker;
+    double start = seconds ();
+    for (uint32_t count = 0; count < BENCH_READS; count++)
+    {
+        tracker.update (p_read (p_encoder));
+    }
+    double took = seconds () - start;
+    printf ("  %-40s %6.2f ns per read (%lld)\n", title,
+            took * 1e9 / BENCH_READS, (long long)tracker.position);
+}
+
+
+int main (void)
+{
+    bool passed = true;
+
+    printf ("%-34s %9s %9s %8s %8s %6s\n", "Test", "Edges", "Position",
+            "Glitches", "Filtered", "Error");
+
+    // Clean signals, read every millisecond at up to 1.3 million edges/s
+    passed &= swing_test ("Clean, 16-bit timer", TIM3, 1.0e6, 1000, 0.0, 0)
+              == 0;
+    passed &= swing_test ("Clean, 32-bit timer", TIM2, 1.0e6, 1000, 0.0, 0)
+              == 0;
+
+    // Glitches come in pairs of edges which cancel when unfiltered, and
+    // the filter (8 clocks at 80 MHz = 100 ns) takes them out entirely,
+    // at the cost of a count which lags by up to 100 ns
+    passed &= swing_test ("Glitches, filter off", TIM3, 2.0e5, 1000, 0.2, 0)
+              == 0;
+    passed &= swing_test ("Glitches, filter 100 ns", TIM3, 2.0e5, 1000, 0.2,
+                          3) <= 1;
+
+    // A 16-bit count read every 40 ms can't keep up with 1.3 million
+    // edges per second: it wraps between readings, and the error shows it
+    bool aliased = swing_test ("Read too seldom (should fail)", TIM3, 1.0e6,
+                               40000, 0.0, 0) > 0;
+    passed &= aliased;
+
+    // How fast the model runs, for benchmarks of code which reads encoders
+    sim_timer_reset (TIM4);
+    STM32Encoder encoder (TIM4, PB6, PB7);
+    QuadratureGenerator shaft (TIM4);
+    shaft.set_speed (1.0e7);
+    double start = seconds ();
+    shaft.run_edges (BENCH_EDGES);
+    double took = seconds () - start;
+    bool exact = (int64_t)(uint16_t)shaft.get_position ()
+                 == (int64_t)encoder.getCount ();
+    passed &= exact;
+    printf ("\nModel: %u edges in %.3f s, %.1f million edges per second "
+            "(count %s)\n", shaft.get_edges (), took,
+            shaft.get_edges () / took / 1e6, exact ? "correct" : "WRONG");
+
+    sim_timer_reset (TIM4);
+    STM32Encoder filtered (TIM4, PB6, PB7);
+    TIM4->CCMR1 = TIM4->CCMR1 | (3UL << TIM_CCMR1_IC1F_Pos)
+                  | (3UL << TIM_CCMR1_IC2F_Pos);
+    QuadratureGenerator noisy (TIM4);
+    noisy.set_speed (1.0e6);
+    noisy.set_noise (0.2, 60, 20);
+    start = seconds ();
+    noisy.run_edges (BENCH_EDGES / 5);
+    took = seconds () - start;
+    printf ("Model with glitches and filter: %.1f million edges per "
+            "second\n", (noisy.get_edges () + 2.0 * noisy.get_glitches ())
+            / took / 1e6);
+
+    // The ways a task might read the count; a real timer register read
+    // costs a few bus cycles more than this memory read
+    printf ("\nReading the count and extending it to 64 bits:\n");
+    time_reads ("STM32Encoder::getCount()",
+                [] (STM32Encoder* p_enc) { return p_enc->getCount (); },
+                &filtered);
+    time_reads ("Timer register TIM4->CNT",
+                [] (STM32Encoder* p_enc)
+                {
+                    (void)p_enc;
+                    return (uint16_t)TIM4->CNT;
+                },
+                &filtered);
+
+    printf ("\nA 16-bit count must be read at least every %.1f ms at 1 "
+            "million edges/s\n", 32767.0 / 1.0e6 * 1000.0);
+    printf ("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,392 @@
+//*****************************************************************************
+/** @file    fixedpoint_bench.cpp
+ *  @brief   Checks the fixed-point control blocks in @c fixedcontrol.h
+ *           against the same blocks in @c double and measures how fast
+ *           they run next to @c float and @c double versions.
+ *  @details Each block is run in @c Q15, @c Q31, @c float and @c double on
+ *           the same inputs, and the @c double results are taken as the
+ *           truth. The PID controllers each close a loop around their own
+ *           copy of a simple first-order plant, so the errors shown are those
+ *           which a real loop would see, including the way rounding in the
+ *           integral adds up. The program also checks saturation and
+ *           rounding in the @c Fixed arithmetic itself.
+ *
+ *           Times on a PC, whose FPU does @c double as fast as @c float,
+ *           show only the cost of the extra shifts and saturation. On a
+ *           Cortex-M4, where @c double is done in software, run the
+ *           @c fixedpoint_test.cpp example to see the difference that
+ *           matters.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc host/fixedpoint_bench.cpp \
+ *               -o fixedpoint_bench
+ *           ./fixedpoint_bench
+ *           @endcode
+ *           The program's exit status is 0 if every check passed.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "fixedcontrol.h"
+
+
+/// The number of steps timed for each block
+const uint32_t BENCH_STEPS = 20000000;
+
+/// The number of input samples, which are used over and over when timing
+const uint32_t N_INPUTS = 4096;
+
+
+/// Gains for a loop around a plant with a time constant of 100 samples
+struct LoopGains
+{
+    static constexpr double KP = 2.0;     ///< Proportional gain
+    static constexpr double KI = 0.02;    ///< Integral gain per sample
+    static constexpr double KD = 0.5;     ///< Derivative gain times samples
+};
+
+
+/// A Butterworth low pass filter at 1/100 of the sample rate
+struct LowPass
+{
+    static constexpr double B0 = 0.0009446918438401619;  ///< Input gain
+    static constexpr double B1 = 0.0018893836876803238;  ///< Last input
+    static constexpr double B2 = 0.0009446918438401619;  ///< Input before
+    static constexpr double A1 = -1.9111970674260732;    ///< Last output
+    static constexpr double A2 = 0.9149758348014339;     ///< Output before
+};
+
+
+/** @brief   A PID controller in floating point, with the same equations as
+ *           @c FixedPID, for comparison.
+ *  @tparam  Real @c float or @c double
+ *  @tparam  Gains The gains, as for @c FixedPID
+ */
+template <class Real, class Gains>
+class FloatPID
+{
+protected:
+    Real integral;                        ///< Sum of KI * error
+    Real last_measurement;                ///< Measurement at the last step
+
+public:
+    FloatPID (void) : integral (0), last_measurement (0) { }
+
+    /// Run the controller for one sample
+    Real step (Real setpoint, Real measurement)
+    {
+        Real error = setpoint - measurement;
+        Real output = (Real)Gains::KP * error + integral
+                      - (Real)Gains::KD * (measurement - last_measurement);
+        last_measurement = measurement;
+        Real limited = (output > 1) ? 1 : (output < -1) ? -1 : output;
+        if (!((output > limited && error > 0)
+              || (output < limited && error < 0)))
+        {
+            integral += (Real)Gains::KI * error;
+            integral = (integral > 1) ? 1 : (integral < -1) ? -1 : integral;
+        }
+        return limited;
+    }
+};
+
+
+/** @brief   A biquad filter in floating point, for comparison.
+ *  @tparam  Real @c float or @c double
+ *  @tparam  Coeffs The coefficients, as for @c FixedBiquad
+ */
+template <class Real, class Coeffs>
+class FloatBiquad
+{
+protected:
+    Real x1, x2, y1, y2;                  ///< Past inputs and outputs
+
+public:
+    FloatBiquad (void) : x1 (0), x2 (0), y1 (0), y2 (0) { }
+
+    /// Filter one sample
+    Real step (Real input)
+    {
+        Real output = (Real)Coeffs::B0 * input + (Real)Coeffs::B1 * x1
+                      + (Real)Coeffs::B2 * x2 - (Real)Coeffs::A1 * y1
+                      - (Real)Coeffs::A2 * y2;
+        x2 = x1;
+        x1 = input;
+        y2 = y1;
+        y1 = output;
+        return output;
+    }
+};
+
+
+/** @brief   A moving average in floating point, for comparison.
+ *  @tparam  Real @c float or @c double
+ *  @tparam  N The number of samples averaged
+ */
+template <class Real, uint16_t N>
+class FloatMovingAverage
+{
+protected:
+    Real samples[N];                      ///< The last N samples
+    Real sum;                             ///< Their sum
+    uint16_t index;                       ///< Where the next one goes
+
+public:
+    FloatMovingAverage (void) : sum (0), index (0)
+    {
+        for (uint16_t count = 0; count < N; count++)
+        {
+            samples[count] = 0;
+        }
+    }
+
+    /// Add a sample and return the average
+    Real step (Real input)
+    {
+        sum += input - samples[index];
+        samples[index] = input;
+        index = (index + 1 < N) ? index + 1 : 0;
+        return sum * (Real)(1.0 / N);
+    }
+};
+
+
+/// Inputs in double, and the same inputs in each other format
+static double inputs[N_INPUTS];
+static float float_inputs[N_INPUTS];
+static Q15 q15_inputs[N_INPUTS];
+static Q31 q31_inputs[N_INPUTS];
+
+
+/// Return a number as a @c double whatever its type
+inline double as_double (double value) { return value; }
+inline double as_double (float value) { return value; }
+inline double as_double (Q15 value) { return value.to_double (); }
+inline double as_double (Q31 value) { return value.to_double (); }
+
+
+/** @brief   Return the time in seconds from a steady clock.
+ */
+static double seconds (void)
+{
+    using namespace std::chrono;
+    return duration<double> (steady_clock::now ().time_since_epoch ())
+           .count ();
+}
+
+
+/** @brief   Run a closed loop with a PID controller and a plant, returning
+ *           the plant's output at each step.
+ *  @param   controller The controller
+ *  @param   p_setpoints The setpoints, in the controller's type
+ *  @param   p_out An array in which to put the plant's outputs
+ */
+template <class Controller, class Signal>
+void run_loop (Controller& controller, const Signal* p_setpoints,
+               double* p_out)
+{
+    double plant = 0.0;
+    for (uint32_t index = 0; index < N_INPUTS; index++)
+    {
+        // The measurement reaches the controller in its own format
+        Signal measured;
+        if constexpr (std::is_floating_point<Signal>::value)
+        {
+            measured = (Signal)plant;
+        }
+        else
+        {
+            measured = Signal::from (plant);
+        }
+        double drive = as_double (controller.step (p_setpoints[index],
+                                                   measured));
+        plant += (drive - plant) * 0.01;
+        p_out[index] = plant;
+    }
+}
+
+
+/** @brief   Return the largest difference between two sets of results.
+ */
+static double worst_error (const double* p_a, const double* p_b)
+{
+    double worst = 0.0;
+    for (uint32_t index = 0; index < N_INPUTS; index++)
+    {
+        worst = fmax (worst, fabs (p_a[index] - p_b[index]));
+    }
+    return worst;
+}
+
+
+/** @brief   Run a filter over the inputs, returning its outputs as doubles.
+ */
+template <class Filter, class Signal>
+void run_filter (Filter& filter, const Signal* p_in, double* p_out)
+{
+    for (uint32_t index = 0; index < N_INPUTS; index++)
+    {
+        p_out[index] = as_double (filter.step (p_in[index]));
+    }
+}
+
+
+/** @brief   Time a block over many steps and print the time per step.
+ *  @param   title What is being timed
+ *  @param   block The block, with a @c step() taking one input
+ *  @param   p_in The inputs, used over and over
+ */
+template <class Block, class Signal>
+void time_filter (const char* title, Block& block, const Signal* p_in)
+{
+    double sink = 0.0;
+    double start = seconds ();
+    for (uint32_t count = 0; count < BENCH_STEPS; count++)
+    {
+        sink += as_double (block.step (p_in[count & (N_INPUTS - 1)]));
+    }
+    double took = seconds () - start;
+    printf ("  %-30s %6.2f ns per step   (%g)\n", title,
+            took * 1e9 / BENCH_STEPS, sink);
+}
+
+
+/** @brief   Time a PID controller over many steps and print the time per
+ *           step; the setpoint and measurement are two different inputs.
+ */
+template <class Block, class Signal>
+void time_pid (const char* title, Block& block, const Signal* p_in)
+{
+    double sink = 0.0;
+    double start = seconds ();
+    for (uint32_t count = 0; count < BENCH_STEPS; count++)
+    {
+        sink += as_double (block.step (p_in[count & (N_INPUTS - 1)],
+                                       p_in[(count + 7) & (N_INPUTS - 1)]));
+    }
+    double took = seconds () - start;
+    printf ("  %-30s %6.2f ns per step   (%g)\n", title,
+            took * 1e9 / BENCH_STEPS, sink);
+}
+
+
+/** @brief   Check the arithmetic of @c Fixed numbers.
+ *  @returns @c true if every check passed
+ */
+static bool check_arithmetic (void)
+{
+    bool passed = true;
+    passed &= (Q15::from (0.9) + Q15::from (0.9)) == Q15::max ();
+    passed &= (Q15::from (-0.9) - Q15::from (0.9)) == Q15::min ();
+    passed &= (-Q15::min ()) == Q15::max ();
+    passed &= (Q15::min () * Q15::min ()) == Q15::max ();
+    passed &= (Q15::from (0.5) * Q15::from (0.5)) == Q15::from (0.25);
+    passed &= (Q31::from (-0.5) * Q31::from (0.75)) == Q31::from (-0.375);
+    passed &= Q15::from (2.0) == Q15::max ();
+    passed &= Q15::from (3.0 / 32768.0).raw == 3;
+    passed &= Q15::from (0.3).convert<31, int32_t> ().raw
+              == (int32_t)Q15::from (0.3).raw << 16;
+    passed &= Q31::from (0.3).convert<15, int16_t> () == Q15::from (0.3);
+    passed &= Q16_16::from (1000.5).convert<15, int16_t> () == Q15::max ();
+    passed &= fabs (Q16_16::from (-123.456).to_double () + 123.456) < 1e-4;
+    printf ("Fixed-point arithmetic: %s\n", passed ? "correct" : "WRONG");
+    return passed;
+}
+
+
+int main (void)
+{
+    bool passed = check_arithmetic ();
+
+    // Steps, a slow sine and a little noise, within -0.9 to 0.9
+    uint32_t random = 507;
+    for (uint32_t index = 0; index < N_INPUTS; index++)
+    {
+        random = random * 1664525 + 1013904223;
+        double noise = ((random >> 8) / 16777216.0 - 0.5) * 0.02;
+        double value = ((index / 512) % 2 ? 0.6 : -0.4)
+                       + 0.25 * sin (index * 0.01) + noise;
+        inputs[index] = value;
+        float_inputs[index] = (float)value;
+        q15_inputs[index] = Q15::from (value);
+        q31_inputs[index] = Q31::from (value);
+    }
+
+    // Accuracy against double, in a closed loop for the PID controllers
+    static double truth[N_INPUTS], result[N_INPUTS];
+    printf ("\nLargest error compared to double:\n");
+    printf ("  %-14s %12s %12s %12s\n", "Block", "Q15", "Q31", "float");
+
+    FloatPID<double, LoopGains> pid_d;
+    FixedPID<Q15, LoopGains> pid_15;
+    FixedPID<Q31, LoopGains> pid_31;
+    FloatPID<float, LoopGains> pid_f;
+    run_loop (pid_d, inputs, truth);
+    run_loop (pid_15, q15_inputs, result);
+    double err_15 = worst_error (truth, result);
+    run_loop (pid_31, q31_inputs, result);
+    double err_31 = worst_error (truth, result);
+    run_loop (pid_f, float_inputs, result);
+    double err_f = worst_error (truth, result);
+    printf ("  %-14s %12.2e %12.2e %12.2e\n", "PID loop", err_15, err_31,
+            err_f);
+    passed &= err_15 < 2e-3 && err_31 < 1e-6;
+
+    FloatBiquad<double, LowPass> bq_d;
+    FixedBiquad<Q15, LowPass> bq_15;
+    FixedBiquad<Q31, LowPass> bq_31;
+    FloatBiquad<float, LowPass> bq_f;
+    run_filter (bq_d, inputs, truth);
+    run_filter (bq_15, q15_inputs, result);
+    err_15 = worst_error (truth, result);
+    run_filter (bq_31, q31_inputs, result);
+    err_31 = worst_error (truth, result);
+    run_filter (bq_f, float_inputs, result);
+    err_f = worst_error (truth, result);
+    printf ("  %-14s %12.2e %12.2e %12.2e\n", "Biquad", err_15, err_31,
+            err_f);
+    passed &= err_15 < 2e-3 && err_31 < 1e-6;
+
+    FloatMovingAverage<double, 50> ma_d;
+    FixedMovingAverage<Q15, 50> ma_15;
+    FixedMovingAverage<Q31, 50> ma_31;
+    FloatMovingAverage<float, 50> ma_f;
+    run_filter (ma_d, inputs, truth);
+    run_filter (ma_15, q15_inputs, result);
+    err_15 = worst_error (truth, result);
+    run_filter (ma_31, q31_inputs, result);
+    err_31 = worst_error (truth, result);
+    run_filter (ma_f, float_inputs, result);
+    err_f = worst_error (truth, result);
+    printf ("  %-14s %12.2e %12.2e %12.2e\n", "Average of 50", err_15,
+            err_31, err_f);
+    passed &= err_15 < 1e-4 && err_31 < 1e-8;
+
+    // Speed; the sums printed in parentheses keep the work from being
+    // optimized away
+    printf ("\nTime per step on this PC:\n");
+    time_pid ("PID, Q15", pid_15, q15_inputs);
+    time_pid ("PID, Q31", pid_31, q31_inputs);
+    time_pid ("PID, float", pid_f, float_inputs);
+    time_pid ("PID, double", pid_d, inputs);
+    time_filter ("Biquad, Q15", bq_15, q15_inputs);
+    time_filter ("Biquad, Q31", bq_31, q31_inputs);
+    time_filter ("Biquad, float", bq_f, float_inputs);
+    time_filter ("Biquad, double", bq_d, inputs);
+    time_filter ("Average of 50, Q15", ma_15, q15_inputs);
+    time_filter ("Average of 50, Q31", ma_31, q31_inputs);
+    time_filter ("Average of 50, float", ma_f, float_inputs);
+    time_filter ("Average of 50, double", ma_d, inputs);
+
+    printf ("\n%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+//*****************************************************************************
+/** @file    mirrorring_bench.cpp
+ *  @brief   Checks the ring buffer in @c mirrorring.h and compares the time
+ *           taken to get a sliding window from it with copying the window
+ *           out of an ordinary ring buffer.
+ *  @details Several million samples are put into rings of several sizes, and
+ *           after every @c HOP samples a window of the newest samples is
+ *           read, as a task running an overlapping FFT or a peak finder
+ *           would. The window is got in four ways:
+ *           - from a @c MirrorRing whose halves are mapped to the same
+ *             memory, as it works on Linux;
+ *           - from a @c MirrorRing which writes each sample twice, as it
+ *             works on a microcontroller;
+ *           - by copying the window out of an ordinary ring buffer with
+ *             @c memcpy(), in one or two pieces;
+ *           - by copying it out one sample at a time with a wrapping index,
+ *             as such code is often written.
+ *
+ *           Each is timed twice: once reading only the ends of the window,
+ *           which shows the cost of getting it, and once adding up the whole
+ *           window, which shows that cost next to a little real work. The
+ *           program first checks that every way gives the same windows, for
+ *           several window lengths and for items whose size doesn't divide
+ *           a memory page.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc host/mirrorring_bench.cpp \
+ *               -o mirrorring_bench
+ *           ./mirrorring_bench
+ *           @endcode
+ *           The program's exit status is 0 if every check passed.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "mirrorring.h"
+
+
+/// The number of samples put into each ring while timing
+const uint32_t N_SAMPLES = 1 << 22;
+
+/// The number of samples put in between windows
+const uint32_t HOP = 16;
+
+
+/** @brief   Return the time in seconds from a steady clock.
+ */
+static double seconds (void)
+{
+    using namespace std::chrono;
+    return duration<double> (steady_clock::now ().time_since_epoch ())
+           .count ();
+}
+
+
+/** @brief   An ordinary ring buffer from which windows must be copied out.
+ */
+template <class DataType>
+class PlainRing
+{
+protected:
+    std::vector<DataType> buffer;         ///< The items
+    uint32_t newest = 0;                  ///< Index where the next item goes
+
+public:
+    /// Create a ring of the given size
+    PlainRing (uint32_t size) : buffer (size) { }
+
+    /// Put an item in, pushing out the oldest
+    void put (const DataType& item)
+    {
+        buffer[newest] = item;
+        newest = (newest + 1 < buffer.size ()) ? newest + 1 : 0;
+    }
+
+    /// Copy the newest items out, oldest first, in one or two pieces
+    void copy_window (DataType* p_out, uint32_t length)
+    {
+        uint32_t size = buffer.size ();
+        uint32_t start = (newest + size - length) % size;
+        uint32_t first = (start + length <= size) ? length : size - start;
+        memcpy (p_out, &buffer[start], first * sizeof (DataType));
+        memcpy (p_out + first, &buffer[0], (length - first)
+                                            * sizeof (DataType));
+    }
+
+    /// Copy the newest items out one at a time with a wrapping index
+    void copy_each (DataType* p_out, uint32_t length)
+    {
+        uint32_t size = buffer.size ();
+        uint32_t index = (newest + size - length) % size;
+        for (uint32_t count = 0; count < length; count++)
+        {
+            p_out[count] = buffer[index];
+            index = (index + 1 == size) ? 0 : index + 1;
+        }
+    }
+};
+
+
+/// An item whose size, 12 bytes, doesn't divide a memory page
+struct Reading
+{
+    int32_t x, y, z;                      ///< Three axes of a sensor
+};
+
+
+/** @brief   Check that a mirrored ring gives the same windows as copying out
+ *           of an ordinary ring, as items are put in over several laps.
+ *  @param   size The size asked for
+ *  @param   allow_mapping Whether the ring may map its halves
+ *  @returns @c true if every window matched
+ */
+static bool check_ring (uint32_t size, bool allow_mapping)
+{
+    MirrorRing<Reading> mirror (size, allow_mapping);
+    PlainRing<Reading> plain (mirror.size ());
+    std::vector<Reading> copy (mirror.size ());
+    bool good = (mirror.window (size).size () == 0);
+
+    for (int32_t count = 0; count < (int32_t)(5 * mirror.size ()); count++)
+    {
+        Reading item = { count, -count, count * 7 };
+        mirror.put (item);
+        plain.put (item);
+
+        // Try a short window, a long one and one longer than allowed
+        uint32_t lengths[] = { 1 + (uint32_t)count % 7, size,
+                               size + 1 };
+        for (uint32_t length : lengths)
+        {
+            uint32_t expected = (length < size) ? length : size;
+            expected = ((uint32_t)count + 1 < expected) ? count + 1
+                                                        : expected;
+            Span<Reading> window = mirror.window (length);
+            plain.copy_window (copy.data (), expected);
+            good = good && window.size () == expected
+                   && memcmp (window.data (), copy.data (),
+                              expected * sizeof (Reading)) == 0;
+        }
+    }
+    printf ("  %-8s %5u items asked for, %5u held: %s\n",
+            mirror.is_mapped () ? "mapped" : "written", size, mirror.size (),
+            good ? "good" : "WRONG");
+    return good;
+}
+
+
+/** @brief   Print the time per window of one way of getting windows.
+ *  @param   title The way windows were got
+ *  @param   took The time taken for all the samples, in seconds
+ */
+static void print_time (const char* title, double took)
+{
+    printf ("    %-32s %8.1f ns per window\n", title,
+            took * 1e9 / (N_SAMPLES / HOP));
+}
+
+
+/** @brief   Time the four ways of getting windows of one length.
+ *  @param   length The number of samples in each window
+ *  @param   p_samples The samples to be put in
+ *  @param   whole @c true to add up each whole window, @c false to read
+ *           only its ends
+ *  @returns A sum of what was read, which keeps the work from being skipped
+ */
+static float time_length (uint32_t length, const float* p_samples,
+                          bool whole)
+{
+    std::vector<float> copy (length);
+    float total = 0.0f;
+
+    // Read a window, as the processing of it would
+    auto use = [&] (const float* p_window)
+    {
+        if (!whole)
+        {
+            return p_window[0] + p_window[length - 1];
+        }
+        float sum = 0.0f;
+        for (uint32_t index = 0; index < length; index++)
+        {
+            sum += p_window[index];
+        }
+        return sum;
+    };
+
+    printf ("  Windows of %u samples, %s:\n", length,
+            whole ? "adding up all samples" : "reading ends only");
+    for (int way = 0; way < 4; way++)
+    {
+        MirrorRing<float> mapped (length, true);
+        MirrorRing<float> written (length, false);
+        PlainRing<float> plain (length);
+        double start = seconds ();
+        for (uint32_t index = 0; index < N_SAMPLES; index++)
+        {
+            bool hop = (index % HOP == HOP - 1 && index >= length);
+            switch (way)
+            {
+                case 0:
+                    mapped.put (p_samples[index]);
+                    if (hop)
+                    {
+                        total += use (mapped.window (length).data ());
+                    }
+                    break;
+                case 1:
+                    written.put (p_samples[index]);
+                    if (hop)
+                    {
+                        total += use (written.window (length).data ());
+                    }
+                    break;
+                case 2:
+                    plain.put (p_samples[index]);
+                    if (hop)
+                    {
+                        plain.copy_window (copy.data (), length);
+                        total += use (copy.data ());
+                    }
+                    break;
+                default:
+                    plain.put (p_samples[index]);
+                    if (hop)
+                    {
+                        plain.copy_each (copy.data (), length);
+                        total += use (copy.data ());
+                    }
+                    break;
+            }
+        }
+        double took = seconds () - start;
+        const char* titles[] =
+        {
+            mapped.is_mapped () ? "Mirrored, mapped" : "Mirrored (no map)",
+            "Mirrored, written twice",
+            "Copied with memcpy()",
+            "Copied one at a time"
+        };
+        print_time (titles[way], took);
+    }
+    return total;
+}
+
+
+/** @brief   Check the mirrored rings, then time each way of getting windows.
+ */
+int main (void)
+{
+    bool passed = true;
+
+    printf ("Checking windows against an ordinary ring:\n");
+    uint32_t sizes[] = { 1, 100, 341, 1024, 5000 };
+    for (uint32_t size : sizes)
+    {
+        passed = check_ring (size, true) && passed;
+        passed = check_ring (size, false) && passed;
+    }
+
+    std::vector<float> samples (N_SAMPLES);
+    for (uint32_t index = 0; index < N_SAMPLES; index++)
+    {
+        samples[index] = (float)((index * 2654435761u) >> 16) / 65536.0f;
+    }
+
+    printf ("Time per window, one window every %u samples:\n", HOP);
+    volatile float sink = 0.0f;
+    uint32_t lengths[] = { 64, 256, 1024, 4096 };
+    for (uint32_t length : lengths)
+    {
+        sink = sink + time_length (length, samples.data (), false);
+        sink = sink + time_length (length, samples.data (), true);
+    }
+
+    printf ("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
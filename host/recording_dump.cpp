@@ -0,0 +1,120 @@
+//*****************************************************************************
+/** @file    recording_dump.cpp
+ *  @brief   Writes a recording of traffic between tasks as CSV.
+ *  @details This program reads a recording made by a @c ShareRecorder (see
+ *           @c src/recorder.h) from a file or standard input and writes one
+ *           line of CSV per item put into a share or queue: the time in
+ *           microseconds since the first item, the name of the share, and
+ *           the item. At the end it prints to standard error, for each
+ *           share, the number of items and the average and longest time
+ *           between them, then the numbers of damaged and lost frames and of
+ *           items which the recorder dropped.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc host/recording_dump.cpp \
+ *               -o recording_dump
+ *           ./recording_dump traffic.rec > traffic.csv
+ *           @endcode
+ *           A path of @c - reads standard input.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include "recording_codec.h"
+
+
+/// Counts and gaps for one channel, for the summary
+struct ChannelSummary
+{
+    uint64_t count;                       ///< Items seen
+    uint32_t last_us;                     ///< Time of the last item
+    uint64_t total_gap_us;                ///< Sum of times between items
+    uint32_t longest_gap_us;              ///< Longest time between items
+};
+
+
+int main (int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "Usage: %s recording.rec|- > out.csv\n", argv[0]);
+        return 2;
+    }
+    FILE* p_in = strcmp (argv[1], "-") ? fopen (argv[1], "rb") : stdin;
+    if (p_in == NULL)
+    {
+        perror (argv[1]);
+        return 1;
+    }
+
+    RecordingParser parser;
+    ChannelSummary summary[RECORDING_MAX_CHANNELS];
+    memset (summary, 0, sizeof (summary));
+    bool have_start = false;
+    uint32_t start_us = 0;
+    char text[32];
+
+    printf ("time_us,share,value\n");
+    int ch;
+    while ((ch = getc (p_in)) != EOF)
+    {
+        if (parser.feed ((uint8_t)ch) != RECORDING_EVENTS)
+        {
+            continue;
+        }
+        uint8_t channel;
+        uint32_t time_us;
+        uint64_t value;
+        while (parser.next_event (channel, time_us, value))
+        {
+            if (!have_start)
+            {
+                start_us = time_us;
+                have_start = true;
+            }
+            uint8_t type = parser.get_type (channel);
+            share_type_format (type, &value, text, sizeof (text));
+            printf ("%d,%s,%s\n", (int32_t)(time_us - start_us),
+                    parser.get_name (channel), text);
+
+            ChannelSummary& entry = summary[channel];
+            if (entry.count > 0)
+            {
+                uint32_t gap = time_us - entry.last_us;
+                entry.total_gap_us += gap;
+                if ((int32_t)gap > (int32_t)entry.longest_gap_us)
+                {
+                    entry.longest_gap_us = gap;
+                }
+            }
+            entry.last_us = time_us;
+            entry.count++;
+        }
+    }
+
+    for (uint8_t channel = 0; channel < parser.get_channels (); channel++)
+    {
+        const ChannelSummary& entry = summary[channel];
+        fprintf (stderr, "%-16s %10llu items", parser.get_name (channel),
+                 (unsigned long long)entry.count);
+        if (entry.count > 1)
+        {
+            fprintf (stderr, ", every %.1f us on average, longest gap %u us",
+                     (double)entry.total_gap_us / (entry.count - 1),
+                     entry.longest_gap_us);
+        }
+        fprintf (stderr, "\n");
+    }
+    fprintf (stderr, "%u bad frames, %u lost frames, %u items dropped by the "
+             "recorder\n", parser.get_bad_frames (),
+             parser.get_lost_frames (), parser.get_dropped ());
+    return 0;
+}
@@ -0,0 +1,377 @@
+//*****************************************************************************
+/** @file    sharelink_loopback.cpp
+ *  @brief   Tests the share link protocol between two simulated nodes joined
+ *           by a pseudo-terminal, and measures its latency and data rate.
+ *  @details Each node keeps a table of linked values and runs a link thread
+ *           which works as @c ShareLink::poll() does: it reads and applies
+ *           frames which have arrived, then sends the latest values of the
+ *           shares which have changed, gathered into one frame, every link
+ *           period, and every value now and then as a refresh. Node A's
+ *           control thread puts a sequence number, the time, and two test
+ *           signals into its shares at 2 kHz; node B's application thread
+ *           sends back the last sequence number it saw. Some of A's frames
+ *           are damaged on purpose to check that the CRC catches them and
+ *           that the refresh makes good the values they carried.
+ *
+ *           The program prints the one-way latency from a put on A to the
+ *           value arriving on B, the round trip time of the sequence number,
+ *           how many puts were gathered into each value sent, and the data
+ *           rate the link needs.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -pthread -Isrc -Ihost \
+ *               host/sharelink_loopback.cpp -o sharelink_loopback
+ *           ./sharelink_loopback [period_us]
+ *           @endcode
+ *           The program's exit status is 0 if both nodes end up with the
+ *           same values and every damaged frame was caught.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sharelink_codec.h"
+
+
+/// The ID numbers and types of the linked shares
+enum : uint8_t { SEQUENCE, TIME_US, ANGLE, COUNT, ACK, N_SHARES };
+
+/// The types of the linked shares, in order of ID number
+const uint8_t TYPES[N_SHARES] = { SHARE_U32, SHARE_U32, SHARE_FLOAT,
+                                  SHARE_I16, SHARE_U32 };
+
+/// The time between puts by node A's control thread, in microseconds
+const uint32_t PUT_US = 500;
+
+/// How long node A's control thread runs, in microseconds
+const uint32_t RUN_US = 3000000;
+
+/// The time between refreshes of every share, in microseconds
+const uint32_t REFRESH_US = 100000;
+
+/// One of node A's frames in this many is damaged on purpose
+const uint32_t DAMAGE_EVERY = 50;
+
+
+/// Return the time in microseconds since the program started
+static uint32_t now_us (void)
+{
+    static const auto start = std::chrono::steady_clock::now ();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>
+           (std::chrono::steady_clock::now () - start).count ();
+}
+
+
+/** @brief   One node: a table of shares and the link which carries them.
+ */
+class Node
+{
+public:
+    int fd;                               ///< This node's end of the line
+    uint64_t values[N_SHARES];            ///< The shares' values, widened
+    bool has_value[N_SHARES];             ///< The share has had data put in
+    std::mutex lock;                      ///< Guards the shares, as queues do
+    std::atomic<uint32_t> changed;        ///< Bit per share to be sent
+    ShareLinkFramer framer;               ///< Builds outgoing frames
+    ShareLinkParser parser;               ///< Unpacks incoming frames
+    uint32_t damage_every;                ///< Damage frames, or 0 for none
+    uint32_t frames_sent;                 ///< Frames sent
+    uint32_t values_sent;                 ///< Share values sent
+    uint32_t damaged;                     ///< Frames damaged on purpose
+    uint64_t bytes_sent;                  ///< Bytes written to the line
+    std::vector<uint32_t> latencies;      ///< Put-to-arrival times of TIME_US
+    uint32_t last_refresh;                ///< Time of the last refresh
+
+    Node (int line_fd, uint32_t damage)
+        : fd (line_fd), changed (0), damage_every (damage), frames_sent (0),
+          values_sent (0), damaged (0), bytes_sent (0), last_refresh (0)
+    {
+        memset (values, 0, sizeof (values));
+        memset (has_value, 0, sizeof (has_value));
+    }
+
+    /// Put a value into a share, as a task would, marking it changed
+    void put (uint8_t id, uint64_t value)
+    {
+        {
+            std::lock_guard<std::mutex> guard (lock);
+            values[id] = value;
+            has_value[id] = true;
+        }
+        changed.fetch_or (1UL << id);
+    }
+
+    /// Get a share's value
+    uint64_t get (uint8_t id)
+    {
+        std::lock_guard<std::mutex> guard (lock);
+        return values[id];
+    }
+
+    /// Read and apply arriving frames, then send changed shares
+    void poll (void)
+    {
+        uint8_t buffer[512];
+        ssize_t got;
+        while ((got = read (fd, buffer, sizeof (buffer))) > 0)
+        {
+            for (ssize_t index = 0; index < got; index++)
+            {
+                if (parser.feed (buffer[index]))
+                {
+                    apply ();
+                }
+            }
+        }
+
+        uint32_t which = changed.exchange (0);
+        uint32_t now = now_us ();
+        if (now - last_refresh >= REFRESH_US)
+        {
+            last_refresh = now;
+            which = (1UL << N_SHARES) - 1;
+        }
+        for (uint8_t id = 0; id < N_SHARES; id++)
+        {
+            if ((which & (1UL << id)) && has_value[id])
+            {
+                uint64_t value = get (id);
+                framer.add (id, TYPES[id], &value);
+                values_sent++;
+            }
+        }
+
+        uint8_t frame[SHARE_LINK_MAX_FRAME];
+        size_t length = framer.finish (frame);
+        if (length == 0)
+        {
+            return;
+        }
+        frames_sent++;
+        if (damage_every > 0 && frames_sent % damage_every == 0)
+        {
+            // Flip a bit, but never make a zero, which would split the frame
+            uint8_t& victim = frame[length / 2];
+            victim ^= (victim == 0x10) ? 0x20 : 0x10;
+            damaged++;
+        }
+        size_t done = 0;
+        while (done < length)
+        {
+            ssize_t wrote = write (fd, frame + done, length - done);
+            if (wrote > 0)
+            {
+                done += wrote;
+            }
+        }
+        bytes_sent += length;
+    }
+
+    /// Put the updates in the frame which just arrived into the shares
+    void apply (void)
+    {
+        uint8_t id, type;
+        const uint8_t* p_value;
+        while (parser.next (id, type, p_value))
+        {
+            if (id >= N_SHARES || type != TYPES[id])
+            {
+                continue;
+            }
+            uint64_t value = share_type_widen (type, p_value);
+            std::lock_guard<std::mutex> guard (lock);
+
+            // Time only new values, not ones sent again by a refresh
+            if (id == TIME_US && value != values[id])
+            {
+                latencies.push_back (now_us () - (uint32_t)value);
+            }
+            values[id] = value;
+            has_value[id] = true;
+        }
+    }
+};
+
+
+/// Set when the nodes' threads should stop
+static std::atomic<bool> stopping (false);
+
+
+/** @brief   Run a node's link every period until told to stop.
+ *  @param   p_node Pointer to the node
+ *  @param   period_us The link period in microseconds
+ */
+static void link_thread (Node* p_node, uint32_t period_us)
+{
+    auto wake = std::chrono::steady_clock::now ();
+    while (!stopping)
+    {
+        p_node->poll ();
+        wake += std::chrono::microseconds (period_us);
+        std::this_thread::sleep_until (wake);
+    }
+}
+
+
+/** @brief   Open a pseudo-terminal in raw, non-blocking mode.
+ *  @param   p_master Set to the master side's file descriptor
+ *  @param   p_slave Set to the slave side's file descriptor
+ *  @returns @c true if it worked
+ */
+static bool open_line (int* p_master, int* p_slave)
+{
+    int master = posix_openpt (O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt (master) != 0 || unlockpt (master) != 0)
+    {
+        return false;
+    }
+    int slave = open (ptsname (master), O_RDWR | O_NOCTTY);
+    if (slave < 0)
+    {
+        return false;
+    }
+    struct termios settings;
+    tcgetattr (slave, &settings);
+    cfmakeraw (&settings);
+    tcsetattr (slave, TCSANOW, &settings);
+    fcntl (master, F_SETFL, O_NONBLOCK);
+    fcntl (slave, F_SETFL, O_NONBLOCK);
+    *p_master = master;
+    *p_slave = slave;
+    return true;
+}
+
+
+/// Return a percentile of a sorted list of times
+static uint32_t percentile (const std::vector<uint32_t>& sorted, double part)
+{
+    return sorted.empty () ? 0 : sorted[(size_t)(part * (sorted.size () - 1))];
+}
+
+
+int main (int argc, char** argv)
+{
+    uint32_t period_us = (argc > 1) ? atoi (argv[1]) : 2000;
+    if (period_us == 0)
+    {
+        period_us = 2000;
+    }
+
+    int master, slave;
+    if (!open_line (&master, &slave))
+    {
+        perror ("Can't open a pseudo-terminal");
+        return 1;
+    }
+    printf ("Linking two nodes through %s, link period %u us, puts every "
+            "%u us\n", ptsname (master), period_us, PUT_US);
+
+    Node node_a (master, DAMAGE_EVERY);
+    Node node_b (slave, 0);
+    std::thread link_a (link_thread, &node_a, period_us);
+    std::thread link_b (link_thread, &node_b, period_us);
+
+    // Node B's application sends back the last sequence number it saw
+    std::thread echo ([&node_b] ()
+    {
+        uint64_t last = 0;
+        while (!stopping)
+        {
+            uint64_t sequence = node_b.get (SEQUENCE);
+            if (sequence != last)
+            {
+                node_b.put (ACK, sequence);
+                last = sequence;
+            }
+            std::this_thread::sleep_for (std::chrono::microseconds (100));
+        }
+    });
+
+    // Node A's control loop puts new values, and notes when each sequence
+    // number was put so the round trip can be timed when it comes back
+    std::vector<uint32_t> put_times;
+    std::vector<uint32_t> round_trips;
+    uint64_t last_ack = 0;
+    uint32_t puts = 0;
+    auto wake = std::chrono::steady_clock::now ();
+    for (uint32_t start = now_us (); now_us () - start < RUN_US; puts++)
+    {
+        float angle = sinf (puts * 0.01f);
+        int16_t count = (int16_t)(puts * 3);
+        put_times.push_back (now_us ());
+        node_a.put (SEQUENCE, puts);
+        node_a.put (TIME_US, put_times.back ());
+        node_a.put (ANGLE, share_type_widen (SHARE_FLOAT, &angle));
+        node_a.put (COUNT, share_type_widen (SHARE_I16, &count));
+
+        uint64_t ack = node_a.get (ACK);
+        if (ack != last_ack && ack < put_times.size ())
+        {
+            round_trips.push_back (now_us () - put_times[ack]);
+            last_ack = ack;
+        }
+        wake += std::chrono::microseconds (PUT_US);
+        std::this_thread::sleep_until (wake);
+    }
+
+    // Let the last changes and a refresh go through, then stop
+    std::this_thread::sleep_for (std::chrono::microseconds (3 * REFRESH_US));
+    stopping = true;
+    link_a.join ();
+    link_b.join ();
+    echo.join ();
+
+    bool same = true;
+    for (uint8_t id = 0; id < N_SHARES; id++)
+    {
+        same = same && node_a.get (id) == node_b.get (id);
+    }
+
+    std::sort (node_b.latencies.begin (), node_b.latencies.end ());
+    std::sort (round_trips.begin (), round_trips.end ());
+    double seconds = RUN_US / 1e6;
+    uint32_t a_frames = node_a.frames_sent;
+    printf ("Node A: %u puts of 4 shares, %u frames (%u damaged), %u values "
+            "sent; %.1f puts per value\n", puts, a_frames, node_a.damaged,
+            node_a.values_sent, 4.0 * puts / node_a.values_sent);
+    printf ("Node B: %u good frames, %u bad, %u lost\n",
+            node_b.parser.get_good_frames (),
+            node_b.parser.get_bad_frames (), 
+            node_b.parser.get_lost_frames ());
+    printf ("Data rate A to B: %.0f bytes/s, %.1f%% of a 921600 baud UART\n",
+            node_a.bytes_sent / seconds,
+            node_a.bytes_sent / seconds / 921.6);
+    printf ("One-way latency, us: median %u, 99%% %u, max %u\n",
+            percentile (node_b.latencies, 0.5),
+            percentile (node_b.latencies, 0.99),
+            percentile (node_b.latencies, 1.0));
+    printf ("Round trip, us: median %u, 99%% %u, max %u\n",
+            percentile (round_trips, 0.5), percentile (round_trips, 0.99),
+            percentile (round_trips, 1.0));
+    printf ("Both nodes hold the same values: %s\n", same ? "yes" : "no");
+
+    close (slave);
+    close (master);
+
+    bool passed = same && node_b.parser.get_bad_frames () == node_a.damaged
+                  && node_a.damaged > 0;
+    printf ("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+//*****************************************************************************
+/** @file    Arduino.h
+ *  @brief   Just enough of the Arduino core to run ME507 programs in the host
+ *           simulation.
+ *  @details The printing classes @c Print, @c Printable and @c Stream behave
+ *           as they do on the ESP32 and STM32 Arduino cores. @c Serial writes
+ *           to standard output and reads, without blocking, from standard
+ *           input. Timing functions use the simulation's virtual clock, and
+ *           digital pins are simple variables which a test can examine.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_ARDUINO_H_
+#define _SIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include "FreeRTOS.h"
+
+#define HIGH            0x1
+#define LOW             0x0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define LED_BUILTIN     13
+#define NUM_DIGITAL_PINS 256
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define constrain(amt, low, high) \
+    ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#ifndef PI
+    #define PI          3.1415926535897932384626433832795
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class __FlashStringHelper;
+#define F(string_literal) \
+    (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+
+/** @brief   A very small version of Arduino's @c String class.
+ */
+class String
+{
+protected:
+    std::string text;                  ///< The characters in the string
+
+public:
+    String (const char* p_text = "") : text (p_text ? p_text : "") { }
+    String (const std::string& a_text) : text (a_text) { }
+    String (char a_char) : text (1, a_char) { }
+    String (int number, unsigned char base = 10);
+    String (unsigned int number, unsigned char base = 10);
+    String (long number, unsigned char base = 10);
+    String (unsigned long number, unsigned char base = 10);
+    String (double number, unsigned int places = 2);
+
+    const char* c_str (void) const { return text.c_str (); }
+    unsigned int length (void) const { return text.length (); }
+    char operator [] (unsigned int index) const { return text[index]; }
+    String& operator += (const String& other)
+    {
+        text += other.text;
+        return *this;
+    }
+    bool operator == (const String& other) const
+    {
+        return text == other.text;
+    }
+    friend String operator + (const String& a, const String& b)
+    {
+        return String (a.text + b.text);
+    }
+    int toInt (void) const { return atoi (text.c_str ()); }
+    float toFloat (void) const { return (float)atof (text.c_str ()); }
+};
+
+
+class Print;
+
+/** @brief   Base class for objects which know how to print themselves.
+ */
+class Printable
+{
+public:
+    virtual ~Printable (void) { }
+    virtual size_t printTo (Print& printer) const = 0;
+};
+
+
+/** @brief   Base class for everything which prints characters.
+ */
+class Print
+{
+protected:
+    size_t print_number (unsigned long long number, uint8_t base);
+
+public:
+    virtual ~Print (void) { }
+    virtual size_t write (uint8_t a_char) = 0;
+    virtual size_t write (const uint8_t* p_buffer, size_t size);
+    size_t write (const char* p_string)
+    {
+        return (p_string == NULL) ? 0
+               : write ((const uint8_t*)p_string, strlen (p_string));
+    }
+    size_t write (const char* p_buffer, size_t size)
+    {
+        return write ((const uint8_t*)p_buffer, size);
+    }
+    virtual int availableForWrite (void) { return 0; }
+    virtual void flush (void) { }
+
+    size_t printf (const char* p_format, ...)
+        __attribute__ ((format (printf, 2, 3)));
+
+    size_t print (const __FlashStringHelper* p_string);
+    size_t print (const String& a_string);
+    size_t print (const char p_string[]);
+    size_t print (char a_char);
+    size_t print (unsigned char number, int base = DEC);
+    size_t print (int number, int base = DEC);
+    size_t print (unsigned int number, int base = DEC);
+    size_t print (long number, int base = DEC);
+    size_t print (unsigned long number, int base = DEC);
+    size_t print (long long number, int base = DEC);
+    size_t print (unsigned long long number, int base = DEC);
+    size_t print (double number, int digits = 2);
+    size_t print (const Printable& thing);
+
+    size_t println (void);
+    template <class Thing> size_t println (const Thing& thing)
+    {
+        size_t count = print (thing);
+        return count + println ();
+    }
+    template <class Thing> size_t println (const Thing& thing, int format)
+    {
+        size_t count = print (thing, format);
+        return count + println ();
+    }
+};
+
+
+/** @brief   Base class for character devices which can be read as well as
+ *           written.
+ */
+class Stream : public Print
+{
+public:
+    virtual int available (void) = 0;
+    virtual int read (void) = 0;
+    virtual int peek (void) = 0;
+    size_t readBytes (char* p_buffer, size_t length);
+    void setTimeout (unsigned long milliseconds) { (void)milliseconds; }
+};
+
+
+/** @brief   The serial port, which in the simulation is the console.
+ */
+class HardwareSerial : public Stream
+{
+protected:
+    int peeked;                        ///< Character read early by @c peek()
+
+public:
+    HardwareSerial (void) : peeked (-1) { }
+    void begin (unsigned long baud_rate, uint32_t config = 0)
+    {
+        (void)baud_rate;
+        (void)config;
+    }
+    void end (void) { }
+    size_t write (uint8_t a_char);
+    size_t write (const uint8_t* p_buffer, size_t size);
+    using Print::write;
+    int available (void);
+    int read (void);
+    int peek (void);
+    void flush (void);
+    operator bool (void) { return true; }
+};
+
+extern HardwareSerial Serial;
+
+
+// Timing, which runs on the simulation's virtual clock
+unsigned long millis (void);
+unsigned long micros (void);
+void delay (uint32_t milliseconds);
+void delayMicroseconds (uint32_t microseconds);
+void yield (void);
+
+/** @brief   Stand-in for the ESP32 core's @c ESP object, which gives the 
+ *           processor's cycle count and clock frequency.
+ *  @details The simulated processor runs at 240 MHz of virtual time, so the
+ *           cycle count is the virtual time in microseconds times 240.
+ */
+class EspClass
+{
+public:
+    uint32_t getCycleCount (void)
+    {
+        return (uint32_t)(micros () * 240UL);
+    }
+    uint32_t getCpuFreqMHz (void)
+    {
+        return 240;
+    }
+};
+
+extern EspClass ESP;
+
+/// Return the processor's clock frequency in MHz, as on the ESP32
+inline uint32_t getCpuFrequencyMhz (void)
+{
+    return 240;
+}
+
+// Digital and analog pins, which are just variables
+void pinMode (uint8_t pin, uint8_t mode);
+void digitalWrite (uint8_t pin, uint8_t value);
+int digitalRead (uint8_t pin);
+int analogRead (uint8_t pin);
+void sim_set_pin (uint8_t pin, int value);
+
+// Arduino-style random numbers, repeatable from run to run
+void randomSeed (unsigned long seed);
+long random (long how_big);
+long random (long how_small, long how_big);
+
+// The program's own setup() and loop() functions
+void setup (void);
+void loop (void);
+
+#endif // _SIM_ARDUINO_H_
@@ -0,0 +1,220 @@
+//*****************************************************************************
+/** @file    FreeRTOS.h
+ *  @brief   A small, deterministic stand-in for the FreeRTOS API which lets
+ *           ME507 programs run on a Linux or macOS host.
+ *  @details This header declares the subset of the FreeRTOS task, queue,
+ *           semaphore, event group and task notification API which is used by
+ *           the ME507 support library and its examples. The functions are
+ *           implemented in @c sim_kernel.cpp by a simulation kernel which runs
+ *           each task in its own host thread but lets only one of them run at
+ *           a time, chosen by FreeRTOS' fixed-priority preemptive rules. Time
+ *           is virtual: the tick count, @c micros() and all timeouts advance
+ *           only when every task is blocked, at which point the clock jumps
+ *           straight to the next wake-up time. A run of the same program
+ *           therefore takes the same path every time, and a long test runs
+ *           as fast as the host can execute the task code.
+ *
+ *           Programs are built with @c HOST_SIM defined and with this
+ *           directory ahead of everything else on the include path; see
+ *           the @c native_sim environment in @c platformio.ini.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_FREERTOS_H_
+#define _SIM_FREERTOS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+// Basic types, sized as on the 32-bit ports used in ME507
+typedef int       BaseType_t;
+typedef unsigned  UBaseType_t;
+typedef uint32_t  TickType_t;
+typedef uint32_t  EventBits_t;
+typedef uint32_t  StackType_t;
+typedef void (*TaskFunction_t) (void*);
+
+typedef struct SimQueue* QueueHandle_t;
+typedef struct SimQueue* SemaphoreHandle_t;
+typedef struct SimTask* TaskHandle_t;
+typedef struct SimEventGroup* EventGroupHandle_t;
+
+#define portBASE_TYPE           int
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFALSE                 ((BaseType_t)0)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define errQUEUE_FULL           ((BaseType_t)0)
+#define errQUEUE_EMPTY          ((BaseType_t)0)
+
+#define configTICK_RATE_HZ      ((TickType_t)1000)
+#define configMAX_PRIORITIES    25
+#define configMINIMAL_STACK_SIZE 768
+#define portTICK_PERIOD_MS      ((TickType_t)(1000 / configTICK_RATE_HZ))
+#define portTICK_RATE_MS        portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms) \
+    ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define tskIDLE_PRIORITY        ((UBaseType_t)0)
+#define portNUM_PROCESSORS      1
+#define tskNO_AFFINITY          0x7FFFFFFF
+
+// Only one simulated task runs at a time and interrupts are only delivered
+// between kernel calls, so critical sections need not do anything
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    0
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)     ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)      ((void)(mux))
+#define portENTER_CRITICAL_SAFE(mux)    ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux)     ((void)(mux))
+#define taskENTER_CRITICAL()            do { } while (0)
+#define taskEXIT_CRITICAL()             do { } while (0)
+#define taskENTER_CRITICAL_FROM_ISR()   ((UBaseType_t)0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)   ((void)(x))
+#define taskDISABLE_INTERRUPTS()        do { } while (0)
+#define taskENABLE_INTERRUPTS()         do { } while (0)
+
+#define taskYIELD()                     vTaskYield ()
+#define portYIELD()                     vTaskYield ()
+#define portYIELD_FROM_ISR(...)         do { } while (0)
+#define portEND_SWITCHING_ISR(x)        ((void)(x))
+
+
+/// Actions which @c xTaskNotify() can take on the notified task's value
+typedef enum
+{
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+
+// Tasks
+BaseType_t xTaskCreate (TaskFunction_t function, const char* name,
+                        uint32_t stack_depth, void* p_params,
+                        UBaseType_t priority, TaskHandle_t* p_handle);
+BaseType_t xTaskCreatePinnedToCore (TaskFunction_t function, const char* name,
+                                    uint32_t stack_depth, void* p_params,
+                                    UBaseType_t priority,
+                                    TaskHandle_t* p_handle, BaseType_t core);
+void vTaskDelete (TaskHandle_t task);
+void vTaskDelay (TickType_t ticks);
+void vTaskDelayUntil (TickType_t* p_previous_wake, TickType_t increment);
+BaseType_t xTaskDelayUntil (TickType_t* p_previous_wake, TickType_t increment);
+void vTaskYield (void);
+void vTaskSuspend (TaskHandle_t task);
+void vTaskResume (TaskHandle_t task);
+void vTaskSuspendAll (void);
+BaseType_t xTaskResumeAll (void);
+UBaseType_t uxTaskPriorityGet (TaskHandle_t task);
+void vTaskPrioritySet (TaskHandle_t task, UBaseType_t priority);
+TickType_t xTaskGetTickCount (void);
+TickType_t xTaskGetTickCountFromISR (void);
+TaskHandle_t xTaskGetCurrentTaskHandle (void);
+char* pcTaskGetName (TaskHandle_t task);
+#define pcTaskGetTaskName pcTaskGetName
+UBaseType_t uxTaskGetStackHighWaterMark (TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks (void);
+void vTaskStartScheduler (void);
+BaseType_t xPortInIsrContext (void);
+BaseType_t xPortGetCoreID (void);
+
+// Task notifications
+BaseType_t xTaskNotifyGive (TaskHandle_t task);
+void vTaskNotifyGiveFromISR (TaskHandle_t task, BaseType_t* p_woken);
+uint32_t ulTaskNotifyTake (BaseType_t clear_on_exit, TickType_t ticks);
+BaseType_t xTaskNotify (TaskHandle_t task, uint32_t value,
+                        eNotifyAction action);
+BaseType_t xTaskNotifyFromISR (TaskHandle_t task, uint32_t value,
+                               eNotifyAction action, BaseType_t* p_woken);
+BaseType_t xTaskNotifyWait (uint32_t clear_on_entry, uint32_t clear_on_exit,
+                            uint32_t* p_value, TickType_t ticks);
+
+// Queues
+QueueHandle_t xQueueCreate (UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete (QueueHandle_t queue);
+BaseType_t xQueueSend (QueueHandle_t queue, const void* p_item,
+                       TickType_t ticks);
+BaseType_t xQueueSendToBack (QueueHandle_t queue, const void* p_item,
+                             TickType_t ticks);
+BaseType_t xQueueSendToFront (QueueHandle_t queue, const void* p_item,
+                              TickType_t ticks);
+BaseType_t xQueueOverwrite (QueueHandle_t queue, const void* p_item);
+BaseType_t xQueueSendFromISR (QueueHandle_t queue, const void* p_item,
+                              BaseType_t* p_woken);
+BaseType_t xQueueSendToBackFromISR (QueueHandle_t queue, const void* p_item,
+                                    BaseType_t* p_woken);
+BaseType_t xQueueSendToFrontFromISR (QueueHandle_t queue, const void* p_item,
+                                     BaseType_t* p_woken);
+BaseType_t xQueueOverwriteFromISR (QueueHandle_t queue, const void* p_item,
+                                   BaseType_t* p_woken);
+BaseType_t xQueueReceive (QueueHandle_t queue, void* p_buffer,
+                          TickType_t ticks);
+BaseType_t xQueueReceiveFromISR (QueueHandle_t queue, void* p_buffer,
+                                 BaseType_t* p_woken);
+BaseType_t xQueuePeek (QueueHandle_t queue, void* p_buffer, TickType_t ticks);
+BaseType_t xQueuePeekFromISR (QueueHandle_t queue, void* p_buffer);
+UBaseType_t uxQueueMessagesWaiting (QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaitingFromISR (QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable (QueueHandle_t queue);
+BaseType_t xQueueReset (QueueHandle_t queue);
+BaseType_t xQueueIsQueueFullFromISR (QueueHandle_t queue);
+BaseType_t xQueueIsQueueEmptyFromISR (QueueHandle_t queue);
+
+// Semaphores and mutexes, which are queues of zero-size items
+SemaphoreHandle_t xSemaphoreCreateBinary (void);
+SemaphoreHandle_t xSemaphoreCreateCounting (UBaseType_t max_count,
+                                            UBaseType_t initial_count);
+SemaphoreHandle_t xSemaphoreCreateMutex (void);
+BaseType_t xSemaphoreTake (SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive (SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTakeFromISR (SemaphoreHandle_t semaphore,
+                                  BaseType_t* p_woken);
+BaseType_t xSemaphoreGiveFromISR (SemaphoreHandle_t semaphore,
+                                  BaseType_t* p_woken);
+UBaseType_t uxSemaphoreGetCount (SemaphoreHandle_t semaphore);
+#define vSemaphoreDelete(sem) vQueueDelete (sem)
+
+// Event groups
+EventGroupHandle_t xEventGroupCreate (void);
+void vEventGroupDelete (EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits (EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits (EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits (EventGroupHandle_t group);
+BaseType_t xEventGroupSetBitsFromISR (EventGroupHandle_t group,
+                                      EventBits_t bits, BaseType_t* p_woken);
+EventBits_t xEventGroupClearBitsFromISR (EventGroupHandle_t group,
+                                         EventBits_t bits);
+EventBits_t xEventGroupGetBitsFromISR (EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits (EventGroupHandle_t group, EventBits_t bits,
+                                 BaseType_t clear_on_exit,
+                                 BaseType_t wait_for_all, TickType_t ticks);
+EventBits_t xEventGroupSync (EventGroupHandle_t group, EventBits_t set_bits,
+                             EventBits_t wait_bits, TickType_t ticks);
+
+
+// Functions which control the simulation itself rather than mimic FreeRTOS
+uint64_t sim_time_us (void);
+void sim_set_time_limit_ms (uint64_t limit_ms);
+void sim_stop (int exit_code = 0);
+bool sim_is_running (void);
+bool sim_scheduler_started (void);
+int sim_get_exit_code (void);
+uint32_t sim_context_switches (void);
+int sim_attach_interrupt (uint32_t period_us, void (*p_isr) (void));
+void sim_detach_interrupt (int id);
+void sim_set_interrupt_period (int id, uint32_t period_us);
+void sim_advance_busy (uint32_t microseconds);
+
+#endif // _SIM_FREERTOS_H_
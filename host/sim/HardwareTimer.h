@@ -0,0 +1,202 @@
+//*****************************************************************************
+/** @file    HardwareTimer.h
+ *  @brief   A model of the STM32 general purpose timers and of the
+ *           STM32duino @c HardwareTimer class, so that code which uses
+ *           timers in encoder mode can run on a PC.
+ *  @details Each timer, @c TIM1 through @c TIM8, is a @c TIM_TypeDef with
+ *           the registers which encoder code uses, and it behaves as the
+ *           STM32's encoder interface does: when the slave mode bits in
+ *           @c SMCR select encoder mode 1, 2 or 3 and @c CEN in @c CR1 is
+ *           set, edges on the channel 1 and 2 inputs count @c CNT up or
+ *           down, wrapping at @c ARR, with the direction shown in the
+ *           @c DIR bit. The input polarity bits in @c CCER and the digital
+ *           input filters set by the @c IC1F and @c IC2F bits of @c CCMR1
+ *           are modeled too, so a glitch shorter than the filter's time is
+ *           ignored just as it is by the hardware. @c TIM2 and @c TIM5 have
+ *           32-bit counters; the others have 16-bit ones.
+ *
+ *           Nothing drives the inputs on its own. A signal generator such
+ *           as @c QuadratureGenerator, in @c quadrature.h, calls
+ *           @c sim_timer_edge() for each edge with the time at which it
+ *           happens, in nanoseconds; edges must come in order of time.
+ *
+ *           The STM32 pin names, such as @c PB4, are defined here as well,
+ *           as the STM32duino variant files would define them, so that
+ *           programs which pass them to @c HardwareTimer compile.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_HARDWARETIMER_H_
+#define _SIM_HARDWARETIMER_H_
+
+#include <stdint.h>
+
+
+/// The timers' clock frequency, as on an STM32L476 running at 80 MHz
+#define SIM_TIMER_CLOCK_HZ      80000000UL
+
+// Register bits used by encoder code, with the names in the CMSIS headers
+#define TIM_CR1_CEN             (1UL << 0)      ///< Counter enable
+#define TIM_CR1_DIR             (1UL << 4)      ///< Counting down
+#define TIM_SMCR_SMS_0          (1UL << 0)      ///< Slave mode bit 0
+#define TIM_SMCR_SMS_1          (1UL << 1)      ///< Slave mode bit 1
+#define TIM_SMCR_SMS_2          (1UL << 2)      ///< Slave mode bit 2
+#define TIM_SMCR_SMS            (7UL << 0)      ///< Slave mode bits
+#define TIM_CCMR1_CC1S_0        (1UL << 0)      ///< Channel 1 is input TI1
+#define TIM_CCMR1_IC1F_Pos      4               ///< Channel 1 filter bits
+#define TIM_CCMR1_IC1F          (15UL << 4)     ///< Channel 1 filter mask
+#define TIM_CCMR1_CC2S_0        (1UL << 8)      ///< Channel 2 is input TI2
+#define TIM_CCMR1_IC2F_Pos      12              ///< Channel 2 filter bits
+#define TIM_CCMR1_IC2F          (15UL << 12)    ///< Channel 2 filter mask
+#define TIM_CCER_CC1P           (1UL << 1)      ///< Invert channel 1
+#define TIM_CCER_CC2P           (1UL << 5)      ///< Invert channel 2
+
+
+/** @brief   The state of one encoder input, which isn't a register but is
+ *           kept with the timer's registers for the model's use.
+ */
+struct SimTimerInput
+{
+    uint8_t raw;                          ///< Level at the pin
+    uint8_t filtered;                     ///< Level after the filter
+    uint64_t change_ns;                   ///< When @c raw last changed
+};
+
+
+/** @brief   The registers of one STM32 general purpose timer, plus the
+ *           model's state for it.
+ */
+struct TIM_TypeDef
+{
+    volatile uint32_t CR1;                ///< Control register 1
+    volatile uint32_t CR2;                ///< Control register 2
+    volatile uint32_t SMCR;               ///< Slave mode control register
+    volatile uint32_t DIER;               ///< DMA and interrupt enables
+    volatile uint32_t SR;                 ///< Status register
+    volatile uint32_t EGR;                ///< Event generation register
+    volatile uint32_t CCMR1;              ///< Capture/compare mode 1
+    volatile uint32_t CCMR2;              ///< Capture/compare mode 2
+    volatile uint32_t CCER;               ///< Capture/compare enables
+    volatile uint32_t CNT;                ///< Counter
+    volatile uint32_t PSC;                ///< Prescaler
+    volatile uint32_t ARR;                ///< Auto-reload (top count)
+
+    SimTimerInput inputs[2];              ///< Channel 1 and 2 inputs
+    uint32_t counted;                     ///< Edges which moved @c CNT
+    uint32_t filtered_out;                ///< Glitches the filter removed
+};
+
+/// The model's timers, which @c TIM1 to @c TIM8 point to
+extern TIM_TypeDef sim_timers[8];
+
+#define TIM1                    (&sim_timers[0])
+#define TIM2                    (&sim_timers[1])
+#define TIM3                    (&sim_timers[2])
+#define TIM4                    (&sim_timers[3])
+#define TIM5                    (&sim_timers[4])
+#define TIM6                    (&sim_timers[5])
+#define TIM7                    (&sim_timers[6])
+#define TIM8                    (&sim_timers[7])
+
+
+/// Pin names as defined by the STM32duino variants for 64-pin parts
+enum SimStm32Pin : uint8_t
+{
+    PA0, PA1, PA2, PA3, PA4, PA5, PA6, PA7,
+    PA8, PA9, PA10, PA11, PA12, PA13, PA14, PA15,
+    PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7,
+    PB8, PB9, PB10, PB11, PB12, PB13, PB14, PB15,
+    PC0, PC1, PC2, PC3, PC4, PC5, PC6, PC7,
+    PC8, PC9, PC10, PC11, PC12, PC13, PC14, PC15
+};
+
+
+/// Timer channel modes; the model only keeps the value
+typedef uint32_t TimerModes_t;
+
+/// The ways in which @c HardwareTimer::setOverflow() can be given a value
+enum TimerFormat_t
+{
+    TICK_FORMAT,                          ///< Counts of the timer's clock
+    MICROSEC_FORMAT,                      ///< Microseconds
+    HERTZ_FORMAT                          ///< Frequency of overflows
+};
+
+
+/** @brief   The parts of STM32duino's @c HardwareTimer class which are used
+ *           with encoders, working on the model's registers.
+ */
+class HardwareTimer
+{
+protected:
+    TIM_TypeDef* p_regs;                  ///< The timer's registers
+    TimerModes_t modes[4];                ///< Modes set for the channels
+    uint32_t pins[4];                     ///< Pins given for the channels
+
+public:
+    // Take charge of a timer
+    HardwareTimer (TIM_TypeDef* instance);
+
+    /// Stop the timer from counting
+    void pause (void)
+    {
+        p_regs->CR1 = p_regs->CR1 & ~TIM_CR1_CEN;
+    }
+
+    /// Let the timer count again
+    void resume (void)
+    {
+        p_regs->CR1 = p_regs->CR1 | TIM_CR1_CEN;
+    }
+
+    // Set the mode of a channel and the pin it uses
+    void setMode (uint32_t channel, TimerModes_t mode, uint32_t pin = 0xFF);
+
+    /// Set the timer's count
+    void setCount (uint32_t count, TimerFormat_t format = TICK_FORMAT)
+    {
+        (void)format;
+        p_regs->CNT = count;
+    }
+
+    /// Return the timer's count
+    uint32_t getCount (TimerFormat_t format = TICK_FORMAT)
+    {
+        (void)format;
+        return p_regs->CNT;
+    }
+
+    // Set the count at which the timer wraps around
+    void setOverflow (uint32_t overflow, TimerFormat_t format = TICK_FORMAT);
+
+    /// Return the count at which the timer wraps around
+    uint32_t getOverflow (TimerFormat_t format = TICK_FORMAT)
+    {
+        (void)format;
+        return p_regs->ARR + 1;
+    }
+
+    /// Return a pointer to the timer's registers
+    TIM_TypeDef* getHandle (void)
+    {
+        return p_regs;
+    }
+};
+
+
+// Reset a timer's registers and inputs as at power-up
+void sim_timer_reset (TIM_TypeDef* timer);
+
+// Toggle the level at a timer's channel 1 or 2 input at the given time
+void sim_timer_edge (TIM_TypeDef* timer, uint8_t channel, uint64_t time_ns);
+
+// Let any input changes which have outlasted the filter reach the counter
+void sim_timer_settle (TIM_TypeDef* timer, uint64_t time_ns);
+
+#endif // _SIM_HARDWARETIMER_H_
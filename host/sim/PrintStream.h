@@ -0,0 +1,68 @@
+//*****************************************************************************
+/** @file    PrintStream.h
+ *  @brief   Stream insertion operators for Arduino @c Print objects, with the
+ *           same interface as the PrintStream library used by ME507 programs.
+ *  @details This is a small re-implementation for the host simulation of
+ *           the library at @c https://github.com/spluttflob/Arduino-PrintStream
+ *           (originally @c https://github.com/tttapa/Arduino-PrintStream).
+ *           Number base, floating point precision and @c boolalpha work as in
+ *           the original; the byte separator is accepted but ignored.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_PRINTSTREAM_H_
+#define _SIM_PRINTSTREAM_H_
+
+#include <Arduino.h>
+
+/// The type of manipulator functions such as @c endl and @c hex
+typedef Print& manipulator (Print&);
+
+Print& endl (Print& printer);
+Print& flush (Print& printer);
+Print& hex (Print& printer);
+Print& bin (Print& printer);
+Print& dec (Print& printer);
+Print& boolalpha (Print& printer);
+Print& noboolalpha (Print& printer);
+
+/// Holds a number base for @c setbase()
+struct _Setbase { uint8_t M_base; };
+_Setbase setbase (uint8_t base);
+
+/// Holds a number of digits for @c setprecision()
+struct _Setprecision { int M_n; };
+_Setprecision setprecision (int n);
+
+/// Holds a separator for @c setbytesep()
+struct _Setbytesep { char M_bytesep; };
+_Setbytesep setbytesep (char bytesep);
+
+Print& operator<< (Print& printer, const __FlashStringHelper* s);
+Print& operator<< (Print& printer, const String& s);
+Print& operator<< (Print& printer, const char s[]);
+Print& operator<< (Print& printer, char c);
+Print& operator<< (Print& printer, unsigned char c);
+Print& operator<< (Print& printer, int i);
+Print& operator<< (Print& printer, unsigned int i);
+Print& operator<< (Print& printer, int8_t i);
+Print& operator<< (Print& printer, long i);
+Print& operator<< (Print& printer, unsigned long i);
+Print& operator<< (Print& printer, long long i);
+Print& operator<< (Print& printer, unsigned long long i);
+Print& operator<< (Print& printer, double d);
+Print& operator<< (Print& printer, float f);
+Print& operator<< (Print& printer, const Printable& p);
+Print& operator<< (Print& printer, bool b);
+Print& operator<< (Print& printer, manipulator pf);
+Print& operator<< (Print& printer, _Setbase f);
+Print& operator<< (Print& printer, _Setprecision f);
+Print& operator<< (Print& printer, _Setbytesep f);
+
+#endif // _SIM_PRINTSTREAM_H_
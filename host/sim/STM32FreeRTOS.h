@@ -0,0 +1,2 @@
+// Stand-in for the STM32FreeRTOS library header; see FreeRTOS.h
+#include "FreeRTOS.h"
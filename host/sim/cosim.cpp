@@ -0,0 +1,301 @@
+//*****************************************************************************
+/** @file    cosim.cpp
+ *  @brief   Source code for the bridge between shares in the host simulation
+ *           and a plant model in another process.
+ *  @details See @c cosim.h for a description of the bridge.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <sys/stat.h>
+#include "cosim.h"
+
+
+/** @brief   Write a value put into an actuator share into its slot.
+ *  @details This is called by the task which put the value in, so the plant
+ *           sees each actuator's latest value at the next step.
+ *  @param   p_from Pointer to the share, which is ignored as each channel
+ *           listens to one share only
+ *  @param   p_value Pointer to the value which was put in
+ */
+void CosimChannel::on_put (BaseShare* p_from, const void* p_value)
+{
+    (void)p_from;
+    cosim_write (*p_signal, share_type_widen (p_signal->type, p_value));
+}
+
+
+/** @brief   Create a bridge which will use the given shared memory region.
+ *  @details The region is made when the first share is connected.
+ *  @param   p_shm_name The name of the shared memory region, which must
+ *           begin with a slash; the plant must use the same name
+ *  @param   p_name A name for the bridge, shown by @c print_all_shares()
+ */
+CosimBridge::CosimBridge (const char* p_shm_name, const char* p_name)
+    : BaseShare (p_name), p_region_name (p_shm_name)
+{
+    p_region = NULL;
+    n_channels = 0;
+    wait_ms = 5000;
+    plant_present = false;
+    steps = 0;
+    missed = 0;
+    sensor_updates = 0;
+    step_ticks = 1;
+}
+
+
+/** @brief   Make the shared memory region, if it hasn't been made yet.
+ *  @details A region of the same name left by an earlier run is removed
+ *           first, so a plant waiting for it doesn't pick up the old one.
+ *  @returns @c true if the region is ready, @c false if it couldn't be made
+ */
+bool CosimBridge::create_region (void)
+{
+    if (p_region != NULL)
+    {
+        return true;
+    }
+    shm_unlink (p_region_name);
+    int fd = shm_open (p_region_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate (fd, sizeof (CosimRegion)) != 0)
+    {
+        perror ("CosimBridge can't make shared memory");
+        return false;
+    }
+    void* p_map = mmap (NULL, sizeof (CosimRegion), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    ::close (fd);
+    if (p_map == MAP_FAILED)
+    {
+        perror ("CosimBridge can't map shared memory");
+        return false;
+    }
+
+    // The new region is all zeros, which is a fine starting state for the
+    // atomic counters in it
+    p_region = (CosimRegion*)p_map;
+    p_region->step_us = 1000;
+    return true;
+}
+
+
+/** @brief   Connect a share in either direction.
+ *  @details The plant finds the share by its name, which is cut short if
+ *           it won't fit in a slot.
+ *  @param   share The share or queue to be connected
+ *  @param   direction Whether the share is an actuator or a sensor
+ *  @returns @c true if connected, @c false if the share holds a type which
+ *           can't be sent, all the slots are used or the region couldn't be
+ *           made
+ */
+bool CosimBridge::add (BaseShare& share, CosimDirection direction)
+{
+    if (n_channels >= COSIM_MAX_SIGNALS
+        || share.get_value_type () == SHARE_NONE || !create_region ())
+    {
+        return false;
+    }
+    CosimSignal* p_signal = &p_region->signals[n_channels];
+    strncpy (p_signal->name, share.get_name (), COSIM_NAME_LENGTH - 1);
+    p_signal->type = share.get_value_type ();
+    p_signal->direction = direction;
+
+    CosimChannel& channel = channels[n_channels];
+    channel.p_bridge = this;
+    channel.p_share = &share;
+    channel.p_signal = p_signal;
+    channel.last_sequence = 0;
+    n_channels++;
+    p_region->n_signals = n_channels;
+
+    // An actuator's slot starts with the share's value, if it has one
+    if (direction == COSIM_TO_PLANT)
+    {
+        uint64_t value = 0;
+        if (share.peek_value (&value))
+        {
+            cosim_write (*p_signal, share_type_widen (p_signal->type,
+                                                      &value));
+        }
+        share.add_listener (&channel);
+    }
+    return true;
+}
+
+
+/** @brief   Connect a share or queue whose values go to the plant.
+ *  @param   share The share or queue, such as a motor's duty cycle
+ *  @returns @c true if connected, @c false if not
+ */
+bool CosimBridge::add_actuator (BaseShare& share)
+{
+    return add (share, COSIM_TO_PLANT);
+}
+
+
+/** @brief   Connect a share or queue whose values come from the plant.
+ *  @details A sensor value is put into the share or queue only when the
+ *           plant has written a new one, so a queue gets one item for each
+ *           value written.
+ *  @param   share The share or queue, such as a motor's measured speed
+ *  @returns @c true if connected, @c false if not
+ */
+bool CosimBridge::add_sensor (BaseShare& share)
+{
+    return add (share, COSIM_FROM_PLANT);
+}
+
+
+/** @brief   Wait for the plant to do a step.
+ *  @details The wait spins, then yields the host CPU, but never blocks the
+ *           simulation's task, so virtual time doesn't move. Once the plant
+ *           has missed a step, later steps don't wait for it until it
+ *           answers again, so a plant which has quit doesn't slow the
+ *           simulation down.
+ *  @param   step The step number which the plant should echo back
+ *  @returns @c true if the plant did the step, @c false if not
+ */
+bool CosimBridge::wait_for_plant (uint64_t step)
+{
+    auto start = std::chrono::steady_clock::now ();
+    uint32_t limit_ms = (step == 1) ? COSIM_FIRST_WAIT_MS
+                        : (plant_present ? wait_ms : 0);
+    for (uint32_t spins = 0; ; spins++)
+    {
+        if (p_region->step_done.load (std::memory_order_acquire) >= step)
+        {
+            plant_present = true;
+            return true;
+        }
+        if (spins > 1000)
+        {
+            std::this_thread::yield ();
+            if ((spins & 0x3FF) == 0
+                && std::chrono::steady_clock::now () - start
+                   >= std::chrono::milliseconds (limit_ms))
+            {
+                plant_present = false;
+                return false;
+            }
+        }
+    }
+}
+
+
+/** @brief   Do one step of the plant and put its sensor values into shares.
+ *  @details This is run by the bridge's task; it may instead be called by a
+ *           program's own task, every @c step_us of virtual time. The first
+ *           step marks the region ready, as every share has been connected
+ *           by then, and waits a long time for the plant, so the plant may
+ *           be started after the simulation.
+ */
+void CosimBridge::step (void)
+{
+    if (p_region == NULL)
+    {
+        return;
+    }
+    steps++;
+    if (steps == 1)
+    {
+        p_region->magic.store (COSIM_MAGIC, std::memory_order_release);
+    }
+    p_region->time_us.store (micros (), std::memory_order_relaxed);
+    p_region->step_request.store (steps, std::memory_order_release);
+    if (!wait_for_plant (steps))
+    {
+        missed++;
+        return;
+    }
+
+    uint64_t value;
+    for (uint8_t index = 0; index < n_channels; index++)
+    {
+        CosimChannel& channel = channels[index];
+        if (channel.p_signal->direction != COSIM_FROM_PLANT)
+        {
+            continue;
+        }
+        uint32_t sequence;
+        uint64_t raw = cosim_read (*channel.p_signal, &sequence);
+        if (sequence != channel.last_sequence)
+        {
+            channel.last_sequence = sequence;
+            share_type_narrow (channel.p_signal->type, raw, &value);
+            channel.p_share->put_value (&value);
+            sensor_updates++;
+        }
+    }
+}
+
+
+/** @brief   Task function which steps the plant at a steady rate.
+ *  @param   p_bridge Pointer to the @c CosimBridge object
+ */
+void CosimBridge::bridge_task (void* p_bridge)
+{
+    CosimBridge* p_this = (CosimBridge*)p_bridge;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        p_this->step ();
+        vTaskDelayUntil (&wake_time, p_this->step_ticks);
+    }
+}
+
+
+/** @brief   Start a task which steps the plant at a steady rate.
+ *  @details The task's priority should be above those of the control tasks
+ *           which read the sensors, so that each step's sensor values are
+ *           in place before those tasks run in the same tick.
+ *  @param   step_ms The virtual time of each step in milliseconds
+ *  @param   priority The priority of the bridge's task
+ *  @param   stack_size The size of the task's stack
+ *  @returns @c true if the task was created, @c false if not
+ */
+bool CosimBridge::begin (uint16_t step_ms, UBaseType_t priority,
+                         uint32_t stack_size)
+{
+    if (!create_region ())
+    {
+        return false;
+    }
+    step_ticks = pdMS_TO_TICKS (step_ms > 0 ? step_ms : 1);
+    p_region->step_us = step_ticks * 1000000UL / configTICK_RATE_HZ;
+    return xTaskCreate (bridge_task, name, stack_size, this, priority, NULL)
+           == pdPASS;
+}
+
+
+/** @brief   Tell the plant that the simulation is over.
+ *  @details The region's name is removed, though the plant keeps its
+ *           mapping until it exits.
+ */
+void CosimBridge::close (void)
+{
+    if (p_region != NULL)
+    {
+        p_region->closed.store (1);
+        shm_unlink (p_region_name);
+    }
+}
+
+
+/** @brief   Print the bridge's status within a list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void CosimBridge::print_in_list (Print& printer)
+{
+    printer.printf ("%-16scosim\t", name);
+    printer << n_channels << " ch., " << (unsigned long)steps << " steps, "
+            << missed << " missed, " << (unsigned long)sensor_updates
+            << " sensor values, plant "
+            << (plant_present ? "present" : "absent") << endl;
+}
@@ -0,0 +1,158 @@
+//*****************************************************************************
+/** @file    cosim.h
+ *  @brief   A bridge which connects shares and queues in a simulated program
+ *           to a plant model running in another process on the same PC.
+ *  @details The control tasks of a program run unchanged in the host
+ *           simulation, and a model of the machine they control, the plant,
+ *           runs as an ordinary program with @c CosimPlant. A
+ *           @c CosimBridge connects them through POSIX shared memory, whose
+ *           layout is in @c cosim_region.h. Each share or queue connected to
+ *           the plant is either an actuator, whose values the plant reads,
+ *           or a sensor, into which the bridge puts the values the plant
+ *           writes.
+ *
+ *           The bridge's task runs once per step of virtual time. It asks
+ *           the plant to do a step and waits, by spinning, until the plant
+ *           has done it; virtual time stands still meanwhile, so the plant
+ *           may take as long as it needs and the run is the same every
+ *           time. Then the new sensor values are put into their shares and
+ *           queues and the program's tasks go on. Actuator values are
+ *           written into shared memory as they're put in, by listeners, so
+ *           the control tasks aren't changed at all.
+ *
+ *           This file is part of the host simulation only.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_COSIM_H_
+#define _SIM_COSIM_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#include "baseshare.h"
+#include "cosim_region.h"
+
+
+/// How long the first step waits for the plant to start, in milliseconds
+#define COSIM_FIRST_WAIT_MS     30000
+
+
+class CosimBridge;
+
+
+/** @brief   Listener which copies values put into an actuator share into
+ *           its slot in shared memory.
+ *  @details Objects of this class are made by @c CosimBridge; programs
+ *           needn't use them directly.
+ */
+class CosimChannel : public ShareListener
+{
+    friend class CosimBridge;
+
+protected:
+    CosimBridge* p_bridge;                ///< The bridge which owns this
+    BaseShare* p_share;                   ///< The connected share or queue
+    CosimSignal* p_signal;                ///< The share's slot
+    uint32_t last_sequence;               ///< Sequence of last sensor value
+
+public:
+    // Write a value put into an actuator share into its slot
+    void on_put (BaseShare* p_from, const void* p_value);
+};
+
+
+/** @brief   Class which steps a plant model in another process in lock step
+ *           with the simulation, trading share values through shared memory.
+ *
+ *           @section usage_cosim Usage
+ *           @code
+ *           #include "cosim.h"
+ *           ...
+ *           Share<float> duty ("Motor Duty");
+ *           Share<float> speed ("Motor Speed");
+ *           CosimBridge plant_bridge;
+ *           ...
+ *           // In setup()
+ *           plant_bridge.add_actuator (duty);
+ *           plant_bridge.add_sensor (speed);
+ *           plant_bridge.begin (1);                    // Step every 1 ms
+ *           @endcode
+ *           Then the plant program is started, in either order.
+ */
+class CosimBridge : public BaseShare
+{
+    friend class CosimChannel;
+
+protected:
+    const char* p_region_name;            ///< Name of the shared memory
+    CosimRegion* p_region;                ///< The mapped region
+    CosimChannel channels[COSIM_MAX_SIGNALS];  ///< One per connected share
+    uint8_t n_channels;                   ///< Number of connected shares
+    uint32_t wait_ms;                     ///< Longest wait for the plant
+    bool plant_present;                   ///< The plant has answered
+    uint64_t steps;                       ///< Steps requested
+    uint32_t missed;                      ///< Steps the plant didn't answer
+    uint64_t sensor_updates;              ///< Sensor values put in
+    TickType_t step_ticks;                ///< Ticks per step
+
+    // Make the shared memory region, if it hasn't been made yet
+    bool create_region (void);
+
+    // Connect a share in either direction
+    bool add (BaseShare& share, CosimDirection direction);
+
+    // Wait for the plant to do a step, returning false if it doesn't
+    bool wait_for_plant (uint64_t step);
+
+    // The task function which runs the steps
+    static void bridge_task (void* p_bridge);
+
+public:
+    // Create a bridge which will use the given shared memory region
+    CosimBridge (const char* p_shm_name = COSIM_DEFAULT_NAME,
+                 const char* p_name = "Cosim");
+
+    // Connect a share or queue whose values go to the plant
+    bool add_actuator (BaseShare& share);
+
+    // Connect a share or queue whose values come from the plant
+    bool add_sensor (BaseShare& share);
+
+    // Do one step of the plant and put its sensor values into shares
+    void step (void);
+
+    // Start a task which steps the plant at a steady rate
+    bool begin (uint16_t step_ms = 1,
+                UBaseType_t priority = configMAX_PRIORITIES - 2,
+                uint32_t stack_size = 4096);
+
+    // Tell the plant that the simulation is over
+    void close (void);
+
+    /** @brief   Return the number of steps the plant didn't answer in time.
+     *  @returns The number of missed steps
+     */
+    uint32_t get_missed (void)
+    {
+        return missed;
+    }
+
+    /** @brief   Return the number of steps done so far.
+     *  @returns The number of steps requested from the plant
+     */
+    uint64_t get_steps (void)
+    {
+        return steps;
+    }
+
+    // Print the bridge's status within a list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _SIM_COSIM_H_
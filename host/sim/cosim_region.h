@@ -0,0 +1,367 @@
+//*****************************************************************************
+/** @file    cosim_region.h
+ *  @brief   The layout of the shared memory through which a simulated
+ *           program and a plant model in another process trade share values,
+ *           and the class which the plant process uses to reach it.
+ *  @details A @c CosimBridge in the simulated program creates a POSIX
+ *           shared memory region holding one slot for each share or queue
+ *           which it connects to the plant. Slots for actuators, such as a
+ *           motor's duty cycle, are written by the program and read by the
+ *           plant; slots for sensors, such as a motor's speed, go the other
+ *           way. Each slot has a sequence counter which is odd while the
+ *           slot is being written, so a reader in either process can get a
+ *           whole value without locks and can tell whether a new value has
+ *           been written since it last looked.
+ *
+ *           The two sides move in step. Once per step the bridge writes the
+ *           virtual time and a step number; the plant reads the actuators,
+ *           advances its model by one step, writes the sensors and echoes
+ *           the step number back; then the bridge puts the sensor values
+ *           into their shares and lets the simulated program go on. Both
+ *           sides wait by spinning, as a handshake through memory is far
+ *           quicker than a trip through the operating system.
+ *
+ *           This file doesn't depend on Arduino or FreeRTOS, so a plant
+ *           model can be any ordinary host program, compiled with
+ *           @c -Isrc @c -Ihost/sim.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_COSIM_REGION_H_
+#define _SIM_COSIM_REGION_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "sharetype.h"
+
+
+/// The name of the shared memory region used if no other is given
+#define COSIM_DEFAULT_NAME      "/me507_cosim"
+
+/// Marks a region which has been set up completely
+#define COSIM_MAGIC             0x4D453537UL
+
+/// The most shares and queues which can be connected to a plant
+#define COSIM_MAX_SIGNALS       32
+
+/// The longest name of a connected share, including its terminating null
+#define COSIM_NAME_LENGTH       24
+
+
+/// The directions in which values may go through the region
+enum CosimDirection : uint8_t
+{
+    COSIM_TO_PLANT = 1,                   ///< An actuator, read by the plant
+    COSIM_FROM_PLANT = 2                  ///< A sensor, written by the plant
+};
+
+
+/// One share's slot in the shared memory region
+struct CosimSignal
+{
+    char name[COSIM_NAME_LENGTH];         ///< The share's name
+    uint8_t type;                         ///< A @c ShareValueType code
+    uint8_t direction;                    ///< A @c CosimDirection
+    std::atomic<uint32_t> sequence;       ///< Odd while being written
+    std::atomic<uint64_t> value;          ///< The value, widened
+};
+
+
+/// The whole shared memory region
+struct CosimRegion
+{
+    std::atomic<uint32_t> magic;          ///< @c COSIM_MAGIC when ready
+    uint32_t n_signals;                   ///< Slots in use
+    uint32_t step_us;                     ///< Virtual microseconds per step
+    std::atomic<uint32_t> plant_pid;      ///< Plant's process ID, or 0
+    std::atomic<uint32_t> closed;         ///< Nonzero once the bridge quits
+    std::atomic<uint64_t> step_request;   ///< Step which the plant should do
+    std::atomic<uint64_t> step_done;      ///< Last step which it has done
+    std::atomic<uint64_t> time_us;        ///< Virtual time of the request
+    CosimSignal signals[COSIM_MAX_SIGNALS];  ///< The slots
+};
+
+
+/** @brief   Write a value into a slot.
+ *  @details Only one process may write each slot.
+ *  @param   signal The slot
+ *  @param   raw The value, widened as by @c share_type_widen()
+ */
+inline void cosim_write (CosimSignal& signal, uint64_t raw)
+{
+    uint32_t sequence = signal.sequence.load (std::memory_order_relaxed);
+    signal.sequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    signal.value.store (raw, std::memory_order_relaxed);
+    signal.sequence.store (sequence + 2, std::memory_order_release);
+}
+
+
+/** @brief   Read a value from a slot, trying again if it's being written.
+ *  @param   signal The slot
+ *  @param   p_sequence Pointer to a variable in which to put the sequence
+ *           number of the value read, or @c NULL
+ *  @returns The value, widened
+ */
+inline uint64_t cosim_read (CosimSignal& signal, uint32_t* p_sequence = NULL)
+{
+    for (;;)
+    {
+        uint32_t before = signal.sequence.load (std::memory_order_acquire);
+        uint64_t raw = signal.value.load (std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_acquire);
+        uint32_t after = signal.sequence.load (std::memory_order_relaxed);
+        if (before == after && (before & 1) == 0)
+        {
+            if (p_sequence != NULL)
+            {
+                *p_sequence = before;
+            }
+            return raw;
+        }
+    }
+}
+
+
+/** @brief   Convert a widened value of any share type to a @c double.
+ *  @param   type The value's @c ShareValueType
+ *  @param   raw The value, widened
+ *  @returns The value as a @c double
+ */
+inline double cosim_to_double (uint8_t type, uint64_t raw)
+{
+    union
+    {
+        uint8_t bytes[8];
+        float f;
+        double d;
+    } value;
+    memset (value.bytes, 0, sizeof (value.bytes));
+    share_type_narrow (type, raw, value.bytes);
+    if (type == SHARE_FLOAT)
+    {
+        return value.f;
+    }
+    if (type == SHARE_DOUBLE)
+    {
+        return value.d;
+    }
+    return share_type_is_signed (type) ? (double)(int64_t)raw : (double)raw;
+}
+
+
+/** @brief   Convert a @c double to a widened value of a share type.
+ *  @details Integers are rounded to the nearest whole number.
+ *  @param   type The @c ShareValueType wanted
+ *  @param   number The number to be converted
+ *  @returns The value, widened
+ */
+inline uint64_t cosim_from_double (uint8_t type, double number)
+{
+    if (type == SHARE_FLOAT)
+    {
+        float single = (float)number;
+        return share_type_widen (type, &single);
+    }
+    if (type == SHARE_DOUBLE)
+    {
+        return share_type_widen (type, &number);
+    }
+    if (type == SHARE_BOOL)
+    {
+        return number != 0.0;
+    }
+    double rounded = (number < 0.0) ? number - 0.5 : number + 0.5;
+    return share_type_is_signed (type) ? (uint64_t)(int64_t)rounded
+                                       : (uint64_t)rounded;
+}
+
+
+/** @brief   Class with which a plant model in its own process reads
+ *           actuators and writes sensors in lock step with the simulation.
+ *
+ *           @section usage_cosim_plant Usage
+ *           @code
+ *           CosimPlant plant;
+ *           plant.open ();
+ *           int duty = plant.find ("Motor Duty");
+ *           int speed = plant.find ("Motor Speed");
+ *           uint64_t time_us;
+ *           while (plant.wait_step (time_us))
+ *           {
+ *               ... advance the model by plant.get_step_us () using
+ *                   plant.get (duty) ...
+ *               plant.set (speed, model_speed);
+ *               plant.finish_step ();
+ *           }
+ *           @endcode
+ */
+class CosimPlant
+{
+protected:
+    CosimRegion* p_region;                ///< The mapped region
+    uint64_t step;                        ///< Step being worked on
+
+public:
+    /// Create a plant which isn't connected yet
+    CosimPlant (void) : p_region (NULL), step (0)
+    {
+    }
+
+    /** @brief   Connect to a simulation's shared memory region.
+     *  @details The simulation may be started before or after the plant;
+     *           this method waits for it to set up the region.
+     *  @param   p_name The region's name, as given to the bridge
+     *  @param   wait_ms The longest time to wait for the region
+     *  @returns @c true if connected, @c false if the region never appeared
+     */
+    bool open (const char* p_name = COSIM_DEFAULT_NAME,
+               uint32_t wait_ms = 30000)
+    {
+        auto start = std::chrono::steady_clock::now ();
+        for (;;)
+        {
+            int fd = shm_open (p_name, O_RDWR, 0);
+            if (fd >= 0)
+            {
+                void* p_map = mmap (NULL, sizeof (CosimRegion),
+                                    PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                                    0);
+                ::close (fd);
+                CosimRegion* p_found = (CosimRegion*)p_map;
+                if (p_map != MAP_FAILED
+                    && p_found->magic.load () == COSIM_MAGIC
+                    && p_found->closed.load () == 0)
+                {
+                    p_region = p_found;
+                    step = p_region->step_done.load ();
+                    p_region->plant_pid.store ((uint32_t)getpid ());
+                    return true;
+                }
+                if (p_map != MAP_FAILED)
+                {
+                    munmap (p_map, sizeof (CosimRegion));
+                }
+            }
+            if (std::chrono::steady_clock::now () - start
+                > std::chrono::milliseconds (wait_ms))
+            {
+                return false;
+            }
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+    }
+
+    /** @brief   Find the slot of a share by its name.
+     *  @param   p_name The share's name
+     *  @returns The slot's index, or -1 if no share has that name
+     */
+    int find (const char* p_name)
+    {
+        for (uint32_t index = 0; index < p_region->n_signals; index++)
+        {
+            if (strncmp (p_region->signals[index].name, p_name,
+                         COSIM_NAME_LENGTH) == 0)
+            {
+                return (int)index;
+            }
+        }
+        return -1;
+    }
+
+    /** @brief   Wait until the simulation asks for the next step.
+     *  @param   time_us A variable in which to put the virtual time at the
+     *           start of the step
+     *  @param   timeout_ms The longest time to wait before giving up
+     *  @returns @c true if a step is to be done, @c false if the simulation
+     *           has ended or stopped answering
+     */
+    bool wait_step (uint64_t& time_us, uint32_t timeout_ms = 5000)
+    {
+        auto start = std::chrono::steady_clock::now ();
+        for (uint32_t spins = 0; ; spins++)
+        {
+            uint64_t requested = p_region->step_request.load (
+                                     std::memory_order_acquire);
+            if (requested > step)
+            {
+                step = requested;
+                time_us = p_region->time_us.load (std::memory_order_relaxed);
+                return true;
+            }
+            if (p_region->closed.load (std::memory_order_relaxed))
+            {
+                return false;
+            }
+            if (spins > 1000)
+            {
+                std::this_thread::yield ();
+                if ((spins & 0x3FF) == 0
+                    && std::chrono::steady_clock::now () - start
+                       > std::chrono::milliseconds (timeout_ms))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    /// Tell the simulation that this step is done
+    void finish_step (void)
+    {
+        p_region->step_done.store (step, std::memory_order_release);
+    }
+
+    /// Return the value in a slot as a @c double, or 0 if there's no slot
+    double get (int index)
+    {
+        if (index < 0)
+        {
+            return 0.0;
+        }
+        CosimSignal& signal = p_region->signals[index];
+        return cosim_to_double (signal.type, cosim_read (signal));
+    }
+
+    /// Write a value into a sensor's slot, converted to the sensor's type
+    void set (int index, double number)
+    {
+        if (index >= 0)
+        {
+            CosimSignal& signal = p_region->signals[index];
+            cosim_write (signal, cosim_from_double (signal.type, number));
+        }
+    }
+
+    /// Return the virtual time per step in microseconds
+    uint32_t get_step_us (void)
+    {
+        return p_region->step_us;
+    }
+
+    /// Return the number of slots in the region
+    uint32_t get_signals (void)
+    {
+        return p_region->n_signals;
+    }
+
+    /// Return the region itself, for programs which need more
+    CosimRegion* get_region (void)
+    {
+        return p_region;
+    }
+};
+
+#endif // _SIM_COSIM_REGION_H_
@@ -0,0 +1,2 @@
+// Stand-in for the FreeRTOS header of the same name; see ../FreeRTOS.h
+#include "../FreeRTOS.h"
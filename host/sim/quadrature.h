@@ -0,0 +1,223 @@
+//*****************************************************************************
+/** @file    quadrature.h
+ *  @brief   A generator of quadrature encoder signals which drives the inputs
+ *           of a simulated STM32 timer.
+ *  @details A @c QuadratureGenerator plays the part of an encoder on a
+ *           shaft turning at a given speed in edges per second; there are
+ *           four edges per encoder line. The speed may be changed at any
+ *           time, including through zero, which reverses the direction.
+ *           Noise may be added in two forms: jitter, which moves each edge
+ *           by a random amount, and glitches, short pulses on the channel
+ *           which isn't changing, as are picked up from a motor's PWM. The
+ *           generator keeps the shaft's true position so that the count
+ *           read from the timer can be checked against it.
+ *
+ *           The random numbers come from a fixed seed, so a run gives the
+ *           same signals every time.
+ *
+ *           @section usage_quadrature Usage
+ *           @code
+ *           #include "quadrature.h"
+ *           ...
+ *           STM32Encoder encoder (TIM3, PB4, PB5);
+ *           QuadratureGenerator shaft (TIM3);
+ *           shaft.set_speed (-20000.0);             // Edges per second
+ *           shaft.set_noise (0.01, 200, 100);       // Glitches and jitter
+ *           shaft.run_until (5000000);              // Run for 5 ms
+ *           int16_t count = encoder.getCount ();
+ *           @endcode
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _SIM_QUADRATURE_H_
+#define _SIM_QUADRATURE_H_
+
+#include <stdint.h>
+#include <math.h>
+#include "HardwareTimer.h"
+
+
+/** @brief   Class which makes quadrature signals for a simulated timer.
+ */
+class QuadratureGenerator
+{
+protected:
+    TIM_TypeDef* p_timer;                 ///< The timer being driven
+    uint64_t now_ns;                      ///< Time up to which signals exist
+    uint64_t last_edge_ns;                ///< Time of the last real edge
+    double speed;                         ///< Edges per second, signed
+    double progress;                      ///< Fraction of the way to an edge
+    int64_t position;                     ///< True position in edges
+    uint8_t phase;                        ///< Which of four states, 0 - 3
+    double glitch_rate;                   ///< Chance of a glitch per edge
+    uint32_t glitch_ns;                   ///< Width of each glitch
+    uint32_t jitter_ns;                   ///< Most by which edges move
+    uint32_t random_state;                ///< State of the random numbers
+    uint32_t edges;                       ///< Real edges made
+    uint32_t glitches;                    ///< Glitches made
+
+    /// Return a pseudorandom number from 0 up to but not including 1
+    double random_fraction (void)
+    {
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        return (random_state >> 8) * (1.0 / 16777216.0);
+    }
+
+    /** @brief   Make one edge, moving the shaft one step forward or back.
+     *  @details Going forward, the states are (A, B) = 00, 10, 11, 01,
+     *           which the timer counts up. A glitch, if there is one, is put
+     *           on the other channel between this edge and the next.
+     *  @param   time_ns The time of the edge
+     *  @param   forward Whether the shaft moves forward
+     *  @param   period_ns The time until the next edge, which limits when
+     *           a glitch may happen
+     */
+    void make_edge (uint64_t time_ns, bool forward, double period_ns)
+    {
+        // Channel A (1) changes leaving even states forward and odd ones
+        // backward; channel B (2) changes otherwise
+        uint8_t channel = ((phase & 1) == (forward ? 0 : 1)) ? 1 : 2;
+        phase = (phase + (forward ? 1 : 3)) & 3;
+        position += forward ? 1 : -1;
+        edges++;
+
+        // Jitter moves an edge, but not to before the one before it
+        if (jitter_ns > 0)
+        {
+            time_ns += (uint64_t)(random_fraction () * jitter_ns);
+        }
+        time_ns = (time_ns > last_edge_ns) ? time_ns : last_edge_ns;
+        sim_timer_edge (p_timer, channel, time_ns);
+        last_edge_ns = time_ns;
+
+        if (glitch_rate > 0.0 && random_fraction () < glitch_rate
+            && period_ns > 2.0 * (glitch_ns + jitter_ns))
+        {
+            uint8_t other = (channel == 1) ? 2 : 1;
+            uint64_t start = time_ns + 1 + (uint64_t)(random_fraction ()
+                             * (period_ns - 2.0 * (glitch_ns + jitter_ns)));
+            sim_timer_edge (p_timer, other, start);
+            sim_timer_edge (p_timer, other, start + glitch_ns);
+            last_edge_ns = start + glitch_ns;
+            glitches++;
+        }
+    }
+
+public:
+    /** @brief   Create a generator which drives a timer's channel 1 and 2
+     *           inputs.
+     *  @details The timer's inputs start out low, as does the generator.
+     *  @param   timer The timer, such as @c TIM3
+     */
+    QuadratureGenerator (TIM_TypeDef* timer)
+        : p_timer (timer), now_ns (0), last_edge_ns (0), speed (0.0),
+          progress (0.0), position (0), phase (0), glitch_rate (0.0),
+          glitch_ns (0), jitter_ns (0), random_state (507), edges (0),
+          glitches (0)
+    {
+    }
+
+    /** @brief   Set the shaft's speed.
+     *  @param   edges_per_second The speed in edges per second; negative
+     *           speeds turn the shaft backward
+     */
+    void set_speed (double edges_per_second)
+    {
+        speed = edges_per_second;
+    }
+
+    /** @brief   Set how noisy the signals are.
+     *  @param   glitches_per_edge The chance, from 0 to 1, of a glitch after
+     *           each real edge
+     *  @param   width_ns The width of each glitch in nanoseconds
+     *  @param   jitter The most by which an edge is moved, in nanoseconds
+     */
+    void set_noise (double glitches_per_edge, uint32_t width_ns,
+                    uint32_t jitter = 0)
+    {
+        glitch_rate = glitches_per_edge;
+        glitch_ns = width_ns;
+        jitter_ns = jitter;
+    }
+
+    /** @brief   Make all the edges up to a given time.
+     *  @details The timer is brought up to date at the end, so its count
+     *           may be read at once.
+     *  @param   time_ns The time, in nanoseconds since the generator
+     *           started, up to which to run
+     */
+    void run_until (uint64_t time_ns)
+    {
+        if (time_ns <= now_ns)
+        {
+            return;
+        }
+        double rate = fabs (speed);
+        if (rate > 0.0)
+        {
+            // The edges which fall in this interval, at even spacing
+            double period_ns = 1.0e9 / rate;
+            double start_ns = (double)now_ns - progress * period_ns;
+            double span = progress + (time_ns - now_ns) / period_ns;
+            uint64_t count = (uint64_t)span;
+            for (uint64_t step = 1; step <= count; step++)
+            {
+                make_edge ((uint64_t)(start_ns + step * period_ns),
+                           speed > 0.0, period_ns);
+            }
+            progress = span - count;
+        }
+        now_ns = time_ns;
+        sim_timer_settle (p_timer, now_ns > last_edge_ns ? now_ns
+                                                          : last_edge_ns);
+    }
+
+    /** @brief   Make a given number of edges at the current speed.
+     *  @details This is handy for benchmarks, which need a known number of
+     *           edges. Nothing happens if the speed is zero.
+     *  @param   count The number of edges to make
+     */
+    void run_edges (uint32_t count)
+    {
+        double rate = fabs (speed);
+        if (rate > 0.0)
+        {
+            run_until (now_ns + (uint64_t)ceil ((count - progress) * 1.0e9
+                                                 / rate));
+        }
+    }
+
+    /// Return the shaft's true position in edges
+    int64_t get_position (void)
+    {
+        return position;
+    }
+
+    /// Return the time up to which signals have been made, in nanoseconds
+    uint64_t get_time_ns (void)
+    {
+        return now_ns;
+    }
+
+    /// Return the number of real edges made
+    uint32_t get_edges (void)
+    {
+        return edges;
+    }
+
+    /// Return the number of glitches made
+    uint32_t get_glitches (void)
+    {
+        return glitches;
+    }
+};
+
+#endif // _SIM_QUADRATURE_H_
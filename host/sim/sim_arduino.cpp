@@ -0,0 +1,567 @@
+//*****************************************************************************
+/** @file    sim_arduino.cpp
+ *  @brief   Host implementations of the Arduino core functions and the
+ *           PrintStream operators used by ME507 programs.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <poll.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "PrintStream.h"
+
+
+/// The one serial port, connected to standard input and output
+HardwareSerial Serial;
+
+/// The levels of simulated digital pins
+static int pin_levels[NUM_DIGITAL_PINS];
+
+/// State of the repeatable random number generator
+static uint32_t random_state = 1;
+
+/// Number base used by the PrintStream operators
+static uint8_t stream_base = 10;
+
+/// Digits after the decimal point used by the PrintStream operators
+static int stream_precision = 2;
+
+/// Whether the PrintStream operators print @c bool as words
+static bool stream_boolalpha = false;
+
+
+//-----------------------------------------------------------------------------
+// String
+
+static std::string number_text (unsigned long long number, bool negative,
+                                unsigned char base)
+{
+    char digits[72];
+    char* p_digit = &digits[sizeof (digits) - 1];
+    *p_digit = '\0';
+    if (base < 2)
+    {
+        base = 10;
+    }
+    do
+    {
+        unsigned digit = number % base;
+        *--p_digit = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        number /= base;
+    }
+    while (number != 0);
+    if (negative)
+    {
+        *--p_digit = '-';
+    }
+    return std::string (p_digit);
+}
+
+String::String (int number, unsigned char base)
+    : String ((long)number, base) { }
+
+String::String (unsigned int number, unsigned char base)
+    : String ((unsigned long)number, base) { }
+
+String::String (long number, unsigned char base)
+{
+    bool negative = (number < 0 && base == 10);
+    unsigned long long magnitude = negative ? 0ULL - (unsigned long long)number
+                                            : (unsigned long)number;
+    text = number_text (magnitude, negative, base);
+}
+
+String::String (unsigned long number, unsigned char base)
+{
+    text = number_text (number, false, base);
+}
+
+String::String (double number, unsigned int places)
+{
+    char buffer[64];
+    snprintf (buffer, sizeof (buffer), "%.*f", (int)places, number);
+    text = buffer;
+}
+
+
+//-----------------------------------------------------------------------------
+// Print
+
+size_t Print::write (const uint8_t* p_buffer, size_t size)
+{
+    size_t count = 0;
+    while (size--)
+    {
+        count += write (*p_buffer++);
+    }
+    return count;
+}
+
+size_t Print::printf (const char* p_format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start (args, p_format);
+    int length = vsnprintf (buffer, sizeof (buffer), p_format, args);
+    va_end (args);
+    if (length < 0)
+    {
+        return 0;
+    }
+    if ((size_t)length >= sizeof (buffer))
+    {
+        length = sizeof (buffer) - 1;
+    }
+    return write ((const uint8_t*)buffer, length);
+}
+
+size_t Print::print_number (unsigned long long number, uint8_t base)
+{
+    std::string text = number_text (number, false, base);
+    return write (text.c_str ());
+}
+
+size_t Print::print (const __FlashStringHelper* p_string)
+{
+    return write ((const char*)p_string);
+}
+
+size_t Print::print (const String& a_string)
+{
+    return write (a_string.c_str ());
+}
+
+size_t Print::print (const char p_string[])
+{
+    return write (p_string);
+}
+
+size_t Print::print (char a_char)
+{
+    return write ((uint8_t)a_char);
+}
+
+size_t Print::print (unsigned char number, int base)
+{
+    return print ((unsigned long long)number, base);
+}
+
+size_t Print::print (int number, int base)
+{
+    return print ((long long)number, base);
+}
+
+size_t Print::print (unsigned int number, int base)
+{
+    return print ((unsigned long long)number, base);
+}
+
+size_t Print::print (long number, int base)
+{
+    return print ((long long)number, base);
+}
+
+size_t Print::print (unsigned long number, int base)
+{
+    return print ((unsigned long long)number, base);
+}
+
+size_t Print::print (long long number, int base)
+{
+    if (base == 0)
+    {
+        return write ((uint8_t)number);
+    }
+    if (number < 0 && base == 10)
+    {
+        size_t count = print ('-');
+        return count + print_number (0ULL - (unsigned long long)number, 10);
+    }
+    return print_number ((unsigned long long)number, base);
+}
+
+size_t Print::print (unsigned long long number, int base)
+{
+    if (base == 0)
+    {
+        return write ((uint8_t)number);
+    }
+    return print_number (number, base);
+}
+
+size_t Print::print (double number, int digits)
+{
+    if (isnan (number))
+    {
+        return print ("nan");
+    }
+    if (isinf (number))
+    {
+        return print ("inf");
+    }
+    char buffer[64];
+    snprintf (buffer, sizeof (buffer), "%.*f", digits, number);
+    return write (buffer);
+}
+
+size_t Print::print (const Printable& thing)
+{
+    return thing.printTo (*this);
+}
+
+size_t Print::println (void)
+{
+    return write ("\r\n");
+}
+
+
+//-----------------------------------------------------------------------------
+// Stream and the serial port
+
+size_t Stream::readBytes (char* p_buffer, size_t length)
+{
+    size_t count = 0;
+    while (count < length && available ())
+    {
+        p_buffer[count++] = (char)read ();
+    }
+    return count;
+}
+
+size_t HardwareSerial::write (uint8_t a_char)
+{
+    fputc (a_char, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write (const uint8_t* p_buffer, size_t size)
+{
+    return fwrite (p_buffer, 1, size, stdout);
+}
+
+int HardwareSerial::available (void)
+{
+    if (peeked >= 0)
+    {
+        return 1;
+    }
+    struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+    return (poll (&input, 1, 0) > 0 && (input.revents & POLLIN)) ? 1 : 0;
+}
+
+int HardwareSerial::read (void)
+{
+    if (peeked >= 0)
+    {
+        int a_char = peeked;
+        peeked = -1;
+        return a_char;
+    }
+    if (!available ())
+    {
+        return -1;
+    }
+    unsigned char a_char;
+    return (::read (STDIN_FILENO, &a_char, 1) == 1) ? a_char : -1;
+}
+
+int HardwareSerial::peek (void)
+{
+    if (peeked < 0)
+    {
+        peeked = read ();
+    }
+    return peeked;
+}
+
+void HardwareSerial::flush (void)
+{
+    fflush (stdout);
+}
+
+
+//-----------------------------------------------------------------------------
+// Timing, pins and random numbers
+
+unsigned long millis (void)
+{
+    return (unsigned long)(sim_time_us () / 1000);
+}
+
+/// The one stand-in ESP object
+EspClass ESP;
+
+
+unsigned long micros (void)
+{
+    return (unsigned long)sim_time_us ();
+}
+
+void delay (uint32_t milliseconds)
+{
+    if (sim_is_running () && xTaskGetCurrentTaskHandle () != NULL)
+    {
+        vTaskDelay (milliseconds);
+    }
+    else
+    {
+        sim_advance_busy (milliseconds * 1000UL);
+    }
+}
+
+void delayMicroseconds (uint32_t microseconds)
+{
+    sim_advance_busy (microseconds);
+}
+
+void yield (void)
+{
+    vTaskYield ();
+}
+
+void pinMode (uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite (uint8_t pin, uint8_t value)
+{
+    pin_levels[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead (uint8_t pin)
+{
+    return pin_levels[pin];
+}
+
+int analogRead (uint8_t pin)
+{
+    return pin_levels[pin];
+}
+
+void sim_set_pin (uint8_t pin, int value)
+{
+    pin_levels[pin] = value;
+}
+
+void randomSeed (unsigned long seed)
+{
+    random_state = (seed != 0) ? (uint32_t)seed : 1;
+}
+
+long random (long how_big)
+{
+    if (how_big <= 0)
+    {
+        return 0;
+    }
+    // A xorshift generator gives the same sequence on every host
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return (long)(random_state % (uint32_t)how_big);
+}
+
+long random (long how_small, long how_big)
+{
+    if (how_small >= how_big)
+    {
+        return how_small;
+    }
+    return random (how_big - how_small) + how_small;
+}
+
+
+//-----------------------------------------------------------------------------
+// PrintStream
+
+Print& endl (Print& printer)
+{
+    printer.println ();
+    printer.flush ();
+    return printer;
+}
+
+Print& flush (Print& printer)
+{
+    printer.flush ();
+    return printer;
+}
+
+Print& hex (Print& printer)
+{
+    stream_base = 16;
+    return printer;
+}
+
+Print& bin (Print& printer)
+{
+    stream_base = 2;
+    return printer;
+}
+
+Print& dec (Print& printer)
+{
+    stream_base = 10;
+    return printer;
+}
+
+Print& boolalpha (Print& printer)
+{
+    stream_boolalpha = true;
+    return printer;
+}
+
+Print& noboolalpha (Print& printer)
+{
+    stream_boolalpha = false;
+    return printer;
+}
+
+_Setbase setbase (uint8_t base)
+{
+    return _Setbase { base };
+}
+
+_Setprecision setprecision (int n)
+{
+    return _Setprecision { n };
+}
+
+_Setbytesep setbytesep (char bytesep)
+{
+    return _Setbytesep { bytesep };
+}
+
+Print& operator<< (Print& printer, const __FlashStringHelper* s)
+{
+    printer.print (s);
+    return printer;
+}
+
+Print& operator<< (Print& printer, const String& s)
+{
+    printer.print (s);
+    return printer;
+}
+
+Print& operator<< (Print& printer, const char s[])
+{
+    printer.print (s);
+    return printer;
+}
+
+Print& operator<< (Print& printer, char c)
+{
+    printer.print (c);
+    return printer;
+}
+
+Print& operator<< (Print& printer, unsigned char c)
+{
+    printer.print ((unsigned long long)c, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, int i)
+{
+    printer.print ((long long)i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, unsigned int i)
+{
+    printer.print ((unsigned long long)i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, int8_t i)
+{
+    printer.print ((long long)i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, long i)
+{
+    printer.print ((long long)i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, unsigned long i)
+{
+    printer.print ((unsigned long long)i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, long long i)
+{
+    printer.print (i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, unsigned long long i)
+{
+    printer.print (i, stream_base);
+    return printer;
+}
+
+Print& operator<< (Print& printer, double d)
+{
+    printer.print (d, stream_precision);
+    return printer;
+}
+
+Print& operator<< (Print& printer, float f)
+{
+    printer.print ((double)f, stream_precision);
+    return printer;
+}
+
+Print& operator<< (Print& printer, const Printable& p)
+{
+    printer.print (p);
+    return printer;
+}
+
+Print& operator<< (Print& printer, bool b)
+{
+    if (stream_boolalpha)
+    {
+        printer.print (b ? "true" : "false");
+    }
+    else
+    {
+        printer.print ((int)b);
+    }
+    return printer;
+}
+
+Print& operator<< (Print& printer, manipulator pf)
+{
+    return pf (printer);
+}
+
+Print& operator<< (Print& printer, _Setbase f)
+{
+    stream_base = f.M_base;
+    return printer;
+}
+
+Print& operator<< (Print& printer, _Setprecision f)
+{
+    stream_precision = f.M_n;
+    return printer;
+}
+
+Print& operator<< (Print& printer, _Setbytesep f)
+{
+    (void)f;
+    return printer;
+}
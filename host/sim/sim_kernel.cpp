@@ -0,0 +1,1584 @@
+//*****************************************************************************
+/** @file    sim_kernel.cpp
+ *  @brief   A deterministic, virtual-time implementation of the FreeRTOS API
+ *           subset declared in the simulation's @c FreeRTOS.h.
+ *  @details Every simulated task runs in its own host thread, but a single
+ *           kernel lock and a "current task" token make sure that only one of
+ *           them executes at any moment. Whenever a task blocks, yields or
+ *           readies a task of higher priority, the kernel hands the token to
+ *           the highest priority ready task, oldest first, just as the
+ *           FreeRTOS scheduler would on a single core. When no task is ready,
+ *           the virtual clock jumps forward to the earliest timeout or
+ *           simulated interrupt, so time costs nothing while tasks wait.
+ *
+ *           Simulated interrupts are plain functions called at a fixed
+ *           virtual period. They run on the thread of whichever task holds
+ *           the token when their time comes, with @c xPortInIsrContext()
+ *           returning @c pdTRUE, and always between two kernel calls; this
+ *           is why critical sections can be empty in the simulation.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "FreeRTOS.h"
+
+
+/// The value of a wake-up time which means "never"
+static const uint64_t NEVER = UINT64_MAX;
+
+/// What a blocked task is waiting for
+enum SimWaitKind
+{
+    WAIT_NOTHING,              ///< Not blocked
+    WAIT_DELAY,                ///< Only waiting for time to pass
+    WAIT_SEND,                 ///< Waiting for space in a queue
+    WAIT_RECEIVE,              ///< Waiting for an item in a queue
+    WAIT_EVENT,                ///< Waiting for event group bits
+    WAIT_NOTIFY,               ///< Waiting for a task notification
+    WAIT_SUSPENDED             ///< Suspended until resumed
+};
+
+/// The states of a simulated task
+enum SimTaskState
+{
+    TASK_READY,
+    TASK_RUNNING,
+    TASK_BLOCKED,
+    TASK_DELETED
+};
+
+
+/// Thrown inside a task's thread to unwind it when it's deleted or when the
+/// simulation ends
+struct SimTaskExit { };
+
+
+/// Everything the simulation kernel knows about one task
+struct SimTask
+{
+    std::string name;                  ///< Name for printouts
+    TaskFunction_t function;           ///< The task function
+    void* p_params;                    ///< Parameter for the task function
+    uint32_t stack_depth;              ///< Requested stack size (unused)
+    UBaseType_t priority;              ///< Priority, perhaps inherited
+    UBaseType_t base_priority;         ///< Priority set by the program
+    SimTaskState state;                ///< Ready, running, blocked, ...
+    std::condition_variable cv;        ///< Signaled when the task may run
+    std::thread thread;                ///< Host thread which runs the task
+    int64_t ready_order;               ///< Position among equal priorities
+    int64_t block_order;               ///< When this task began waiting
+    uint64_t wake_time;                ///< Virtual microseconds of timeout
+    void* p_waiting_on;                ///< Object being waited for
+    SimWaitKind wait_kind;             ///< What's being waited for
+    bool timed_out;                    ///< True if the wait timed out
+    EventBits_t event_bits;            ///< Event bits waited for
+    bool event_all;                    ///< Wait for all bits or any
+    bool event_clear;                  ///< Clear bits waited for on exit
+    EventBits_t event_result;          ///< Bits seen when the wait ended
+    uint32_t notify_value;             ///< Task notification value
+    bool notify_pending;               ///< A notification is waiting
+};
+
+
+/// A queue, semaphore or mutex; semaphores hold zero-size items
+struct SimQueue
+{
+    UBaseType_t length;                ///< Maximum number of items
+    UBaseType_t item_size;             ///< Bytes in each item
+    std::vector<uint8_t> storage;      ///< Ring buffer for the items
+    UBaseType_t head;                  ///< Index of the oldest item
+    UBaseType_t count;                 ///< Number of items held
+    bool is_mutex;                     ///< Whether priority is inherited
+    struct SimTask* p_holder;          ///< Task holding a mutex, if any
+};
+
+
+/// An event group is just a set of bits and whoever waits on them
+struct SimEventGroup
+{
+    EventBits_t bits;                  ///< The current event bits
+};
+
+
+/// A periodic simulated interrupt
+struct SimInterrupt
+{
+    uint64_t next_time;                ///< Virtual time of the next firing
+    uint32_t period;                   ///< Microseconds between firings
+    void (*p_isr) (void);              ///< The interrupt service routine
+};
+
+
+static std::mutex kernel_mutex;                  ///< Guards everything here
+static std::unique_lock<std::mutex>* p_held = NULL; ///< Outermost holder
+static std::atomic<std::thread::id> kernel_owner; ///< Lock holder thread
+static std::condition_variable main_cv;          ///< Wakes the main thread
+static std::vector<SimTask*> all_tasks;          ///< Every task ever made
+static std::vector<SimInterrupt> interrupts;     ///< Simulated interrupts
+static std::vector<SimQueue*> all_mutexes;       ///< Every mutex made
+static SimTask* p_current = NULL;                ///< Task holding the CPU
+static thread_local SimTask* p_self = NULL;      ///< This thread's task
+static bool scheduler_running = false;           ///< Scheduler started yet?
+static bool stopping = false;                    ///< Simulation is ending
+static int sim_exit_code = 0;                    ///< Returned by main()
+static uint64_t now_us = 0;                      ///< The virtual clock
+static uint64_t time_limit_us = NEVER;           ///< When to stop, if ever
+static int64_t order_counter = 0;                ///< Orders ready lists
+static int64_t front_counter = 0;                ///< Orders preempted tasks
+static uint32_t switch_count = 0;                ///< Context switches made
+static int isr_depth = 0;                        ///< Nonzero within an ISR
+
+
+/** @brief   A lock on the simulation kernel which may be taken again by the
+ *           thread which already holds it.
+ *  @details Kernel functions call one another, and interrupt functions run
+ *           in the middle of kernel calls, so the kernel lock must nest. Only
+ *           the outermost lock of a thread really locks the mutex; waiting
+ *           with @c kernel_wait() releases it completely, however deeply
+ *           nested the wait happens to be.
+ */
+class KernelLock
+{
+protected:
+    std::unique_lock<std::mutex> lock;  ///< Holds the mutex if outermost
+    bool outermost;                     ///< Whether this lock owns the mutex
+
+public:
+    KernelLock (void)
+    {
+        outermost = (kernel_owner != std::this_thread::get_id ());
+        if (outermost)
+        {
+            lock = std::unique_lock<std::mutex> (kernel_mutex);
+            kernel_owner = std::this_thread::get_id ();
+            p_held = &lock;
+        }
+    }
+
+    ~KernelLock (void)
+    {
+        if (outermost)
+        {
+            kernel_owner = std::thread::id ();
+            p_held = NULL;
+        }
+    }
+};
+
+
+/** @brief   Wait on a condition variable, completely releasing the kernel
+ *           lock until woken.
+ */
+static void kernel_wait (std::condition_variable& cv)
+{
+    std::unique_lock<std::mutex>* p_mine = p_held;
+    kernel_owner = std::thread::id ();
+    p_held = NULL;
+    cv.wait (*p_mine);
+    kernel_owner = std::this_thread::get_id ();
+    p_held = p_mine;
+}
+
+
+/** @brief   Check whether the calling thread should unwind because its task
+ *           was deleted or the simulation is over.
+ */
+static void check_exit (void)
+{
+    if (p_self != NULL && isr_depth == 0
+        && (stopping || p_self->state == TASK_DELETED))
+    {
+        throw SimTaskExit ();
+    }
+}
+
+
+/** @brief   Begin shutting down the simulation and wake every thread so
+ *           that it can unwind.
+ */
+static void begin_stop (void)
+{
+    stopping = true;
+    for (SimTask* p_task : all_tasks)
+    {
+        p_task->cv.notify_all ();
+    }
+    main_cv.notify_all ();
+}
+
+
+/** @brief   Put a task into the ready state behind others of its priority.
+ */
+static void make_ready (SimTask* p_task)
+{
+    p_task->state = TASK_READY;
+    p_task->ready_order = ++order_counter;
+    p_task->p_waiting_on = NULL;
+    p_task->wait_kind = WAIT_NOTHING;
+    p_task->wake_time = NEVER;
+}
+
+
+/** @brief   Run interrupts and wake tasks whose time has come.
+ */
+static void process_time (void)
+{
+    // Interrupts first, in order of their due times
+    for (;;)
+    {
+        SimInterrupt* p_due = NULL;
+        for (SimInterrupt& irq : interrupts)
+        {
+            if (irq.p_isr != NULL && irq.next_time <= now_us
+                && (p_due == NULL || irq.next_time < p_due->next_time))
+            {
+                p_due = &irq;
+            }
+        }
+        if (p_due == NULL)
+        {
+            break;
+        }
+        p_due->next_time += p_due->period;
+        void (*p_isr) (void) = p_due->p_isr;
+        isr_depth++;
+        p_isr ();
+        isr_depth--;
+    }
+
+    // Then any task whose timeout or delay has expired
+    for (SimTask* p_task : all_tasks)
+    {
+        if (p_task->state == TASK_BLOCKED && p_task->wake_time <= now_us)
+        {
+            make_ready (p_task);
+            p_task->timed_out = true;
+        }
+    }
+}
+
+
+/** @brief   Find the highest priority ready task, advancing the virtual clock
+ *           if nothing is ready.
+ *  @returns The task to run next, or @c NULL if the simulation is over
+ */
+static SimTask* pick_next (void)
+{
+    for (;;)
+    {
+        if (stopping)
+        {
+            return NULL;
+        }
+
+        SimTask* p_best = NULL;
+        for (SimTask* p_task : all_tasks)
+        {
+            if (p_task->state == TASK_READY
+                && (p_best == NULL || p_task->priority > p_best->priority
+                    || (p_task->priority == p_best->priority
+                        && p_task->ready_order < p_best->ready_order)))
+            {
+                p_best = p_task;
+            }
+        }
+        if (p_best != NULL)
+        {
+            return p_best;
+        }
+
+        // Nothing can run, so jump ahead to the next thing that will happen
+        uint64_t next = NEVER;
+        for (SimTask* p_task : all_tasks)
+        {
+            if (p_task->state == TASK_BLOCKED && p_task->wake_time < next)
+            {
+                next = p_task->wake_time;
+            }
+        }
+        for (SimInterrupt& irq : interrupts)
+        {
+            if (irq.p_isr != NULL && irq.next_time < next)
+            {
+                next = irq.next_time;
+            }
+        }
+        if (next == NEVER || next > time_limit_us)
+        {
+            if (next == NEVER && getenv ("SIM_VERBOSE") != NULL)
+            {
+                fprintf (stderr, "sim: every task is blocked forever at "
+                         "%llu us\n", (unsigned long long)now_us);
+            }
+            if (next != NEVER)
+            {
+                now_us = time_limit_us;
+            }
+            begin_stop ();
+            return NULL;
+        }
+        now_us = next;
+        process_time ();
+    }
+}
+
+
+/** @brief   Give the CPU to the best ready task and wait until the calling
+ *           task is chosen to run again.
+ *  @details The caller must already have changed its own state, to ready,
+ *           blocked or deleted, before calling this function.
+ */
+static void reschedule (void)
+{
+    SimTask* p_next = pick_next ();
+    if (p_next != p_current)
+    {
+        switch_count++;
+    }
+    p_current = p_next;
+    if (p_next != NULL)
+    {
+        p_next->state = TASK_RUNNING;
+        p_next->cv.notify_all ();
+    }
+    if (p_self == NULL)
+    {
+        return;
+    }
+    while (p_current != p_self && !stopping
+           && p_self->state != TASK_DELETED)
+    {
+        kernel_wait (p_self->cv);
+    }
+    check_exit ();
+}
+
+
+/** @brief   Let a higher priority task which has just become ready take over
+ *           the CPU from the calling task.
+ */
+static void maybe_preempt (void)
+{
+    if (isr_depth > 0 || p_self == NULL || p_current != p_self)
+    {
+        return;
+    }
+    for (SimTask* p_task : all_tasks)
+    {
+        if (p_task->state == TASK_READY
+            && p_task->priority > p_self->priority)
+        {
+            // A preempted task goes to the front of its priority's line
+            p_self->state = TASK_READY;
+            p_self->ready_order = --front_counter;
+            reschedule ();
+            return;
+        }
+    }
+}
+
+
+/** @brief   Block the calling task until it's woken or the given virtual time
+ *           has passed.
+ *  @returns @c true if woken by an event, @c false if the wait timed out or
+ *           the caller can't block (it's an ISR or not a task)
+ */
+static bool block_until (void* p_object, SimWaitKind kind,
+                         uint64_t wake_time)
+{
+    if (p_self == NULL || isr_depth > 0 || wake_time <= now_us
+        || !scheduler_running)
+    {
+        return false;
+    }
+    p_self->state = TASK_BLOCKED;
+    p_self->p_waiting_on = p_object;
+    p_self->wait_kind = kind;
+    p_self->wake_time = wake_time;
+    p_self->block_order = ++order_counter;
+    p_self->timed_out = false;
+    reschedule ();
+    return !p_self->timed_out;
+}
+
+
+/** @brief   Compute the virtual time at which a timeout in ticks expires.
+ */
+static uint64_t deadline_for (TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        return NEVER;
+    }
+    if (ticks == 0)
+    {
+        return now_us;
+    }
+    return (now_us / 1000 + ticks) * 1000;
+}
+
+
+/** @brief   Wake the highest priority task which is waiting on an object.
+ *  @returns The task which was woken, or @c NULL if none was waiting
+ */
+static SimTask* wake_one (void* p_object, SimWaitKind kind)
+{
+    SimTask* p_best = NULL;
+    for (SimTask* p_task : all_tasks)
+    {
+        if (p_task->state == TASK_BLOCKED && p_task->p_waiting_on == p_object
+            && p_task->wait_kind == kind
+            && (p_best == NULL || p_task->priority > p_best->priority
+                || (p_task->priority == p_best->priority
+                    && p_task->block_order < p_best->block_order)))
+        {
+            p_best = p_task;
+        }
+    }
+    if (p_best != NULL)
+    {
+        make_ready (p_best);
+    }
+    return p_best;
+}
+
+
+/** @brief   After waking a task, switch to it if it outranks the caller, or
+ *           tell an ISR that a switch is due.
+ */
+static void after_wake (SimTask* p_woken,
+                        BaseType_t* p_woken_flag)
+{
+    if (p_woken == NULL)
+    {
+        return;
+    }
+    if (p_woken_flag != NULL && p_current != NULL
+        && p_woken->priority > p_current->priority)
+    {
+        *p_woken_flag = pdTRUE;
+    }
+    maybe_preempt ();
+}
+
+
+/** @brief   Set a task's priority to the highest of its own and those of
+ *           the tasks waiting for mutexes which it holds.
+ *  @details This is FreeRTOS' priority inheritance, worked out afresh
+ *           whenever a task takes, gives or times out waiting for a mutex,
+ *           which also covers a task holding several mutexes at once.
+ */
+static void update_inheritance (SimTask* p_task)
+{
+    if (p_task == NULL)
+    {
+        return;
+    }
+    UBaseType_t priority = p_task->base_priority;
+    for (SimQueue* p_mutex : all_mutexes)
+    {
+        if (p_mutex->p_holder != p_task)
+        {
+            continue;
+        }
+        for (SimTask* p_waiter : all_tasks)
+        {
+            if (p_waiter->state == TASK_BLOCKED
+                && p_waiter->p_waiting_on == p_mutex
+                && p_waiter->priority > priority)
+            {
+                priority = p_waiter->priority;
+            }
+        }
+    }
+    p_task->priority = priority;
+}
+
+
+/** @brief   The function which runs in each task's host thread.
+ */
+static void task_thread (SimTask* p_task)
+{
+    p_self = p_task;
+    try
+    {
+        {
+            KernelLock lock;
+            while (p_current != p_task && !stopping
+                   && p_task->state != TASK_DELETED)
+            {
+                kernel_wait (p_task->cv);
+            }
+            check_exit ();
+        }
+        p_task->function (p_task->p_params);
+
+        // Returning from a task function isn't allowed in FreeRTOS; here we
+        // treat it as the task deleting itself
+        vTaskDelete (NULL);
+    }
+    catch (SimTaskExit&)
+    {
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// Tasks
+
+BaseType_t xTaskCreate (TaskFunction_t function, const char* name,
+                        uint32_t stack_depth, void* p_params,
+                        UBaseType_t priority, TaskHandle_t* p_handle)
+{
+    KernelLock lock;
+    check_exit ();
+
+    SimTask* p_task = new SimTask;
+    p_task->name = (name != NULL) ? name : "";
+    p_task->function = function;
+    p_task->p_params = p_params;
+    p_task->stack_depth = stack_depth;
+    p_task->priority = (priority < configMAX_PRIORITIES)
+                       ? priority : configMAX_PRIORITIES - 1;
+    p_task->base_priority = p_task->priority;
+    p_task->block_order = 0;
+    p_task->timed_out = false;
+    p_task->event_bits = 0;
+    p_task->event_all = false;
+    p_task->event_clear = false;
+    p_task->event_result = 0;
+    p_task->notify_value = 0;
+    p_task->notify_pending = false;
+    make_ready (p_task);
+    all_tasks.push_back (p_task);
+    p_task->thread = std::thread (task_thread, p_task);
+
+    if (p_handle != NULL)
+    {
+        *p_handle = p_task;
+    }
+    if (scheduler_running)
+    {
+        maybe_preempt ();
+    }
+    return pdPASS;
+}
+
+
+BaseType_t xTaskCreatePinnedToCore (TaskFunction_t function, const char* name,
+                                    uint32_t stack_depth, void* p_params,
+                                    UBaseType_t priority,
+                                    TaskHandle_t* p_handle, BaseType_t core)
+{
+    (void)core;
+    return xTaskCreate (function, name, stack_depth, p_params, priority,
+                        p_handle);
+}
+
+
+void vTaskDelete (TaskHandle_t task)
+{
+    KernelLock lock;
+    SimTask* p_task = (task == NULL) ? p_self : task;
+    if (p_task == NULL)
+    {
+        return;
+    }
+    p_task->state = TASK_DELETED;
+    if (p_task == p_self)
+    {
+        reschedule ();
+    }
+    else
+    {
+        p_task->cv.notify_all ();
+    }
+}
+
+
+void vTaskDelay (TickType_t ticks)
+{
+    KernelLock lock;
+    check_exit ();
+    if (ticks == 0)
+    {
+        vTaskYield ();
+    }
+    else
+    {
+        block_until (NULL, WAIT_DELAY, deadline_for (ticks));
+    }
+}
+
+
+BaseType_t xTaskDelayUntil (TickType_t* p_previous_wake, TickType_t increment)
+{
+    KernelLock lock;
+    check_exit ();
+    TickType_t target = *p_previous_wake + increment;
+    TickType_t now_ticks = (TickType_t)(now_us / 1000);
+    *p_previous_wake = target;
+
+    // Only wait if the target tick hasn't already gone by
+    if ((int32_t)(target - now_ticks) > 0)
+    {
+        block_until (NULL, WAIT_DELAY,
+                     now_us - now_us % 1000
+                     + (uint64_t)(target - now_ticks) * 1000);
+        return pdTRUE;
+    }
+    return pdFALSE;
+}
+
+
+void vTaskDelayUntil (TickType_t* p_previous_wake, TickType_t increment)
+{
+    xTaskDelayUntil (p_previous_wake, increment);
+}
+
+
+void vTaskYield (void)
+{
+    KernelLock lock;
+    check_exit ();
+    if (p_self != NULL && isr_depth == 0 && scheduler_running)
+    {
+        p_self->state = TASK_READY;
+        p_self->ready_order = ++order_counter;
+        reschedule ();
+    }
+}
+
+
+void vTaskSuspend (TaskHandle_t task)
+{
+    KernelLock lock;
+    SimTask* p_task = (task == NULL) ? p_self : task;
+    p_task->state = TASK_BLOCKED;
+    p_task->wait_kind = WAIT_SUSPENDED;
+    p_task->p_waiting_on = NULL;
+    p_task->wake_time = NEVER;
+    if (p_task == p_self)
+    {
+        reschedule ();
+    }
+}
+
+
+void vTaskResume (TaskHandle_t task)
+{
+    KernelLock lock;
+    if (task->state == TASK_BLOCKED && task->wait_kind == WAIT_SUSPENDED)
+    {
+        make_ready (task);
+        maybe_preempt ();
+    }
+}
+
+
+void vTaskSuspendAll (void)
+{
+}
+
+
+BaseType_t xTaskResumeAll (void)
+{
+    return pdFALSE;
+}
+
+
+UBaseType_t uxTaskPriorityGet (TaskHandle_t task)
+{
+    KernelLock lock;
+    SimTask* p_task = (task == NULL) ? p_self : task;
+    return (p_task != NULL) ? p_task->priority : 0;
+}
+
+
+void vTaskPrioritySet (TaskHandle_t task, UBaseType_t priority)
+{
+    KernelLock lock;
+    SimTask* p_task = (task == NULL) ? p_self : task;
+    p_task->base_priority = priority;
+    update_inheritance (p_task);
+    maybe_preempt ();
+}
+
+
+TickType_t xTaskGetTickCount (void)
+{
+    KernelLock lock;
+    return (TickType_t)(now_us / 1000);
+}
+
+
+TickType_t xTaskGetTickCountFromISR (void)
+{
+    return xTaskGetTickCount ();
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle (void)
+{
+    return p_self;
+}
+
+
+char* pcTaskGetName (TaskHandle_t task)
+{
+    SimTask* p_task = (task == NULL) ? p_self : task;
+    return (p_task != NULL) ? (char*)p_task->name.c_str () : (char*)"main";
+}
+
+
+UBaseType_t uxTaskGetStackHighWaterMark (TaskHandle_t task)
+{
+    SimTask* p_task = (task == NULL) ? p_self : task;
+    return (p_task != NULL) ? p_task->stack_depth : 0;
+}
+
+
+UBaseType_t uxTaskGetNumberOfTasks (void)
+{
+    KernelLock lock;
+    UBaseType_t count = 0;
+    for (SimTask* p_task : all_tasks)
+    {
+        if (p_task->state != TASK_DELETED)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+
+/** @brief   Start running tasks; return when the simulation is over.
+ *  @details If called by a task, the calling task simply stops, as nothing
+ *           after a call to @c vTaskStartScheduler() runs on a real target.
+ */
+void vTaskStartScheduler (void)
+{
+    {
+        KernelLock lock;
+        if (p_self != NULL)
+        {
+            vTaskDelete (NULL);
+            return;
+        }
+        if (scheduler_running)
+        {
+            return;
+        }
+
+        const char* p_limit = getenv ("SIM_TIME_LIMIT_MS");
+        if (p_limit != NULL && time_limit_us == NEVER)
+        {
+            time_limit_us = strtoull (p_limit, NULL, 10) * 1000ULL;
+        }
+
+        scheduler_running = true;
+        reschedule ();
+        while (!stopping)
+        {
+            kernel_wait (main_cv);
+        }
+
+        // Let every task thread unwind before cleaning up
+        begin_stop ();
+    }
+    for (SimTask* p_task : all_tasks)
+    {
+        if (p_task->thread.joinable ())
+        {
+            p_task->thread.join ();
+        }
+    }
+}
+
+
+BaseType_t xPortInIsrContext (void)
+{
+    return (isr_depth > 0) ? pdTRUE : pdFALSE;
+}
+
+
+BaseType_t xPortGetCoreID (void)
+{
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// Task notifications
+
+BaseType_t xTaskNotify (TaskHandle_t task, uint32_t value,
+                        eNotifyAction action)
+{
+    return xTaskNotifyFromISR (task, value, action, NULL);
+}
+
+
+BaseType_t xTaskNotifyFromISR (TaskHandle_t task, uint32_t value,
+                               eNotifyAction action, BaseType_t* p_woken)
+{
+    KernelLock lock;
+    check_exit ();
+    bool was_pending = task->notify_pending;
+    switch (action)
+    {
+        case eSetBits:
+            task->notify_value |= value;
+            break;
+        case eIncrement:
+            task->notify_value++;
+            break;
+        case eSetValueWithOverwrite:
+            task->notify_value = value;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (was_pending)
+            {
+                return pdFAIL;
+            }
+            task->notify_value = value;
+            break;
+        default:
+            break;
+    }
+    task->notify_pending = true;
+
+    SimTask* p_woken_task = NULL;
+    if (task->state == TASK_BLOCKED && task->wait_kind == WAIT_NOTIFY)
+    {
+        make_ready (task);
+        p_woken_task = task;
+    }
+    after_wake (p_woken_task, p_woken);
+    return pdPASS;
+}
+
+
+BaseType_t xTaskNotifyGive (TaskHandle_t task)
+{
+    return xTaskNotifyFromISR (task, 0, eIncrement, NULL);
+}
+
+
+void vTaskNotifyGiveFromISR (TaskHandle_t task, BaseType_t* p_woken)
+{
+    xTaskNotifyFromISR (task, 0, eIncrement, p_woken);
+}
+
+
+uint32_t ulTaskNotifyTake (BaseType_t clear_on_exit, TickType_t ticks)
+{
+    KernelLock lock;
+    check_exit ();
+    if (p_self == NULL)
+    {
+        return 0;
+    }
+    if (p_self->notify_value == 0)
+    {
+        block_until (p_self, WAIT_NOTIFY, deadline_for (ticks));
+    }
+    uint32_t value = p_self->notify_value;
+    if (value != 0)
+    {
+        p_self->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    p_self->notify_pending = false;
+    return value;
+}
+
+
+BaseType_t xTaskNotifyWait (uint32_t clear_on_entry, uint32_t clear_on_exit,
+                            uint32_t* p_value, TickType_t ticks)
+{
+    KernelLock lock;
+    check_exit ();
+    if (p_self == NULL)
+    {
+        return pdFALSE;
+    }
+    if (!p_self->notify_pending)
+    {
+        p_self->notify_value &= ~clear_on_entry;
+        block_until (p_self, WAIT_NOTIFY, deadline_for (ticks));
+    }
+    if (p_value != NULL)
+    {
+        *p_value = p_self->notify_value;
+    }
+    if (!p_self->notify_pending)
+    {
+        return pdFALSE;
+    }
+    p_self->notify_value &= ~clear_on_exit;
+    p_self->notify_pending = false;
+    return pdTRUE;
+}
+
+
+//-----------------------------------------------------------------------------
+// Queues and semaphores
+
+/// Where @c queue_send() puts an item
+enum SimSendPosition { SEND_BACK, SEND_FRONT, SEND_OVERWRITE };
+
+
+/** @brief   Create a queue, or a semaphore if the item size is zero.
+ */
+static SimQueue* make_queue (UBaseType_t length, UBaseType_t item_size,
+                             UBaseType_t initial_count)
+{
+    SimQueue* p_queue = new SimQueue;
+    p_queue->length = length;
+    p_queue->item_size = item_size;
+    p_queue->storage.resize ((size_t)length * item_size);
+    p_queue->head = 0;
+    p_queue->count = initial_count;
+    p_queue->is_mutex = false;
+    p_queue->p_holder = NULL;
+    return p_queue;
+}
+
+
+/** @brief   Put an item into a queue, blocking for space if allowed.
+ */
+static BaseType_t queue_send (QueueHandle_t queue, const void* p_item,
+                              TickType_t ticks, SimSendPosition position,
+                              BaseType_t* p_woken)
+{
+    KernelLock lock;
+    check_exit ();
+    if (queue == NULL)
+    {
+        return errQUEUE_FULL;
+    }
+    uint64_t deadline = deadline_for (ticks);
+
+    for (;;)
+    {
+        if (queue->count < queue->length || position == SEND_OVERWRITE)
+        {
+            size_t size = queue->item_size;
+            if (position == SEND_OVERWRITE && queue->count >= queue->length)
+            {
+                // Overwriting is only meant for queues of length one
+                memcpy (&queue->storage[queue->head * size], p_item, size);
+            }
+            else if (position == SEND_FRONT)
+            {
+                queue->head = (queue->head + queue->length - 1)
+                              % queue->length;
+                if (size > 0)
+                {
+                    memcpy (&queue->storage[queue->head * size], p_item, size);
+                }
+                queue->count++;
+            }
+            else
+            {
+                UBaseType_t tail = (queue->head + queue->count)
+                                   % queue->length;
+                if (size > 0)
+                {
+                    memcpy (&queue->storage[tail * size], p_item, size);
+                }
+                queue->count++;
+            }
+            if (queue->is_mutex && queue->p_holder != NULL)
+            {
+                // The giver drops any priority it inherited through this
+                // mutex, which may let a waiting task run at once
+                SimTask* p_giver = queue->p_holder;
+                queue->p_holder = NULL;
+                update_inheritance (p_giver);
+                SimTask* p_woken_task = wake_one (queue, WAIT_RECEIVE);
+                if (p_woken_task == NULL)
+                {
+                    maybe_preempt ();
+                }
+                after_wake (p_woken_task, p_woken);
+                return pdPASS;
+            }
+            after_wake (wake_one (queue, WAIT_RECEIVE), p_woken);
+            return pdPASS;
+        }
+        if (p_woken != NULL
+            || !block_until (queue, WAIT_SEND, deadline))
+        {
+            return errQUEUE_FULL;
+        }
+    }
+}
+
+
+/** @brief   Take (or just look at) the item at the front of a queue,
+ *           blocking until there is one if allowed.
+ */
+static BaseType_t queue_receive (QueueHandle_t queue, void* p_buffer,
+                                 TickType_t ticks, bool peek,
+                                 BaseType_t* p_woken)
+{
+    KernelLock lock;
+    check_exit ();
+    if (queue == NULL)
+    {
+        return pdFALSE;
+    }
+    uint64_t deadline = deadline_for (ticks);
+
+    for (;;)
+    {
+        if (queue->count > 0)
+        {
+            size_t size = queue->item_size;
+            if (size > 0)
+            {
+                memcpy (p_buffer, &queue->storage[queue->head * size], size);
+            }
+            if (peek)
+            {
+                // The item is still there for anyone else who's waiting
+                after_wake (wake_one (queue, WAIT_RECEIVE), p_woken);
+            }
+            else
+            {
+                queue->head = (queue->head + 1) % queue->length;
+                queue->count--;
+                if (queue->is_mutex && isr_depth == 0)
+                {
+                    queue->p_holder = p_self;
+                }
+                after_wake (wake_one (queue, WAIT_SEND), p_woken);
+            }
+            return pdTRUE;
+        }
+
+        // A task which waits for a mutex lends its priority to the holder
+        SimTask* p_holder = queue->is_mutex ? queue->p_holder : NULL;
+        if (p_holder != NULL && p_woken == NULL && p_self != NULL
+            && p_self->priority > p_holder->priority)
+        {
+            p_holder->priority = p_self->priority;
+        }
+        if (p_woken != NULL
+            || !block_until (queue, WAIT_RECEIVE, deadline))
+        {
+            // When a wait times out, the holder gives back what it borrowed
+            update_inheritance (p_holder);
+            return pdFALSE;
+        }
+    }
+}
+
+
+QueueHandle_t xQueueCreate (UBaseType_t length, UBaseType_t item_size)
+{
+    KernelLock lock;
+    if (length == 0)
+    {
+        return NULL;
+    }
+    return make_queue (length, item_size, 0);
+}
+
+
+void vQueueDelete (QueueHandle_t queue)
+{
+    KernelLock lock;
+    for (size_t index = 0; index < all_mutexes.size (); index++)
+    {
+        if (all_mutexes[index] == queue)
+        {
+            all_mutexes.erase (all_mutexes.begin () + index);
+            break;
+        }
+    }
+    delete queue;
+}
+
+
+BaseType_t xQueueSend (QueueHandle_t queue, const void* p_item,
+                       TickType_t ticks)
+{
+    return queue_send (queue, p_item, ticks, SEND_BACK, NULL);
+}
+
+
+BaseType_t xQueueSendToBack (QueueHandle_t queue, const void* p_item,
+                             TickType_t ticks)
+{
+    return queue_send (queue, p_item, ticks, SEND_BACK, NULL);
+}
+
+
+BaseType_t xQueueSendToFront (QueueHandle_t queue, const void* p_item,
+                              TickType_t ticks)
+{
+    return queue_send (queue, p_item, ticks, SEND_FRONT, NULL);
+}
+
+
+BaseType_t xQueueOverwrite (QueueHandle_t queue, const void* p_item)
+{
+    return queue_send (queue, p_item, 0, SEND_OVERWRITE, NULL);
+}
+
+
+// The FromISR versions pass a non-null "woken" pointer, which also tells
+// queue_send() and queue_receive() that they mustn't block
+static BaseType_t isr_woken_dummy;
+
+BaseType_t xQueueSendFromISR (QueueHandle_t queue, const void* p_item,
+                              BaseType_t* p_woken)
+{
+    return queue_send (queue, p_item, 0, SEND_BACK,
+                       p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+BaseType_t xQueueSendToBackFromISR (QueueHandle_t queue, const void* p_item,
+                                    BaseType_t* p_woken)
+{
+    return queue_send (queue, p_item, 0, SEND_BACK,
+                       p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+BaseType_t xQueueSendToFrontFromISR (QueueHandle_t queue, const void* p_item,
+                                     BaseType_t* p_woken)
+{
+    return queue_send (queue, p_item, 0, SEND_FRONT,
+                       p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+BaseType_t xQueueOverwriteFromISR (QueueHandle_t queue, const void* p_item,
+                                   BaseType_t* p_woken)
+{
+    return queue_send (queue, p_item, 0, SEND_OVERWRITE,
+                       p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+BaseType_t xQueueReceive (QueueHandle_t queue, void* p_buffer,
+                          TickType_t ticks)
+{
+    return queue_receive (queue, p_buffer, ticks, false, NULL);
+}
+
+
+BaseType_t xQueueReceiveFromISR (QueueHandle_t queue, void* p_buffer,
+                                 BaseType_t* p_woken)
+{
+    return queue_receive (queue, p_buffer, 0, false,
+                          p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+BaseType_t xQueuePeek (QueueHandle_t queue, void* p_buffer, TickType_t ticks)
+{
+    return queue_receive (queue, p_buffer, ticks, true, NULL);
+}
+
+
+BaseType_t xQueuePeekFromISR (QueueHandle_t queue, void* p_buffer)
+{
+    return queue_receive (queue, p_buffer, 0, true, &isr_woken_dummy);
+}
+
+
+UBaseType_t uxQueueMessagesWaiting (QueueHandle_t queue)
+{
+    KernelLock lock;
+    return (queue != NULL) ? queue->count : 0;
+}
+
+
+UBaseType_t uxQueueMessagesWaitingFromISR (QueueHandle_t queue)
+{
+    return uxQueueMessagesWaiting (queue);
+}
+
+
+UBaseType_t uxQueueSpacesAvailable (QueueHandle_t queue)
+{
+    KernelLock lock;
+    return (queue != NULL) ? queue->length - queue->count : 0;
+}
+
+
+BaseType_t xQueueReset (QueueHandle_t queue)
+{
+    KernelLock lock;
+    queue->head = 0;
+    queue->count = 0;
+    after_wake (wake_one (queue, WAIT_SEND), NULL);
+    return pdPASS;
+}
+
+
+BaseType_t xQueueIsQueueFullFromISR (QueueHandle_t queue)
+{
+    KernelLock lock;
+    return (queue->count >= queue->length) ? pdTRUE : pdFALSE;
+}
+
+
+BaseType_t xQueueIsQueueEmptyFromISR (QueueHandle_t queue)
+{
+    KernelLock lock;
+    return (queue->count == 0) ? pdTRUE : pdFALSE;
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateBinary (void)
+{
+    KernelLock lock;
+    return make_queue (1, 0, 0);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateCounting (UBaseType_t max_count,
+                                            UBaseType_t initial_count)
+{
+    KernelLock lock;
+    return make_queue (max_count, 0, initial_count);
+}
+
+
+SemaphoreHandle_t xSemaphoreCreateMutex (void)
+{
+    KernelLock lock;
+    SimQueue* p_mutex = make_queue (1, 0, 1);
+    p_mutex->is_mutex = true;
+    all_mutexes.push_back (p_mutex);
+    return p_mutex;
+}
+
+
+BaseType_t xSemaphoreTake (SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    return queue_receive (semaphore, NULL, ticks, false, NULL);
+}
+
+
+BaseType_t xSemaphoreGive (SemaphoreHandle_t semaphore)
+{
+    return queue_send (semaphore, NULL, 0, SEND_BACK, NULL);
+}
+
+
+BaseType_t xSemaphoreTakeFromISR (SemaphoreHandle_t semaphore,
+                                  BaseType_t* p_woken)
+{
+    return queue_receive (semaphore, NULL, 0, false,
+                          p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+BaseType_t xSemaphoreGiveFromISR (SemaphoreHandle_t semaphore,
+                                  BaseType_t* p_woken)
+{
+    return queue_send (semaphore, NULL, 0, SEND_BACK,
+                       p_woken ? p_woken : &isr_woken_dummy);
+}
+
+
+UBaseType_t uxSemaphoreGetCount (SemaphoreHandle_t semaphore)
+{
+    return uxQueueMessagesWaiting (semaphore);
+}
+
+
+//-----------------------------------------------------------------------------
+// Event groups
+
+/** @brief   Set bits in an event group and release every task whose wait
+ *           condition is now met.
+ */
+static EventBits_t event_set (EventGroupHandle_t group, EventBits_t bits,
+                              BaseType_t* p_woken)
+{
+    KernelLock lock;
+    check_exit ();
+    group->bits |= bits;
+
+    EventBits_t to_clear = 0;
+    SimTask* p_best = NULL;
+    for (SimTask* p_task : all_tasks)
+    {
+        if (p_task->state == TASK_BLOCKED && p_task->p_waiting_on == group
+            && p_task->wait_kind == WAIT_EVENT)
+        {
+            EventBits_t match = group->bits & p_task->event_bits;
+            if (p_task->event_all ? (match == p_task->event_bits)
+                                  : (match != 0))
+            {
+                p_task->event_result = group->bits;
+                if (p_task->event_clear)
+                {
+                    to_clear |= p_task->event_bits;
+                }
+                make_ready (p_task);
+                if (p_best == NULL || p_task->priority > p_best->priority)
+                {
+                    p_best = p_task;
+                }
+            }
+        }
+    }
+    group->bits &= ~to_clear;
+    EventBits_t result = group->bits;
+    after_wake (p_best, p_woken);
+    return result;
+}
+
+
+EventGroupHandle_t xEventGroupCreate (void)
+{
+    KernelLock lock;
+    SimEventGroup* p_group = new SimEventGroup;
+    p_group->bits = 0;
+    return p_group;
+}
+
+
+void vEventGroupDelete (EventGroupHandle_t group)
+{
+    KernelLock lock;
+    delete group;
+}
+
+
+EventBits_t xEventGroupSetBits (EventGroupHandle_t group, EventBits_t bits)
+{
+    return event_set (group, bits, NULL);
+}
+
+
+BaseType_t xEventGroupSetBitsFromISR (EventGroupHandle_t group,
+                                      EventBits_t bits, BaseType_t* p_woken)
+{
+    event_set (group, bits, p_woken ? p_woken : &isr_woken_dummy);
+    return pdPASS;
+}
+
+
+EventBits_t xEventGroupClearBits (EventGroupHandle_t group, EventBits_t bits)
+{
+    KernelLock lock;
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+
+EventBits_t xEventGroupClearBitsFromISR (EventGroupHandle_t group,
+                                         EventBits_t bits)
+{
+    return xEventGroupClearBits (group, bits);
+}
+
+
+EventBits_t xEventGroupGetBits (EventGroupHandle_t group)
+{
+    KernelLock lock;
+    return group->bits;
+}
+
+
+EventBits_t xEventGroupGetBitsFromISR (EventGroupHandle_t group)
+{
+    return xEventGroupGetBits (group);
+}
+
+
+EventBits_t xEventGroupWaitBits (EventGroupHandle_t group, EventBits_t bits,
+                                 BaseType_t clear_on_exit,
+                                 BaseType_t wait_for_all, TickType_t ticks)
+{
+    KernelLock lock;
+    check_exit ();
+    EventBits_t match = group->bits & bits;
+    if (wait_for_all ? (match == bits) : (match != 0))
+    {
+        EventBits_t result = group->bits;
+        if (clear_on_exit)
+        {
+            group->bits &= ~bits;
+        }
+        return result;
+    }
+    if (p_self == NULL)
+    {
+        return group->bits;
+    }
+    p_self->event_bits = bits;
+    p_self->event_all = wait_for_all;
+    p_self->event_clear = clear_on_exit;
+    if (block_until (group, WAIT_EVENT, deadline_for (ticks)))
+    {
+        return p_self->event_result;
+    }
+    return group->bits;
+}
+
+
+EventBits_t xEventGroupSync (EventGroupHandle_t group, EventBits_t set_bits,
+                             EventBits_t wait_bits, TickType_t ticks)
+{
+    KernelLock lock;
+    check_exit ();
+    EventBits_t original = group->bits;
+    event_set (group, set_bits, NULL);
+    if (((original | set_bits) & wait_bits) == wait_bits)
+    {
+        // This task was the last one to arrive
+        group->bits &= ~wait_bits;
+        return original | set_bits;
+    }
+    if (p_self == NULL)
+    {
+        return group->bits;
+    }
+    p_self->event_bits = wait_bits;
+    p_self->event_all = true;
+    p_self->event_clear = true;
+    if (block_until (group, WAIT_EVENT, deadline_for (ticks)))
+    {
+        return p_self->event_result;
+    }
+    return group->bits;
+}
+
+
+//-----------------------------------------------------------------------------
+// Simulation control
+
+/** @brief   Return the virtual time in microseconds since the program began.
+ */
+uint64_t sim_time_us (void)
+{
+    KernelLock lock;
+    return now_us;
+}
+
+
+/** @brief   Set the virtual time at which the simulation ends by itself.
+ */
+void sim_set_time_limit_ms (uint64_t limit_ms)
+{
+    KernelLock lock;
+    time_limit_us = limit_ms * 1000ULL;
+}
+
+
+/** @brief   End the simulation as soon as the calling task next reaches a
+ *           kernel call; @c vTaskStartScheduler() then returns.
+ */
+void sim_stop (int exit_code)
+{
+    KernelLock lock;
+    sim_exit_code = exit_code;
+    begin_stop ();
+    check_exit ();
+}
+
+
+/** @brief   Return the exit code given to @c sim_stop().
+ */
+int sim_get_exit_code (void)
+{
+    return sim_exit_code;
+}
+
+
+bool sim_is_running (void)
+{
+    KernelLock lock;
+    return scheduler_running && !stopping;
+}
+
+
+/** @brief   Return @c true once @c vTaskStartScheduler() has been called.
+ */
+bool sim_scheduler_started (void)
+{
+    KernelLock lock;
+    return scheduler_running;
+}
+
+
+uint32_t sim_context_switches (void)
+{
+    KernelLock lock;
+    return switch_count;
+}
+
+
+/** @brief   Attach a function to be called as a periodic interrupt.
+ *  @returns An identifier for use with @c sim_detach_interrupt()
+ */
+int sim_attach_interrupt (uint32_t period_us, void (*p_isr) (void))
+{
+    KernelLock lock;
+    SimInterrupt irq;
+    irq.period = (period_us > 0) ? period_us : 1;
+    irq.next_time = now_us + irq.period;
+    irq.p_isr = p_isr;
+    interrupts.push_back (irq);
+    return (int)interrupts.size () - 1;
+}
+
+
+void sim_detach_interrupt (int id)
+{
+    KernelLock lock;
+    if (id >= 0 && id < (int)interrupts.size ())
+    {
+        interrupts[id].p_isr = NULL;
+    }
+}
+
+
+void sim_set_interrupt_period (int id, uint32_t period_us)
+{
+    KernelLock lock;
+    if (id >= 0 && id < (int)interrupts.size ())
+    {
+        interrupts[id].period = (period_us > 0) ? period_us : 1;
+        interrupts[id].next_time = now_us + interrupts[id].period;
+    }
+}
+
+
+/** @brief   Let virtual time pass while the calling code keeps the CPU, as a
+ *           busy-wait such as @c delayMicroseconds() does.
+ */
+void sim_advance_busy (uint32_t microseconds)
+{
+    KernelLock lock;
+    check_exit ();
+    now_us += microseconds;
+    process_time ();
+    maybe_preempt ();
+}
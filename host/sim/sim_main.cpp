@@ -0,0 +1,67 @@
+//*****************************************************************************
+/** @file    sim_main.cpp
+ *  @brief   The host program's @c main(), which runs an Arduino program's
+ *           @c setup() and @c loop() in the simulation.
+ *  @details @c setup() runs before the scheduler starts, as on an STM32. If
+ *           it doesn't start the scheduler itself, a lowest-priority task is
+ *           created which calls @c loop() once per tick, much as the ESP32
+ *           core's @c loopTask does, and then the scheduler is started. The
+ *           program ends when every task is blocked forever, when the virtual
+ *           time limit in the environment variable @c SIM_TIME_LIMIT_MS is
+ *           reached, or when some task calls @c sim_stop().
+ *
+ *           To build and run an example by hand, from the top directory of
+ *           this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -DESP32 -DHOST_SIM -Ihost/sim -Isrc \
+ *               examples/mission_test.cpp src/baseshare.cpp \
+ *               host/sim/sim_*.cpp -pthread -o mission_test
+ *           SIM_TIME_LIMIT_MS=700000 ./mission_test
+ *           @endcode
+ *           Add whichever other files from @c src or @c examples the
+ *           program uses. The @c ESP32 define picks the ESP32 branches of
+ *           the library, whose FreeRTOS and Arduino calls the simulation
+ *           provides, and the STM32 timers used with encoders are modeled
+ *           as well (see @c HardwareTimer.h and @c quadrature.h); @c HOST_SIM
+ *           lets a program use the @c sim_...() functions, for instance to
+ *           stop the run when a test is finished. Recordings made with
+ *           @c ShareRecorder on a microcontroller can be played back here by
+ *           @c ShareReplay from a file opened as a @c Stream.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include "Arduino.h"
+
+
+/** @brief   Task which calls the Arduino @c loop() function over and over.
+ *  @details The delay lets virtual time pass when @c loop() is empty; a real
+ *           @c loopTask would spin, but here that would stop the clock.
+ */
+static void loop_task (void* p_params)
+{
+    (void)p_params;
+    for (;;)
+    {
+        loop ();
+        vTaskDelay (1);
+    }
+}
+
+
+int main (void)
+{
+    setup ();
+    if (!sim_scheduler_started ())
+    {
+        xTaskCreate (loop_task, "loopTask", 8192, NULL, 1, NULL);
+        vTaskStartScheduler ();
+    }
+    fflush (stdout);
+    return sim_get_exit_code ();
+}
@@ -0,0 +1,233 @@
+//*****************************************************************************
+/** @file    sim_timer.cpp
+ *  @brief   The model of STM32 timers in encoder mode and of the parts of
+ *           STM32duino's @c HardwareTimer used with them.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <string.h>
+#include "HardwareTimer.h"
+
+
+/// The model's timers, with @c ARR at its reset value; @c TIM2 and @c TIM5
+/// are the 32-bit ones
+TIM_TypeDef sim_timers[8] =
+{
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFFFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFFFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, { }, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFFFF, { }, 0, 0 }
+};
+
+
+/** @brief   Work out how long an input must hold a new level to get through
+ *           a channel's digital filter.
+ *  @details The @c ICxF bits choose a sampling rate, a fraction of the
+ *           timer's clock, and a number of samples in a row which must
+ *           agree, as in the table in the STM32 reference manuals.
+ *  @param   timer The timer whose filter is used
+ *  @param   index The channel, 0 for channel 1 or 1 for channel 2
+ *  @returns The filter's delay in nanoseconds, or 0 if it's off
+ */
+static uint64_t filter_ns (TIM_TypeDef* timer, uint8_t index)
+{
+    static const uint8_t DIVIDERS[16] = { 1, 1, 1, 1, 2, 2, 4, 4, 8, 8, 16,
+                                          16, 16, 32, 32, 32 };
+    static const uint8_t SAMPLES[16] = { 0, 2, 4, 8, 6, 8, 6, 8, 6, 8, 5, 6,
+                                         8, 5, 6, 8 };
+    uint8_t setting = (index == 0)
+        ? (timer->CCMR1 & TIM_CCMR1_IC1F) >> TIM_CCMR1_IC1F_Pos
+        : (timer->CCMR1 & TIM_CCMR1_IC2F) >> TIM_CCMR1_IC2F_Pos;
+    return (uint64_t)SAMPLES[setting] * DIVIDERS[setting] * 1000000000ULL
+           / SIM_TIMER_CLOCK_HZ;
+}
+
+
+/** @brief   Let a new input level through the filter to the counter.
+ *  @details In encoder mode 1 the counter counts on channel 1's edges, in
+ *           mode 2 on channel 2's, and in mode 3 on both, up or down
+ *           according to the level of the other channel as in the reference
+ *           manual's table of counting directions.
+ *  @param   timer The timer whose input has changed
+ *  @param   index The channel, 0 for channel 1 or 1 for channel 2
+ */
+static void accept (TIM_TypeDef* timer, uint8_t index)
+{
+    SimTimerInput* p_inputs = timer->inputs;
+    p_inputs[index].filtered = p_inputs[index].raw;
+
+    uint32_t mode = timer->SMCR & TIM_SMCR_SMS;
+    if (!(timer->CR1 & TIM_CR1_CEN) || mode < 1 || mode > 3
+        || (mode == 1 && index != 0) || (mode == 2 && index != 1))
+    {
+        return;
+    }
+
+    // The levels as seen by the counter, after the polarity bits
+    uint8_t ti1 = p_inputs[0].filtered
+                  ^ ((timer->CCER & TIM_CCER_CC1P) ? 1 : 0);
+    uint8_t ti2 = p_inputs[1].filtered
+                  ^ ((timer->CCER & TIM_CCER_CC2P) ? 1 : 0);
+    bool up = (index == 0) ? (ti1 != ti2) : (ti1 == ti2);
+
+    uint32_t top = timer->ARR;
+    if (up)
+    {
+        timer->CNT = (timer->CNT >= top) ? 0 : timer->CNT + 1;
+        timer->CR1 = timer->CR1 & ~TIM_CR1_DIR;
+    }
+    else
+    {
+        timer->CNT = (timer->CNT == 0 || timer->CNT > top) ? top
+                     : timer->CNT - 1;
+        timer->CR1 = timer->CR1 | TIM_CR1_DIR;
+    }
+    timer->counted++;
+}
+
+
+/** @brief   Reset a timer's registers and inputs as at power-up.
+ *  @param   timer The timer to be reset
+ */
+void sim_timer_reset (TIM_TypeDef* timer)
+{
+    bool wide = (timer == TIM2 || timer == TIM5);
+    timer->CR1 = 0;
+    timer->CR2 = 0;
+    timer->SMCR = 0;
+    timer->DIER = 0;
+    timer->SR = 0;
+    timer->EGR = 0;
+    timer->CCMR1 = 0;
+    timer->CCMR2 = 0;
+    timer->CCER = 0;
+    timer->CNT = 0;
+    timer->PSC = 0;
+    timer->ARR = wide ? 0xFFFFFFFF : 0xFFFF;
+    memset (timer->inputs, 0, sizeof (timer->inputs));
+    timer->counted = 0;
+    timer->filtered_out = 0;
+}
+
+
+/** @brief   Let any input changes which have outlasted the filter reach the
+ *           counter.
+ *  @details Signal generators call this before reading the count, so that
+ *           the last edges before the reading are counted.
+ *  @param   timer The timer whose inputs are to be brought up to date
+ *  @param   time_ns The time now, in nanoseconds
+ */
+void sim_timer_settle (TIM_TypeDef* timer, uint64_t time_ns)
+{
+    for (;;)
+    {
+        // The change which got through the filter first goes first
+        int8_t first = -1;
+        uint64_t first_ns = 0;
+        for (uint8_t index = 0; index < 2; index++)
+        {
+            SimTimerInput& input = timer->inputs[index];
+            if (input.raw == input.filtered)
+            {
+                continue;
+            }
+            uint64_t through_ns = input.change_ns + filter_ns (timer, index);
+            if (through_ns <= time_ns && (first < 0 || through_ns < first_ns))
+            {
+                first = index;
+                first_ns = through_ns;
+            }
+        }
+        if (first < 0)
+        {
+            return;
+        }
+        accept (timer, first);
+    }
+}
+
+
+/** @brief   Toggle the level at a timer's channel 1 or 2 input.
+ *  @details A change is counted once it has lasted as long as the channel's
+ *           filter requires; one which is undone sooner is a glitch, and
+ *           the filter removes it.
+ *  @param   timer The timer whose input changes
+ *  @param   channel The channel, 1 or 2
+ *  @param   time_ns The time of the edge in nanoseconds, which mustn't be
+ *           earlier than that of the edge before
+ */
+void sim_timer_edge (TIM_TypeDef* timer, uint8_t channel, uint64_t time_ns)
+{
+    uint8_t index = (channel == 2) ? 1 : 0;
+    sim_timer_settle (timer, time_ns);
+
+    SimTimerInput& input = timer->inputs[index];
+    input.raw ^= 1;
+    if (input.raw == input.filtered)
+    {
+        timer->filtered_out++;
+    }
+    else
+    {
+        input.change_ns = time_ns;
+        if (filter_ns (timer, index) == 0)
+        {
+            accept (timer, index);
+        }
+    }
+}
+
+
+/** @brief   Take charge of a timer.
+ *  @param   instance The timer, such as @c TIM3
+ */
+HardwareTimer::HardwareTimer (TIM_TypeDef* instance)
+    : p_regs (instance)
+{
+    for (uint8_t index = 0; index < 4; index++)
+    {
+        modes[index] = 0;
+        pins[index] = 0xFF;
+    }
+}
+
+
+/** @brief   Set the mode of a channel and the pin it uses.
+ *  @details The model keeps these but doesn't act on them; encoder code
+ *           sets the counting mode through the registers.
+ *  @param   channel The channel, 1 to 4
+ *  @param   mode The channel's mode
+ *  @param   pin The pin which the channel uses
+ */
+void HardwareTimer::setMode (uint32_t channel, TimerModes_t mode,
+                             uint32_t pin)
+{
+    if (channel >= 1 && channel <= 4)
+    {
+        modes[channel - 1] = mode;
+        pins[channel - 1] = pin;
+    }
+}
+
+
+/** @brief   Set the count at which the timer wraps around.
+ *  @details Only @c TICK_FORMAT is meaningful for an encoder; the value is
+ *           the number of counts in one cycle, so @c ARR is set to one less.
+ *  @param   overflow The number of counts before the timer wraps around
+ *  @param   format The format of @c overflow (only @c TICK_FORMAT is used)
+ */
+void HardwareTimer::setOverflow (uint32_t overflow, TimerFormat_t format)
+{
+    (void)format;
+    p_regs->ARR = (overflow > 0) ? overflow - 1 : 0;
+}
@@ -0,0 +1,233 @@
+//*****************************************************************************
+/** @file    telemetry_decode.cpp
+ *  @brief   Reads binary telemetry from a serial port and writes it as CSV.
+ *  @details This program reads the frames sent by a @c Telemetry object (see
+ *           @c src/telemetry.h) from a serial port, a pseudo-terminal, a file
+ *           or standard input, and writes one line of CSV per row of samples
+ *           to standard output, beginning with a header line naming the 
+ *           columns. When the input ends, or Ctrl-C is pressed, it prints the
+ *           number of rows and of good, damaged and lost frames to standard
+ *           error.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -Isrc -Ihost host/telemetry_decode.cpp \
+ *               -o telemetry_decode
+ *           ./telemetry_decode /dev/ttyUSB0 921600 > run.csv
+ *           @endcode
+ *           A path of @c - reads standard input. The baud rate is only used
+ *           when the path is a terminal device; the default is 115200.
+ *
+ *           With @c -o and a file name after the other arguments, the rows
+ *           are written to that file as a column log (see @c columnlog.h)
+ *           instead of as CSV, which is much quicker to analyze when the 
+ *           capture is large:
+ *           @code
+ *           ./telemetry_decode /dev/ttyUSB0 921600 -o run.col
+ *           @endcode
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "telemetry_decoder.h"
+#include "columnlog.h"
+
+
+/// Set by the Ctrl-C handler to make the program stop reading
+static volatile sig_atomic_t stop_now = 0;
+
+
+/** @brief   Handle Ctrl-C by asking the main loop to stop.
+ *  @param   signal_number The signal, which is ignored
+ */
+static void on_interrupt (int signal_number)
+{
+    (void)signal_number;
+    stop_now = 1;
+}
+
+
+/** @brief   Find the @c termios speed code for a baud rate.
+ *  @param   baud The baud rate
+ *  @returns The speed code, or @c B0 if the rate isn't a standard one
+ */
+static speed_t baud_code (long baud)
+{
+    switch (baud)
+    {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+#ifdef B460800
+        case 460800:  return B460800;
+#endif
+#ifdef B921600
+        case 921600:  return B921600;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+        default:      return B0;
+    }
+}
+
+
+/** @brief   Put a terminal device into raw mode at the given baud rate.
+ *  @param   fd The file descriptor of the open device
+ *  @param   baud The baud rate
+ *  @returns @c true if successful or if the file isn't a terminal
+ */
+static bool set_raw (int fd, long baud)
+{
+    if (!isatty (fd))
+    {
+        return true;
+    }
+    struct termios settings;
+    if (tcgetattr (fd, &settings) != 0)
+    {
+        return false;
+    }
+    cfmakeraw (&settings);
+    speed_t speed = baud_code (baud);
+    if (speed != B0)
+    {
+        cfsetispeed (&settings, speed);
+        cfsetospeed (&settings, speed);
+    }
+    settings.c_cc[VMIN] = 1;
+    settings.c_cc[VTIME] = 0;
+    return tcsetattr (fd, TCSANOW, &settings) == 0;
+}
+
+
+/** @brief   Decoder which writes rows to a column log instead of as CSV.
+ *  @details The log file is created when the first row arrives, as the
+ *           channels' names aren't known until then. The microcontroller's
+ *           32-bit microsecond times wrap around every 71 minutes; they are
+ *           extended to 64 bits so the times in the log keep increasing.
+ */
+class LogDecoder : public TelemetryDecoder
+{
+protected:
+    const char* p_path;                   ///< Path of the log file
+    ColumnLogWriter writer;               ///< Writes the log
+    bool opened;                          ///< The log has been created
+    uint32_t last_us;                     ///< Time of the last row
+    uint64_t high_us;                     ///< Time added for wrap-arounds
+
+public:
+    /** @brief   Create a decoder which writes a column log.
+     *  @param   p_log_path The path of the log file
+     */
+    LogDecoder (const char* p_log_path)
+        : TelemetryDecoder (NULL), p_path (p_log_path), opened (false),
+          last_us (0), high_us (0)
+    {
+    }
+
+    /** @brief   Write one row to the column log.
+     *  @param   time_us The time at which the row was sampled
+     *  @param   types The type of each channel
+     *  @param   values The widened values
+     */
+    void on_row (uint32_t time_us, const std::vector<uint8_t>& types,
+                 const std::vector<uint64_t>& values)
+    {
+        if (!opened)
+        {
+            if (!writer.open (p_path, get_names (), types))
+            {
+                perror (p_path);
+                exit (1);
+            }
+            opened = true;
+        }
+        if (time_us < last_us)
+        {
+            high_us += 1ULL << 32;
+        }
+        last_us = time_us;
+        writer.add_row (high_us + time_us, values.data ());
+    }
+
+    /** @brief   Write the last rows and close the log file.
+     */
+    void close (void)
+    {
+        writer.close ();
+    }
+};
+
+
+int main (int argc, char** argv)
+{
+    // Take out the -o option, leaving the others in place
+    const char* p_log_path = NULL;
+    if (argc > 3 && strcmp (argv[argc - 2], "-o") == 0)
+    {
+        p_log_path = argv[argc - 1];
+        argc -= 2;
+    }
+    if (argc < 2)
+    {
+        fprintf (stderr, "Usage: %s <device or file or -> [baud] "
+                 "[-o log file]\n", argv[0]);
+        return 1;
+    }
+    long baud = (argc > 2) ? atol (argv[2]) : 115200;
+
+    int fd = STDIN_FILENO;
+    if (strcmp (argv[1], "-") != 0)
+    {
+        fd = open (argv[1], O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            perror (argv[1]);
+            return 1;
+        }
+    }
+    if (!set_raw (fd, baud))
+    {
+        perror ("Can't set up the serial port");
+        return 1;
+    }
+    signal (SIGINT, on_interrupt);
+
+    TelemetryDecoder csv_decoder (stdout);
+    LogDecoder log_decoder (p_log_path);
+    TelemetryDecoder& decoder = p_log_path ? log_decoder : csv_decoder;
+    uint8_t buffer[4096];
+    while (!stop_now)
+    {
+        ssize_t got = read (fd, buffer, sizeof (buffer));
+        if (got <= 0)
+        {
+            break;
+        }
+        decoder.feed (buffer, got);
+    }
+    fflush (stdout);
+    log_decoder.close ();
+
+    fprintf (stderr, "%llu rows, %u good frames, %u bad, %u lost, "
+             "%u before schema\n", (unsigned long long)decoder.rows,
+             decoder.good_frames, decoder.bad_frames, decoder.lost_frames,
+             decoder.skipped_frames);
+    return 0;
+}
@@ -0,0 +1,297 @@
+//*****************************************************************************
+/** @file    telemetry_decoder.h
+ *  @brief   A class which turns a stream of telemetry bytes from a
+ *           microcontroller back into rows of numbers, on a PC.
+ *  @details Bytes are fed to the decoder as they arrive, in pieces of any
+ *           size. It splits them into frames at the zero bytes, checks each
+ *           frame's CRC, and decodes schema and data frames as described in
+ *           @c src/telemetry_codec.h. Each row of data is written to a file as
+ *           a line of CSV, beginning with the time at which it was sampled. A
+ *           header line naming the columns is written when the first schema
+ *           arrives; data frames which come before any schema are counted and
+ *           skipped.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#ifndef _TELEMETRY_DECODER_H_
+#define _TELEMETRY_DECODER_H_
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include "telemetry_codec.h"
+
+
+/** @brief   Class which decodes telemetry frames and writes their rows as
+ *           CSV.
+ */
+class TelemetryDecoder
+{
+protected:
+    FILE* p_csv;                          ///< Where the CSV goes, or NULL
+    std::vector<uint8_t> frame;           ///< Bytes of the current frame
+    std::vector<uint8_t> types;           ///< Type of each channel
+    std::vector<std::string> names;       ///< Name of each channel
+    std::vector<uint64_t> values;         ///< Most recent row of values
+    bool have_schema;                     ///< A schema frame has arrived
+    bool have_sequence;                   ///< A data frame has arrived
+    uint32_t next_sequence;               ///< Sequence number expected next
+
+public:
+    uint32_t good_frames;                 ///< Frames decoded correctly
+    uint32_t bad_frames;                  ///< Frames with bad CRC's or COBS
+    uint32_t lost_frames;                 ///< Gaps in the sequence numbers
+    uint32_t skipped_frames;              ///< Data frames before any schema
+    uint64_t rows;                        ///< Rows decoded
+
+    /** @brief   Create a decoder.
+     *  @param   p_csv_file The file to which CSV is written, or @c NULL to
+     *           decode without writing anything
+     */
+    TelemetryDecoder (FILE* p_csv_file)
+        : p_csv (p_csv_file), have_schema (false), have_sequence (false),
+          next_sequence (0), good_frames (0), bad_frames (0), lost_frames (0),
+          skipped_frames (0), rows (0)
+    {
+    }
+
+    /** @brief   Handle one decoded row of values.
+     *  @details The default writes the row as a line of CSV; a descendent 
+     *           class may do something else with the values.
+     *  @param   time_us The time at which the row was sampled
+     *  @param   types The @c ShareValueType code of each channel
+     *  @param   values The values, widened as by @c share_type_widen()
+     */
+    virtual void on_row (uint32_t time_us, const std::vector<uint8_t>& types,
+                         const std::vector<uint64_t>& values)
+    {
+        if (p_csv == NULL)
+        {
+            return;
+        }
+        fprintf (p_csv, "%" PRIu32, time_us);
+        for (size_t index = 0; index < values.size (); index++)
+        {
+            fputc (',', p_csv);
+            print_value (p_csv, types[index], values[index]);
+        }
+        fputc ('\n', p_csv);
+    }
+
+    /** @brief   Destroy the decoder; this does nothing but must be virtual.
+     */
+    virtual ~TelemetryDecoder (void)
+    {
+    }
+
+    /** @brief   Feed bytes received from the microcontroller to the decoder.
+     *  @param   p_data Pointer to the bytes
+     *  @param   length The number of bytes
+     */
+    void feed (const uint8_t* p_data, size_t length)
+    {
+        for (size_t index = 0; index < length; index++)
+        {
+            if (p_data[index] != 0)
+            {
+                // A frame too long to be valid is noise; drop what we have
+                if (frame.size () > 2 * TELEMETRY_MAX_FRAME)
+                {
+                    frame.clear ();
+                    bad_frames++;
+                }
+                frame.push_back (p_data[index]);
+            }
+            else if (!frame.empty ())
+            {
+                decode_frame ();
+                frame.clear ();
+            }
+        }
+    }
+
+    /** @brief   Return the names of the channels.
+     *  @returns A vector of the names from the most recent schema frame
+     */
+    const std::vector<std::string>& get_names (void)
+    {
+        return names;
+    }
+
+    /** @brief   Print a value of one of the share types as text.
+     *  @param   p_file The file to which the value is printed
+     *  @param   type The value's @c ShareValueType code
+     *  @param   raw The value, widened as by @c share_type_widen()
+     */
+    static void print_value (FILE* p_file, uint8_t type, uint64_t raw)
+    {
+        if (type == SHARE_FLOAT)
+        {
+            float value;
+            share_type_narrow (type, raw, &value);
+            fprintf (p_file, "%.9g", value);
+        }
+        else if (type == SHARE_DOUBLE)
+        {
+            double value;
+            share_type_narrow (type, raw, &value);
+            fprintf (p_file, "%.17g", value);
+        }
+        else if (share_type_is_signed (type))
+        {
+            fprintf (p_file, "%" PRId64, (int64_t)raw);
+        }
+        else
+        {
+            fprintf (p_file, "%" PRIu64, raw);
+        }
+    }
+
+protected:
+    /** @brief   Check and decode the frame whose bytes have been collected.
+     */
+    void decode_frame (void)
+    {
+        std::vector<uint8_t> payload (frame.size ());
+        size_t length = cobs_decode (frame.data (), frame.size (),
+                                     payload.data ());
+        if (length < 3)
+        {
+            bad_frames++;
+            return;
+        }
+        length -= 2;
+        uint16_t crc = payload[length] | (payload[length + 1] << 8);
+        if (crc16_ccitt (payload.data (), length) != crc)
+        {
+            bad_frames++;
+            return;
+        }
+
+        const uint8_t* p_read = payload.data () + 1;
+        const uint8_t* p_end = payload.data () + length;
+        bool good = false;
+        if (payload[0] == TELEMETRY_SCHEMA)
+        {
+            good = decode_schema (p_read, p_end);
+        }
+        else if (payload[0] == TELEMETRY_DATA)
+        {
+            if (!have_schema)
+            {
+                skipped_frames++;
+                return;
+            }
+            good = decode_data (p_read, p_end);
+        }
+        if (good)
+        {
+            good_frames++;
+        }
+        else
+        {
+            bad_frames++;
+        }
+    }
+
+    /** @brief   Decode a schema frame, writing a CSV header if it's the first.
+     *  @param   p_read Pointer to the payload after the frame type
+     *  @param   p_end Pointer to the end of the payload
+     *  @returns @c true if the frame was valid
+     */
+    bool decode_schema (const uint8_t* p_read, const uint8_t* p_end)
+    {
+        uint64_t count;
+        p_read = varint_get (p_read, p_end, count);
+        if (p_read == NULL || count > TELEMETRY_MAX_CHANNELS)
+        {
+            return false;
+        }
+        std::vector<uint8_t> new_types;
+        std::vector<std::string> new_names;
+        for (uint64_t index = 0; index < count; index++)
+        {
+            if (p_end - p_read < 2 || p_end - p_read < 2 + p_read[1]
+                || share_type_size (p_read[0]) == 0)
+            {
+                return false;
+            }
+            new_types.push_back (p_read[0]);
+            new_names.push_back (std::string ((const char*)p_read + 2,
+                                              p_read[1]));
+            p_read += 2 + p_read[1];
+        }
+
+        if (!have_schema && p_csv != NULL)
+        {
+            fprintf (p_csv, "time_us");
+            for (size_t index = 0; index < new_names.size (); index++)
+            {
+                fprintf (p_csv, ",%s", new_names[index].c_str ());
+            }
+            fputc ('\n', p_csv);
+        }
+        types = new_types;
+        names = new_names;
+        values.assign (types.size (), 0);
+        have_schema = true;
+        return true;
+    }
+
+    /** @brief   Decode a data frame, writing each of its rows.
+     *  @param   p_read Pointer to the payload after the frame type
+     *  @param   p_end Pointer to the end of the payload
+     *  @returns @c true if the frame was valid
+     */
+    bool decode_data (const uint8_t* p_read, const uint8_t* p_end)
+    {
+        uint64_t sequence, time_us, delta;
+        p_read = varint_get (p_read, p_end, sequence);
+        if (p_read == NULL
+            || (p_read = varint_get (p_read, p_end, time_us)) == NULL)
+        {
+            return false;
+        }
+        if (have_sequence && (uint32_t)sequence != next_sequence)
+        {
+            lost_frames += (uint32_t)sequence - next_sequence;
+        }
+        have_sequence = true;
+        next_sequence = (uint32_t)sequence + 1;
+
+        // Each frame starts from zero, so it doesn't depend on earlier ones
+        values.assign (types.size (), 0);
+        uint32_t time = (uint32_t)time_us;
+        while (p_read < p_end)
+        {
+            p_read = varint_get (p_read, p_end, delta);
+            if (p_read == NULL)
+            {
+                return false;
+            }
+            time += (uint32_t)delta;
+            for (size_t index = 0; index < types.size (); index++)
+            {
+                p_read = varint_get (p_read, p_end, delta);
+                if (p_read == NULL)
+                {
+                    return false;
+                }
+                values[index] = telemetry_undelta (types[index], delta,
+                                                   values[index]);
+            }
+            rows++;
+            on_row (time, types, values);
+        }
+        return true;
+    }
+};
+
+#endif // _TELEMETRY_DECODER_H_
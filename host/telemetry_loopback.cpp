@@ -0,0 +1,269 @@
+//*****************************************************************************
+/** @file    telemetry_loopback.cpp
+ *  @brief   Tests the telemetry encoder and decoder through a pseudo-terminal
+ *           and measures how many values per second the format can carry.
+ *  @details One thread plays the part of the microcontroller: it frames rows
+ *           of test signals with the same @c TelemetryFramer which 
+ *           @c Telemetry uses and writes them into the master side of a 
+ *           pseudo-terminal. The main thread reads the slave side as 
+ *           @c telemetry_decode would, decodes the rows, and checks every 
+ *           value against the signals. Some frames are damaged on purpose
+ *           to check that the CRC catches them and that decoding picks up
+ *           again at the next frame.
+ *
+ *           The program then prints the average number of bytes per row,
+ *           compares it with the same rows printed as text, and works out
+ *           how many values per second each would carry at 115200 baud.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -pthread -Isrc -Ihost \
+ *               host/telemetry_loopback.cpp -o telemetry_loopback
+ *           ./telemetry_loopback
+ *           @endcode
+ *           The program's exit status is 0 if every row was decoded
+ *           correctly.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <thread>
+#include "telemetry_decoder.h"
+
+
+/// The number of rows of test signals sent
+const uint32_t N_ROWS = 200000;
+
+/// The time between rows, in microseconds, as if sampled at 1 kHz
+const uint32_t ROW_US = 1000;
+
+/// One frame in this many is damaged on purpose
+const uint32_t DAMAGE_EVERY = 97;
+
+/// A schema frame is sent after this many data frames, as by @c Telemetry
+const uint32_t SCHEMA_EVERY = 64;
+
+/// The names of the test channels
+const char* const NAMES[] = { "angle", "count", "millis", "limit", "speed" };
+
+/// The types of the test channels
+const uint8_t TYPES[] = { SHARE_FLOAT, SHARE_I16, SHARE_U32, SHARE_BOOL,
+                          SHARE_DOUBLE };
+
+/// The number of test channels
+const uint8_t N_CHANNELS = sizeof (TYPES);
+
+
+/** @brief   Compute the test signals for one row, widened for framing.
+ *  @param   row The row number
+ *  @param   p_values Pointer to an array in which to put a value for each
+ *           channel
+ */
+static void make_row (uint32_t row, uint64_t* p_values)
+{
+    float angle = sinf (row * 0.01f);         // A smooth signal
+    int16_t count = (int16_t)(row * 3);       // Wraps around now and then
+    uint32_t millis = row;                    // A steady ramp
+    bool limit = (row / 500) % 2;             // Changes seldom
+    double speed = 12.5;                      // Doesn't change at all
+
+    p_values[0] = share_type_widen (SHARE_FLOAT, &angle);
+    p_values[1] = share_type_widen (SHARE_I16, &count);
+    p_values[2] = share_type_widen (SHARE_U32, &millis);
+    p_values[3] = share_type_widen (SHARE_BOOL, &limit);
+    p_values[4] = share_type_widen (SHARE_DOUBLE, &speed);
+}
+
+
+/** @brief   Decoder which checks each row against the test signals.
+ */
+class CheckingDecoder : public TelemetryDecoder
+{
+public:
+    uint32_t wrong;                       ///< Rows with wrong values
+    uint64_t text_bytes;                  ///< Length of the rows as CSV
+    uint32_t last_row;                    ///< Row number of the last row
+
+    CheckingDecoder (void)
+        : TelemetryDecoder (NULL), wrong (0), text_bytes (0), last_row (0)
+    {
+    }
+
+    void on_row (uint32_t time_us, const std::vector<uint8_t>& types,
+                 const std::vector<uint64_t>& values)
+    {
+        uint64_t expected[N_CHANNELS];
+        last_row = time_us / ROW_US;
+        make_row (last_row, expected);
+        for (uint8_t index = 0; index < N_CHANNELS; index++)
+        {
+            if (values[index] != expected[index])
+            {
+                wrong++;
+                break;
+            }
+        }
+
+        // Measure how long the row would be as text, as printed by a task
+        char line[256];
+        FILE* p_line = fmemopen (line, sizeof (line), "w");
+        fprintf (p_line, "%u", time_us);
+        for (uint8_t index = 0; index < N_CHANNELS; index++)
+        {
+            fputc (',', p_line);
+            print_value (p_line, types[index], values[index]);
+        }
+        fputs ("\r\n", p_line);
+        text_bytes += ftell (p_line);
+        fclose (p_line);
+    }
+};
+
+
+/** @brief   Send the test rows into the pseudo-terminal as telemetry.
+ *  @param   fd The file descriptor of the pseudo-terminal's master side
+ *  @param   p_sent Pointer to a variable in which to put the bytes sent
+ *  @param   p_damaged Pointer to a variable in which to put the number of
+ *           frames damaged on purpose
+ */
+static void send_rows (int fd, uint64_t* p_sent, uint32_t* p_damaged)
+{
+    TelemetryFramer framer;
+    for (uint8_t index = 0; index < N_CHANNELS; index++)
+    {
+        framer.add_channel (TYPES[index]);
+    }
+
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    uint32_t frames = 0;
+    *p_sent = 0;
+    *p_damaged = 0;
+
+    // Garbage runs into the first frame, as when a program starts listening
+    // partway through a stream; the decoder must skip data frames until the
+    // next schema frame comes along
+    const uint8_t junk[] = { 0x12, 0x34, 0x56 };
+    *p_sent += write (fd, junk, sizeof (junk));
+    size_t length = framer.schema (NAMES, frame);
+    *p_sent += write (fd, frame, length);
+
+    uint64_t values[N_CHANNELS];
+    for (uint32_t row = 0; row <= N_ROWS; row++)
+    {
+        make_row (row, values);
+        if (row < N_ROWS && framer.add_row (row * ROW_US, values))
+        {
+            continue;
+        }
+        length = framer.finish (frame);
+        if (++frames % DAMAGE_EVERY == 0)
+        {
+            frame[length / 2] ^= 0x10;
+            (*p_damaged)++;
+        }
+        size_t done = 0;
+        while (done < length)
+        {
+            ssize_t wrote = write (fd, frame + done, length - done);
+            if (wrote > 0)
+            {
+                done += wrote;
+            }
+        }
+        *p_sent += length;
+        if (frames % SCHEMA_EVERY == 0)
+        {
+            length = framer.schema (NAMES, frame);
+            *p_sent += write (fd, frame, length);
+        }
+        if (row < N_ROWS)
+        {
+            framer.add_row (row * ROW_US, values);
+        }
+    }
+}
+
+
+int main (void)
+{
+    // Open a pseudo-terminal and put its slave side into raw mode, so the
+    // bytes go through exactly as they would through a USB serial port
+    int master = posix_openpt (O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt (master) != 0 || unlockpt (master) != 0)
+    {
+        perror ("Can't open a pseudo-terminal");
+        return 1;
+    }
+    int slave = open (ptsname (master), O_RDWR | O_NOCTTY);
+    struct termios settings;
+    tcgetattr (slave, &settings);
+    cfmakeraw (&settings);
+    tcsetattr (slave, TCSANOW, &settings);
+    printf ("Sending %u rows of %u channels through %s\n", N_ROWS,
+            N_CHANNELS, ptsname (master));
+
+    uint64_t sent = 0;
+    uint32_t damaged = 0;
+    std::thread sender (send_rows, master, &sent, &damaged);
+
+    // The decoder's side: read until the sender is done and the pty is empty
+    CheckingDecoder decoder;
+    uint8_t buffer[4096];
+    uint64_t received = 0;
+    for (;;)
+    {
+        fd_set readable;
+        FD_ZERO (&readable);
+        FD_SET (slave, &readable);
+        struct timeval timeout = { 0, 200000 };
+        if (select (slave + 1, &readable, NULL, NULL, &timeout) <= 0)
+        {
+            break;
+        }
+        ssize_t got = read (slave, buffer, sizeof (buffer));
+        if (got <= 0)
+        {
+            break;
+        }
+        received += got;
+        decoder.feed (buffer, got);
+    }
+    sender.join ();
+
+    printf ("Bytes sent %llu, received %llu\n", (unsigned long long)sent,
+            (unsigned long long)received);
+    printf ("Frames: %u good, %u bad (%u damaged on purpose and 1 after "
+            "junk), %u lost, %u before schema\n", decoder.good_frames,
+            decoder.bad_frames, damaged, decoder.lost_frames,
+            decoder.skipped_frames);
+    printf ("Rows decoded %llu, wrong %u, last row %u\n",
+            (unsigned long long)decoder.rows, decoder.wrong,
+            decoder.last_row);
+
+    double binary_per_row = (double)sent / N_ROWS;
+    double text_per_row = (double)decoder.text_bytes / decoder.rows;
+    printf ("Bytes per row: %.2f binary, %.2f as text (%.1f times as many)\n",
+            binary_per_row, text_per_row, text_per_row / binary_per_row);
+    printf ("Values per second at 115200 baud: %.0f binary, %.0f as text\n",
+            11520.0 / binary_per_row * N_CHANNELS,
+            11520.0 / text_per_row * N_CHANNELS);
+
+    close (slave);
+    close (master);
+
+    bool passed = decoder.wrong == 0 && decoder.bad_frames == damaged + 1
+                  && decoder.rows > 0 && decoder.last_row == N_ROWS - 1;
+    printf ("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+//*****************************************************************************
+/** @file    workpool_bench.cpp
+ *  @brief   Tests the work-stealing scheduler on a PC and measures how well it
+ *           scales as worker threads are added.
+ *  @details This program runs the scheduler from @c src/worksteal.h with
+ *           @c std::thread workers in place of FreeRTOS tasks. It computes the
+ *           magnitude spectrum of a test signal with a slow, direct discrete
+ *           Fourier transform, first in one thread and then with pools of 1,
+ *           2, 4 and more workers, checks that every result matches the
+ *           single-threaded one, and prints the time taken, the speedup and
+ *           the number of pieces of work stolen. It then runs nested loops to
+ *           check that fork-join calls from inside workers finish correctly.
+ *
+ *           To compile and run from the top directory of this repository:
+ *           @code
+ *           g++ -O2 -std=gnu++17 -pthread -Isrc host/workpool_bench.cpp \
+ *               src/worksteal.cpp -o workpool_bench
+ *           ./workpool_bench
+ *           @endcode
+ *           A number given on the command line is used in place of the number
+ *           of processors in the PC, to try more threads than it has.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "worksteal.h"
+
+
+/// Number of samples in the test signal; the DFT takes N^2 steps
+const uint32_t N_SAMPLES = 4096;
+
+/// Number of frequency bins computed in each piece of work
+const uint32_t GRAIN = 16;
+
+
+/// The data on which the DFT loop works
+struct Spectrum
+{
+    const float* p_signal;                ///< Samples of the test signal
+    float* p_magnitude;                   ///< Magnitude of each bin
+};
+
+
+/** @brief   Compute the magnitudes of a range of DFT bins.
+ *  @param   p_context A pointer to the @c Spectrum being computed
+ *  @param   begin The first bin
+ *  @param   end One past the last bin
+ */
+static void dft_bins (void* p_context, uint32_t begin, uint32_t end)
+{
+    Spectrum* p_spectrum = (Spectrum*)p_context;
+    for (uint32_t bin = begin; bin < end; bin++)
+    {
+        double real = 0.0, imaginary = 0.0;
+        for (uint32_t sample = 0; sample < N_SAMPLES; sample++)
+        {
+            double angle = 2.0 * M_PI * bin * sample / N_SAMPLES;
+            real += p_spectrum->p_signal[sample] * cos (angle);
+            imaginary -= p_spectrum->p_signal[sample] * sin (angle);
+        }
+        p_spectrum->p_magnitude[bin] = (float)sqrt (real * real
+                                                    + imaginary * imaginary);
+    }
+}
+
+
+/** @brief   A scheduler whose threads yield the processor while waiting.
+ *  @details On a microcontroller @c WorkPool makes waiting tasks block; on a
+ *           PC, yielding is good enough for measurements.
+ */
+class HostStealer : public WorkStealer
+{
+protected:
+    void sleep_worker (uint8_t self)
+    {
+        (void)self;
+        std::this_thread::yield ();
+    }
+    void wait_for_job (uint8_t self)
+    {
+        (void)self;
+        std::this_thread::yield ();
+    }
+
+public:
+    HostStealer (uint8_t n_workers) : WorkStealer (n_workers)
+    {
+    }
+};
+
+
+/// Context for the nested loop test: each outer index runs an inner loop
+struct Nested
+{
+    HostStealer* p_stealer;               ///< Scheduler used for inner loops
+    std::vector<std::atomic<uint32_t>>* p_hits;  ///< Count of each index
+    thread_local static uint8_t self;     ///< Index of the running thread
+};
+thread_local uint8_t Nested::self = 0;
+
+
+/** @brief   Count one hit for each index in a range of the inner loop.
+ */
+static void inner_loop (void* p_context, uint32_t begin, uint32_t end)
+{
+    Nested* p_nested = (Nested*)p_context;
+    for (uint32_t index = begin; index < end; index++)
+    {
+        (*(p_nested->p_hits))[index]++;
+    }
+}
+
+
+/** @brief   Run an inner loop in parallel for each index of the outer loop.
+ */
+static void outer_loop (void* p_context, uint32_t begin, uint32_t end)
+{
+    Nested* p_nested = (Nested*)p_context;
+    for (uint32_t index = begin; index < end; index++)
+    {
+        p_nested->p_stealer->parallel_for (Nested::self, 0, 1000, 10,
+                                           inner_loop, p_context);
+    }
+}
+
+
+/** @brief   Run a function with a pool of worker threads, timing it.
+ *  @param   n_workers The number of worker threads to create
+ *  @param   p_stealer A pointer to a scheduler with that many workers
+ *  @param   job A function which runs the parallel loop
+ *  @returns The time taken by the job, in seconds
+ */
+template <class Job>
+static double run_with_workers (uint8_t n_workers, HostStealer* p_stealer,
+                                Job job)
+{
+    std::atomic<bool> stop (false);
+    std::vector<std::thread> workers;
+    for (uint8_t index = 0; index < n_workers; index++)
+    {
+        workers.emplace_back ([=, &stop] ()
+        {
+            Nested::self = index;
+            while (!stop.load ())
+            {
+                p_stealer->work (index);
+            }
+        });
+    }
+
+    Nested::self = p_stealer->get_outside_index ();
+    auto start = std::chrono::steady_clock::now ();
+    job ();
+    auto finish = std::chrono::steady_clock::now ();
+
+    stop = true;
+    for (std::thread& worker : workers)
+    {
+        worker.join ();
+    }
+    return std::chrono::duration<double> (finish - start).count ();
+}
+
+
+int main (int argc, char** argv)
+{
+    std::vector<float> signal (N_SAMPLES);
+    for (uint32_t sample = 0; sample < N_SAMPLES; sample++)
+    {
+        signal[sample] = sin (2.0 * M_PI * 50.0 * sample / N_SAMPLES)
+                         + 0.5 * sin (2.0 * M_PI * 311.0 * sample / N_SAMPLES);
+    }
+
+    // Compute the reference spectrum in one thread, without the scheduler
+    std::vector<float> reference (N_SAMPLES);
+    Spectrum serial = {signal.data (), reference.data ()};
+    auto start = std::chrono::steady_clock::now ();
+    dft_bins (&serial, 0, N_SAMPLES);
+    double serial_time = std::chrono::duration<double> 
+        (std::chrono::steady_clock::now () - start).count ();
+    printf ("DFT of %u samples, %u bins per piece\n", N_SAMPLES, GRAIN);
+    printf ("serial          %8.3f s\n", serial_time);
+
+    // The number of processors can be given on the command line to try
+    // more threads than the PC has
+    unsigned n_cpus = std::thread::hardware_concurrency ();
+    if (argc > 1)
+    {
+        n_cpus = (unsigned)atoi (argv[1]);
+    }
+    bool all_ok = true;
+    for (unsigned n_workers = 1; n_workers <= 2 * n_cpus && n_workers <= 16;
+         n_workers *= 2)
+    {
+        // The calling thread also works, so use one fewer worker thread
+        HostStealer stealer (n_workers - 1);
+        std::vector<float> magnitude (N_SAMPLES, -1.0f);
+        Spectrum parallel = {signal.data (), magnitude.data ()};
+
+        double elapsed = run_with_workers (n_workers - 1, &stealer, [&] ()
+        {
+            stealer.parallel_for (stealer.get_outside_index (), 0, N_SAMPLES,
+                                  GRAIN, dft_bins, &parallel);
+        });
+
+        bool ok = (magnitude == reference);
+        all_ok = all_ok && ok;
+        printf ("%2u thread%s      %8.3f s  speedup %5.2f  pieces %4u  "
+                "stolen %4u  %s\n", n_workers, n_workers == 1 ? " " : "s",
+                elapsed, serial_time / elapsed, stealer.get_done (),
+                stealer.get_stolen (), ok ? "OK" : "WRONG");
+    }
+
+    // Nested fork-join: 200 outer indices each run a 1000-index inner loop
+    uint8_t n_workers = (n_cpus > 1) ? n_cpus - 1 : 1;
+    HostStealer stealer (n_workers);
+    std::vector<std::atomic<uint32_t>> hits (1000);
+    Nested nested = {&stealer, &hits};
+    run_with_workers (n_workers, &stealer, [&] ()
+    {
+        stealer.parallel_for (stealer.get_outside_index (), 0, 200, 1,
+                              outer_loop, &nested);
+    });
+    bool nested_ok = true;
+    for (std::atomic<uint32_t>& count : hits)
+    {
+        nested_ok = nested_ok && (count.load () == 200);
+    }
+    all_ok = all_ok && nested_ok;
+    printf ("nested loops    %u jobs, stolen %u  %s\n", stealer.get_jobs (),
+            stealer.get_stolen (), nested_ok ? "OK" : "WRONG");
+
+    return all_ok ? 0 : 1;
+}
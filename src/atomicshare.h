@@ -0,0 +1,440 @@
+//*****************************************************************************
+/** @file    atomicshare.h
+ *  @brief   Counters and sets of flags which tasks and interrupt service
+ *           routines can change safely without locks.
+ *  @details This file contains two classes of shared data which are changed
+ *           by single atomic operations rather than by a @c get() followed
+ *           by a @c put(). A @c Share<uint32_t> used as a counter has a race:
+ *           if an ISR or another task changes the value between one task's
+ *           @c get() and @c put(), that change is lost. A @c CounterShare
+ *           does the whole read, add and write as one operation, and a 
+ *           @c FlagShare does the same for setting and clearing bits.
+ *
+ *           On the Cortex-M4 these operations use the @c LDREX and @c STREX
+ *           instructions and on the ESP32 they use @c S32C1I, so they never
+ *           disable interrupts or block and may be used anywhere, including
+ *           in ISR's. They work on items of up to 32 bits; larger ones would
+ *           need locks on these processors, so they're not allowed.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _ATOMICSHARE_H_
+#define _ATOMICSHARE_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include <type_traits>
+#include "baseshare.h"
+
+
+/** @brief   Class for a counter which tasks and ISR's can change safely.
+ *  @details Each method reads and changes the count in one atomic operation,
+ *           so counts made by different tasks and ISR's are never lost. 
+ *           Every method may be called from an ISR.
+ *
+ *           @section usage_counter Usage
+ *           @code
+ *           #include "atomicshare.h"
+ *           ...
+ *           /// Counts encoder index pulses
+ *           CounterShare<uint32_t> index_count ("Index");
+ *           @endcode
+ *           In an ISR:
+ *           @code
+ *           index_count++;                      // or index_count.add ();
+ *           @endcode
+ *           In a task, to get the count and start again from zero:
+ *           @code
+ *           uint32_t pulses = index_count.exchange (0);
+ *           @endcode
+ *  @tparam  DataType An integer type of at most 32 bits
+ */
+template <class DataType = uint32_t>
+class CounterShare : public BaseShare
+{
+    static_assert (std::is_integral<DataType>::value,
+                   "CounterShare holds integers only");
+    static_assert (sizeof (DataType) <= sizeof (uint32_t),
+                   "CounterShare can't be lock-free for items over 32 bits");
+
+protected:
+    std::atomic<DataType> count;          ///< The count itself
+
+public:
+    /** @brief   Create a counter share.
+     *  @param   p_name A name for the counter, shown by @c print_all_shares()
+     *  @param   initial The value with which the count starts (default 0)
+     */
+    CounterShare (const char* p_name = NULL, DataType initial = 0)
+        : BaseShare (p_name), count (initial)
+    {
+    }
+
+    /** @brief   Add to the count.
+     *  @param   amount The amount to add (default 1)
+     *  @returns The count before the amount was added
+     */
+    DataType add (DataType amount = 1)
+    {
+        return count.fetch_add (amount);
+    }
+
+    /** @brief   Subtract from the count.
+     *  @param   amount The amount to subtract (default 1)
+     *  @returns The count before the amount was subtracted
+     */
+    DataType subtract (DataType amount = 1)
+    {
+        return count.fetch_sub (amount);
+    }
+
+    /** @brief   Replace the count with a new value.
+     *  @details A task which reads and clears a tally of events with
+     *           @c exchange(0) can't miss any events counted in between.
+     *  @param   new_count The new value of the count
+     *  @returns The count before it was replaced
+     */
+    DataType exchange (DataType new_count)
+    {
+        return count.exchange (new_count);
+    }
+
+    /** @brief   Replace the count only if it has an expected value.
+     *  @param   expected The value the count must have to be replaced; if it
+     *           has another value, that value is put here
+     *  @param   new_count The new value of the count
+     *  @returns @c true if the count was replaced, @c false if not
+     */
+    bool compare_exchange (DataType& expected, DataType new_count)
+    {
+        return count.compare_exchange_strong (expected, new_count);
+    }
+
+    /** @brief   Set the count to a new value.
+     *  @param   new_count The new value of the count
+     */
+    void put (DataType new_count)
+    {
+        count.store (new_count);
+    }
+
+    /** @brief   Return the count.
+     *  @returns The value of the count
+     */
+    DataType get (void)
+    {
+        return count.load ();
+    }
+
+    /** @brief   Operator which adds one to the count.
+     *  @returns The count after being incremented
+     */
+    DataType operator ++ (void)
+    {
+        return count.fetch_add (1) + 1;
+    }
+
+    /** @brief   Operator which adds one to the count.
+     *  @returns The count before being incremented
+     */
+    DataType operator ++ (int)
+    {
+        return count.fetch_add (1);
+    }
+
+    /** @brief   Operator which subtracts one from the count.
+     *  @returns The count after being decremented
+     */
+    DataType operator -- (void)
+    {
+        return count.fetch_sub (1) - 1;
+    }
+
+    /** @brief   Operator which subtracts one from the count.
+     *  @returns The count before being decremented
+     */
+    DataType operator -- (int)
+    {
+        return count.fetch_sub (1);
+    }
+
+    /** @brief   Operator which adds an amount to the count.
+     *  @param   amount The amount to add
+     *  @returns The count after the amount was added
+     */
+    DataType operator += (DataType amount)
+    {
+        return count.fetch_add (amount) + amount;
+    }
+
+    /** @brief   Operator which subtracts an amount from the count.
+     *  @param   amount The amount to subtract
+     *  @returns The count after the amount was subtracted
+     */
+    DataType operator -= (DataType amount)
+    {
+        return count.fetch_sub (amount) - amount;
+    }
+
+    /** @brief   Operator which sets the count, in the way of @c Share.
+     *  @param   new_count The new value of the count
+     */
+    void operator << (DataType new_count)
+    {
+        count.store (new_count);
+    }
+
+    /** @brief   Operator which reads the count, in the way of @c Share.
+     *  @param   put_here Reference to a variable into which the count is put
+     */
+    void operator >> (DataType& put_here)
+    {
+        put_here = count.load ();
+    }
+
+    /** @brief   Return the type of value this counter holds.
+     *  @returns The @c ShareValueType code for @c DataType
+     */
+    uint8_t get_value_type (void)
+    {
+        return ShareType<DataType>::code;
+    }
+
+    /** @brief   Copy the count without changing it.
+     *  @param   p_value Pointer to a buffer big enough for a @c DataType
+     *  @returns @c true, as a counter always has a value
+     */
+    bool peek_value (void* p_value)
+    {
+        DataType value = count.load ();
+        memcpy (p_value, &value, sizeof (DataType));
+        return true;
+    }
+
+    /** @brief   Set the count.
+     *  @param   p_value Pointer to a @c DataType value
+     *  @returns @c true, as a counter can always be set
+     */
+    bool put_value (const void* p_value)
+    {
+        DataType value;
+        memcpy (&value, p_value, sizeof (DataType));
+        put (value);
+        return true;
+    }
+
+    /** @brief   Print the counter's name, type and value within a list.
+     *  @param   printer Reference to a serial device on which to print
+     */
+    void print_in_list (Print& printer)
+    {
+        printer.printf ("%-16scounter\t", name);
+
+        // Widen the count so 8-bit counts aren't printed as characters
+        if (std::is_signed<DataType>::value)
+        {
+            printer << (int32_t)count.load () << endl;
+        }
+        else
+        {
+            printer << (uint32_t)count.load () << endl;
+        }
+    }
+};
+
+
+/** @brief   Class for a set of up to 32 flags which tasks and ISR's can set
+ *           and clear safely.
+ *  @details Each flag is one bit. Each method reads and changes the bits in
+ *           one atomic operation, so a flag set by an ISR while a task is
+ *           clearing other flags isn't lost. Every method may be called from
+ *           an ISR. Unlike an @c EventGroup, a @c FlagShare can't make a task
+ *           wait for a flag, but it is much quicker to use.
+ *
+ *           @section usage_flags Usage
+ *           @code
+ *           #include "atomicshare.h"
+ *           ...
+ *           const uint32_t FAULT_OVERCURRENT = (1 << 0);
+ *           const uint32_t FAULT_OVERTEMP = (1 << 1);
+ *
+ *           /// Faults found by the motor ISR and cleared by the UI task
+ *           FlagShare motor_faults ("Faults");
+ *           @endcode
+ *           In an ISR:
+ *           @code
+ *           motor_faults.set (FAULT_OVERCURRENT);
+ *           @endcode
+ *           In a task, to find and acknowledge faults:
+ *           @code
+ *           uint32_t faults = motor_faults.test_and_clear (0xFFFFFFFF);
+ *           @endcode
+ */
+class FlagShare : public BaseShare
+{
+protected:
+    std::atomic<uint32_t> flags;          ///< The flags, one per bit
+
+public:
+    /** @brief   Create a set of flags.
+     *  @param   p_name A name for the flags, shown by @c print_all_shares()
+     *  @param   initial The flags which are set at first (default none)
+     */
+    FlagShare (const char* p_name = NULL, uint32_t initial = 0)
+        : BaseShare (p_name), flags (initial)
+    {
+    }
+
+    /** @brief   Set flags.
+     *  @param   bits The flags to be set
+     *  @returns The flags before these were set
+     */
+    uint32_t set (uint32_t bits)
+    {
+        return flags.fetch_or (bits);
+    }
+
+    /** @brief   Clear flags.
+     *  @param   bits The flags to be cleared
+     *  @returns The flags before these were cleared
+     */
+    uint32_t clear (uint32_t bits)
+    {
+        return flags.fetch_and (~bits);
+    }
+
+    /** @brief   Change flags which are set to clear and vice versa.
+     *  @param   bits The flags to be changed
+     *  @returns The flags before these were changed
+     */
+    uint32_t toggle (uint32_t bits)
+    {
+        return flags.fetch_xor (bits);
+    }
+
+    /** @brief   Check whether any of the given flags is set.
+     *  @param   bits The flags to check
+     *  @returns @c true if any of the flags is set
+     */
+    bool test (uint32_t bits)
+    {
+        return (flags.load () & bits) != 0;
+    }
+
+    /** @brief   Check whether all of the given flags are set.
+     *  @param   bits The flags to check
+     *  @returns @c true if all of the flags are set
+     */
+    bool test_all (uint32_t bits)
+    {
+        return (flags.load () & bits) == bits;
+    }
+
+    /** @brief   Clear flags and find which of them had been set.
+     *  @details Because this is one operation, a flag which is set just after
+     *           this call stays set for the next one rather than being lost.
+     *  @param   bits The flags to be cleared
+     *  @returns Those of the given flags which had been set
+     */
+    uint32_t test_and_clear (uint32_t bits)
+    {
+        return flags.fetch_and (~bits) & bits;
+    }
+
+    /** @brief   Replace all the flags at once.
+     *  @param   new_flags The new values of all the flags
+     */
+    void put (uint32_t new_flags)
+    {
+        flags.store (new_flags);
+    }
+
+    /** @brief   Return all the flags.
+     *  @returns All the flags, one per bit
+     */
+    uint32_t get (void)
+    {
+        return flags.load ();
+    }
+
+    /** @brief   Operator which sets flags.
+     *  @param   bits The flags to be set
+     */
+    void operator << (uint32_t bits)
+    {
+        flags.fetch_or (bits);
+    }
+
+    /** @brief   Operator which reads all the flags.
+     *  @param   put_here Reference to a variable into which the flags are put
+     */
+    void operator >> (uint32_t& put_here)
+    {
+        put_here = flags.load ();
+    }
+
+    /** @brief   Return the type of value this set of flags holds.
+     *  @returns @c SHARE_U32, as the flags are bits in a 32-bit number
+     */
+    uint8_t get_value_type (void)
+    {
+        return SHARE_U32;
+    }
+
+    /** @brief   Copy all the flags without changing them.
+     *  @param   p_value Pointer to a buffer big enough for a @c uint32_t
+     *  @returns @c true, as a set of flags always has a value
+     */
+    bool peek_value (void* p_value)
+    {
+        uint32_t value = flags.load ();
+        memcpy (p_value, &value, sizeof (uint32_t));
+        return true;
+    }
+
+    /** @brief   Set all the flags at once.
+     *  @param   p_value Pointer to a @c uint32_t holding the new flags
+     *  @returns @c true, as flags can always be set
+     */
+    bool put_value (const void* p_value)
+    {
+        uint32_t value;
+        memcpy (&value, p_value, sizeof (uint32_t));
+        put (value);
+        return true;
+    }
+
+    /** @brief   Print the flags' name, type and value within a list.
+     *  @param   printer Reference to a serial device on which to print
+     */
+    void print_in_list (Print& printer)
+    {
+        printer.printf ("%-16sflags\t0x%08lX", name,
+                        (unsigned long)flags.load ());
+        printer << endl;
+    }
+};
+
+#endif // _ATOMICSHARE_H_
@@ -51,6 +51,7 @@ BaseShare::BaseShare (const char* p_name)
         uint8_t namelength = strlen (p_name);
         namelength = (namelength <= 15) ? namelength : 15;
         strncpy (name, p_name, namelength);
+        name[namelength] = '\0';
     }
     else
     {
@@ -60,15 +61,85 @@ BaseShare::BaseShare (const char* p_name)
     // Install this share in the linked list of shares
     p_next = p_newest;
     p_newest = this;
+    p_listeners = NULL;
 }
 
 
-/** @brief   Start the printout showing the status of all shared data items.
- *  @details This method begins printing out the status of all items in the 
- *           system's linked list of shared data items (queues, task shares, 
- *           and so on). The most recently created share's status is printed
- *           first, followed by the status of other shares in reverse order of
- *           creation. 
+/** @brief   Attach a listener which is told whenever data is put in.
+ *  @details Listeners should be attached while setting things up, before 
+ *           tasks and ISR's begin putting data into this item. The newest
+ *           listener is told first.
+ *  @param   p_listener Pointer to the listener, which must not already be
+ *           attached to any share
+ */
+void BaseShare::add_listener (ShareListener* p_listener)
+{
+    p_listener->p_next_listener = p_listeners;
+    p_listeners = p_listener;
+}
+
+
+/** @brief   Detach a listener so it's no longer told about puts.
+ *  @details A put running in another task at the same moment may still call
+ *           the listener once, so it must not be destroyed right away.
+ *  @param   p_listener Pointer to the listener
+ */
+void BaseShare::remove_listener (ShareListener* p_listener)
+{
+    for (ShareListener** pp_link = &p_listeners; *pp_link != NULL;
+         pp_link = &((*pp_link)->p_next_listener))
+    {
+        if (*pp_link == p_listener)
+        {
+            *pp_link = p_listener->p_next_listener;
+            return;
+        }
+    }
+}
+
+
+/** @brief   Find a shared data item in the list by its name.
+ *  @details This function looks through the system's linked list of shared
+ *           data items for one with the given name. If a class tag is given,
+ *           only items whose @c get_class_tag() method returns the same tag
+ *           will match, so the caller can safely cast the pointer which is
+ *           returned to a pointer of the class to which the tag belongs. 
+ *           Because the list is searched one item at a time, this function
+ *           should be used while setting things up, not in a fast loop. 
+ *  @param   p_name The name of the item to be found
+ *  @param   p_class_tag A class tag which the item must have, or @c NULL to
+ *           match an item of any class (default @c NULL)
+ *  @returns A pointer to the most recently created matching item, or 
+ *           @c NULL if no item matches
+ */
+BaseShare* BaseShare::find (const char* p_name, const void* p_class_tag)
+{
+    if (p_name == NULL)
+    {
+        return NULL;
+    }
+    for (BaseShare* p_share = p_newest; p_share != NULL; 
+         p_share = p_share->p_next)
+    {
+        if (strncmp (p_share->name, p_name, 15) == 0
+            && (p_class_tag == NULL 
+                || p_share->get_class_tag () == p_class_tag))
+        {
+            return p_share;
+        }
+    }
+    return NULL;
+}
+
+
+/** @brief   Print a table showing the status of all shared data items.
+ *  @details This function prints the status of all items in the system's 
+ *           linked list of shared data items (queues, task shares, and so 
+ *           on). The most recently created share's status is printed first,
+ *           followed by the status of other shares in reverse order of
+ *           creation. The list is walked in a loop rather than by having 
+ *           each item call the next one, so printing a long list doesn't use
+ *           up the printing task's stack. 
  *  @param   printer Pointer to a serial device on which to print
  */
 void print_all_shares (Print& printer)
@@ -76,5 +147,9 @@ void print_all_shares (Print& printer)
     printer.println ("Share/Queue     Type    Max. Full");
     printer.println ("-----------     ----    ---------");
 
-    BaseShare::p_newest->print_in_list (printer);
+    for (BaseShare* p_share = BaseShare::p_newest; p_share != NULL; 
+         p_share = p_share->p_next)
+    {
+        p_share->print_in_list (printer);
+    }
 }
@@ -11,6 +11,10 @@
  *
  *  @date 2014-Oct-18 JRR Created file
  *  @date 2020-Oct-19 JRR Modified for use with Arduino/FreeRTOS platform
+ *  @date 2026-Oct-17 Added methods which read values of any type of share
+ *  @date 2026-Oct-17 Added listeners which are told when data is put in
+ *  @date 2026-Oct-17 Added methods which write values and reset statistics
+ *  @date 2026-Oct-17 Added @c is_queue() so samplers can refuse queues
  *
  *  License:
  *    This file is copyright 2014 - 2020 by JR Ridgely and released under the
@@ -34,6 +38,7 @@
 #define _BASESHARE_H_
 
 #include <Arduino.h>
+#include "sharetype.h"
 
 // Different functions are used in STM32's and ESP32's to determine if the CPU
 // is currently running within an interrupt service routine
@@ -44,6 +49,47 @@
 #endif
 
 
+class BaseShare;
+
+
+/** @brief   Base class for objects which are told whenever data is put into
+ *           a share.
+ *  @details A listener is attached to a share with 
+ *           @c BaseShare::add_listener(). From then on, each time data is
+ *           put into the share, the listener's @c on_put() method is called
+ *           with a pointer to the new data. This lets tools such as captures
+ *           and recorders watch shares without the tasks which use those
+ *           shares being changed. A share may have several listeners; they
+ *           are kept in a linked list through the listeners themselves, so
+ *           each listener object can listen to only one share.
+ */
+class ShareListener
+{
+    friend class BaseShare;
+
+protected:
+    /// The next listener attached to the same share, or @c NULL
+    ShareListener* p_next_listener;
+
+public:
+    /** @brief   Create a listener which isn't yet attached to a share.
+     */
+    ShareListener (void) : p_next_listener (NULL)
+    {
+    }
+
+    /** @brief   Respond to data being put into a share.
+     *  @details This method runs in whatever task or ISR put the data, 
+     *           before the put returns, so it must be quick, mustn't block,
+     *           and must be safe to run in an ISR.
+     *  @param   p_share Pointer to the share into which data was put
+     *  @param   p_value Pointer to the data which was put in, whose type is
+     *           given by @c p_share->get_value_type()
+     */
+    virtual void on_put (BaseShare* p_share, const void* p_value) = 0;
+};
+
+
 /** @brief   Base class for classes that share data in a thread-safe manner 
  *           between tasks.
  *  @details This is a base class for classes which share data between tasks
@@ -77,6 +123,24 @@ class BaseShare
          */
         static BaseShare* p_newest;
 
+        /// The first of the listeners which are told about puts, or @c NULL
+        ShareListener* p_listeners;
+
+        /** @brief   Tell each listener that data has been put into this item.
+         *  @details Descendent classes call this method from each method 
+         *           which puts data in. If there are no listeners, it takes
+         *           only a test of one pointer.
+         *  @param   p_value Pointer to the data which was put in
+         */
+        void notify_put (const void* p_value)
+        {
+            for (ShareListener* p_listener = p_listeners; p_listener != NULL;
+                 p_listener = p_listener->p_next_listener)
+            {
+                p_listener->on_put (this, p_value);
+            }
+        }
+
     public:
         // Construct a base shared data item
         BaseShare (const char* p_name = NULL);
@@ -86,11 +150,132 @@ class BaseShare
          *           item, such as the value of a shared variable or how full a
          *           queue's buffer is. This method must be overridden in each
          *           descendent class with a method that actually @e does 
-         *           something. 
+         *           something. It prints one line for this item only; the
+         *           function @c print_all_shares() walks through the list.
          *  @param   printer Reference to a serial device on which to print 
          */
         virtual void print_in_list (Print& printer) = 0;
 
+        /** @brief   Return a tag which identifies the class of this item.
+         *  @details Classes whose objects are looked up by name, such as 
+         *           topics, override this method to return the address of a
+         *           static variable which belongs only to that class (and to
+         *           that template instantiation). Comparing tags lets 
+         *           @c find() check the type of an item without needing C++ 
+         *           run-time type information, which is usually turned off on
+         *           microcontrollers. 
+         *  @returns A pointer which is unique to the class, or @c NULL for
+         *           classes which don't need to be identified
+         */
+        virtual const void* get_class_tag (void)
+        {
+            return NULL;
+        }
+
+        /** @brief   Return the type of value this item holds.
+         *  @details Items such as shares which hold one current value of a
+         *           plain numeric type override this method and 
+         *           @c peek_value() so that code such as telemetry senders can
+         *           read the value without knowing the item's C++ type.
+         *  @returns One of the @c ShareValueType codes, or @c SHARE_NONE if
+         *           this item's value can't be read this way
+         */
+        virtual uint8_t get_value_type (void)
+        {
+            return SHARE_NONE;
+        }
+
+        /** @brief   Copy this item's current value without changing it.
+         *  @details This method must not block. It may not be called from
+         *           within an ISR.
+         *  @param   p_value Pointer to a buffer with room for a value of the
+         *           size given by @c share_type_size (get_value_type ())
+         *  @returns @c true if a value was copied, @c false if this item has
+         *           no value yet or its values can't be read this way
+         */
+        virtual bool peek_value (void* p_value)
+        {
+            (void)p_value;
+            return false;
+        }
+
+        /** @brief   Tell whether this item is a queue.
+         *  @details A queue's @c peek_value() copies the item at its head,
+         *           which isn't a current value as a share's is. Code which
+         *           samples values from time to time, such as a telemetry
+         *           sender, uses this method to refuse queues.
+         *  @returns @c true for queues, @c false for shares
+         */
+        virtual bool is_queue (void)
+        {
+            return false;
+        }
+
+        /** @brief   Put a value into this item without waiting.
+         *  @details Items which override @c peek_value() usually override
+         *           this method too, so that a value of the type given by
+         *           @c get_value_type() can be written without knowing the
+         *           item's C++ type, for instance from a command shell. It
+         *           may not be called from within an ISR.
+         *  @param   p_value Pointer to the value to be put in
+         *  @returns @c true if the value was put in, @c false if it couldn't
+         *           be, for instance because a queue is full
+         */
+        virtual bool put_value (const void* p_value)
+        {
+            (void)p_value;
+            return false;
+        }
+
+        /** @brief   Start this item's statistics over again.
+         *  @details Items which keep track of things such as how full a
+         *           queue has been or how many times data was put in
+         *           override this method to reset them. The data itself
+         *           isn't changed. It may not be called from within an ISR.
+         */
+        virtual void reset_stats (void)
+        {
+        }
+
+        /** @brief   Return the name of this shared data item.
+         *  @returns A pointer to the item's name, which is at most 15 
+         *           characters long
+         */
+        const char* get_name (void)
+        {
+            return name;
+        }
+
+        /** @brief   Return the most recently created shared data item.
+         *  @details This method and @c get_next() let programs such as 
+         *           command shells walk through the list of all shares.
+         *  @returns A pointer to the newest item, or @c NULL if there are
+         *           no items
+         */
+        static BaseShare* get_newest (void)
+        {
+            return p_newest;
+        }
+
+        /** @brief   Return the item which was created before this one.
+         *  @returns A pointer to the next item in the list of all shared
+         *           data items, or @c NULL if this is the oldest one
+         */
+        BaseShare* get_next (void)
+        {
+            return p_next;
+        }
+
+        // Attach a listener which is told whenever data is put in
+        void add_listener (ShareListener* p_listener);
+
+        // Detach a listener
+        void remove_listener (ShareListener* p_listener);
+
+        // Find a shared data item in the list by its name
+        static BaseShare* find (const char* p_name, 
+                                const void* p_class_tag = NULL);
+
         // }
         friend void print_all_shares (Print& printer);
 };
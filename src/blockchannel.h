@@ -0,0 +1,443 @@
+//*****************************************************************************
+/** @file    blockchannel.h
+ *  @brief   A double (ping-pong) or N-buffer channel which passes whole blocks
+ *           of data from a producer to a consumer without copying them.
+ *  @details Producers which make data in blocks, such as DMA transfers and
+ *           burst reads from sensors, don't fit well with @c Queue, which
+ *           copies items one at a time. This file contains a class which owns
+ *           a set of equal-sized blocks. The producer fills one block while
+ *           the consumer works on another, and ownership of blocks is passed
+ *           back and forth by changing each block's state, so the data itself
+ *           is never copied. Blocks are handed out as @c Span objects.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _BLOCKCHANNEL_H_
+#define _BLOCKCHANNEL_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+#include "span.h"
+
+
+/** @brief   States of the blocks in a block channel.
+ */
+enum BlockState
+{
+    BLOCK_FREE,         ///< Nobody is using the block
+    BLOCK_FILLING,      ///< The producer is filling the block
+    BLOCK_READY,        ///< The block is full, waiting for the consumer
+    BLOCK_READING       ///< The consumer is working on the block
+};
+
+
+/** @brief   Implements a channel which passes blocks of data from one
+ *           producer to one consumer without copying.
+ *  @details The channel owns a number of blocks, each holding the same
+ *           number of items. Two blocks make a ping-pong buffer; more blocks
+ *           let the consumer fall further behind before data is lost. 
+ *
+ *           The producer, which may be a task or an ISR, always owns one
+ *           block. It gets that block from @c write_block(), fills it, and
+ *           calls @c commit() (or @c ISR_commit() in an ISR) to hand it to
+ *           the consumer and take the next free block. If no block is free
+ *           because the consumer has fallen behind, the oldest full block
+ *           which the consumer hasn't started on is taken back and reused,
+ *           losing its data; if there's no such block either, the block just
+ *           filled is kept and refilled. Either way, one block of data is
+ *           lost and counted as an overrun. 
+ *
+ *           The consumer task calls @c acquire() to get the oldest full
+ *           block, waiting for one if necessary, works on the data in place,
+ *           and then calls @c release() to give the block back. The consumer
+ *           may hold more than one block at a time if there are more than two
+ *           blocks, but it must release each one eventually. 
+ *
+ *           A DMA transfer can fill blocks directly: the DMA is started to
+ *           fill @c write_block(), and its transfer complete callback calls
+ *           @c ISR_commit() and then restarts the DMA on the new
+ *           @c write_block().
+ *
+ *           The number of blocks passed, the largest number of full blocks
+ *           which have waited for the consumer, and the number of overruns
+ *           are shown by @c print_all_shares().
+ *
+ *           @section block_usage Usage
+ *           @code
+ *           #include "blockchannel.h"
+ *           ...
+ *           /// Ping-pong buffer of 256 samples for each burst from the IMU
+ *           BlockChannel<int16_t> imu_blocks (2, 256, "IMU");
+ *           @endcode
+ *           In the producer:
+ *           @code
+ *           Span<int16_t> block = imu_blocks.write_block ();
+ *           imu.read_burst (block.data (), block.size ());
+ *           imu_blocks.commit ();
+ *           @endcode
+ *           In the consumer task:
+ *           @code
+ *           Span<int16_t> samples = imu_blocks.acquire ();
+ *           filter.process (samples.data (), samples.size ());
+ *           imu_blocks.release (samples);
+ *           @endcode
+ */
+template <class DataType> class BlockChannel : public BaseShare
+{
+protected:
+    DataType* p_storage;                  ///< Memory for all the blocks
+    std::atomic<uint8_t>* p_states;       ///< A @c BlockState for each block
+    uint32_t* p_sequence;                 ///< Order in which blocks filled
+    uint16_t* p_lengths;                  ///< Items put into each block
+    uint8_t n_blocks;                     ///< Number of blocks
+    uint16_t block_size;                  ///< Number of items in a block
+    uint8_t filling;                      ///< Block the producer is filling
+    uint32_t committed;                   ///< Blocks committed so far
+    std::atomic<bool> waiting;            ///< Consumer is blocked for data
+    SemaphoreHandle_t data_signal;        ///< Wakes the blocked consumer
+    uint32_t overruns;                    ///< Blocks of data lost
+    uint8_t max_backlog;                  ///< Most full blocks waiting
+
+    // Hand the producer's block to the consumer and take another one
+    bool commit_block (uint16_t count, bool in_ISR);
+
+    // Find the oldest block which is full and waiting for the consumer
+    int16_t oldest_ready (void);
+
+public:
+    // Create a channel with the given number and size of blocks
+    BlockChannel (uint8_t blocks, uint16_t items_per_block,
+                  const char* p_name = NULL);
+
+    /** @brief   Return the block which the producer is to fill.
+     *  @details The block stays the same until @c commit() is called. The
+     *           span returned always covers the whole block.
+     *  @returns A span referring to the producer's block
+     */
+    Span<DataType> write_block (void)
+    {
+        if (!usable ())
+        {
+            return Span<DataType> ();
+        }
+        return Span<DataType> (p_storage + (uint32_t)filling * block_size,
+                               block_size);
+    }
+
+    /** @brief   Hand the block just filled to the consumer.
+     *  @details This method must @b not be called within an ISR; use
+     *           @c ISR_commit() there.
+     *  @param   count The number of items which were put into the block
+     *           (default: the whole block)
+     *  @returns @c true if the block was handed over without losing data,
+     *           @c false if a block of data was lost to an overrun
+     */
+    bool commit (uint16_t count = 0xFFFF)
+    {
+        return commit_block (count, false);
+    }
+
+    /** @brief   Hand the block just filled to the consumer from within an ISR.
+     *  @param   count The number of items which were put into the block
+     *           (default: the whole block)
+     *  @returns @c true if the block was handed over without losing data,
+     *           @c false if a block of data was lost to an overrun
+     */
+    bool ISR_commit (uint16_t count = 0xFFFF)
+    {
+        return commit_block (count, true);
+    }
+
+    // Get the oldest full block, waiting for one if necessary
+    Span<DataType> acquire (TickType_t wait_time = portMAX_DELAY);
+
+    // Give a block back to the channel when the consumer is done with it
+    void release (const Span<DataType>& block);
+
+    /** @brief   Return the number of blocks of data lost to overruns.
+     *  @returns The number of overruns
+     */
+    uint32_t get_overruns (void)
+    {
+        return overruns;
+    }
+
+    /** @brief   Indicates whether this channel is usable.
+     *  @details This method returns @c true if memory for the blocks and the
+     *           semaphore were successfully allocated.
+     *  @returns @c true if this channel is usable, @c false if not
+     */
+    bool usable (void)
+    {
+        return (p_storage != NULL && p_states != NULL && p_sequence != NULL
+                && p_lengths != NULL && data_signal != NULL);
+    }
+
+    // Print the channel's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+}; // class BlockChannel
+
+
+/** @brief   Create a block channel.
+ *  @details All the memory for the blocks is allocated here. The producer
+ *           starts out owning the first block. 
+ *  @param   blocks The number of blocks, at least 2
+ *  @param   items_per_block The number of items each block holds
+ *  @param   p_name A name for the channel, shown by @c print_all_shares()
+ */
+template <class DataType>
+BlockChannel<DataType>::BlockChannel (uint8_t blocks, uint16_t items_per_block,
+                                      const char* p_name)
+    : BaseShare (p_name)
+{
+    n_blocks = (blocks >= 2) ? blocks : 2;
+    block_size = items_per_block;
+    p_storage = new DataType[(uint32_t)n_blocks * block_size];
+    p_states = new std::atomic<uint8_t>[n_blocks];
+    p_sequence = new uint32_t[n_blocks];
+    p_lengths = new uint16_t[n_blocks];
+    data_signal = xSemaphoreCreateBinary ();
+    waiting = false;
+    filling = 0;
+    committed = 0;
+    overruns = 0;
+    max_backlog = 0;
+
+    if (usable ())
+    {
+        for (uint8_t index = 0; index < n_blocks; index++)
+        {
+            p_states[index] = BLOCK_FREE;
+            p_sequence[index] = 0;
+            p_lengths[index] = 0;
+        }
+        p_states[0] = BLOCK_FILLING;
+    }
+}
+
+
+/** @brief   Find the oldest block which is full and waiting for the consumer.
+ *  @returns The index of the block, or -1 if no block is waiting
+ */
+template <class DataType>
+int16_t BlockChannel<DataType>::oldest_ready (void)
+{
+    int16_t oldest = -1;
+    for (uint8_t index = 0; index < n_blocks; index++)
+    {
+        if (p_states[index].load (std::memory_order_acquire) == BLOCK_READY
+            && (oldest < 0 
+                || (int32_t)(p_sequence[index] - p_sequence[oldest]) < 0))
+        {
+            oldest = index;
+        }
+    }
+    return oldest;
+}
+
+
+/** @brief   Hand the producer's block to the consumer and take another one.
+ *  @details The next block in order is taken if it's free; otherwise any
+ *           free block is taken. If none is free, the oldest waiting block is
+ *           taken back from the consumer, or if none is waiting, the
+ *           producer keeps its block, and an overrun is counted.
+ *  @param   count The number of items which were put into the block
+ *  @param   in_ISR @c true if called from within an ISR
+ *  @returns @c true if no data was lost, @c false if there was an overrun
+ */
+template <class DataType>
+bool BlockChannel<DataType>::commit_block (uint16_t count, bool in_ISR)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+
+    // Look for a free block to fill next, starting with the next in order
+    int16_t next = -1;
+    for (uint8_t offset = 1; offset < n_blocks; offset++)
+    {
+        uint8_t index = (filling + offset) % n_blocks;
+        uint8_t expected = BLOCK_FREE;
+        if (p_states[index].compare_exchange_strong (expected, BLOCK_FILLING))
+        {
+            next = index;
+            break;
+        }
+    }
+
+    // If none is free, take back the oldest block the consumer hasn't started
+    bool lost = false;
+    if (next < 0)
+    {
+        overruns++;
+        lost = true;
+        int16_t oldest = oldest_ready ();
+        uint8_t expected = BLOCK_READY;
+        if (oldest >= 0 && p_states[oldest].compare_exchange_strong 
+                               (expected, BLOCK_FILLING))
+        {
+            next = oldest;
+        }
+        else
+        {
+            // Everything else is being read, so refill the same block
+            return false;
+        }
+    }
+
+    // Hand over the block just filled and move on to the next one
+    p_lengths[filling] = (count < block_size) ? count : block_size;
+    p_sequence[filling] = committed++;
+    p_states[filling].store (BLOCK_READY, std::memory_order_release);
+    filling = next;
+
+    uint8_t backlog = 0;
+    for (uint8_t index = 0; index < n_blocks; index++)
+    {
+        if (p_states[index].load (std::memory_order_relaxed) == BLOCK_READY)
+        {
+            backlog++;
+        }
+    }
+    if (backlog > max_backlog)
+    {
+        max_backlog = backlog;
+    }
+
+    if (waiting.exchange (false))
+    {
+        if (in_ISR)
+        {
+            BaseType_t wake_up;
+            xSemaphoreGiveFromISR (data_signal, &wake_up);
+        }
+        else
+        {
+            xSemaphoreGive (data_signal);
+        }
+    }
+    return !lost;
+}
+
+
+/** @brief   Get the oldest full block, waiting for one if necessary.
+ *  @details The block belongs to the consumer until it's given back with
+ *           @c release(). Only one task may acquire blocks from a channel,
+ *           and this method must @b not be called within an ISR.
+ *  @param   wait_time The longest time to wait for a block, in RTOS ticks
+ *           (default @c portMAX_DELAY, which means forever)
+ *  @returns A span referring to the items which were put into the block, or
+ *           an empty span if no block arrived within the wait time
+ */
+template <class DataType>
+Span<DataType> BlockChannel<DataType>::acquire (TickType_t wait_time)
+{
+    if (!usable ())
+    {
+        return Span<DataType> ();
+    }
+    TickType_t start = xTaskGetTickCount ();
+
+    for (;;)
+    {
+        int16_t oldest = oldest_ready ();
+        if (oldest >= 0)
+        {
+            uint8_t expected = BLOCK_READY;
+            if (p_states[oldest].compare_exchange_strong (expected,
+                                                          BLOCK_READING))
+            {
+                return Span<DataType> (p_storage 
+                                       + (uint32_t)oldest * block_size,
+                                       p_lengths[oldest]);
+            }
+            continue;               // The producer took it back; try again
+        }
+
+        TickType_t waited = xTaskGetTickCount () - start;
+        if (wait_time != portMAX_DELAY && waited >= wait_time)
+        {
+            return Span<DataType> ();
+        }
+
+        // Say we're waiting, then look once more so that a block committed
+        // in the meantime isn't missed
+        waiting.store (true);
+        if (oldest_ready () < 0)
+        {
+            xSemaphoreTake (data_signal, (wait_time == portMAX_DELAY)
+                                         ? portMAX_DELAY : wait_time - waited);
+        }
+        waiting.store (false);
+    }
+}
+
+
+/** @brief   Give a block back to the channel when the consumer is done.
+ *  @details After this the producer may fill the block again, so the
+ *           consumer must not use the span any more.
+ *  @param   block The span which was returned by @c acquire()
+ */
+template <class DataType>
+void BlockChannel<DataType>::release (const Span<DataType>& block)
+{
+    if (!usable () || block.data () == NULL)
+    {
+        return;
+    }
+    uint32_t index = (block.data () - p_storage) / block_size;
+    if (index < n_blocks)
+    {
+        p_states[index].store (BLOCK_FREE, std::memory_order_release);
+    }
+}
+
+
+/** @brief   Print the channel's status within a list of shares.
+ *  @details This method prints a line showing the channel's name, the
+ *           number of blocks and their size, the number of blocks passed to
+ *           the consumer, the most full blocks which have waited for the
+ *           consumer at once, and the number of blocks lost to overruns.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class DataType>
+void BlockChannel<DataType>::print_in_list (Print& printer)
+{
+    // Print this channel's name and pad it to 16 characters
+    printer.printf ("%-16sblocks\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << n_blocks << 'x' << block_size << ", " << committed 
+            << " passed, " << max_backlog << " max waiting, " << overruns
+            << " overruns" << endl;
+}
+
+#endif // _BLOCKCHANNEL_H_
@@ -0,0 +1,677 @@
+//*****************************************************************************
+/** @file    blockfilter.h
+ *  @brief   Filters which work on blocks of samples at a time: FIR filters,
+ *           cascades of biquad IIR filters and decimating FIR filters.
+ *  @details Filtering a block of samples at once, as they come from a
+ *           @c BlockChannel or a batch from an @c IsrBatch, is much quicker
+ *           than one sample at a time: the coefficients and state stay in
+ *           registers, and the loops can use SIMD instructions. On an STM32
+ *           with the CMSIS-DSP library available, these classes call its
+ *           @c arm_fir_..., @c arm_biquad_cascade_df1_... and
+ *           @c arm_fir_decimate_... functions, which use the Cortex-M4's
+ *           instructions that multiply two pairs of 16-bit numbers at once.
+ *           Elsewhere, as on an ESP32 or a PC, portable code gives the same
+ *           results. Its FIR loops are arranged so that compilers can
+ *           vectorize them, with @c -O3, for a PC's SSE or AVX units.
+ *
+ *           Samples may be @c float, @c Q15 or @c Q31 (see
+ *           @c fixedpoint.h). The layout of coefficients and state is that
+ *           of CMSIS-DSP, so both versions of the code behave alike: the
+ *           fixed-point results are truncated and saturated as CMSIS-DSP
+ *           does. Coefficients are given as @c float numbers when a filter
+ *           is created and converted to the sample type then.
+ *
+ *           To use CMSIS-DSP, install it (for the STM32 Arduino core, the
+ *           @c CMSIS_DSP library) so that @c arm_math.h can be found. To use
+ *           the portable code even so, define @c BLOCKFILTER_NO_CMSIS.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _BLOCKFILTER_H_
+#define _BLOCKFILTER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "span.h"
+#include "fixedpoint.h"
+
+#if (defined STM32F4xx || defined STM32L4xx) && !defined BLOCKFILTER_NO_CMSIS
+    #if __has_include (<arm_math.h>)
+        #include <arm_math.h>
+        /// Defined when the filters use the CMSIS-DSP library
+        #define BLOCKFILTER_CMSIS
+    #endif
+#endif
+
+
+/** @brief   Template which holds the arithmetic for each type of sample, so
+ *           that one version of the portable code serves all three types.
+ *  @details @c Acc holds a sum of products; @c finish() turns a sum into a
+ *           sample, and @c BIQUAD_COEFFS is the number of coefficients which
+ *           CMSIS-DSP keeps for each biquad stage.
+ *  @tparam  Sample @c float, @c Q15 or @c Q31
+ */
+template <class Sample> struct BlockMath;
+
+/// Arithmetic for @c float samples
+template <> struct BlockMath<float>
+{
+    typedef float Acc;                    ///< Sum of products
+    static const uint8_t BIQUAD_COEFFS = 5;    ///< Per biquad stage
+    static const uint8_t FRAC_BITS = 0;        ///< Bits of fraction
+
+    /// Convert a coefficient, scaled down by @c 2^shift
+    static float from (float value, uint8_t shift)
+    {
+        return value / (float)(1UL << shift);
+    }
+
+    /// Multiply a coefficient by a sample
+    static Acc mul (float coeff, float sample)
+    {
+        return coeff * sample;
+    }
+
+    /// Turn a sum into a sample, shifting it left by @c shift bits
+    static float finish (Acc sum, uint8_t shift)
+    {
+        return sum * (float)(1UL << shift);
+    }
+};
+
+/// Arithmetic for @c Q15 samples; an FIR filter's coefficients must add up,
+/// without their signs, to less than 2 so that the 32-bit sums can't overflow
+template <> struct BlockMath<Q15>
+{
+    typedef int32_t Acc;                  ///< Sum of products
+    static const uint8_t BIQUAD_COEFFS = 6;    ///< Per biquad stage
+    static const uint8_t FRAC_BITS = 15;       ///< Bits of fraction
+
+    /// Convert a coefficient, scaled down by @c 2^shift
+    static Q15 from (float value, uint8_t shift)
+    {
+        return Q15::from (value / (double)(1UL << shift));
+    }
+
+    /// Multiply a coefficient by a sample
+    static Acc mul (Q15 coeff, Q15 sample)
+    {
+        return (Acc)coeff.raw * sample.raw;
+    }
+
+    /// Turn a sum into a sample, shifting it left by @c shift bits
+    static Q15 finish (int64_t sum, uint8_t shift)
+    {
+        return Q15::from_raw (fixed_saturate<int16_t> (
+                   (int32_t)fixed_saturate<int32_t> (sum >> (15 - shift))));
+    }
+};
+
+/// Arithmetic for @c Q31 samples
+template <> struct BlockMath<Q31>
+{
+    typedef int64_t Acc;                  ///< Sum of products
+    static const uint8_t BIQUAD_COEFFS = 5;    ///< Per biquad stage
+    static const uint8_t FRAC_BITS = 31;       ///< Bits of fraction
+
+    /// Convert a coefficient, scaled down by @c 2^shift
+    static Q31 from (float value, uint8_t shift)
+    {
+        return Q31::from (value / (double)(1UL << shift));
+    }
+
+    /// Multiply a coefficient by a sample
+    static Acc mul (Q31 coeff, Q31 sample)
+    {
+        return (Acc)coeff.raw * sample.raw;
+    }
+
+    /// Turn a sum into a sample, shifting it left by @c shift bits
+    static Q31 finish (int64_t sum, uint8_t shift)
+    {
+        return Q31::from_raw (fixed_saturate<int32_t> (sum >> (31 - shift)));
+    }
+};
+
+
+/** @brief   Portable FIR filter over one block, laid out as in CMSIS-DSP.
+ *  @details The state holds the last @c taps - 1 input samples followed by
+ *           room for the new block, and the coefficients are in reverse time
+ *           order. The loop over the block is inside the loop over the taps,
+ *           so each pass is a multiply and add over neighboring samples
+ *           which a compiler can vectorize.
+ *  @param   p_coeffs The coefficients, oldest sample's first
+ *  @param   p_state The state, @c taps - 1 + @c count samples long
+ *  @param   taps The number of coefficients
+ *  @param   p_in The input samples
+ *  @param   p_out Where to put the output samples
+ *  @param   count The number of samples in the block
+ *  @param   p_sums Room for @c count sums
+ */
+template <class Sample>
+void block_fir_portable (const Sample* p_coeffs, Sample* p_state,
+                         uint16_t taps, const Sample* p_in, Sample* p_out,
+                         uint16_t count,
+                         typename BlockMath<Sample>::Acc* p_sums)
+{
+    typedef BlockMath<Sample> Math;
+    memcpy ((void*)(p_state + taps - 1), p_in, count * sizeof (Sample));
+    for (uint16_t index = 0; index < count; index++)
+    {
+        p_sums[index] = 0;
+    }
+    for (uint16_t tap = 0; tap < taps; tap++)
+    {
+        const Sample coeff = p_coeffs[tap];
+        const Sample* p_from = p_state + tap;
+        for (uint16_t index = 0; index < count; index++)
+        {
+            p_sums[index] += Math::mul (coeff, p_from[index]);
+        }
+    }
+    for (uint16_t index = 0; index < count; index++)
+    {
+        p_out[index] = Math::finish (p_sums[index], 0);
+    }
+    memmove ((void*)p_state, p_state + count, (taps - 1) * sizeof (Sample));
+}
+
+
+/** @brief   Portable decimating FIR filter over one block, laid out as in
+ *           CMSIS-DSP.
+ *  @details Only every @c factor th output is worked out. The output for
+ *           each group of @c factor inputs is the one at the group's first
+ *           sample, as in CMSIS-DSP.
+ *  @param   p_coeffs The coefficients, oldest sample's first
+ *  @param   p_state The state, @c taps - 1 + @c count samples long
+ *  @param   taps The number of coefficients
+ *  @param   factor The decimation factor
+ *  @param   p_in The input samples
+ *  @param   p_out Where to put the @c count / @c factor output samples
+ *  @param   count The number of input samples, a multiple of @c factor
+ */
+template <class Sample>
+void block_decimate_portable (const Sample* p_coeffs, Sample* p_state,
+                              uint16_t taps, uint8_t factor,
+                              const Sample* p_in, Sample* p_out,
+                              uint16_t count)
+{
+    typedef BlockMath<Sample> Math;
+    memcpy ((void*)(p_state + taps - 1), p_in, count * sizeof (Sample));
+    for (uint16_t index = 0; index < count / factor; index++)
+    {
+        const Sample* p_from = p_state + index * factor;
+        typename Math::Acc sum = 0;
+        for (uint16_t tap = 0; tap < taps; tap++)
+        {
+            sum += Math::mul (p_coeffs[tap], p_from[tap]);
+        }
+        p_out[index] = Math::finish (sum, 0);
+    }
+    memmove ((void*)p_state, p_state + count, (taps - 1) * sizeof (Sample));
+}
+
+
+/** @brief   Portable cascade of direct form I biquads over one block, laid
+ *           out as in CMSIS-DSP.
+ *  @details Each stage's coefficients are @c b0, @c b1, @c b2, @c a1, @c a2
+ *           with the signs of the @c a's reversed, and for @c Q15 a zero
+ *           after @c b0; each stage's state is @c x1, @c x2, @c y1, @c y2.
+ *           Sums are kept in 64 bits for fixed-point samples; for @c Q31 they
+ *           are added without a sign, so that a sum which overflows partway
+ *           through still comes out right if the final sum fits.
+ *  @param   p_coeffs The coefficients of all the stages
+ *  @param   p_state The state of all the stages
+ *  @param   stages The number of stages
+ *  @param   shift The number of bits by which the coefficients were scaled
+ *           down to fit
+ *  @param   p_in The input samples
+ *  @param   p_out Where to put the output samples, which may be @c p_in
+ *  @param   count The number of samples in the block
+ */
+template <class Sample>
+void block_biquad_portable (const Sample* p_coeffs, Sample* p_state,
+                            uint8_t stages, uint8_t shift, const Sample* p_in,
+                            Sample* p_out, uint16_t count)
+{
+    typedef BlockMath<Sample> Math;
+    typedef typename std::conditional<Math::FRAC_BITS == 0, float,
+                                      uint64_t>::type Sum;
+    const uint8_t SKIP = Math::BIQUAD_COEFFS - 5;
+    for (uint8_t stage = 0; stage < stages; stage++)
+    {
+        const Sample* p_c = p_coeffs + stage * Math::BIQUAD_COEFFS;
+        Sample* p_s = p_state + stage * 4;
+        Sample x1 = p_s[0], x2 = p_s[1], y1 = p_s[2], y2 = p_s[3];
+        for (uint16_t index = 0; index < count; index++)
+        {
+            Sample input = p_in[index];
+            Sum sum = (Sum)Math::mul (p_c[0], input)
+                      + (Sum)Math::mul (p_c[1 + SKIP], x1)
+                      + (Sum)Math::mul (p_c[2 + SKIP], x2)
+                      + (Sum)Math::mul (p_c[3 + SKIP], y1)
+                      + (Sum)Math::mul (p_c[4 + SKIP], y2);
+            Sample output = Math::finish (
+                (typename std::conditional<Math::FRAC_BITS == 0, float,
+                                           int64_t>::type)sum, shift);
+            x2 = x1;
+            x1 = input;
+            y2 = y1;
+            y1 = output;
+            p_out[index] = output;
+        }
+        p_s[0] = x1;
+        p_s[1] = x2;
+        p_s[2] = y1;
+        p_s[3] = y2;
+
+        // Later stages filter the output of the one before
+        p_in = p_out;
+    }
+}
+
+
+#ifdef BLOCKFILTER_CMSIS
+/// Run CMSIS-DSP's FIR filter on @c float samples
+inline void block_fir_cmsis (float* p_coeffs, float* p_state, uint16_t taps,
+                             float* p_in, float* p_out, uint16_t count)
+{
+    arm_fir_instance_f32 fir;
+    fir.numTaps = taps;
+    fir.pState = p_state;
+    fir.pCoeffs = p_coeffs;
+    arm_fir_f32 (&fir, p_in, p_out, count);
+}
+
+/// Run CMSIS-DSP's FIR filter on @c Q15 samples
+inline void block_fir_cmsis (Q15* p_coeffs, Q15* p_state, uint16_t taps,
+                             Q15* p_in, Q15* p_out, uint16_t count)
+{
+    arm_fir_instance_q15 fir;
+    fir.numTaps = taps;
+    fir.pState = (q15_t*)p_state;
+    fir.pCoeffs = (q15_t*)p_coeffs;
+    arm_fir_q15 (&fir, (q15_t*)p_in, (q15_t*)p_out, count);
+}
+
+/// Run CMSIS-DSP's FIR filter on @c Q31 samples
+inline void block_fir_cmsis (Q31* p_coeffs, Q31* p_state, uint16_t taps,
+                             Q31* p_in, Q31* p_out, uint16_t count)
+{
+    arm_fir_instance_q31 fir;
+    fir.numTaps = taps;
+    fir.pState = (q31_t*)p_state;
+    fir.pCoeffs = (q31_t*)p_coeffs;
+    arm_fir_q31 (&fir, (q31_t*)p_in, (q31_t*)p_out, count);
+}
+
+/// Run CMSIS-DSP's decimating FIR filter on @c float samples
+inline void block_decimate_cmsis (float* p_coeffs, float* p_state,
+                                  uint16_t taps, uint8_t factor, float* p_in,
+                                  float* p_out, uint16_t count)
+{
+    arm_fir_decimate_instance_f32 fir;
+    fir.M = factor;
+    fir.numTaps = taps;
+    fir.pCoeffs = p_coeffs;
+    fir.pState = p_state;
+    arm_fir_decimate_f32 (&fir, p_in, p_out, count);
+}
+
+/// Run CMSIS-DSP's decimating FIR filter on @c Q15 samples
+inline void block_decimate_cmsis (Q15* p_coeffs, Q15* p_state, uint16_t taps,
+                                  uint8_t factor, Q15* p_in, Q15* p_out,
+                                  uint16_t count)
+{
+    arm_fir_decimate_instance_q15 fir;
+    fir.M = factor;
+    fir.numTaps = taps;
+    fir.pCoeffs = (q15_t*)p_coeffs;
+    fir.pState = (q15_t*)p_state;
+    arm_fir_decimate_q15 (&fir, (q15_t*)p_in, (q15_t*)p_out, count);
+}
+
+/// Run CMSIS-DSP's decimating FIR filter on @c Q31 samples
+inline void block_decimate_cmsis (Q31* p_coeffs, Q31* p_state, uint16_t taps,
+                                  uint8_t factor, Q31* p_in, Q31* p_out,
+                                  uint16_t count)
+{
+    arm_fir_decimate_instance_q31 fir;
+    fir.M = factor;
+    fir.numTaps = taps;
+    fir.pCoeffs = (q31_t*)p_coeffs;
+    fir.pState = (q31_t*)p_state;
+    arm_fir_decimate_q31 (&fir, (q31_t*)p_in, (q31_t*)p_out, count);
+}
+
+/// Run CMSIS-DSP's biquad cascade on @c float samples
+inline void block_biquad_cmsis (float* p_coeffs, float* p_state,
+                                uint8_t stages, uint8_t shift, float* p_in,
+                                float* p_out, uint16_t count)
+{
+    (void)shift;
+    arm_biquad_casd_df1_inst_f32 biquad;
+    biquad.numStages = stages;
+    biquad.pState = p_state;
+    biquad.pCoeffs = p_coeffs;
+    arm_biquad_cascade_df1_f32 (&biquad, p_in, p_out, count);
+}
+
+/// Run CMSIS-DSP's biquad cascade on @c Q15 samples
+inline void block_biquad_cmsis (Q15* p_coeffs, Q15* p_state, uint8_t stages,
+                                uint8_t shift, Q15* p_in, Q15* p_out,
+                                uint16_t count)
+{
+    arm_biquad_casd_df1_inst_q15 biquad;
+    biquad.numStages = stages;
+    biquad.pState = (q15_t*)p_state;
+    biquad.pCoeffs = (q15_t*)p_coeffs;
+    biquad.postShift = shift;
+    arm_biquad_cascade_df1_q15 (&biquad, (q15_t*)p_in, (q15_t*)p_out, count);
+}
+
+/// Run CMSIS-DSP's biquad cascade on @c Q31 samples
+inline void block_biquad_cmsis (Q31* p_coeffs, Q31* p_state, uint8_t stages,
+                                uint8_t shift, Q31* p_in, Q31* p_out,
+                                uint16_t count)
+{
+    arm_biquad_casd_df1_inst_q31 biquad;
+    biquad.numStages = stages;
+    biquad.pState = (q31_t*)p_state;
+    biquad.pCoeffs = (q31_t*)p_coeffs;
+    biquad.postShift = shift;
+    arm_biquad_cascade_df1_q31 (&biquad, (q31_t*)p_in, (q31_t*)p_out, count);
+}
+#endif // BLOCKFILTER_CMSIS
+
+
+/** @brief   Class for an FIR filter which filters blocks of samples.
+ *
+ *           @section usage_block_fir Usage
+ *           @code
+ *           #include "blockfilter.h"
+ *           ...
+ *           const float SMOOTH[16] = { ... };         // From a design tool
+ *           BlockFIR<Q15, 16> smoother (SMOOTH);
+ *           ...
+ *           // In the filtering task
+ *           Span<Q15> samples = adc_blocks.acquire ();
+ *           smoother.process (samples, filtered);
+ *           adc_blocks.release (samples);
+ *           @endcode
+ *  @tparam  Sample @c float, @c Q15 or @c Q31
+ *  @tparam  N_TAPS The number of coefficients
+ *  @tparam  MAX_BLOCK The most samples filtered in one go; longer spans are
+ *           filtered in pieces of this size
+ */
+template <class Sample, uint16_t N_TAPS, uint16_t MAX_BLOCK = 64>
+class BlockFIR
+{
+protected:
+    /// The number of coefficients kept, which CMSIS-DSP's @c Q15 filter
+    /// needs to be even; a zero is added for the oldest sample if needed
+    static const uint16_t TAPS = (N_TAPS + 1) & ~1;
+
+    static_assert (N_TAPS > 0 && MAX_BLOCK > 0,
+                   "A BlockFIR needs at least one tap and one sample");
+
+    Sample coeffs[TAPS];                  ///< Coefficients, oldest first
+    Sample state[TAPS - 1 + MAX_BLOCK];   ///< Past inputs and a new block
+#ifndef BLOCKFILTER_CMSIS
+    typename BlockMath<Sample>::Acc sums[MAX_BLOCK];  ///< Scratch sums
+#endif
+
+public:
+    /** @brief   Create a filter with the given coefficients.
+     *  @param   p_taps The @c N_TAPS coefficients, that for the newest
+     *           sample first, as given by filter design programs
+     */
+    BlockFIR (const float* p_taps)
+    {
+        coeffs[0] = BlockMath<Sample>::from (0.0f, 0);
+        for (uint16_t tap = 0; tap < N_TAPS; tap++)
+        {
+            coeffs[TAPS - 1 - tap] = BlockMath<Sample>::from (p_taps[tap],
+                                                               0);
+        }
+        reset ();
+    }
+
+    /// Clear the filter's past inputs
+    void reset (void)
+    {
+        memset ((void*)state, 0, sizeof (state));
+    }
+
+    /** @brief   Filter a block of samples.
+     *  @param   input The samples to be filtered
+     *  @param   output Where to put the filtered samples; it mustn't
+     *           overlap the input
+     *  @returns The number of samples filtered, which is the smaller of the
+     *           two spans' sizes
+     */
+    size_t process (const Span<Sample>& input, const Span<Sample>& output)
+    {
+        size_t total = (input.size () < output.size ()) ? input.size ()
+                                                         : output.size ();
+        for (size_t done = 0; done < total; done += MAX_BLOCK)
+        {
+            uint16_t count = (total - done < MAX_BLOCK) ? total - done
+                                                         : MAX_BLOCK;
+#ifdef BLOCKFILTER_CMSIS
+            block_fir_cmsis (coeffs, state, TAPS, input.data () + done,
+                             output.data () + done, count);
+#else
+            block_fir_portable (coeffs, state, TAPS, input.data () + done,
+                                output.data () + done, count, sums);
+#endif
+        }
+        return total;
+    }
+};
+
+
+/** @brief   Class for a decimating FIR filter, which low-pass filters blocks
+ *           of samples and keeps one output for every @c FACTOR inputs.
+ *  @details Only the outputs which are kept are worked out, so this is
+ *           @c FACTOR times quicker than filtering and then throwing outputs
+ *           away. Each block's size should be a multiple of @c FACTOR;
+ *           samples left over at the end of a block are dropped.
+ *  @tparam  Sample @c float, @c Q15 or @c Q31
+ *  @tparam  N_TAPS The number of coefficients
+ *  @tparam  FACTOR The number of inputs for each output
+ *  @tparam  MAX_BLOCK The most input samples filtered in one go, a multiple
+ *           of @c FACTOR
+ */
+template <class Sample, uint16_t N_TAPS, uint8_t FACTOR,
+          uint16_t MAX_BLOCK = 64>
+class BlockDecimator
+{
+protected:
+    static_assert (FACTOR > 0 && MAX_BLOCK % FACTOR == 0,
+                   "BlockDecimator's MAX_BLOCK must be a multiple of FACTOR");
+    static_assert (N_TAPS >= FACTOR,
+                   "BlockDecimator needs at least FACTOR taps");
+
+    Sample coeffs[N_TAPS];                ///< Coefficients, oldest first
+    Sample state[N_TAPS - 1 + MAX_BLOCK]; ///< Past inputs and a new block
+
+public:
+    /** @brief   Create a filter with the given coefficients.
+     *  @param   p_taps The @c N_TAPS coefficients, that for the newest
+     *           sample first
+     */
+    BlockDecimator (const float* p_taps)
+    {
+        for (uint16_t tap = 0; tap < N_TAPS; tap++)
+        {
+            coeffs[N_TAPS - 1 - tap] = BlockMath<Sample>::from (p_taps[tap],
+                                                                 0);
+        }
+        reset ();
+    }
+
+    /// Clear the filter's past inputs
+    void reset (void)
+    {
+        memset ((void*)state, 0, sizeof (state));
+    }
+
+    /** @brief   Filter and decimate a block of samples.
+     *  @param   input The samples to be filtered
+     *  @param   output Where to put the output samples, which must have room
+     *           for @c input.size() / @c FACTOR of them
+     *  @returns The number of output samples
+     */
+    size_t process (const Span<Sample>& input, const Span<Sample>& output)
+    {
+        size_t total = input.size () - input.size () % FACTOR;
+        if (total > output.size () * FACTOR)
+        {
+            total = output.size () * FACTOR;
+        }
+        for (size_t done = 0; done < total; done += MAX_BLOCK)
+        {
+            uint16_t count = (total - done < MAX_BLOCK) ? total - done
+                                                         : MAX_BLOCK;
+#ifdef BLOCKFILTER_CMSIS
+            block_decimate_cmsis (coeffs, state, N_TAPS, FACTOR,
+                                  input.data () + done,
+                                  output.data () + done / FACTOR, count);
+#else
+            block_decimate_portable (coeffs, state, N_TAPS, FACTOR,
+                                     input.data () + done,
+                                     output.data () + done / FACTOR, count);
+#endif
+        }
+        return total / FACTOR;
+    }
+};
+
+
+/** @brief   Class for a cascade of biquad IIR filters which filters blocks of
+ *           samples.
+ *  @details Each stage's coefficients are given as @c b0, @c b1, @c b2,
+ *           @c a1, @c a2, for
+ *           @code
+ *           y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ *           @endcode
+ *           as for @c FixedBiquad. For fixed-point samples, the coefficients
+ *           are scaled down by a power of two until the largest fits, and
+ *           the sums are scaled back up; each stage's output must fit in
+ *           the sample type. Filtering in place, with the output the same
+ *           span as the input, is allowed.
+ *  @tparam  Sample @c float, @c Q15 or @c Q31
+ *  @tparam  N_STAGES The number of biquad stages
+ */
+template <class Sample, uint8_t N_STAGES>
+class BlockBiquadCascade
+{
+protected:
+    typedef BlockMath<Sample> Math;       ///< Arithmetic for the samples
+
+    Sample coeffs[N_STAGES * Math::BIQUAD_COEFFS];  ///< As CMSIS-DSP has them
+    Sample state[N_STAGES * 4];           ///< x1, x2, y1, y2 for each stage
+    uint8_t shift;                        ///< Scaling of the coefficients
+
+public:
+    /** @brief   Create a filter with the given coefficients.
+     *  @param   p_stages Five coefficients for each stage, @c b0, @c b1,
+     *           @c b2, @c a1, @c a2
+     */
+    BlockBiquadCascade (const float* p_stages)
+    {
+        // Find the power of two by which to scale the coefficients down so
+        // that the largest fits in the range -1 to 1
+        float largest = 0.0f;
+        for (uint16_t index = 0; index < N_STAGES * 5; index++)
+        {
+            float size = (p_stages[index] < 0.0f) ? -p_stages[index]
+                                                  : p_stages[index];
+            largest = (size > largest) ? size : largest;
+        }
+        shift = 0;
+        while (Math::FRAC_BITS > 0 && largest >= (float)(1UL << shift)
+               && shift < 8)
+        {
+            shift++;
+        }
+
+        const uint8_t SKIP = Math::BIQUAD_COEFFS - 5;
+        for (uint8_t stage = 0; stage < N_STAGES; stage++)
+        {
+            const float* p_in = p_stages + stage * 5;
+            Sample* p_out = coeffs + stage * Math::BIQUAD_COEFFS;
+            p_out[0] = Math::from (p_in[0], shift);
+            if (SKIP)
+            {
+                p_out[1] = Math::from (0.0f, 0);
+            }
+            p_out[1 + SKIP] = Math::from (p_in[1], shift);
+            p_out[2 + SKIP] = Math::from (p_in[2], shift);
+            p_out[3 + SKIP] = Math::from (-p_in[3], shift);
+            p_out[4 + SKIP] = Math::from (-p_in[4], shift);
+        }
+        reset ();
+    }
+
+    /// Clear the filter's past inputs and outputs
+    void reset (void)
+    {
+        memset ((void*)state, 0, sizeof (state));
+    }
+
+    /** @brief   Filter a block of samples.
+     *  @param   input The samples to be filtered
+     *  @param   output Where to put the filtered samples, which may be the
+     *           same span as @c input
+     *  @returns The number of samples filtered, which is the smaller of the
+     *           two spans' sizes
+     */
+    size_t process (const Span<Sample>& input, const Span<Sample>& output)
+    {
+        size_t total = (input.size () < output.size ()) ? input.size ()
+                                                         : output.size ();
+        for (size_t done = 0; done < total; done += 0xFFFF)
+        {
+            uint16_t count = (total - done < 0xFFFF) ? total - done : 0xFFFF;
+#ifdef BLOCKFILTER_CMSIS
+            block_biquad_cmsis (coeffs, state, N_STAGES, shift,
+                                input.data () + done, output.data () + done,
+                                count);
+#else
+            block_biquad_portable (coeffs, state, N_STAGES, shift,
+                                   input.data () + done,
+                                   output.data () + done, count);
+#endif
+        }
+        return total;
+    }
+
+    /// Return the number of bits by which the coefficients were scaled down
+    uint8_t get_shift (void)
+    {
+        return shift;
+    }
+};
+
+#endif // _BLOCKFILTER_H_
@@ -0,0 +1,431 @@
+//*****************************************************************************
+/** @file    bufferpool.h
+ *  @brief   A fixed-size pool of reference-counted buffers whose small handles
+ *           can be passed through queues instead of the buffers themselves.
+ *  @details This file contains template classes for a pool of equal-sized
+ *           data blocks and for handles which refer to those blocks. When a
+ *           large item such as a sensor frame must go to several tasks, the
+ *           item is built once in a block from the pool and only handles,
+ *           which are a few bytes long, are put into the tasks' queues. Each
+ *           block keeps count of the handles which refer to it, and it goes
+ *           back into the pool when the last one is released. Allocation and
+ *           release use atomic operations only, so they may be done in tasks
+ *           or in interrupt service routines.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _BUFFERPOOL_H_
+#define _BUFFERPOOL_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+template <class DataType> class BufferPool;
+
+
+/** @brief   A handle which refers to one reference-counted block in a
+ *           @c BufferPool.
+ *  @details A handle is only a pointer to its pool and the index of a block,
+ *           so it can be put into a @c Queue<SharedBuffer<DataType>> cheaply
+ *           no matter how large @c DataType is. Because queues copy their
+ *           items byte by byte, copying a handle does @b not change the
+ *           block's reference count; instead the rules are:
+ *           * A handle returned by @c BufferPool::allocate() or by
+ *             @c share() holds one reference to its block
+ *           * To send the block to another task, put a handle made with
+ *             @c share() into that task's queue; the receiving task now owns
+ *             that reference
+ *           * Every task which owns a reference calls @c release() when it's
+ *             done with the block; the block returns to the pool when the
+ *             last reference is released
+ *
+ *           For example, a task which forwards one frame to a logger and to
+ *           a telemetry task, then lets go of its own reference:
+ *           @code
+ *           SharedBuffer<Frame> frame = frame_pool.allocate ();
+ *           if (frame.valid ())
+ *           {
+ *               camera.read_into (*frame);
+ *               log_queue.put (frame.share ());
+ *               telemetry_queue.put (frame.share ());
+ *               frame.release ();
+ *           }
+ *           @endcode
+ *           and in each receiving task:
+ *           @code
+ *           SharedBuffer<Frame> frame = log_queue.get ();
+ *           write_to_card (frame->pixels, sizeof (frame->pixels));
+ *           frame.release ();
+ *           @endcode
+ */
+template <class DataType> class SharedBuffer
+{
+    friend class BufferPool<DataType>;
+
+protected:
+    BufferPool<DataType>* p_pool;      ///< The pool holding the block
+    uint16_t index;                    ///< Which block in the pool
+
+public:
+    /** @brief   Create an empty handle which doesn't refer to any block.
+     */
+    SharedBuffer (void) : p_pool (NULL), index (0)
+    {
+    }
+
+    /** @brief   Return true if this handle refers to a block.
+     *  @returns @c true if the handle refers to a block, @c false if it's
+     *           empty because it was released or allocation failed
+     */
+    bool valid (void) const
+    {
+        return (p_pool != NULL);
+    }
+
+    /** @brief   Return a pointer to the data in the block.
+     *  @returns A pointer to the block's data, or @c NULL if this handle is
+     *           empty
+     */
+    DataType* get (void) const
+    {
+        return (p_pool != NULL) ? &(p_pool->p_blocks[index]) : NULL;
+    }
+
+    /// Access the block's data as if this handle were a pointer to it
+    DataType* operator -> (void) const
+    {
+        return get ();
+    }
+
+    /// Access the block's data as if this handle were a pointer to it
+    DataType& operator * (void) const
+    {
+        return *get ();
+    }
+
+    /** @brief   Make another handle to the same block, adding a reference.
+     *  @details The handle which is returned owns its own reference, which
+     *           must be released by whichever task ends up holding it. This
+     *           method may be called within an interrupt service routine.
+     *  @returns A new handle to this handle's block, or an empty handle if
+     *           this one is empty
+     */
+    SharedBuffer<DataType> share (void) const
+    {
+        if (p_pool != NULL)
+        {
+            p_pool->p_refs[index].fetch_add (1, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    /** @brief   Give up this handle's reference to its block.
+     *  @details When the last reference is released, the block goes back
+     *           into the pool. The handle is empty afterwards. This method may
+     *           be called within an interrupt service routine.
+     */
+    void release (void)
+    {
+        if (p_pool != NULL)
+        {
+            p_pool->free_reference (index);
+            p_pool = NULL;
+        }
+    }
+
+    /** @brief   Return the number of references to this handle's block.
+     *  @details The count may change at any time as other tasks share or
+     *           release the block, so it's only useful for debugging.
+     *  @returns The number of references, or zero for an empty handle
+     */
+    uint16_t ref_count (void) const
+    {
+        return (p_pool != NULL)
+               ? p_pool->p_refs[index].load (std::memory_order_relaxed) : 0;
+    }
+}; // class SharedBuffer
+
+
+/** @brief   A fixed-size pool of reference-counted blocks of data.
+ *  @details All of a pool's memory is allocated once, when the pool is
+ *           created, so there's no heap activity and no fragmentation while
+ *           the program runs. Free blocks are tracked in a bitmap which is
+ *           changed only with atomic compare-and-swap operations; these are
+ *           lock-free on Cortex-M4 and ESP32 processors, so @c allocate() and
+ *           @c SharedBuffer::release() may be called from tasks and from
+ *           interrupt service routines alike.
+ *
+ *           The pool keeps statistics which @c print_all_shares() shows: the
+ *           greatest number of blocks ever in use at once, the number of
+ *           allocations, and the number of times a block was wanted but the
+ *           pool was exhausted. As a leak check, it also shows how many
+ *           blocks have been held for longer than a given time; blocks which
+ *           stay in use for much longer than a message normally takes to be
+ *           processed have probably been lost by a task which forgot to
+ *           call @c release().
+ *
+ *           @section pool_usage Usage
+ *           @code
+ *           #include "bufferpool.h"
+ *           ...
+ *           /// Ten frames for the camera, flagged if held for over 2 seconds
+ *           BufferPool<Frame> frame_pool (10, "Frames", pdMS_TO_TICKS (2000));
+ *
+ *           /// Queues of handles, not of frames
+ *           Queue<SharedBuffer<Frame>> log_queue (10, "Log Q");
+ *           @endcode
+ *           See @c SharedBuffer for the rules about passing handles around.
+ */
+template <class DataType> class BufferPool : public BaseShare
+{
+    friend class SharedBuffer<DataType>;
+
+protected:
+    DataType* p_blocks;                   ///< The blocks of data
+    std::atomic<uint16_t>* p_refs;        ///< Reference count of each block
+    TickType_t* p_alloc_ticks;            ///< When each block was allocated
+    std::atomic<uint32_t>* p_free_map;    ///< One bit per block, 1 = in use
+    uint16_t n_blocks;                    ///< Number of blocks in the pool
+    uint16_t n_words;                     ///< Number of words in the bitmap
+    TickType_t leak_ticks;                ///< Age at which blocks look leaked
+    std::atomic<uint16_t> in_use;         ///< Blocks allocated right now
+    std::atomic<uint16_t> max_in_use;     ///< Most blocks ever in use at once
+    std::atomic<uint32_t> allocations;    ///< Successful allocations
+    std::atomic<uint32_t> failures;       ///< Allocations with pool empty
+
+    // Drop one reference to a block, freeing it if that was the last
+    void free_reference (uint16_t index);
+
+public:
+    // Create a pool with the given number of blocks
+    BufferPool (uint16_t size, const char* p_name = NULL,
+                TickType_t leak_time = portMAX_DELAY);
+
+    // Take a free block from the pool
+    SharedBuffer<DataType> allocate (void);
+
+    /** @brief   Return the number of blocks which are currently in use.
+     *  @returns The number of allocated blocks
+     */
+    uint16_t blocks_in_use (void)
+    {
+        return in_use.load (std::memory_order_relaxed);
+    }
+
+    /** @brief   Return the number of times the pool was found empty.
+     *  @returns The number of failed allocations
+     */
+    uint32_t get_failures (void)
+    {
+        return failures.load (std::memory_order_relaxed);
+    }
+
+    // Count blocks which have been in use for at least the given time
+    uint16_t count_old_blocks (TickType_t age);
+
+    /** @brief   Indicates whether this pool is usable.
+     *  @returns @c true if memory for the pool was successfully allocated
+     */
+    bool usable (void)
+    {
+        return (p_blocks != NULL && p_refs != NULL && p_free_map != NULL
+                && p_alloc_ticks != NULL);
+    }
+
+    // Print the pool's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+}; // class BufferPool
+
+
+/** @brief   Create a pool of reference-counted blocks.
+ *  @details All the memory for the blocks and their bookkeeping is allocated
+ *           here, so a pool should be created while the program is starting
+ *           up, just as queues are.
+ *  @param   size The number of blocks in the pool, at most 65535
+ *  @param   p_name A name to be shown in the list of task shares (default
+ *           @c NULL)
+ *  @param   leak_time A time in RTOS ticks; blocks held longer than this are
+ *           shown as possible leaks in the list of task shares (default
+ *           @c portMAX_DELAY, which turns the leak check off)
+ */
+template <class DataType>
+BufferPool<DataType>::BufferPool (uint16_t size, const char* p_name,
+                                  TickType_t leak_time)
+    : BaseShare (p_name), in_use (0), max_in_use (0), allocations (0),
+      failures (0)
+{
+    n_blocks = size;
+    n_words = (size + 31) / 32;
+    leak_ticks = leak_time;
+
+    p_blocks = new DataType[size];
+    p_refs = new std::atomic<uint16_t>[size];
+    p_alloc_ticks = new TickType_t[size];
+    p_free_map = new std::atomic<uint32_t>[n_words];
+
+    for (uint16_t index = 0; index < size; index++)
+    {
+        p_refs[index].store (0);
+        p_alloc_ticks[index] = 0;
+    }
+
+    // Bits beyond the last block are marked as used so they're never handed
+    // out; every other bit starts out free
+    for (uint16_t word = 0; word < n_words; word++)
+    {
+        uint16_t bits_here = size - word * 32;
+        p_free_map[word].store ((bits_here >= 32) ? 0UL
+                                                  : (0xFFFFFFFFUL << bits_here));
+    }
+}
+
+
+/** @brief   Take a free block from the pool.
+ *  @details This method finds a free block in the pool's bitmap and marks it
+ *           as used with an atomic compare-and-swap, so it may be called from
+ *           a task or an interrupt service routine. The block's contents are
+ *           whatever the previous user left in it.
+ *  @returns A handle holding the only reference to the new block, or an
+ *           empty handle (whose @c valid() method returns @c false) if the
+ *           pool is exhausted
+ */
+template <class DataType>
+SharedBuffer<DataType> BufferPool<DataType>::allocate (void)
+{
+    SharedBuffer<DataType> handle;
+
+    for (uint16_t word = 0; word < n_words; word++)
+    {
+        uint32_t bits = p_free_map[word].load (std::memory_order_relaxed);
+        while (bits != 0xFFFFFFFFUL)
+        {
+            uint8_t bit = __builtin_ctz (~bits);
+            if (p_free_map[word].compare_exchange_weak (bits,
+                                                 bits | (1UL << bit),
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_relaxed))
+            {
+                uint16_t index = word * 32 + bit;
+                p_refs[index].store (1, std::memory_order_relaxed);
+                p_alloc_ticks[index] = CHECK_IF_IN_ISR ()
+                                       ? xTaskGetTickCountFromISR ()
+                                       : xTaskGetTickCount ();
+
+                // Update the statistics, keeping the maximum with a CAS loop
+                allocations.fetch_add (1, std::memory_order_relaxed);
+                uint16_t now_used = in_use.fetch_add (1) + 1;
+                uint16_t most = max_in_use.load (std::memory_order_relaxed);
+                while (now_used > most
+                       && !max_in_use.compare_exchange_weak (most, now_used))
+                {
+                }
+
+                handle.p_pool = this;
+                handle.index = index;
+                return handle;
+            }
+        }
+    }
+
+    failures.fetch_add (1, std::memory_order_relaxed);
+    return handle;
+}
+
+
+/** @brief   Drop one reference to a block, returning the block to the pool if
+ *           that was its last reference.
+ *  @param   index The index of the block
+ */
+template <class DataType>
+void BufferPool<DataType>::free_reference (uint16_t index)
+{
+    if (p_refs[index].fetch_sub (1, std::memory_order_acq_rel) == 1)
+    {
+        in_use.fetch_sub (1, std::memory_order_relaxed);
+        p_free_map[index / 32].fetch_and (~(1UL << (index % 32)),
+                                          std::memory_order_release);
+    }
+}
+
+
+/** @brief   Count the blocks which have been in use for at least the given
+ *           time.
+ *  @details This is the pool's leak check. A block which a task forgot to
+ *           release stays allocated forever, so it will sooner or later be
+ *           counted here. This method must @b not be called within an
+ *           interrupt service routine.
+ *  @param   age The minimum time a block has been in use, in RTOS ticks
+ *  @returns The number of blocks which are at least that old
+ */
+template <class DataType>
+uint16_t BufferPool<DataType>::count_old_blocks (TickType_t age)
+{
+    TickType_t now = xTaskGetTickCount ();
+    uint16_t count = 0;
+    for (uint16_t index = 0; index < n_blocks; index++)
+    {
+        if (p_refs[index].load (std::memory_order_relaxed) != 0
+            && (TickType_t)(now - p_alloc_ticks[index]) >= age)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+
+/** @brief   Print the pool's status within a list of all shares' statuses.
+ *  @details This method prints the pool's name, the greatest number of blocks
+ *           ever in use and the pool size, the number of allocations, the
+ *           number of allocations which failed because the pool was empty
+ *           and, if a leak time was given to the constructor, the number of
+ *           blocks which have been in use for longer than that.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class DataType>
+void BufferPool<DataType>::print_in_list (Print& printer)
+{
+    // Print this pool's name and pad it to 16 characters
+    printer.printf ("%-16spool\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+
+    printer << max_in_use.load () << '/' << n_blocks << ' '
+            << allocations.load () << " allocs, " << failures.load ()
+            << " empty";
+    if (leak_ticks != portMAX_DELAY)
+    {
+        printer << ", " << count_old_blocks (leak_ticks) << " leaked?";
+    }
+    printer << endl;
+}
+
+#endif // _BUFFERPOOL_H_
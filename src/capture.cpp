@@ -0,0 +1,430 @@
+//*****************************************************************************
+/** @file    capture.cpp
+ *  @brief   Source code for a software oscilloscope which records values put
+ *           into shares around a trigger.
+ *  @details See @c capture.h for a description of the classes.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "capture.h"
+
+
+// The processor's cycle counter times the entries; it's much quicker to read
+// than micros(), and the number of cycles per microsecond converts it
+#ifdef ESP32
+    #define CAPTURE_CYCLES()        ESP.getCycleCount ()
+    #define CAPTURE_CYCLES_PER_US() getCpuFrequencyMhz ()
+#elif (defined STM32F4xx || defined STM32L4xx)
+    #define CAPTURE_CYCLES()        (DWT->CYCCNT)
+    #define CAPTURE_CYCLES_PER_US() (SystemCoreClock / 1000000UL)
+#endif
+
+
+/** @brief   Record a value which was put into this channel's share.
+ *  @param   p_from Pointer to the share, which is ignored as each channel
+ *           listens to one share only
+ *  @param   p_value Pointer to the value which was put in
+ */
+void CaptureChannel::on_put (BaseShare* p_from, const void* p_value)
+{
+    (void)p_from;
+    p_capture->record (this, p_value);
+}
+
+
+/** @brief   Create a capture with a buffer of the given number of entries.
+ *  @param   n_entries The number of values the buffer can hold, which is
+ *           rounded up to a power of two; each takes 12 bytes
+ *  @param   p_name A name for the capture, shown by @c print_all_shares()
+ */
+Capture::Capture (uint32_t n_entries, const char* p_name)
+    : BaseShare (p_name)
+{
+    uint32_t size = 16;
+    while (size < n_entries)
+    {
+        size <<= 1;
+    }
+    p_ring = new CaptureEntry[size];
+    mask = (p_ring != NULL) ? size - 1 : 0;
+    write_index = 0;
+    state = CAPTURE_IDLE;
+    armed_index = 0;
+    stop_index = 0;
+    pre_count = size / 2;
+    trigger_cycles = 0;
+    n_channels = 0;
+    trigger_channel = -1;
+    trigger_kind = CAPTURE_EXTERNAL;
+    trigger_level = 0;
+    previous = 0;
+    have_previous = false;
+    captures = 0;
+}
+
+
+/** @brief   Record the values put into a share.
+ *  @details Shares should be added while setting things up, before the
+ *           capture is armed. If the share is a queue, each item put into it
+ *           is recorded; the queue's readers still get every item.
+ *  @param   share The share to be recorded
+ *  @returns @c true if the share was added, @c false if its values can't be
+ *           read, are longer than 32 bits, or there are already
+ *           @c CAPTURE_MAX_CHANNELS channels
+ */
+bool Capture::add (BaseShare& share)
+{
+    uint8_t type = share.get_value_type ();
+    uint8_t size = share_type_size (type);
+    if (n_channels >= CAPTURE_MAX_CHANNELS || size == 0 || size > 4)
+    {
+        return false;
+    }
+    CaptureChannel& channel = channels[n_channels];
+    channel.p_capture = this;
+    channel.p_share = &share;
+    channel.index = n_channels;
+    channel.type = type;
+    n_channels++;
+    share.add_listener (&channel);
+    return true;
+}
+
+
+/** @brief   Record the values put into a share found by its name.
+ *  @param   p_share_name The name of the share
+ *  @returns @c true if the share was found and added
+ */
+bool Capture::add (const char* p_share_name)
+{
+    BaseShare* p_share = BaseShare::find (p_share_name);
+    return p_share != NULL && add (*p_share);
+}
+
+
+/** @brief   Set a trigger on the values put into a share.
+ *  @details The share must already have been added. The level is given as a
+ *           @c float for convenience and converted to the share's own type
+ *           here, so values put in by ISR's are compared without floating
+ *           point arithmetic unless the share holds @c float values.
+ *  @param   share The share whose values are watched
+ *  @param   kind The condition which triggers the capture
+ *  @param   level The level with which values are compared
+ *  @param   pre_fraction The fraction of the buffer which holds values from
+ *           before the trigger (default 0.5)
+ *  @returns @c true if the trigger was set, @c false if the share hasn't
+ *           been added to this capture
+ */
+bool Capture::set_trigger (BaseShare& share, CaptureTrigger kind,
+                           float level, float pre_fraction)
+{
+    for (uint8_t index = 0; index < n_channels; index++)
+    {
+        if (channels[index].p_share == &share)
+        {
+            uint8_t type = channels[index].type;
+            if (type == SHARE_FLOAT)
+            {
+                trigger_level = share_type_widen (type, &level);
+            }
+            else if (share_type_is_signed (type))
+            {
+                trigger_level = (uint64_t)(int64_t)level;
+            }
+            else
+            {
+                trigger_level = (level > 0.0f) ? (uint64_t)level : 0;
+            }
+            set_external_trigger (pre_fraction);
+            trigger_channel = index;
+            trigger_kind = kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** @brief   Trigger only when @c trigger() is called.
+ *  @param   pre_fraction The fraction of the buffer which holds values from
+ *           before the trigger (default 0.5)
+ */
+void Capture::set_external_trigger (float pre_fraction)
+{
+    if (pre_fraction < 0.0f)
+    {
+        pre_fraction = 0.0f;
+    }
+    else if (pre_fraction > 1.0f)
+    {
+        pre_fraction = 1.0f;
+    }
+    pre_count = (uint32_t)(pre_fraction * mask);
+    trigger_channel = -1;
+    trigger_kind = CAPTURE_EXTERNAL;
+}
+
+
+/** @brief   Start recording and wait for the trigger.
+ *  @details This method throws away any window which was captured before.
+ *           It must be called from a task.
+ */
+void Capture::arm (void)
+{
+    #if (defined STM32F4xx || defined STM32L4xx)
+        // Turn on the cycle counter, which is off after a reset
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
+
+    state = CAPTURE_IDLE;
+    armed_index = write_index.load ();
+    stop_index = armed_index + 0x7FFFFFFF;
+    have_previous = false;
+    state = CAPTURE_ARMED;
+}
+
+
+/** @brief   Trigger the capture now, if it's armed.
+ *  @details This method may be called from any task or ISR. Unlike a trigger
+ *           on a share's values, it doesn't wait for the part of the buffer
+ *           before the trigger to fill.
+ */
+void Capture::trigger (void)
+{
+    fire ();
+}
+
+
+/** @brief   Stop recording, keeping what has been recorded.
+ *  @details The values recorded so far can then be dumped, whether or not
+ *           the capture was triggered.
+ */
+void Capture::stop (void)
+{
+    uint8_t now = state.load ();
+    if (now == CAPTURE_ARMED || now == CAPTURE_TRIGGERED)
+    {
+        stop_index = write_index.load ();
+        if (now == CAPTURE_ARMED)
+        {
+            trigger_cycles = CAPTURE_CYCLES ();
+        }
+        state = CAPTURE_DONE;
+    }
+}
+
+
+/** @brief   Trigger the capture if it's armed.
+ *  @details Only the first of several tasks or ISR's which trigger at once
+ *           succeeds. Recording then goes on until the part of the buffer
+ *           after the trigger is full.
+ */
+void Capture::fire (void)
+{
+    uint8_t expected = CAPTURE_ARMED;
+    if (state.compare_exchange_strong (expected, CAPTURE_TRIGGERED))
+    {
+        trigger_cycles = CAPTURE_CYCLES ();
+        stop_index = write_index.load () + (mask - pre_count);
+    }
+}
+
+
+/** @brief   Check a value against the trigger condition.
+ *  @param   type The value's @c ShareValueType code
+ *  @param   value The value, widened by @c share_type_widen()
+ *  @returns @c true if the value meets the condition
+ */
+bool Capture::check_trigger (uint8_t type, uint64_t value)
+{
+    // Compare each value and the one before with the level, in their type
+    int8_t now_vs_level;
+    int8_t before_vs_level;
+    if (type == SHARE_FLOAT)
+    {
+        float now, before, level;
+        share_type_narrow (type, value, &now);
+        share_type_narrow (type, previous, &before);
+        share_type_narrow (type, trigger_level, &level);
+        now_vs_level = (now > level) - (now < level);
+        before_vs_level = (before > level) - (before < level);
+    }
+    else if (share_type_is_signed (type))
+    {
+        int64_t level = (int64_t)trigger_level;
+        now_vs_level = ((int64_t)value > level) - ((int64_t)value < level);
+        before_vs_level = ((int64_t)previous > level)
+                          - ((int64_t)previous < level);
+    }
+    else
+    {
+        now_vs_level = (value > trigger_level) - (value < trigger_level);
+        before_vs_level = (previous > trigger_level)
+                          - (previous < trigger_level);
+    }
+
+    bool had_previous = have_previous;
+    previous = value;
+    have_previous = true;
+
+    switch (trigger_kind)
+    {
+        case CAPTURE_RISING:
+            return had_previous && before_vs_level < 0 && now_vs_level >= 0;
+        case CAPTURE_FALLING:
+            return had_previous && before_vs_level > 0 && now_vs_level <= 0;
+        case CAPTURE_ABOVE:
+            return now_vs_level >= 0;
+        case CAPTURE_BELOW:
+            return now_vs_level <= 0;
+        default:
+            return false;
+    }
+}
+
+
+/** @brief   Record one value from a channel.
+ *  @details This method runs in whichever task or ISR put the value into the
+ *           share. Each value claims the next entry in the buffer with an
+ *           atomic increment, so values from several tasks and ISR's don't
+ *           get in each other's way.
+ *  @param   p_channel Pointer to the channel whose share got the value
+ *  @param   p_value Pointer to the value
+ */
+void Capture::record (CaptureChannel* p_channel, const void* p_value)
+{
+    uint8_t now = state.load (std::memory_order_relaxed);
+    if (now == CAPTURE_IDLE || now == CAPTURE_DONE)
+    {
+        return;
+    }
+
+    uint32_t index = write_index.fetch_add (1);
+    if ((int32_t)(index - stop_index) >= 0)
+    {
+        // Only the first put past the end counts the finished window
+        uint8_t expected = CAPTURE_TRIGGERED;
+        if (state.compare_exchange_strong (expected, CAPTURE_DONE))
+        {
+            captures++;
+        }
+        return;
+    }
+
+    CaptureEntry& entry = p_ring[index & mask];
+    entry.cycles = CAPTURE_CYCLES ();
+    entry.value = 0;
+    memcpy (&entry.value, p_value, share_type_size (p_channel->type));
+    entry.channel = p_channel->index;
+
+    // Only the trigger channel's values are checked, once there's enough
+    // history before the trigger
+    if (now == CAPTURE_ARMED && p_channel->index == trigger_channel
+        && index - armed_index >= pre_count)
+    {
+        if (check_trigger (p_channel->type,
+                           share_type_widen (p_channel->type, &entry.value)))
+        {
+            fire ();
+        }
+    }
+    else if (p_channel->index == trigger_channel)
+    {
+        previous = share_type_widen (p_channel->type, &entry.value);
+        have_previous = true;
+    }
+}
+
+
+/** @brief   Write the captured window as CSV.
+ *  @details Each line holds the time in microseconds relative to the trigger
+ *           (negative before it), the name of the share and the value put
+ *           into it, oldest first. This method should be called from a task
+ *           once @c is_done() returns @c true; the whole window is printed
+ *           at once, so the serial port's buffer may fill and make the task
+ *           wait.
+ *  @param   out The serial device or other @c Print object to write to
+ */
+void Capture::dump (Print& out)
+{
+    if (state.load () != CAPTURE_DONE)
+    {
+        out << "Capture not done" << endl;
+        return;
+    }
+
+    // Let any put which claimed an entry just before the end finish
+    vTaskDelay (1);
+
+    uint32_t end = stop_index;
+    uint32_t begin = armed_index;
+    if (end - begin > mask + 1)
+    {
+        begin = end - (mask + 1);
+    }
+    float cycles_per_us = (float)CAPTURE_CYCLES_PER_US ();
+
+    out << "time_us,share,value" << endl;
+    for (uint32_t index = begin; index != end; index++)
+    {
+        const CaptureEntry& entry = p_ring[index & mask];
+        const CaptureChannel& channel = channels[entry.channel];
+        float time_us = (int32_t)(entry.cycles - trigger_cycles)
+                        / cycles_per_us;
+        out.printf ("%.2f,%s,", time_us, channel.p_share->get_name ());
+        uint64_t value = share_type_widen (channel.type, &entry.value);
+        if (channel.type == SHARE_FLOAT)
+        {
+            float as_float;
+            share_type_narrow (channel.type, value, &as_float);
+            out.printf ("%g", as_float);
+        }
+        else if (share_type_is_signed (channel.type))
+        {
+            out.printf ("%ld", (long)(int64_t)value);
+        }
+        else
+        {
+            out.printf ("%lu", (unsigned long)value);
+        }
+        out << endl;
+    }
+}
+
+
+/** @brief   Print the capture's status within a list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void Capture::print_in_list (Print& printer)
+{
+    static const char* const STATE_NAMES[] = { "idle", "armed", "triggered",
+                                                "done" };
+
+    printer.printf ("%-16scapture\t", name);
+    if (mask == 0)
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << n_channels << " ch., " << (mask + 1) << " entries, "
+            << STATE_NAMES[state.load ()] << ", " << captures << " captures"
+            << endl;
+}
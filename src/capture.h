@@ -0,0 +1,221 @@
+//*****************************************************************************
+/** @file    capture.h
+ *  @brief   A software oscilloscope which records every value put into
+ *           chosen shares and freezes the record when a trigger occurs.
+ *  @details A fast control loop can change its shares thousands of times per
+ *           second, far more than can be printed as it runs. A @c Capture
+ *           listens to chosen shares and records each value put into them,
+ *           with the time, in a ring buffer in RAM. When a trigger condition
+ *           is met, such as a value rising through a threshold, recording
+ *           goes on until the part of the buffer after the trigger is full,
+ *           then stops, leaving a window of values from before and after the
+ *           trigger. A task then dumps the window, and the capture may be
+ *           armed again.
+ *
+ *           Recording a value takes a virtual call, an atomic increment, a
+ *           read of the processor's cycle counter and a 12-byte store, a few
+ *           dozen cycles on an ESP32 or Cortex-M4. Shares whose values are
+ *           up to 32 bits long may be recorded. A queue of such values may
+ *           be added too; each item is recorded as it's put in, and none is
+ *           taken out of the queue.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _CAPTURE_H_
+#define _CAPTURE_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+/// The most shares which one capture can record
+#define CAPTURE_MAX_CHANNELS    8
+
+
+/// Conditions which can trigger a capture
+enum CaptureTrigger : uint8_t
+{
+    CAPTURE_RISING,                       ///< Value rises to or past a level
+    CAPTURE_FALLING,                      ///< Value falls to or past a level
+    CAPTURE_ABOVE,                        ///< Value is at or above a level
+    CAPTURE_BELOW,                        ///< Value is at or below a level
+    CAPTURE_EXTERNAL                      ///< Only @c Capture::trigger()
+};
+
+
+/// The states of a capture
+enum CaptureState : uint8_t
+{
+    CAPTURE_IDLE,                         ///< Not recording
+    CAPTURE_ARMED,                        ///< Recording, waiting to trigger
+    CAPTURE_TRIGGERED,                    ///< Recording after the trigger
+    CAPTURE_DONE                          ///< Window full, waiting for dump
+};
+
+
+/// One recorded value
+struct CaptureEntry
+{
+    uint32_t cycles;                      ///< Cycle count when recorded
+    uint32_t value;                       ///< The value's bits
+    uint8_t channel;                      ///< Index of the channel
+};
+
+
+class Capture;
+
+
+/** @brief   Listener which passes values put into one share to a capture.
+ *  @details Objects of this class are made by @c Capture::add(); programs
+ *           needn't use them directly.
+ */
+class CaptureChannel : public ShareListener
+{
+    friend class Capture;
+
+protected:
+    Capture* p_capture;                   ///< The capture to record into
+    BaseShare* p_share;                   ///< The share being recorded
+    uint8_t index;                        ///< This channel's number
+    uint8_t type;                         ///< Type of the share's values
+
+public:
+    // Record a value which was put into the share
+    void on_put (BaseShare* p_from, const void* p_value);
+};
+
+
+/** @brief   Class which records values put into shares around a trigger.
+ *  @details The buffer's size is rounded up to a power of two entries. The
+ *           part of it kept from before the trigger is set by the trigger's
+ *           pre-trigger fraction; a trigger is ignored until that part has
+ *           filled, so each window has its full share of history.
+ *
+ *           @section usage_capture Usage
+ *           @code
+ *           #include "capture.h"
+ *           ...
+ *           /// Records the speed loop's error and output around faults
+ *           Capture scope (2048, "Speed Scope");
+ *           ...
+ *           // In setup(), after the shares have been created
+ *           scope.add (speed_error);
+ *           scope.add (motor_duty);
+ *           scope.set_trigger (speed_error, CAPTURE_RISING, 50.0, 0.25);
+ *           scope.arm ();
+ *           @endcode
+ *           In a low priority task:
+ *           @code
+ *           if (scope.is_done ())
+ *           {
+ *               scope.dump (Serial);
+ *               scope.arm ();
+ *           }
+ *           @endcode
+ *           Any task or ISR may also call @c scope.trigger() to trigger the
+ *           capture at once, for instance when it detects a fault.
+ */
+class Capture : public BaseShare
+{
+    friend class CaptureChannel;
+
+protected:
+    CaptureEntry* p_ring;                 ///< The ring buffer
+    uint32_t mask;                        ///< Buffer size minus one
+    std::atomic<uint32_t> write_index;    ///< Entries claimed so far
+    std::atomic<uint8_t> state;           ///< A @c CaptureState
+    uint32_t armed_index;                 ///< Write index when armed
+    volatile uint32_t stop_index;         ///< Index at which to stop
+    uint32_t pre_count;                   ///< Entries kept before trigger
+    uint32_t trigger_cycles;              ///< Cycle count at the trigger
+    CaptureChannel channels[CAPTURE_MAX_CHANNELS];  ///< The channels
+    uint8_t n_channels;                   ///< Number of channels
+    int8_t trigger_channel;               ///< Channel watched, or -1
+    CaptureTrigger trigger_kind;          ///< The trigger condition
+    uint64_t trigger_level;               ///< Level, widened, in its type
+    uint64_t previous;                    ///< Last value of trigger channel
+    bool have_previous;                   ///< @c previous has been set
+    uint32_t captures;                    ///< Windows captured so far
+
+    // Record one value from a channel
+    void record (CaptureChannel* p_channel, const void* p_value);
+
+    // Trigger the capture if it's armed
+    void fire (void);
+
+    // Check a value against the trigger condition
+    bool check_trigger (uint8_t type, uint64_t value);
+
+public:
+    // Create a capture with a buffer of the given number of entries
+    Capture (uint32_t n_entries, const char* p_name = "Capture");
+
+    // Record the values put into a share
+    bool add (BaseShare& share);
+
+    // Record the values put into a share found by its name
+    bool add (const char* p_share_name);
+
+    // Set a trigger on the values put into a share
+    bool set_trigger (BaseShare& share, CaptureTrigger kind, float level,
+                      float pre_fraction = 0.5f);
+
+    // Trigger only when trigger() is called
+    void set_external_trigger (float pre_fraction = 0.5f);
+
+    // Start recording and wait for the trigger
+    void arm (void);
+
+    // Trigger the capture now, from a task or an ISR
+    void trigger (void);
+
+    /** @brief   Check whether a window has been captured.
+     *  @returns @c true if the capture has triggered and filled its buffer
+     */
+    bool is_done (void)
+    {
+        return state.load () == CAPTURE_DONE;
+    }
+
+    /** @brief   Return the capture's state.
+     *  @returns One of the @c CaptureState values
+     */
+    uint8_t get_state (void)
+    {
+        return state.load ();
+    }
+
+    // Stop recording, keeping what has been recorded
+    void stop (void);
+
+    // Write the captured window as CSV
+    void dump (Print& out);
+
+    // Print the capture's status within a list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _CAPTURE_H_
@@ -0,0 +1,131 @@
+//*****************************************************************************
+/** @file    critical.h
+ *  @brief   A class which protects short sections of code from being
+ *           interrupted, in tasks or in interrupt service routines.
+ *  @details FreeRTOS has different calls for entering critical sections on
+ *           the ESP32 and the STM32, and different calls again for use in an
+ *           ISR. A @c CriticalSection object hides those differences: its
+ *           @c enter() and @c exit() methods may be used the same way in
+ *           tasks and ISR's on either processor. 
+ *
+ *           On the ESP32 the object holds a spinlock, so code running on the
+ *           other core is kept out too; each set of data to be protected
+ *           should have its own @c CriticalSection. On the STM32 interrupts
+ *           are simply masked. Either way, code in a critical section must
+ *           be short and must not call functions which might block.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _CRITICAL_H_
+#define _CRITICAL_H_
+
+#include <Arduino.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+    #include "task.h"
+#endif
+#include "baseshare.h"                          // For CHECK_IF_IN_ISR()
+
+
+/** @brief   Class which protects short sections of code from interruption.
+ *  @details The value returned by @c enter() must be given to the matching
+ *           @c exit(), which restores the interrupt state which was there
+ *           before:
+ *           @code
+ *           CriticalSection data_guard;         // Next to the data it guards
+ *           ...
+ *           UBaseType_t saved = data_guard.enter ();
+ *           ...                                 // Change the data quickly
+ *           data_guard.exit (saved);
+ *           @endcode
+ *           Critical sections may not be nested within the same object. 
+ */
+class CriticalSection
+{
+protected:
+#ifdef ESP32
+    portMUX_TYPE mux;                     ///< Spinlock shared by both cores
+#endif
+
+public:
+    /** @brief   Create a critical section guard.
+     */
+    CriticalSection (void)
+    {
+        #ifdef ESP32
+            mux = portMUX_INITIALIZER_UNLOCKED;
+        #endif
+    }
+
+    /** @brief   Enter the critical section, in a task or an ISR.
+     *  @returns A value which must be given to @c exit()
+     */
+    UBaseType_t enter (void)
+    {
+        #ifdef ESP32
+            if (CHECK_IF_IN_ISR ())
+            {
+                portENTER_CRITICAL_ISR (&mux);
+            }
+            else
+            {
+                portENTER_CRITICAL (&mux);
+            }
+            return 0;
+        #else
+            if (CHECK_IF_IN_ISR ())
+            {
+                return taskENTER_CRITICAL_FROM_ISR ();
+            }
+            taskENTER_CRITICAL ();
+            return 0;
+        #endif
+    }
+
+    /** @brief   Leave the critical section, in a task or an ISR.
+     *  @param   saved The value which was returned by @c enter()
+     */
+    void exit (UBaseType_t saved)
+    {
+        #ifdef ESP32
+            (void)saved;
+            if (CHECK_IF_IN_ISR ())
+            {
+                portEXIT_CRITICAL_ISR (&mux);
+            }
+            else
+            {
+                portEXIT_CRITICAL (&mux);
+            }
+        #else
+            if (CHECK_IF_IN_ISR ())
+            {
+                taskEXIT_CRITICAL_FROM_ISR (saved);
+            }
+            else
+            {
+                taskEXIT_CRITICAL ();
+            }
+        #endif
+    }
+};
+
+#endif // _CRITICAL_H_
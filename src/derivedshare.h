@@ -0,0 +1,477 @@
+//*****************************************************************************
+/** @file    derivedshare.h
+ *  @brief   Shares whose values are computed from other shares, only when
+ *           they're read after an input has changed.
+ *  @details Many shared values are functions of others: the distance a
+ *           robot has gone is worked out from two encoder counts, and the
+ *           power drawn from a voltage and a current. Having a task compute
+ *           such a value every cycle and put it into a share wastes time
+ *           whenever nobody reads it or its inputs haven't changed. A
+ *           @c DerivedShare is given its input shares and a function. A
+ *           listener on each input marks the derived value out of date when
+ *           data is put into that input, and the function is run by whatever
+ *           task next reads the derived value, and only then.
+ *
+ *           Inputs may be @c Share objects or other derived shares, so a
+ *           derived value can depend on derived values. The list printed by
+ *           @c print_all_shares() shows how many times each derived value
+ *           was computed and how many times it was read.
+ *
+ *  @date 2026-Oct-17 Original file
+ *  @date 2026-Oct-17 Compute under a mutex so a stale value can't be kept
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _DERIVEDSHARE_H_
+#define _DERIVEDSHARE_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <utility>
+#include <atomic>
+#include "baseshare.h"
+#include "taskshare.h"
+
+
+/** @brief   Base class of all derived shares, which lets a derived share ask
+ *           whether its inputs, if they are derived shares too, are out of
+ *           date.
+ *  @details Application code doesn't use this class directly.
+ */
+class DerivedBase : public BaseShare
+{
+protected:
+    /// Set when data is put into an input, cleared when the value is computed
+    volatile bool dirty;
+
+    /// The number of times the value has been computed
+    std::atomic<uint32_t> computes;
+
+    /// The number of times the value has been read
+    std::atomic<uint32_t> reads;
+
+    /// Counts computations like @c computes but is never reset, so derived
+    /// shares which use this one can tell when it has a new value
+    std::atomic<uint32_t> generation;
+
+public:
+    /** @brief   Create the parts of a derived share common to all types.
+     *  @param   p_name A name to be shown in the list of shares
+     */
+    DerivedBase (const char* p_name)
+        : BaseShare (p_name), computes (0), reads (0), generation (0)
+    {
+        dirty = true;
+    }
+
+    /** @brief   Return whether the value must be computed before it's read.
+     *  @returns @c true if data has been put into an input, or into an
+     *           input of a derived input, since the value was last computed
+     */
+    virtual bool is_stale (void) = 0;
+
+    /** @brief   Return whether every input has been given data, so that the
+     *           value can be computed without waiting.
+     */
+    virtual bool is_ready (void) = 0;
+
+    /** @brief   Return a number which changes each time the value is
+     *           computed.
+     */
+    uint32_t get_generation (void)
+    {
+        return generation.load (std::memory_order_acquire);
+    }
+
+    /** @brief   Return the number of times the value has been computed.
+     */
+    uint32_t get_compute_count (void)
+    {
+        return computes.load (std::memory_order_relaxed);
+    }
+
+    /** @brief   Return the number of times the value has been read.
+     */
+    uint32_t get_read_count (void)
+    {
+        return reads.load (std::memory_order_relaxed);
+    }
+
+    /// Set the counts of times the value was computed and read to zero
+    void reset_stats (void)
+    {
+        computes.store (0, std::memory_order_relaxed);
+        reads.store (0, std::memory_order_relaxed);
+    }
+};
+
+
+/** @brief   A listener which marks a derived share out of date when data is
+ *           put into one of its inputs.
+ */
+class DerivedListener : public ShareListener
+{
+protected:
+    volatile bool* p_dirty;               ///< The derived share's flag
+    volatile bool heard;                  ///< Data has been put in
+
+public:
+    /** @brief   Create a listener which sets the given flag.
+     *  @param   p_flag Pointer to the derived share's out of date flag
+     */
+    DerivedListener (volatile bool* p_flag) : p_dirty (p_flag), heard (false)
+    {
+    }
+
+    /// Mark the derived share out of date; this may run in an ISR
+    void on_put (BaseShare* p_share, const void* p_value)
+    {
+        (void)p_share;
+        (void)p_value;
+        *p_dirty = true;
+        heard = true;
+    }
+
+    /// Return whether data has ever been put into the input
+    bool has_heard (void)
+    {
+        return heard;
+    }
+};
+
+
+/* These overloads let an input be treated one way if it's a plain share and
+ * another if it's a derived share. A derived input doesn't get a listener:
+ * reading it may compute it, which puts data in, and that mustn't mark the
+ * share which is reading it out of date. Instead, a derived share asks its
+ * derived inputs whether they're out of date, and whether they've been
+ * computed, perhaps by another reader, since it last used them. */
+
+/// Attach a listener to a plain input
+inline void derived_watch (BaseShare* p_input, DerivedListener* p_listener)
+{
+    p_input->add_listener (p_listener);
+}
+
+/// Don't attach a listener to a derived input
+inline void derived_watch (DerivedBase*, DerivedListener*)
+{
+}
+
+/// A plain input is out of date only if its listener says so
+inline bool derived_stale (BaseShare*, uint32_t)
+{
+    return false;
+}
+
+/// A derived input is out of date if its own inputs have changed or it has
+/// been computed since the generation which was last used
+inline bool derived_stale (DerivedBase* p_input, uint32_t used)
+{
+    return p_input->is_stale () || p_input->get_generation () != used;
+}
+
+/// Plain inputs have no generations
+inline uint32_t derived_generation (BaseShare*)
+{
+    return 0;
+}
+
+/// Return the generation of a derived input
+inline uint32_t derived_generation (DerivedBase* p_input)
+{
+    return p_input->get_generation ();
+}
+
+/// A plain input is ready once data has been put into it
+inline bool derived_ready (BaseShare*, DerivedListener& listener)
+{
+    return listener.has_heard ();
+}
+
+/// A derived input is ready once its own inputs are
+inline bool derived_ready (DerivedBase* p_input, DerivedListener&)
+{
+    return p_input->is_ready ();
+}
+
+
+/// The end of the chain of inputs, which calls the function
+template <class... Inputs> class DerivedInputs
+{
+protected:
+    DerivedInputs (volatile bool* p_dirty)
+    {
+        (void)p_dirty;
+    }
+
+    bool stale (void)
+    {
+        return false;
+    }
+
+    bool ready (void)
+    {
+        return true;
+    }
+
+    template <class Result, class Function, class... Got>
+    Result apply (Function function, Got... got)
+    {
+        return function (got...);
+    }
+};
+
+
+/** @brief   One input of a derived share, with its listener.
+ *  @details A derived share inherits a chain of these, one for each input;
+ *           each reads its own input and passes the values read so far on to
+ *           the rest of the chain, the end of which calls the function.
+ *           Application code doesn't use this class directly.
+ */
+template <class First, class... Rest> class DerivedInputs<First, Rest...>
+    : public DerivedInputs<Rest...>
+{
+protected:
+    First* p_input;                       ///< The input share
+    DerivedListener listener;             ///< Told about puts to the input
+    uint32_t used;                        ///< Generation of input last used
+
+    /** @brief   Save an input and attach a listener to it.
+     *  @param   p_dirty Pointer to the derived share's out of date flag
+     *  @param   first This link's input
+     *  @param   rest The inputs for the rest of the chain
+     */
+    DerivedInputs (volatile bool* p_dirty, First& first, Rest&... rest)
+        : DerivedInputs<Rest...> (p_dirty, rest...), p_input (&first),
+          listener (p_dirty), used (0)
+    {
+        derived_watch (p_input, &listener);
+    }
+
+    /// Return whether any derived input is out of date
+    bool stale (void)
+    {
+        return derived_stale (p_input, used)
+               || DerivedInputs<Rest...>::stale ();
+    }
+
+    /// Return whether every input has been given data
+    bool ready (void)
+    {
+        return derived_ready (p_input, listener)
+               && DerivedInputs<Rest...>::ready ();
+    }
+
+    /// Read this input, then pass it on with the others for the function
+    template <class Result, class Function, class... Got>
+    Result apply (Function function, Got... got)
+    {
+        auto value = p_input->get ();
+        used = derived_generation (p_input);
+        return DerivedInputs<Rest...>::template apply<Result>
+                   (function, got..., value);
+    }
+};
+
+
+/** @brief   Class for a share whose value is computed from other shares when
+ *           it's read after one of them has changed.
+ *  @details The value is computed in whatever task reads it, so the
+ *           function should be quick. It's computed at most once after each
+ *           change to the inputs, no matter how many tasks read it; a mutex
+ *           lets one task at a time compute it, and a task which waited for
+ *           another to finish uses the value that task computed. If data is
+ *           put into an input while the value is being computed, the next
+ *           read computes it again. The value may not be read from within an
+ *           ISR, but data may be put into its inputs there.
+ *
+ *           @section usage_derived Usage
+ *           @code
+ *           #include "derivedshare.h"
+ *           ...
+ *           Share<float> voltage ("Voltage");
+ *           Share<float> current ("Current");
+ *
+ *           /// Compute the power drawn from the supply
+ *           float watts (float volts, float amps)
+ *           {
+ *               return volts * amps;
+ *           }
+ *           DerivedShare<float, Share<float>, Share<float>>
+ *               power ("Power", watts, voltage, current);
+ *           ...
+ *           // In any task; the product is worked out only if needed
+ *           float now_drawing = power.get ();
+ *           @endcode
+ *           Like @c Share::get(), @c get() waits until every input has been
+ *           given data.
+ *  @tparam  DataType The type of the derived value
+ *  @tparam  Inputs The classes of the input shares, such as
+ *           @c Share<int32_t> or another @c DerivedShare
+ */
+template <class DataType, class... Inputs>
+class DerivedShare : public DerivedBase, protected DerivedInputs<Inputs...>
+{
+public:
+    /// The type of function which computes the value from the inputs' values
+    typedef DataType (*Function)
+        (decltype (std::declval<Inputs&> ().get ())...);
+
+protected:
+    /// A queue holds the most recently computed value, as in a @c Share
+    QueueHandle_t queue;
+
+    /// The function which computes the value
+    Function function;
+
+    /// Lets one task at a time compute the value and publish it
+    SemaphoreHandle_t mutex;
+
+public:
+    /** @brief   Create a derived share.
+     *  @details The inputs are given listeners here, so a derived share
+     *           should be created while setting things up, before tasks
+     *           begin putting data into its inputs.
+     *  @param   p_name A name to be shown in the list of shares
+     *  @param   a_function The function which computes the value
+     *  @param   inputs The input shares, in the same order as the function's
+     *           parameters
+     */
+    DerivedShare (const char* p_name, Function a_function, Inputs&... inputs)
+        : DerivedBase (p_name), DerivedInputs<Inputs...> (&dirty, inputs...)
+    {
+        queue = xQueueCreate (1, sizeof (DataType));
+        function = a_function;
+        mutex = xSemaphoreCreateMutex ();
+    }
+
+    /** @brief   Return the derived value, computing it first if any input has
+     *           changed since it was last computed.
+     *  @details Listeners attached to this share are told each time the
+     *           value is computed, so it can be recorded like any other.
+     *  @returns The value computed from the inputs' most recent data
+     */
+    DataType get (void)
+    {
+        DataType value;
+
+        reads.fetch_add (1, std::memory_order_relaxed);
+        if (is_stale ())
+        {
+            // Without the mutex, a task which began computing from older
+            // inputs could overwrite a newer value after another task had
+            // published it and cleared the flag
+            xSemaphoreTake (mutex, portMAX_DELAY);
+
+            // Another task may have computed the value while we waited
+            if (is_stale ())
+            {
+                // Clear the flag first, so a put during the function isn't
+                // lost
+                dirty = false;
+                value = DerivedInputs<Inputs...>::template apply<DataType>
+                            (function);
+                xQueueOverwrite (queue, &value);
+                computes.fetch_add (1, std::memory_order_relaxed);
+                generation.fetch_add (1, std::memory_order_release);
+                notify_put (&value);
+                xSemaphoreGive (mutex);
+                return value;
+            }
+            xSemaphoreGive (mutex);
+        }
+        xQueuePeek (queue, &value, portMAX_DELAY);
+        return value;
+    }
+
+    /** @brief   Read the derived value into a variable, computing it first
+     *           if any input has changed.
+     *  @param   recv_data A reference to the variable in which to put the
+     *           value
+     */
+    void get (DataType& recv_data)
+    {
+        recv_data = get ();
+    }
+
+    /** @brief   Return whether the value must be computed before it's read.
+     */
+    bool is_stale (void)
+    {
+        return dirty || DerivedInputs<Inputs...>::stale ();
+    }
+
+    /** @brief   Return whether every input has been given data.
+     */
+    bool is_ready (void)
+    {
+        return DerivedInputs<Inputs...>::ready ();
+    }
+
+    /** @brief   Return the type of value this share holds.
+     *  @returns A @c ShareValueType code, which is @c SHARE_NONE if the
+     *           value isn't a plain number
+     */
+    uint8_t get_value_type (void)
+    {
+        return ShareType<DataType>::code;
+    }
+
+    /** @brief   Copy the derived value, computing it first if needed.
+     *  @details This lets tools such as telemetry senders and command shells
+     *           read a derived value, which counts as a read. It doesn't wait.
+     *  @param   p_value Pointer to a buffer big enough for a @c DataType
+     *  @returns @c true if a value was copied, @c false if some input hasn't
+     *           been given data yet or the type isn't a plain number
+     */
+    bool peek_value (void* p_value)
+    {
+        if (ShareType<DataType>::code == SHARE_NONE || !is_ready ())
+        {
+            return false;
+        }
+        DataType value = get ();
+        memcpy (p_value, &value, sizeof (DataType));
+        return true;
+    }
+
+    // Print the share's name and its counts within a list of all shares
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Print the name of this derived share, how many times its value
+ *           has been computed, and how many times it has been read.
+ *  @details A value which is computed far less often than it's read is
+ *           saving the work of a task which would compute it every time.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class DataType, class... Inputs>
+void DerivedShare<DataType, Inputs...>::print_in_list (Print& printer)
+{
+    printer.printf ("%-16sderived\t", name);
+    printer << computes.load () << " computes, " << reads.load () << " reads"
+            << endl;
+}
+
+#endif // _DERIVEDSHARE_H_
@@ -0,0 +1,237 @@
+//*****************************************************************************
+/** @file    eventgroup.cpp
+ *  @brief   Source code for an event group wrapper and a cyclic barrier.
+ *  @details See @c eventgroup.h for descriptions of the classes.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "eventgroup.h"
+
+
+/** @brief   Create an event group with all its bits clear.
+ *  @param   p_name A name for the group, shown by @c print_all_shares()
+ */
+EventGroup::EventGroup (const char* p_name)
+    : BaseShare (p_name)
+{
+    handle = xEventGroupCreate ();
+    sets = 0;
+    timeouts = 0;
+}
+
+
+/** @brief   Set bits in the group, waking any tasks which are waiting for
+ *           them.
+ *  @details This method must @b not be used within an ISR; use 
+ *           @c ISR_set() there.
+ *  @param   bits The bits to be set
+ *  @returns The bits in the group after being set; bits may already have been
+ *           cleared again by tasks which were waiting for them
+ */
+EventBits_t EventGroup::set (EventBits_t bits)
+{
+    sets++;
+    return xEventGroupSetBits (handle, bits);
+}
+
+
+/** @brief   Set bits in the group from within an ISR.
+ *  @param   bits The bits to be set
+ *  @returns @c true if the bits will be set, @c false if the request to set
+ *           them couldn't be sent to the timer service task
+ */
+bool EventGroup::ISR_set (EventBits_t bits)
+{
+    BaseType_t wake_up;
+    sets++;
+    return xEventGroupSetBitsFromISR (handle, bits, &wake_up) == pdPASS;
+}
+
+
+/** @brief   Wait until any of the given bits is set.
+ *  @details This method must @b not be used within an ISR.
+ *  @param   bits The bits for which to wait
+ *  @param   clear_on_exit @c true to clear the given bits when the wait ends
+ *           (default @c true)
+ *  @param   wait_time The longest time to wait, in RTOS ticks (default
+ *           @c portMAX_DELAY, which means forever)
+ *  @returns The bits which were set when the wait ended, before any were
+ *           cleared; if none of the given bits is among them, the wait timed
+ *           out
+ */
+EventBits_t EventGroup::wait_any (EventBits_t bits, bool clear_on_exit,
+                                  TickType_t wait_time)
+{
+    EventBits_t result = xEventGroupWaitBits (handle, bits,
+                                              clear_on_exit ? pdTRUE : pdFALSE,
+                                              pdFALSE, wait_time);
+    if ((result & bits) == 0)
+    {
+        timeouts++;
+    }
+    return result;
+}
+
+
+/** @brief   Wait until all of the given bits are set.
+ *  @details This method must @b not be used within an ISR.
+ *  @param   bits The bits for which to wait
+ *  @param   clear_on_exit @c true to clear the given bits when the wait ends
+ *           (default @c true)
+ *  @param   wait_time The longest time to wait, in RTOS ticks (default
+ *           @c portMAX_DELAY, which means forever)
+ *  @returns The bits which were set when the wait ended, before any were
+ *           cleared; if not all of the given bits are among them, the wait
+ *           timed out
+ */
+EventBits_t EventGroup::wait_all (EventBits_t bits, bool clear_on_exit,
+                                  TickType_t wait_time)
+{
+    EventBits_t result = xEventGroupWaitBits (handle, bits,
+                                              clear_on_exit ? pdTRUE : pdFALSE,
+                                              pdTRUE, wait_time);
+    if ((result & bits) != bits)
+    {
+        timeouts++;
+    }
+    return result;
+}
+
+
+/** @brief   Set bits, then wait until all of another set of bits are set.
+ *  @details This is the FreeRTOS @c xEventGroupSync() function, with which
+ *           tasks which each own one bit can wait for each other. The wait
+ *           bits are cleared when all of them have been set. 
+ *  @param   set_bits The bits to set
+ *  @param   wait_bits The bits for which to wait
+ *  @param   wait_time The longest time to wait, in RTOS ticks (default
+ *           @c portMAX_DELAY, which means forever)
+ *  @returns The bits which were set when the wait ended; if not all of the
+ *           wait bits are among them, the wait timed out
+ */
+EventBits_t EventGroup::sync (EventBits_t set_bits, EventBits_t wait_bits,
+                              TickType_t wait_time)
+{
+    sets++;
+    EventBits_t result = xEventGroupSync (handle, set_bits, wait_bits,
+                                          wait_time);
+    if ((result & wait_bits) != wait_bits)
+    {
+        timeouts++;
+    }
+    return result;
+}
+
+
+/** @brief   Print the event group's status within a list of shares.
+ *  @details This method prints a line showing the group's name, the bits
+ *           which are set, the number of times bits have been set, and the 
+ *           number of waits which timed out.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void EventGroup::print_in_list (Print& printer)
+{
+    // Print this group's name and pad it to 16 characters
+    printer.printf ("%-16sevents\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer.printf ("0x%06lX, ", (unsigned long)get ());
+    printer << sets << " sets, " << timeouts << " timeouts" << endl;
+}
+
+
+/** @brief   Create a cyclic barrier.
+ *  @param   tasks The number of tasks which must arrive at the barrier
+ *           before any of them may go on
+ *  @param   p_name A name for the barrier, shown by @c print_all_shares()
+ */
+Barrier::Barrier (uint8_t tasks, const char* p_name)
+    : BaseShare (p_name)
+{
+    handle = xEventGroupCreate ();
+    n_tasks = (tasks > 0) ? tasks : 1;
+    arrived = 0;
+    cycles = 0;
+    timeouts = 0;
+}
+
+
+/** @brief   Wait until all the tasks have arrived at the barrier.
+ *  @details The last task to arrive clears the bit which the next cycle will
+ *           use, then sets this cycle's bit, which lets all the waiting tasks
+ *           go. This method must @b not be used within an ISR.
+ *  @param   wait_time The longest time to wait, in RTOS ticks (default
+ *           @c portMAX_DELAY, which means forever)
+ *  @returns @c true if all the tasks arrived, @c false if the wait timed out
+ */
+bool Barrier::wait (TickType_t wait_time)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+
+    // The cycle can't end until this task has arrived, so it's safe to read
+    // the cycle count before counting this task's arrival
+    EventBits_t my_bit = (cycles.load () & 1) ? 0x02 : 0x01;
+
+    if (arrived.fetch_add (1) + 1 >= n_tasks)
+    {
+        arrived.store (0);
+        cycles.fetch_add (1);
+        xEventGroupClearBits (handle, my_bit ^ 0x03);
+        xEventGroupSetBits (handle, my_bit);
+        return true;
+    }
+
+    EventBits_t result = xEventGroupWaitBits (handle, my_bit, pdFALSE, pdTRUE,
+                                              wait_time);
+    if ((result & my_bit) == 0)
+    {
+        timeouts++;
+        return false;
+    }
+    return true;
+}
+
+
+/** @brief   Print the barrier's status within a list of shares.
+ *  @details This method prints a line showing the barrier's name, the number
+ *           of tasks which meet at it, the number of cycles completed, and
+ *           the number of waits which timed out.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void Barrier::print_in_list (Print& printer)
+{
+    // Print this barrier's name and pad it to 16 characters
+    printer.printf ("%-16sbarrier\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << n_tasks << " tasks, " << cycles.load () << " cycles, "
+            << timeouts << " timeouts" << endl;
+}
@@ -0,0 +1,252 @@
+//*****************************************************************************
+/** @file    eventgroup.h
+ *  @brief   Classes which let tasks wait for combinations of events and
+ *           which keep several tasks running in step, cycle after cycle.
+ *  @details This file contains a wrapper class for FreeRTOS event groups and
+ *           a cyclic barrier class built upon one. An event group holds a set
+ *           of bits, each of which stands for something having happened;
+ *           tasks can wait until any or all of a chosen set of bits are set.
+ *           A barrier makes each of a fixed number of tasks wait until all of
+ *           them have reached the same point, so a sense task, a compute task
+ *           and an actuate task can start each control cycle together.
+ *           These replace pairs of @c Queue<bool> objects which tasks have
+ *           used to signal each other.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _EVENTGROUP_H_
+#define _EVENTGROUP_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+    #include "event_groups.h"
+#else
+    #include "freertos/event_groups.h"
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+/** @brief   Class which implements a group of event bits which tasks can
+ *           wait for.
+ *  @details This class doesn't add functionality to the FreeRTOS event group;
+ *           it simplifies the programming interface, puts the group into the
+ *           list of shared data items, and counts the times bits were set and
+ *           the waits which timed out. Bits are set with @c set() in tasks or
+ *           @c ISR_set() in interrupt service routines, and a task waits for
+ *           any or all of a set of bits with @c wait_any() or @c wait_all().
+ *           An event group has 24 usable bits on 32-bit processors.
+ *
+ *           On an ESP32, and on other processors whose FreeRTOS is built that
+ *           way, @c ISR_set() works by asking the timer service task to set
+ *           the bits, so the bits are set a short time after the ISR returns.
+ *
+ *           @section events_usage Usage
+ *           @code
+ *           #include "eventgroup.h"
+ *           ...
+ *           const EventBits_t LIMIT_HIT = (1 << 0);   ///< A limit switch
+ *           const EventBits_t ESTOP = (1 << 1);       ///< Emergency stop
+ *
+ *           /// Events which make the motor task stop the motor
+ *           EventGroup motor_events ("Motor Ev.");
+ *           @endcode
+ *           In an ISR:
+ *           @code
+ *           motor_events.ISR_set (LIMIT_HIT);
+ *           @endcode
+ *           In the motor task:
+ *           @code
+ *           EventBits_t what = motor_events.wait_any (LIMIT_HIT | ESTOP);
+ *           if (what & ESTOP) ...
+ *           @endcode
+ */
+class EventGroup : public BaseShare
+{
+protected:
+    EventGroupHandle_t handle;            ///< Handle of the FreeRTOS group
+    uint32_t sets;                        ///< Times bits have been set
+    uint32_t timeouts;                    ///< Waits which timed out
+
+public:
+    // Create an event group with all bits clear
+    EventGroup (const char* p_name = NULL);
+
+    // Set bits in the group, waking any tasks waiting for them
+    EventBits_t set (EventBits_t bits);
+
+    // Set bits in the group from within an ISR
+    bool ISR_set (EventBits_t bits);
+
+    /** @brief   Clear bits in the group.
+     *  @param   bits The bits to be cleared
+     *  @returns The bits as they were before being cleared
+     */
+    EventBits_t clear (EventBits_t bits)
+    {
+        return xEventGroupClearBits (handle, bits);
+    }
+
+    /** @brief   Clear bits in the group from within an ISR.
+     *  @param   bits The bits to be cleared
+     *  @returns The bits as they were before being cleared
+     */
+    EventBits_t ISR_clear (EventBits_t bits)
+    {
+        return xEventGroupClearBitsFromISR (handle, bits);
+    }
+
+    /** @brief   Return the bits in the group without waiting.
+     *  @returns The bits which are set
+     */
+    EventBits_t get (void)
+    {
+        return xEventGroupGetBits (handle);
+    }
+
+    /** @brief   Return the bits in the group from within an ISR.
+     *  @returns The bits which are set
+     */
+    EventBits_t ISR_get (void)
+    {
+        return xEventGroupGetBitsFromISR (handle);
+    }
+
+    // Wait until any of the given bits is set
+    EventBits_t wait_any (EventBits_t bits, bool clear_on_exit = true,
+                          TickType_t wait_time = portMAX_DELAY);
+
+    // Wait until all of the given bits are set
+    EventBits_t wait_all (EventBits_t bits, bool clear_on_exit = true,
+                          TickType_t wait_time = portMAX_DELAY);
+
+    // Set bits, then wait until all of another set of bits are set
+    EventBits_t sync (EventBits_t set_bits, EventBits_t wait_bits,
+                      TickType_t wait_time = portMAX_DELAY);
+
+    /** @brief   Operator which sets bits in the group.
+     *  @details This operator checks whether it's running in an ISR and
+     *           calls @c ISR_set() or @c set() as appropriate.
+     *  @param   bits The bits to be set
+     */
+    void operator << (EventBits_t bits)
+    {
+        if (CHECK_IF_IN_ISR ())
+        {
+            ISR_set (bits);
+        }
+        else
+        {
+            set (bits);
+        }
+    }
+
+    /** @brief   Return the handle of the FreeRTOS event group.
+     *  @details The handle can be used to call FreeRTOS functions which this
+     *           class doesn't wrap. 
+     *  @returns The handle of the event group
+     */
+    EventGroupHandle_t get_handle (void)
+    {
+        return handle;
+    }
+
+    /** @brief   Indicates whether this event group is usable.
+     *  @returns @c true if the event group was successfully created
+     */
+    bool usable (void)
+    {
+        return handle != NULL;
+    }
+
+    // Print the group's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Class which implements a cyclic barrier at which a fixed number
+ *           of tasks wait for each other.
+ *  @details Each task calls @c wait() when it reaches the barrier. The first
+ *           tasks to arrive block; when the last one arrives, all of them go
+ *           on together. The barrier then resets itself for the next cycle,
+ *           so the same barrier can be used at the top of each task's loop:
+ *           @code
+ *           /// Starts each cycle of the sense, compute and actuate tasks
+ *           Barrier cycle_start (3, "Cycle");
+ *           ...
+ *           for (;;)                              // In each of the 3 tasks
+ *           {
+ *               cycle_start.wait ();
+ *               ...                               // Do this task's job
+ *           }
+ *           @endcode
+ *
+ *           The barrier is built on an event group using two bits, one for
+ *           even cycles and one for odd ones, so tasks which race ahead into
+ *           the next cycle can't be let through by the bit which released the
+ *           cycle before. Arrivals are counted with an atomic counter, so
+ *           only the last task to arrive makes more than one kernel call. 
+ *
+ *           If a task times out waiting at a barrier, the barrier is out of
+ *           step: it still counts that task as having arrived. Timeouts are
+ *           meant for detecting faults, after which the program should be
+ *           restarted. The number of completed cycles and of timeouts are
+ *           shown by @c print_all_shares().
+ */
+class Barrier : public BaseShare
+{
+protected:
+    EventGroupHandle_t handle;            ///< Event group holding the bits
+    uint8_t n_tasks;                      ///< Number of tasks which wait
+    std::atomic<uint8_t> arrived;         ///< Tasks which have arrived
+    std::atomic<uint32_t> cycles;         ///< Cycles completed
+    uint32_t timeouts;                    ///< Waits which timed out
+
+public:
+    // Create a barrier for the given number of tasks
+    Barrier (uint8_t tasks, const char* p_name = NULL);
+
+    // Wait until all the tasks have arrived at the barrier
+    bool wait (TickType_t wait_time = portMAX_DELAY);
+
+    /** @brief   Return the number of cycles completed.
+     *  @returns The number of times all the tasks have met at the barrier
+     */
+    uint32_t get_cycles (void)
+    {
+        return cycles.load ();
+    }
+
+    /** @brief   Indicates whether this barrier is usable.
+     *  @returns @c true if the barrier's event group was successfully created
+     */
+    bool usable (void)
+    {
+        return handle != NULL;
+    }
+
+    // Print the barrier's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+};
+
+#endif // _EVENTGROUP_H_
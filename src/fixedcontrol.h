@@ -0,0 +1,413 @@
+//*****************************************************************************
+/** @file    fixedcontrol.h
+ *  @brief   Control blocks in fixed-point math: a PID controller, a biquad
+ *           IIR filter and a moving average.
+ *  @details Each block is a template whose signal format and whose gains or
+ *           coefficients are fixed when the program is compiled. The gains
+ *           are written as ordinary numbers in a small @c struct, and the
+ *           compiler converts them to fixed point, checks that no product or
+ *           sum can overflow for any input, and builds the shifts into the
+ *           code, so each step is a few multiplies and adds which take the
+ *           same number of cycles every time. Signals are @c Fixed numbers
+ *           such as @c Q15 or @c Q31 (see @c fixedpoint.h), which run from
+ *           -1 to just under 1, so measurements and outputs should be
+ *           scaled into that range; results saturate at its ends.
+ *
+ *           Each block has a @c step() method which takes and returns
+ *           numbers, and a @c run() method which gets its inputs from shares
+ *           or queues and puts its output into another, so a control task's
+ *           loop can be one line.
+ *
+ *           This file uses no Arduino or FreeRTOS code, so programs on a PC
+ *           can use it too.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _FIXEDCONTROL_H_
+#define _FIXEDCONTROL_H_
+
+#include "fixedpoint.h"
+
+
+/** @brief   Return the absolute value of a number, at compile time if it's a
+ *           constant.
+ *  @param   value The number
+ *  @returns The number without its sign
+ */
+constexpr double fixed_abs (double value)
+{
+    return (value < 0.0) ? -value : value;
+}
+
+
+/** @brief   Class for a PID controller whose gains are fixed at compile time.
+ *  @details The controller runs once per sample:
+ *           @code
+ *           output = KP * error + integral - KD * (measurement - last one)
+ *           integral += KI * error
+ *           @endcode
+ *           so @c KI is the integral gain times the sample period and @c KD
+ *           is the derivative gain divided by it. The derivative acts on the
+ *           measurement rather than the error, so a step in the setpoint
+ *           doesn't kick the output. The integral isn't increased while the
+ *           output is saturated in the direction the error pushes it, which
+ *           keeps it from winding up.
+ *
+ *           The gains are held with @c GAIN_BITS bits of fraction. The
+ *           compiler checks that @c KI is from 0 up to 1, and that @c KP and
+ *           @c KD together are small enough that nothing can overflow: with
+ *           the default @c GAIN_BITS, up to about 15 for @c Q15 signals and
+ *           up to 15 each for @c Q31.
+ *
+ *           @section usage_fixed_pid Usage
+ *           @code
+ *           #include "fixedcontrol.h"
+ *           ...
+ *           // Gains for a loop run every 1 ms; ki = 20 per second
+ *           struct SpeedGains
+ *           {
+ *               static constexpr double KP = 1.5;
+ *               static constexpr double KI = 20.0 * 0.001;
+ *               static constexpr double KD = 0.0;
+ *           };
+ *           Share<Q15> setpoint ("Setpoint");
+ *           Share<Q15> speed ("Speed");
+ *           Share<Q15> duty ("Duty");
+ *           ...
+ *           // In the control task
+ *           FixedPID<Q15, SpeedGains> controller;
+ *           for (;;)
+ *           {
+ *               controller.run (setpoint, speed, duty);
+ *               vTaskDelayUntil (&wake_time, 1);
+ *           }
+ *           @endcode
+ *  @tparam  Signal The type of the setpoint, measurement and output, such as
+ *           @c Q15
+ *  @tparam  Gains A @c struct with @c static @c constexpr @c double members
+ *           @c KP, @c KI and @c KD
+ *  @tparam  GAIN_BITS The number of fraction bits in @c KP and @c KD
+ */
+template <class Signal, class Gains,
+          uint8_t GAIN_BITS = sizeof (typename Signal::Raw) * 8 - 5>
+class FixedPID
+{
+protected:
+    typedef typename Signal::Raw Raw;     ///< Raw type of the signals
+    typedef typename Signal::Wide Wide;   ///< Type of products and sums
+
+    /// The number of bits in a raw signal
+    static const uint8_t BITS = sizeof (Raw) * 8;
+
+    /// The number of fraction bits in @c KI, which is less than 1
+    static const uint8_t I_BITS = BITS - 1;
+
+    /// The proportional gain in fixed point
+    static constexpr Wide KP = fixed_raw (Gains::KP, GAIN_BITS);
+
+    /// The integral gain in fixed point
+    static constexpr Wide KI = fixed_raw (Gains::KI, I_BITS);
+
+    /// The derivative gain in fixed point
+    static constexpr Wide KD = fixed_raw (Gains::KD, GAIN_BITS);
+
+    static_assert (GAIN_BITS > 0 && GAIN_BITS < BITS - 1,
+                   "FixedPID gains need from 1 to BITS - 2 fraction bits");
+    static_assert (Gains::KI >= 0.0 && Gains::KI < 1.0,
+                   "FixedPID's KI, the integral gain times the sample time, "
+                   "must be from 0 up to 1");
+    static_assert ((fixed_abs (Gains::KP) + fixed_abs (Gains::KD) + 1.0)
+                   * (double)(INT64_C (1) << GAIN_BITS)
+                   < (double)(INT64_C (1) << BITS) - 4.0
+                   && fixed_abs (Gains::KP) < (double)(1L << (31 - GAIN_BITS))
+                   && fixed_abs (Gains::KD) < (double)(1L << (31 - GAIN_BITS)),
+                   "FixedPID's KP and KD are too large; use fewer GAIN_BITS");
+
+    Wide integral;                        ///< Sum of KI * error, I_BITS
+    Raw last_measurement;                 ///< Measurement at the last step
+
+public:
+    /// Create a controller with nothing in its integral
+    FixedPID (void)
+    {
+        reset ();
+    }
+
+    /** @brief   Clear the integral and the remembered measurement.
+     *  @param   measurement The measurement from which the derivative will
+     *           be found at the next step
+     */
+    void reset (Signal measurement = Signal::from_raw (0))
+    {
+        integral = 0;
+        last_measurement = measurement.raw;
+    }
+
+    /** @brief   Run the controller for one sample.
+     *  @param   setpoint The value which the measurement should reach
+     *  @param   measurement The measured value
+     *  @returns The controller's output
+     */
+    Signal step (Signal setpoint, Signal measurement)
+    {
+        Wide error = fixed_saturate<Raw> ((Wide)setpoint.raw
+                                          - measurement.raw);
+        Wide change = fixed_saturate<Raw> ((Wide)measurement.raw
+                                           - last_measurement);
+        last_measurement = measurement.raw;
+
+        Wide sum = KP * error - KD * change
+                   + (integral >> (I_BITS - GAIN_BITS))
+                   + ((Wide)1 << (GAIN_BITS - 1));
+        Wide output = sum >> GAIN_BITS;
+        Raw limited = fixed_saturate<Raw> (output);
+
+        // Integrate unless that would push a saturated output further out
+        if (!((output > limited && error > 0)
+              || (output < limited && error < 0)))
+        {
+            const Wide LIMIT = (Wide)std::numeric_limits<Raw>::max ()
+                               << I_BITS;
+            integral += KI * error;
+            integral = (integral > LIMIT) ? LIMIT
+                     : (integral < -LIMIT) ? -LIMIT : integral;
+        }
+        return Signal::from_raw (limited);
+    }
+
+    /** @brief   Run the controller for one sample, getting its inputs from
+     *           shares and putting its output into another.
+     *  @details Any class with @c get() and @c put() methods for values of
+     *           type @c Signal will do, such as @c Share or @c Queue.
+     *  @param   setpoint The share holding the setpoint
+     *  @param   measurement The share holding the measurement
+     *  @param   output The share into which the output is put
+     *  @returns The controller's output
+     */
+    template <class SetShare, class MeasureShare, class OutShare>
+    Signal run (SetShare& setpoint, MeasureShare& measurement,
+                OutShare& output)
+    {
+        Signal result = step (setpoint.get (), measurement.get ());
+        output.put (result);
+        return result;
+    }
+
+    /// Return the integral term as a signal, for watching windup
+    Signal get_integral (void)
+    {
+        return Signal::from_raw (fixed_saturate<Raw> (integral >> I_BITS));
+    }
+};
+
+
+/** @brief   Class for a second-order IIR filter, a biquad, whose
+ *           coefficients are fixed at compile time.
+ *  @details The filter finds
+ *           @code
+ *           y[n] = B0 x[n] + B1 x[n-1] + B2 x[n-2] - A1 y[n-1] - A2 y[n-2]
+ *           @endcode
+ *           with the coefficients held as 32-bit numbers with 29 bits of
+ *           fraction and the sum kept in 64 bits, as in direct form I. That
+ *           gives low-frequency filters, whose poles are close to 1, the
+ *           precision they need even with @c Q15 signals. The compiler
+ *           checks that each coefficient is under 4 and that their sizes add
+ *           up to less than 8, which keeps the sum from overflowing; the
+ *           coefficients of any stable filter with a gain of a few or less
+ *           meet that. Coefficients can be had from a filter design program
+ *           or the well known "Audio EQ Cookbook" formulas, divided through
+ *           by @c a0.
+ *
+ *           @section usage_fixed_biquad Usage
+ *           @code
+ *           // Butterworth low pass at 50 Hz, sampled at 1 kHz
+ *           struct Smoothing
+ *           {
+ *               static constexpr double B0 = 0.020083;
+ *               static constexpr double B1 = 0.040167;
+ *               static constexpr double B2 = 0.020083;
+ *               static constexpr double A1 = -1.561018;
+ *               static constexpr double A2 = 0.641352;
+ *           };
+ *           FixedBiquad<Q15, Smoothing> filter;
+ *           ...
+ *           filter.run (raw_current, smooth_current);
+ *           @endcode
+ *  @tparam  Signal The type of the input and output, such as @c Q15
+ *  @tparam  Coeffs A @c struct with @c static @c constexpr @c double members
+ *           @c B0, @c B1, @c B2, @c A1 and @c A2
+ */
+template <class Signal, class Coeffs>
+class FixedBiquad
+{
+protected:
+    typedef typename Signal::Raw Raw;     ///< Raw type of the signals
+
+    /// The number of fraction bits in the coefficients
+    static const uint8_t COEF_BITS = 29;
+
+    static constexpr int64_t B0 = fixed_raw (Coeffs::B0, COEF_BITS);
+    static constexpr int64_t B1 = fixed_raw (Coeffs::B1, COEF_BITS);
+    static constexpr int64_t B2 = fixed_raw (Coeffs::B2, COEF_BITS);
+    static constexpr int64_t A1 = fixed_raw (Coeffs::A1, COEF_BITS);
+    static constexpr int64_t A2 = fixed_raw (Coeffs::A2, COEF_BITS);
+
+    static_assert (fixed_abs (Coeffs::B0) < 4.0
+                   && fixed_abs (Coeffs::B1) < 4.0
+                   && fixed_abs (Coeffs::B2) < 4.0
+                   && fixed_abs (Coeffs::A1) < 4.0
+                   && fixed_abs (Coeffs::A2) < 4.0,
+                   "FixedBiquad coefficients must be less than 4");
+    static_assert (fixed_abs (Coeffs::B0) + fixed_abs (Coeffs::B1)
+                   + fixed_abs (Coeffs::B2) + fixed_abs (Coeffs::A1)
+                   + fixed_abs (Coeffs::A2) < 7.99,
+                   "FixedBiquad coefficients are too large to add up safely");
+
+    Raw x1;                               ///< The input one sample ago
+    Raw x2;                               ///< The input two samples ago
+    Raw y1;                               ///< The output one sample ago
+    Raw y2;                               ///< The output two samples ago
+
+public:
+    /// Create a filter whose past inputs and outputs are all zero
+    FixedBiquad (void)
+    {
+        reset ();
+    }
+
+    /** @brief   Set the filter's past inputs and outputs.
+     *  @details Setting them to a steady input and the output which that
+     *           gives avoids a transient when the filter starts.
+     *  @param   input The value for the past inputs
+     *  @param   output The value for the past outputs
+     */
+    void reset (Signal input = Signal::from_raw (0),
+                Signal output = Signal::from_raw (0))
+    {
+        x1 = x2 = input.raw;
+        y1 = y2 = output.raw;
+    }
+
+    /** @brief   Filter one sample.
+     *  @param   input The new input
+     *  @returns The filter's output
+     */
+    Signal step (Signal input)
+    {
+        int64_t sum = B0 * input.raw + B1 * x1 + B2 * x2 - A1 * y1 - A2 * y2
+                      + (INT64_C (1) << (COEF_BITS - 1));
+        int64_t wide = sum >> COEF_BITS;
+        Raw output = (wide > std::numeric_limits<Raw>::max ())
+                     ? std::numeric_limits<Raw>::max ()
+                   : (wide < std::numeric_limits<Raw>::min ())
+                     ? std::numeric_limits<Raw>::min () : (Raw)wide;
+        x2 = x1;
+        x1 = input.raw;
+        y2 = y1;
+        y1 = output;
+        return Signal::from_raw (output);
+    }
+
+    /** @brief   Filter one sample, getting it from a share or queue and
+     *           putting the output into another.
+     *  @param   input The share or queue holding the input
+     *  @param   output The share or queue into which the output is put
+     *  @returns The filter's output
+     */
+    template <class InShare, class OutShare>
+    Signal run (InShare& input, OutShare& output)
+    {
+        Signal result = step (input.get ());
+        output.put (result);
+        return result;
+    }
+};
+
+
+/** @brief   Class for the average of the last @c N samples.
+ *  @details A running sum is kept, so each step costs the same however long
+ *           the average is; the division by the constant @c N is turned into
+ *           a multiply, or a shift if @c N is a power of two.
+ *  @tparam  Signal The type of the input and output, such as @c Q15
+ *  @tparam  N The number of samples averaged
+ */
+template <class Signal, uint16_t N>
+class FixedMovingAverage
+{
+protected:
+    typedef typename Signal::Raw Raw;     ///< Raw type of the signals
+    typedef typename Signal::Wide Wide;   ///< Type of the running sum
+
+    static_assert (N > 0, "A moving average needs at least one sample");
+
+    Raw samples[N];                       ///< The last N samples
+    Wide sum;                             ///< The sum of those samples
+    uint16_t index;                       ///< Where the next sample goes
+
+public:
+    /// Create an average of samples which are all zero
+    FixedMovingAverage (void)
+    {
+        reset ();
+    }
+
+    /** @brief   Fill the average with one value.
+     *  @param   value The value with which to fill it
+     */
+    void reset (Signal value = Signal::from_raw (0))
+    {
+        for (uint16_t count = 0; count < N; count++)
+        {
+            samples[count] = value.raw;
+        }
+        sum = (Wide)value.raw * N;
+        index = 0;
+    }
+
+    /** @brief   Add a sample to the average, dropping the oldest one.
+     *  @param   input The new sample
+     *  @returns The average, rounded
+     */
+    Signal step (Signal input)
+    {
+        sum += (Wide)input.raw - samples[index];
+        samples[index] = input.raw;
+        index = (index + 1 < N) ? index + 1 : 0;
+        Wide half = (sum < 0) ? -(Wide)(N / 2) : (Wide)(N / 2);
+        return Signal::from_raw ((Raw)((sum + half) / (Wide)N));
+    }
+
+    /** @brief   Add a sample from a share or queue to the average and put
+     *           the average into another.
+     *  @param   input The share or queue holding the new sample
+     *  @param   output The share or queue into which the average is put
+     *  @returns The average
+     */
+    template <class InShare, class OutShare>
+    Signal run (InShare& input, OutShare& output)
+    {
+        Signal result = step (input.get ());
+        output.put (result);
+        return result;
+    }
+};
+
+#endif // _FIXEDCONTROL_H_
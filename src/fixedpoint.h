@@ -0,0 +1,316 @@
+//*****************************************************************************
+/** @file    fixedpoint.h
+ *  @brief   Fixed-point numbers in Q formats, such as Q15 and Q31, for control
+ *           math on processors without a fast floating-point unit.
+ *  @details A fixed-point number is an integer with an implied binary point:
+ *           a Q15 number is an @c int16_t whose value is divided by 2^15, so
+ *           it runs from -1 up to just under 1 in steps of 1/32768. Adding
+ *           and multiplying these takes a few integer instructions, each
+ *           taking the same time every time, where a @c double on a
+ *           Cortex-M4, whose FPU handles only @c float, takes a call into a
+ *           software library. Results which won't fit saturate at the
+ *           largest or smallest number rather than wrapping around, which is
+ *           what a controller's output should do.
+ *
+ *           The formats are set at compile time by the template parameters
+ *           of @c Fixed, so the compiler turns every shift into a constant.
+ *           Fixed-point numbers may be kept in shares, where they report the
+ *           type of their raw integers to programs such as the telemetry
+ *           sender. The control blocks which use them are in
+ *           @c fixedcontrol.h.
+ *
+ *           This file uses no Arduino or FreeRTOS code, so programs on a PC
+ *           can use it too.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _FIXEDPOINT_H_
+#define _FIXEDPOINT_H_
+
+#include <stdint.h>
+#include <limits>
+#include "sharetype.h"
+
+
+/** @brief   Template which gives the integer types used in arithmetic on
+ *           fixed-point numbers stored in a given integer type.
+ *  @details Only @c int16_t and @c int32_t are supported, as those are the
+ *           sizes for which processors have single-cycle multiplies.
+ *  @tparam  Storage The type of the raw integers
+ */
+template <class Storage> struct FixedTraits;
+
+/// Arithmetic for numbers stored in 16 bits, with 32-bit products
+template <> struct FixedTraits<int16_t>
+{
+    typedef int32_t Wide;                 ///< Holds a product of two numbers
+};
+
+/// Arithmetic for numbers stored in 32 bits, with 64-bit products
+template <> struct FixedTraits<int32_t>
+{
+    typedef int64_t Wide;                 ///< Holds a product of two numbers
+};
+
+
+/** @brief   Limit a wide integer to the range of a narrower one.
+ *  @tparam  Storage The narrow type
+ *  @param   value The number to be limited
+ *  @returns The number, or the nearest end of the narrow type's range
+ */
+template <class Storage>
+constexpr Storage fixed_saturate (typename FixedTraits<Storage>::Wide value)
+{
+    return (value > (typename FixedTraits<Storage>::Wide)
+                    std::numeric_limits<Storage>::max ())
+           ? std::numeric_limits<Storage>::max ()
+         : (value < (typename FixedTraits<Storage>::Wide)
+                    std::numeric_limits<Storage>::min ())
+           ? std::numeric_limits<Storage>::min ()
+         : (Storage)value;
+}
+
+
+/** @brief   Convert a number to fixed point with rounding, at compile time
+ *           if the number is a constant.
+ *  @details This is used for gains and coefficients given to the control
+ *           blocks as @c double constants. Numbers beyond the range of a
+ *           32-bit integer give the nearest end of that range.
+ *  @param   value The number to be converted
+ *  @param   frac_bits The number of bits after the binary point
+ *  @returns The raw fixed-point integer
+ */
+constexpr int32_t fixed_raw (double value, uint8_t frac_bits)
+{
+    return (value * (double)(INT64_C (1) << frac_bits) >= 2147483647.0)
+           ? INT32_MAX
+         : (value * (double)(INT64_C (1) << frac_bits) <= -2147483648.0)
+           ? INT32_MIN
+         : (int32_t)(value * (double)(INT64_C (1) << frac_bits)
+                     + (value < 0.0 ? -0.5 : 0.5));
+}
+
+
+/** @brief   Class for a fixed-point number with a given number of fraction
+ *           bits, stored in a 16-bit or 32-bit signed integer.
+ *  @details The raw integer is public and the class has nothing else in it,
+ *           so a @c Fixed is the same size as its integer and can be copied
+ *           through shares and queues. Arithmetic between two numbers needs
+ *           both in the same format; @c convert() changes formats.
+ *
+ *           @section usage_fixed Usage
+ *           @code
+ *           #include "fixedpoint.h"
+ *           ...
+ *           Q15 gain = Q15::from (0.25);
+ *           Q15 reading = Q15::from_raw (analogRead (A0) << 3);
+ *           Q15 scaled = gain * reading;
+ *           float shown = scaled.to_float ();
+ *           @endcode
+ *  @tparam  FRAC The number of bits after the binary point
+ *  @tparam  Storage The type of the raw integer, @c int16_t or @c int32_t
+ */
+template <uint8_t FRAC, class Storage = int32_t>
+class Fixed
+{
+public:
+    /// The type of the raw integer
+    typedef Storage Raw;
+
+    /// The type which holds a product of two raw integers
+    typedef typename FixedTraits<Storage>::Wide Wide;
+
+    /// The number of bits after the binary point
+    static const uint8_t FRAC_BITS = FRAC;
+
+    static_assert (FRAC < sizeof (Storage) * 8,
+                   "A fixed-point number needs a sign bit");
+
+    Storage raw;                          ///< The number times 2^FRAC
+
+    /// Create a number whose value is undefined, as for a plain integer
+    Fixed (void) = default;
+
+    /** @brief   Create a number from its raw integer.
+     *  @param   bits The number times 2^FRAC
+     *  @returns The number
+     */
+    static constexpr Fixed from_raw (Storage bits)
+    {
+        return Fixed (bits, 0);
+    }
+
+    /** @brief   Create a number from a floating-point one, saturating.
+     *  @details With a constant argument this is worked out by the compiler,
+     *           so no floating-point code is run.
+     *  @param   value The number to be converted
+     *  @returns The nearest fixed-point number
+     */
+    static constexpr Fixed from (double value)
+    {
+        return Fixed (fixed_saturate<Storage> (fixed_raw (value, FRAC)), 0);
+    }
+
+    /// Return the largest number in this format
+    static constexpr Fixed max (void)
+    {
+        return from_raw (std::numeric_limits<Storage>::max ());
+    }
+
+    /// Return the smallest (most negative) number in this format
+    static constexpr Fixed min (void)
+    {
+        return from_raw (std::numeric_limits<Storage>::min ());
+    }
+
+    /// Return the number as a @c float
+    float to_float (void) const
+    {
+        return raw * (1.0f / (float)(INT64_C (1) << FRAC));
+    }
+
+    /// Return the number as a @c double
+    double to_double (void) const
+    {
+        return raw * (1.0 / (double)(INT64_C (1) << FRAC));
+    }
+
+    /** @brief   Convert the number to another fixed-point format.
+     *  @details Bits shifted out on the right are rounded off; numbers which
+     *           won't fit saturate.
+     *  @tparam  TO_FRAC The number of fraction bits in the new format
+     *  @tparam  ToStorage The raw integer type of the new format
+     *  @returns The number in the new format
+     */
+    template <uint8_t TO_FRAC, class ToStorage = Storage>
+    Fixed<TO_FRAC, ToStorage> convert (void) const
+    {
+        int64_t value = raw;
+        if (TO_FRAC > FRAC)
+        {
+            value *= INT64_C (1) << ((TO_FRAC - FRAC) & 63);
+        }
+        else if (TO_FRAC < FRAC)
+        {
+            value = (value + (INT64_C (1) << ((FRAC - TO_FRAC - 1) & 63)))
+                    >> ((FRAC - TO_FRAC) & 63);
+        }
+        value = (value > std::numeric_limits<ToStorage>::max ())
+                ? std::numeric_limits<ToStorage>::max ()
+              : (value < std::numeric_limits<ToStorage>::min ())
+                ? std::numeric_limits<ToStorage>::min () : value;
+        return Fixed<TO_FRAC, ToStorage>::from_raw ((ToStorage)value);
+    }
+
+    /// Add two numbers, saturating
+    Fixed operator + (Fixed other) const
+    {
+        return from_raw (fixed_saturate<Storage> ((Wide)raw + other.raw));
+    }
+
+    /// Subtract two numbers, saturating
+    Fixed operator - (Fixed other) const
+    {
+        return from_raw (fixed_saturate<Storage> ((Wide)raw - other.raw));
+    }
+
+    /// Negate a number; the most negative number becomes the largest
+    Fixed operator - (void) const
+    {
+        return from_raw (fixed_saturate<Storage> (-(Wide)raw));
+    }
+
+    /// Multiply two numbers, rounding and saturating
+    Fixed operator * (Fixed other) const
+    {
+        Wide product = (Wide)raw * other.raw + ((Wide)1 << (FRAC - 1));
+        return from_raw (fixed_saturate<Storage> (product >> FRAC));
+    }
+
+    /// Add another number to this one, saturating
+    Fixed& operator += (Fixed other)
+    {
+        return *this = *this + other;
+    }
+
+    /// Subtract another number from this one, saturating
+    Fixed& operator -= (Fixed other)
+    {
+        return *this = *this - other;
+    }
+
+    /// Multiply this number by another, rounding and saturating
+    Fixed& operator *= (Fixed other)
+    {
+        return *this = *this * other;
+    }
+
+    /// Compare two numbers
+    bool operator == (Fixed other) const { return raw == other.raw; }
+
+    /// Compare two numbers
+    bool operator != (Fixed other) const { return raw != other.raw; }
+
+    /// Compare two numbers
+    bool operator < (Fixed other) const { return raw < other.raw; }
+
+    /// Compare two numbers
+    bool operator > (Fixed other) const { return raw > other.raw; }
+
+    /// Compare two numbers
+    bool operator <= (Fixed other) const { return raw <= other.raw; }
+
+    /// Compare two numbers
+    bool operator >= (Fixed other) const { return raw >= other.raw; }
+
+private:
+    /// Make a number from a raw integer; the second parameter tells this
+    /// constructor from one which converts an integer's value
+    constexpr Fixed (Storage bits, int) : raw (bits)
+    {
+    }
+};
+
+
+/// Numbers from -1 to just under 1 in 16 bits, for signals such as
+/// scaled ADC readings and PWM duty cycles
+typedef Fixed<15, int16_t> Q15;
+
+/// Numbers from -1 to just under 1 in 32 bits
+typedef Fixed<31, int32_t> Q31;
+
+/// Numbers from -32768 to just under 32768 with 16 bits of fraction
+typedef Fixed<16, int32_t> Q16_16;
+
+
+/** @brief   Shares of fixed-point numbers report the type of their raw
+ *           integers, so telemetry and logs carry the raw values.
+ *  @tparam  FRAC The number of bits after the binary point
+ *  @tparam  Storage The type of the raw integer
+ */
+template <uint8_t FRAC, class Storage>
+struct ShareType<Fixed<FRAC, Storage> >
+{
+    /// The code for the raw integer type
+    static const uint8_t code = ShareType<Storage>::code;
+};
+
+#endif // _FIXEDPOINT_H_
@@ -0,0 +1,375 @@
+//*****************************************************************************
+/** @file    histogramshare.h
+ *  @brief   A share which counts how many samples fall into each of a set of
+ *           bins, for finding the distributions of latencies and readings.
+ *  @details A mean and standard deviation don't show the rare long delay
+ *           which makes a control loop miss its deadline; a histogram does.
+ *           A @c HistogramShare counts samples into bins whose layout is set
+ *           when the program is compiled, either equal-width bins or bins
+ *           which double in width, which suit times spanning microseconds to
+ *           seconds. Counting a sample is one atomic increment, with no lock,
+ *           so samples may be put in from any task or ISR.
+ *
+ *           The counts can be printed by @c print_all_shares() or written in
+ *           a compact binary form, described with @c export_binary(), for a
+ *           program on a PC to read.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _HISTOGRAMSHARE_H_
+#define _HISTOGRAMSHARE_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+/** @brief   Bin layout in which every bin has the same width.
+ *  @details Samples below @c LOW_EDGE are counted in the first bin and samples
+ *           beyond the last bin in the last bin, so those two bins also show
+ *           how many samples were out of range.
+ *  @tparam  LOW_EDGE The lowest value which goes into the first bin
+ *  @tparam  BIN_WIDTH The width of each bin; a power of two is quickest
+ */
+template <int32_t LOW_EDGE, uint32_t BIN_WIDTH>
+struct LinearBins
+{
+    static_assert (BIN_WIDTH > 0, "Histogram bins must have a nonzero width");
+
+    /// The type of the samples which are counted
+    typedef int32_t ValueType;
+
+    /// The number which identifies this layout in binary exports
+    static const uint8_t LAYOUT_ID = 0;
+
+    /** @brief   Find the bin into which a sample goes.
+     *  @param   value The sample
+     *  @param   n_bins The number of bins in the histogram
+     *  @returns The index of the bin
+     */
+    static uint16_t bin (int32_t value, uint16_t n_bins)
+    {
+        if (value < LOW_EDGE)
+        {
+            return 0;
+        }
+        uint32_t index = (uint32_t)((int64_t)value - LOW_EDGE) / BIN_WIDTH;
+        return (index < n_bins) ? index : n_bins - 1;
+    }
+
+    /** @brief   Find the lowest value which goes into a bin.
+     *  @param   index The index of the bin
+     *  @returns The bin's lower edge
+     */
+    static int32_t lower_edge (uint16_t index)
+    {
+        return LOW_EDGE + (int32_t)(index * BIN_WIDTH);
+    }
+};
+
+
+/** @brief   Bin layout in which each bin is twice as wide as the one before.
+ *  @details Bin 0 holds zero, bin 1 holds 1, bin 2 holds 2 and 3, bin 3 holds
+ *           4 through 7, and so on; bin @e i holds samples whose highest set
+ *           bit is bit @e i - 1. Finding the bin takes one count-leading-zeros
+ *           instruction. Samples too large for the last bin go into it.
+ */
+struct Log2Bins
+{
+    /// The type of the samples which are counted
+    typedef uint32_t ValueType;
+
+    /// The number which identifies this layout in binary exports
+    static const uint8_t LAYOUT_ID = 1;
+
+    /** @brief   Find the bin into which a sample goes.
+     *  @param   value The sample
+     *  @param   n_bins The number of bins in the histogram
+     *  @returns The index of the bin
+     */
+    static uint16_t bin (uint32_t value, uint16_t n_bins)
+    {
+        uint16_t index = (value == 0) ? 0 : 32 - __builtin_clz (value);
+        return (index < n_bins) ? index : n_bins - 1;
+    }
+
+    /** @brief   Find the lowest value which goes into a bin.
+     *  @param   index The index of the bin
+     *  @returns The bin's lower edge
+     */
+    static uint32_t lower_edge (uint16_t index)
+    {
+        return (index == 0) ? 0 : (1UL << (index - 1));
+    }
+};
+
+
+/** @brief   Class which counts samples into the bins of a histogram.
+ *  @details The counts are kept in two banks. Samples are counted in the
+ *           active bank; a task which takes a snapshot with reset switches
+ *           samples to the other bank, waits for any @c put() which was
+ *           counting in the old bank to finish, then copies and clears the
+ *           old bank. Each sample is therefore counted in exactly one
+ *           snapshot, and a snapshot holds exactly the samples put in between
+ *           two resets, without samples ever waiting for a lock. Only one
+ *           task at a time should take snapshots with reset.
+ *
+ *           @section usage_hist Usage
+ *           @code
+ *           #include "histogramshare.h"
+ *           ...
+ *           /// Times from the encoder interrupt to the control task, in us
+ *           HistogramShare<20> encoder_latency ("Enc. Latency");
+ *
+ *           /// Motor currents from -2000 to 1999 mA, in 100 mA bins
+ *           HistogramShare<40, LinearBins<-2000, 100> > current_mA ("Amps");
+ *           @endcode
+ *           In the control task:
+ *           @code
+ *           encoder_latency.put (micros () - encoder_isr_time);
+ *           @endcode
+ *           In a monitoring task, each few seconds:
+ *           @code
+ *           encoder_latency.export_binary (Serial);   // Sends and resets
+ *           @endcode
+ *  @tparam  N_BINS The number of bins
+ *  @tparam  Layout A class such as @c Log2Bins (the default) or 
+ *           @c LinearBins which says which bin each sample goes into
+ */
+template <uint16_t N_BINS, class Layout = Log2Bins>
+class HistogramShare : public BaseShare
+{
+    static_assert (N_BINS >= 2, "A histogram needs at least two bins");
+
+public:
+    /// The type of the samples which are counted
+    typedef typename Layout::ValueType ValueType;
+
+protected:
+    std::atomic<uint32_t> counts[2][N_BINS]; ///< Two banks of counts
+    std::atomic<uint8_t> active;          ///< The bank now counting
+    std::atomic<uint16_t> putting[2];     ///< Puts under way in each bank
+
+public:
+    /** @brief   Create a histogram with all its counts zero.
+     *  @param   p_name A name for the histogram, shown by
+     *           @c print_all_shares()
+     */
+    HistogramShare (const char* p_name = NULL)
+        : BaseShare (p_name)
+    {
+        for (uint16_t index = 0; index < N_BINS; index++)
+        {
+            counts[0][index] = 0;
+            counts[1][index] = 0;
+        }
+        active = 0;
+        putting[0] = 0;
+        putting[1] = 0;
+    }
+
+    /** @brief   Count a sample in the bin in which it belongs.
+     *  @details This method may be called from any task or ISR. 
+     *  @param   value The sample to be counted
+     */
+    void put (ValueType value)
+    {
+        uint16_t index = Layout::bin (value, N_BINS);
+
+        // Register as putting into the active bank, then make sure it's still
+        // active; if a snapshot switched banks in between, use the new one
+        uint8_t bank;
+        for (;;)
+        {
+            bank = active.load ();
+            putting[bank].fetch_add (1);
+            if (active.load () == bank)
+            {
+                break;
+            }
+            putting[bank].fetch_sub (1);
+        }
+        counts[bank][index].fetch_add (1);
+        putting[bank].fetch_sub (1);
+    }
+
+    /** @brief   Operator which counts a sample.
+     *  @param   value The sample to be counted
+     */
+    void operator << (ValueType value)
+    {
+        put (value);
+    }
+
+    /** @brief   Copy the counts into an array, optionally resetting them.
+     *  @details With @c and_reset set, this method must be called from a
+     *           task, as it may have to wait a moment for puts in other tasks
+     *           to finish. Without it, the counts are copied one bin at a time
+     *           while samples may still be arriving.
+     *  @param   p_counts Pointer to an array of @c N_BINS counts to be filled,
+     *           or @c NULL to throw the counts away when resetting them
+     *  @param   and_reset @c true to reset the counts to zero (default
+     *           @c true)
+     *  @returns The total number of samples in the copied counts
+     */
+    uint32_t snapshot (uint32_t* p_counts, bool and_reset = true)
+    {
+        uint32_t total = 0;
+
+        if (!and_reset)
+        {
+            for (uint16_t index = 0; index < N_BINS; index++)
+            {
+                p_counts[index] = counts[0][index].load ()
+                                + counts[1][index].load ();
+                total += p_counts[index];
+            }
+            return total;
+        }
+
+        // Switch the active bank, then wait until no put is still using the
+        // old one; yielding lets a preempted lower priority put finish
+        uint8_t old_bank = active.load ();
+        active.store (old_bank ^ 1);
+        while (putting[old_bank].load () != 0)
+        {
+            vTaskDelay (1);
+        }
+        for (uint16_t index = 0; index < N_BINS; index++)
+        {
+            uint32_t count = counts[old_bank][index].exchange (0);
+            if (p_counts != NULL)
+            {
+                p_counts[index] = count;
+            }
+            total += count;
+        }
+        return total;
+    }
+
+    /// Reset the counts to zero; this must be called from a task
+    void reset_stats (void)
+    {
+        snapshot (NULL, true);
+    }
+
+    /** @brief   Return the lowest value which goes into a bin.
+     *  @param   index The index of the bin
+     *  @returns The bin's lower edge
+     */
+    static ValueType lower_edge (uint16_t index)
+    {
+        return Layout::lower_edge (index);
+    }
+
+    /** @brief   Write the counts to a serial device in a compact binary form
+     *           and reset them.
+     *  @details The record written is:
+     *           - The byte @c 'H' (0x48)
+     *           - The layout: 0 for @c LinearBins, 1 for @c Log2Bins
+     *           - The number of bins, 2 bytes, least significant first
+     *           - The lower edge of the first bin and of the second bin, each
+     *             4 bytes, least significant first, from which a reader can
+     *             work out every bin's edges 
+     *           - The length of the share's name and the name itself, without
+     *             a terminating null
+     *           - Each bin's count as an unsigned LEB128 number: 7 bits per
+     *             byte, least significant first, with the top bit set in each
+     *             byte but the last. Empty bins take one byte.
+     *
+     *           The counts are snapshotted and reset as by @c snapshot(), so
+     *           this method must be called from a task. 
+     *  @param   out Reference to a serial device or other @c Print object
+     *  @returns The number of bytes written
+     */
+    size_t export_binary (Print& out)
+    {
+        uint32_t values[N_BINS];
+        snapshot (values, true);
+
+        size_t written = out.write ((uint8_t)'H');
+        written += out.write (Layout::LAYOUT_ID);
+        written += write_le (out, N_BINS, 2);
+        written += write_le (out, (uint32_t)Layout::lower_edge (0), 4);
+        written += write_le (out, (uint32_t)Layout::lower_edge (1), 4);
+        uint8_t name_length = strnlen (name, sizeof (name));
+        written += out.write (name_length);
+        written += out.write ((const uint8_t*)name, name_length);
+        for (uint16_t index = 0; index < N_BINS; index++)
+        {
+            uint32_t value = values[index];
+            while (value >= 0x80)
+            {
+                written += out.write ((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            written += out.write ((uint8_t)value);
+        }
+        return written;
+    }
+
+    /** @brief   Print the histogram's name, type and counts within a list.
+     *  @details Only bins which have counts in them are printed, each as the
+     *           bin's lower edge, a colon, and the count. The counts are not
+     *           reset.
+     *  @param   printer Reference to a serial device on which to print
+     */
+    void print_in_list (Print& printer)
+    {
+        uint32_t values[N_BINS];
+        uint32_t total = snapshot (values, false);
+
+        printer.printf ("%-16shistogram\t", name);
+        printer << "n=" << total;
+        for (uint16_t index = 0; index < N_BINS; index++)
+        {
+            if (values[index] != 0)
+            {
+                printer << ' ' << Layout::lower_edge (index) << ':'
+                        << values[index];
+            }
+        }
+        printer << endl;
+    }
+
+protected:
+    /** @brief   Write the low bytes of a number, least significant first.
+     *  @param   out Reference to the device on which to write
+     *  @param   value The number to be written
+     *  @param   n_bytes How many of the number's bytes to write
+     *  @returns The number of bytes written
+     */
+    static size_t write_le (Print& out, uint32_t value, uint8_t n_bytes)
+    {
+        size_t written = 0;
+        for (uint8_t count = 0; count < n_bytes; count++)
+        {
+            written += out.write ((uint8_t)(value >> (8 * count)));
+        }
+        return written;
+    }
+};
+
+#endif // _HISTOGRAMSHARE_H_
@@ -0,0 +1,429 @@
+//*****************************************************************************
+/** @file    isrbatch.h
+ *  @brief   A channel which carries data from an interrupt service routine to
+ *           a task in batches, waking the task once per batch rather than
+ *           once per item.
+ *  @details An ISR which reads an ADC or an encoder thousands of times per
+ *           second and puts each reading into a @c Queue with @c ISR_put()
+ *           wakes the receiving task for every item, costing a pair of context
+ *           switches each time. This file contains a class which holds items
+ *           in a ring buffer and wakes the receiving task only when a number
+ *           of items called the watermark has piled up, or when the oldest
+ *           item has waited for a given maximum latency. The task then takes
+ *           the whole batch with one call, which is the deferred interrupt
+ *           processing pattern recommended in the FreeRTOS documentation.
+ *
+ *  @date 2026-Oct-17 Original file
+ *  @date 2026-Oct-17 Buffer sizes are powers of two, so slots survive a wrap
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _ISRBATCH_H_
+#define _ISRBATCH_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+/** @brief   Implements a channel which carries items from one ISR to one
+ *           task in batches.
+ *  @details One ISR puts items into the channel's ring buffer with
+ *           @c ISR_put(), which is very quick, as it only makes a kernel call
+ *           when the batch is complete and the receiving task is waiting. One
+ *           task takes items with @c get_batch(), which waits until either
+ *           the watermark number of items are in the buffer or the oldest
+ *           item has been waiting for the maximum latency, then copies all
+ *           the items it can into an array at once. When there are no items,
+ *           the task wakes up once per maximum latency to check, so a lone
+ *           item never waits much longer than that. The time at which each
+ *           item was put in is kept with it, costing four bytes per item, so
+ *           items left behind by one batch are timed from when they arrived.
+ *
+ *           If the buffer fills because the task isn't keeping up, new items
+ *           are thrown away and counted as overruns. The buffer should
+ *           therefore hold several batches. 
+ *
+ *           The channel keeps statistics which are shown by
+ *           @c print_all_shares(): the most items which have been in the
+ *           buffer, the average batch size, the longest time in microseconds
+ *           which the oldest item in a batch waited before being taken, and
+ *           the number of overruns. The number of times the task has woken up
+ *           is available from @c get_wakes(). 
+ *
+ *           @section batch_usage Usage
+ *           The channel is created near the top of the file containing
+ *           @c setup(), with the buffer size, the watermark, the maximum
+ *           latency in RTOS ticks and a name:
+ *           @code
+ *           #include "isrbatch.h"
+ *           ...
+ *           /// Carries ADC readings from the timer ISR to the filter task
+ *           IsrBatch<uint16_t> adc_batch (256, 64, 10, "ADC");
+ *           @endcode
+ *           The ISR puts each reading into the channel:
+ *           @code
+ *           adc_batch.ISR_put (analogRead (A0));
+ *           @endcode
+ *           The task takes readings a batch at a time:
+ *           @code
+ *           uint16_t readings[64];
+ *           for (;;)
+ *           {
+ *               uint16_t how_many = adc_batch.get_batch (readings, 64);
+ *               for (uint16_t index = 0; index < how_many; index++)
+ *               {
+ *                   ...                            // Filter each reading
+ *               }
+ *           }
+ *           @endcode
+ */
+template <class DataType> class IsrBatch : public BaseShare
+{
+protected:
+    DataType* p_buffer;                   ///< Ring buffer of items
+    uint16_t buf_size;                    ///< Number of items in buffer
+    uint16_t mask;                        ///< Buffer size minus one
+    uint16_t watermark;                   ///< Items which make up a batch
+    TickType_t max_latency;               ///< Longest wait for a batch
+    std::atomic<uint32_t> head;           ///< Count of items put in
+    std::atomic<uint32_t> tail;           ///< Count of items taken out
+    std::atomic<bool> waiting;            ///< Receiving task is blocked
+    SemaphoreHandle_t batch_signal;       ///< Wakes the receiving task
+    uint32_t* p_stamps;                   ///< When each item was put in, us
+    uint32_t latency_us;                  ///< Longest wait, in microseconds
+    uint32_t overruns;                    ///< Items lost to a full buffer
+    uint16_t max_full;                    ///< Most items in buffer at once
+    uint32_t batches;                     ///< Number of batches taken
+    uint32_t items_taken;                 ///< Number of items taken
+    uint32_t wakes;                       ///< Times receiver woke up
+    uint32_t max_wait_us;                 ///< Longest wait of oldest item
+
+    // Put an item into the buffer and wake the receiver if a batch is ready
+    bool put_item (const DataType& item, bool in_ISR);
+
+public:
+    // Create a channel with a ring buffer of the given size
+    IsrBatch (uint16_t size, uint16_t batch_size, TickType_t latency,
+              const char* p_name = NULL);
+
+    /** @brief   Put an item into the channel from within an ISR.
+     *  @param   item The item to be put into the channel
+     *  @returns @c true if the item was put in, @c false if the buffer was
+     *           full and the item was lost
+     */
+    bool ISR_put (const DataType& item)
+    {
+        return put_item (item, true);
+    }
+
+    /** @brief   Put an item into the channel from within a task.
+     *  @details This method must @b not be used within an ISR. It's here for
+     *           testing and for programs which sometimes send items from a
+     *           task; one ISR or one task may put items into a channel, but 
+     *           not both.
+     *  @param   item The item to be put into the channel
+     *  @returns @c true if the item was put in, @c false if the buffer was
+     *           full and the item was lost
+     */
+    bool put (const DataType& item)
+    {
+        return put_item (item, false);
+    }
+
+    /** @brief   Operator which puts an item into the channel.
+     *  @details This operator checks whether it's running in an ISR and
+     *           calls @c ISR_put() or @c put() as appropriate.
+     *  @param   item The item to be put into the channel
+     */
+    void operator << (const DataType& item)
+    {
+        put_item (item, CHECK_IF_IN_ISR ());
+    }
+
+    // Wait for a batch of items and take as many as will fit in an array
+    uint16_t get_batch (DataType* p_items, uint16_t max_items,
+                        TickType_t wait_time = portMAX_DELAY);
+
+    /** @brief   Return the number of items waiting in the buffer.
+     *  @returns The number of items which have been put in but not taken
+     */
+    uint16_t available (void)
+    {
+        return (uint16_t)(head.load (std::memory_order_acquire)
+                          - tail.load (std::memory_order_relaxed));
+    }
+
+    /** @brief   Return the number of times the receiving task has woken up.
+     *  @details Each wake-up costs a pair of context switches; comparing
+     *           this count with the number of items shows how much batching
+     *           has saved.
+     *  @returns The number of times @c get_batch() has stopped waiting
+     */
+    uint32_t get_wakes (void)
+    {
+        return wakes;
+    }
+
+    /** @brief   Return the number of items which have been taken.
+     *  @returns The number of items taken by @c get_batch()
+     */
+    uint32_t get_items (void)
+    {
+        return items_taken;
+    }
+
+    /** @brief   Return the longest time the oldest item in a batch waited.
+     *  @returns The longest wait in microseconds
+     */
+    uint32_t get_max_wait_us (void)
+    {
+        return max_wait_us;
+    }
+
+    /** @brief   Indicates whether this channel is usable.
+     *  @details This method returns @c true if memory for the buffer and the
+     *           semaphore were successfully allocated.
+     *  @returns @c true if this channel is usable, @c false if not
+     */
+    bool usable (void)
+    {
+        return (p_buffer != NULL && p_stamps != NULL
+                && batch_signal != NULL);
+    }
+
+    // Print the channel's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+}; // class IsrBatch
+
+
+/** @brief   Create a batching channel.
+ *  @param   size The number of items the ring buffer can hold; this should
+ *           be several times the batch size. It's rounded up to a power of
+ *           two, at most 32768, so that each item's slot stays in order when
+ *           the counts of items wrap around
+ *  @param   batch_size The number of items at which the receiving task is
+ *           woken up, also called the watermark
+ *  @param   latency The longest time, in RTOS ticks, for which an item may
+ *           wait before the receiving task is woken up to take it
+ *  @param   p_name A name for the channel, shown by @c print_all_shares()
+ */
+template <class DataType>
+IsrBatch<DataType>::IsrBatch (uint16_t size, uint16_t batch_size,
+                              TickType_t latency, const char* p_name)
+    : BaseShare (p_name)
+{
+    buf_size = 1;
+    while (buf_size < size && buf_size < 0x8000)
+    {
+        buf_size <<= 1;
+    }
+    mask = buf_size - 1;
+    p_buffer = new DataType[buf_size];
+    p_stamps = new uint32_t[buf_size];
+    watermark = (batch_size > 0 && batch_size <= buf_size) ? batch_size
+                                                           : buf_size;
+    max_latency = (latency > 0) ? latency : 1;
+    latency_us = max_latency * portTICK_PERIOD_MS * 1000UL;
+    head = 0;
+    tail = 0;
+    waiting = false;
+    batch_signal = xSemaphoreCreateBinary ();
+    overruns = 0;
+    max_full = 0;
+    batches = 0;
+    items_taken = 0;
+    wakes = 0;
+    max_wait_us = 0;
+}
+
+
+/** @brief   Put an item into the buffer and wake the receiver if needed.
+ *  @details The time is saved with each item, so the receiver knows how
+ *           long the oldest item has waited even when an earlier batch left
+ *           some items behind. When the buffer
+ *           reaches the watermark and the receiver is blocked, the receiver
+ *           is woken; this is the only kernel call made while putting items.
+ *  @param   item The item to be put into the channel
+ *  @param   in_ISR @c true if called from within an ISR
+ *  @returns @c true if the item was put in, @c false if the buffer was full
+ */
+template <class DataType>
+bool IsrBatch<DataType>::put_item (const DataType& item, bool in_ISR)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+
+    uint32_t now_head = head.load (std::memory_order_relaxed);
+    uint16_t count = (uint16_t)(now_head
+                                - tail.load (std::memory_order_acquire));
+    if (count >= buf_size)
+    {
+        overruns++;
+        return false;
+    }
+    p_buffer[now_head & mask] = item;
+    p_stamps[now_head & mask] = micros ();
+    head.store (now_head + 1, std::memory_order_release);
+
+    count++;
+    if (count > max_full)
+    {
+        max_full = count;
+    }
+    if (count >= watermark && waiting.exchange (false))
+    {
+        if (in_ISR)
+        {
+            BaseType_t wake_up;
+            xSemaphoreGiveFromISR (batch_signal, &wake_up);
+        }
+        else
+        {
+            xSemaphoreGive (batch_signal);
+        }
+    }
+    return true;
+}
+
+
+/** @brief   Wait for a batch of items and take them.
+ *  @details This method returns as soon as the watermark number of items
+ *           are in the buffer, or the oldest item has waited for the maximum
+ *           latency, or the wait time has passed. It then copies as many items
+ *           as are available, up to @c max_items, into the given array. It
+ *           must be called by only one task, and not from within an ISR.
+ *  @param   p_items A pointer to an array into which the items are copied
+ *  @param   max_items The number of items which fit into the array
+ *  @param   wait_time The longest time to wait for items, in RTOS ticks
+ *           (default @c portMAX_DELAY, which means forever)
+ *  @returns The number of items taken, which is 0 only if no items arrived
+ *           within the wait time
+ */
+template <class DataType>
+uint16_t IsrBatch<DataType>::get_batch (DataType* p_items, uint16_t max_items,
+                                        TickType_t wait_time)
+{
+    if (!usable () || max_items == 0)
+    {
+        return 0;
+    }
+    TickType_t start = xTaskGetTickCount ();
+
+    for (;;)
+    {
+        TickType_t now = xTaskGetTickCount ();
+        uint16_t count = available ();
+        bool timed_out = (wait_time != portMAX_DELAY)
+                         && (now - start >= wait_time);
+
+        // Find how long the oldest item has waited; as the task can only
+        // sleep whole ticks, an item whose time is up within the next tick
+        // counts as having waited long enough
+        const uint32_t tick_us = portTICK_PERIOD_MS * 1000UL;
+        uint32_t age_us = 0;
+        if (count > 0)
+        {
+            age_us = micros () - p_stamps[tail.load (std::memory_order_relaxed)
+                                          & mask];
+        }
+
+        // Take a batch if there's a full one, or if anything has waited long
+        // enough, or if we've run out of time to wait
+        if (count >= watermark || count >= max_items
+            || (count > 0 && (age_us + tick_us > latency_us || timed_out)))
+        {
+            break;
+        }
+        if (timed_out)
+        {
+            return 0;
+        }
+
+        // Sleep until the oldest item's time is up, or one latency period if
+        // there aren't any items, unless a full batch wakes us sooner
+        TickType_t sleep = (count > 0) ? (latency_us - age_us) / tick_us
+                                       : max_latency;
+        if (wait_time != portMAX_DELAY && wait_time - (now - start) < sleep)
+        {
+            sleep = wait_time - (now - start);
+        }
+        waiting.store (true);
+        if (available () < watermark)
+        {
+            xSemaphoreTake (batch_signal, sleep);
+            wakes++;
+        }
+        waiting.store (false);
+
+        // Remove any signal which came just after we stopped waiting
+        xSemaphoreTake (batch_signal, 0);
+    }
+
+    // Take the items, freeing their space all at once
+    uint32_t now_tail = tail.load (std::memory_order_relaxed);
+    uint16_t count = available ();
+    count = (count < max_items) ? count : max_items;
+    for (uint16_t index = 0; index < count; index++)
+    {
+        p_items[index] = p_buffer[(now_tail + index) & mask];
+    }
+    uint32_t waited = micros () - p_stamps[now_tail & mask];
+    tail.store (now_tail + count, std::memory_order_release);
+
+    batches++;
+    items_taken += count;
+    if (waited > max_wait_us)
+    {
+        max_wait_us = waited;
+    }
+    return count;
+}
+
+
+/** @brief   Print the channel's status within a list of shares.
+ *  @details This method prints a line showing the channel's name, the most
+ *           items which have been in the buffer and the buffer's size, the
+ *           average batch size, the longest wait of the oldest item in a
+ *           batch in microseconds, and the number of items lost to overruns.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class DataType>
+void IsrBatch<DataType>::print_in_list (Print& printer)
+{
+    // Print this channel's name and pad it to 16 characters
+    printer.printf ("%-16sbatch\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << max_full << '/' << buf_size << ' '
+            << (batches ? items_taken / batches : 0) << "/batch, "
+            << max_wait_us << " us, " << overruns << " overruns" << endl;
+}
+
+#endif // _ISRBATCH_H_
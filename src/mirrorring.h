@@ -0,0 +1,266 @@
+//*****************************************************************************
+/** @file    mirrorring.h
+ *  @brief   A ring buffer whose newest items can always be read as one
+ *           contiguous block, for sliding-window signal processing.
+ *  @details A task which runs a sliding window over samples, such as a
+ *           filter, a peak finder or an FFT of the last 256 readings, wants
+ *           the window as one array. In an ordinary ring buffer the window
+ *           is split in two wherever the ring wraps around, so it must be
+ *           copied out first. A @c MirrorRing avoids the copy by keeping
+ *           every item twice, @c size items apart, so that any run of up to
+ *           @c size items ending at the newest one lies in one piece:
+ *           - On a microcontroller, each item put in is written to both
+ *             halves of a buffer twice the size of the ring. That costs
+ *             one more store per item, but getting a window is free.
+ *           - On Linux, as in host programs and the host simulation, the
+ *             same memory is mapped twice, one copy right after the other,
+ *             so each item is written once and appears in both places.
+ *             The ring is then rounded up to a whole number of memory
+ *             pages.
+ *
+ *           A ring is meant to be used by one task, which puts items in and
+ *           reads windows; items usually come to that task through a
+ *           @c Queue, from which @c take_all() moves them in.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _MIRRORRING_H_
+#define _MIRRORRING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+#include "span.h"
+
+#ifdef __linux__
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+
+/** @brief   Class for a ring buffer whose newest items can be read as one
+ *           contiguous @c Span.
+ *
+ *           @section usage_mirror_ring Usage
+ *           @code
+ *           #include "mirrorring.h"
+ *           ...
+ *           // In the task which processes readings from a queue
+ *           MirrorRing<int16_t> history (256);
+ *           for (;;)
+ *           {
+ *               history.put (readings.get ());      // Wait for one reading
+ *               history.take_all (readings);        // and take any others
+ *               Span<int16_t> window = history.window (256);
+ *               if (window.size () == 256)
+ *               {
+ *                   find_peaks (window.data (), window.size ());
+ *               }
+ *           }
+ *           @endcode
+ *  @tparam  DataType The type of the items, which must be trivially copyable
+ */
+template <class DataType> class MirrorRing
+{
+    static_assert (std::is_trivially_copyable<DataType>::value,
+                   "MirrorRing items are copied as bytes");
+
+protected:
+    DataType* p_data;                     ///< The doubled buffer
+    uint32_t ring_size;                   ///< Items in one half
+    uint32_t window_limit;                ///< Longest window, as asked for
+    uint32_t newest;                      ///< Index where the next item goes
+    uint32_t filled;                      ///< Items put in, up to the size
+    bool mapped;                          ///< The halves are one memory
+
+    // Set up a buffer in which the halves are the same memory
+    bool map_twice (uint32_t items);
+
+public:
+    // Create a ring which holds at least the given number of items
+    MirrorRing (uint32_t size, bool allow_mapping = true);
+
+    // Free the ring's memory
+    ~MirrorRing (void);
+
+    /** @brief   Put an item into the ring, pushing out the oldest if the ring
+     *           is full.
+     *  @param   item The item to be put in
+     */
+    void put (const DataType& item)
+    {
+        p_data[newest] = item;
+        if (!mapped)
+        {
+            p_data[newest + ring_size] = item;
+        }
+        newest = (newest + 1 < ring_size) ? newest + 1 : 0;
+        filled = (filled < ring_size) ? filled + 1 : filled;
+    }
+
+    /** @brief   Move all the items waiting in a queue into the ring, without
+     *           waiting for more.
+     *  @details Any class with @c is_empty() and @c get() methods will do.
+     *  @param   queue The queue from which items are taken
+     *  @returns The number of items moved
+     */
+    template <class Source> uint32_t take_all (Source& queue)
+    {
+        uint32_t moved = 0;
+        while (!queue.is_empty ())
+        {
+            put (queue.get ());
+            moved++;
+        }
+        return moved;
+    }
+
+    /** @brief   Return the newest items as one block, oldest first.
+     *  @details The span refers to the ring's own memory; it stays valid
+     *           until that many more items have been put in.
+     *  @param   length The number of items wanted
+     *  @returns A span of the newest @c length items, or fewer if fewer have
+     *           been put in or @c length is more than the size asked for
+     *           when the ring was created
+     */
+    Span<DataType> window (uint32_t length)
+    {
+        length = (length < filled) ? length : filled;
+        length = (length < window_limit) ? length : window_limit;
+        return Span<DataType> (p_data + newest + ring_size - length, length);
+    }
+
+    /// Return the number of items the ring holds, which may have been
+    /// rounded up from the size asked for
+    uint32_t size (void)
+    {
+        return ring_size;
+    }
+
+    /// Return @c true if the ring's halves are mapped to the same memory,
+    /// or @c false if each item is written twice
+    bool is_mapped (void)
+    {
+        return mapped;
+    }
+
+    /// Empty the ring
+    void clear (void)
+    {
+        newest = 0;
+        filled = 0;
+    }
+};
+
+
+/** @brief   Create a ring which holds at least the given number of items.
+ *  @details On Linux the halves are mapped to the same memory if possible;
+ *           if not, or elsewhere, a buffer of twice the size is allocated
+ *           and each item is written to both halves.
+ *  @param   size The longest window which will be read
+ *  @param   allow_mapping @c false to write each item twice even on Linux,
+ *           which is useful for comparing the two methods
+ */
+template <class DataType>
+MirrorRing<DataType>::MirrorRing (uint32_t size, bool allow_mapping)
+{
+    window_limit = (size > 0) ? size : 1;
+    newest = 0;
+    filled = 0;
+    mapped = allow_mapping && map_twice (window_limit);
+    if (!mapped)
+    {
+        ring_size = window_limit;
+        p_data = new DataType[2 * ring_size];
+    }
+}
+
+
+/** @brief   Free the ring's memory.
+ */
+template <class DataType>
+MirrorRing<DataType>::~MirrorRing (void)
+{
+#ifdef __linux__
+    if (mapped)
+    {
+        munmap ((void*)p_data, 2 * ring_size * sizeof (DataType));
+        return;
+    }
+#endif
+    delete[] p_data;
+}
+
+
+/** @brief   Set up a buffer in which the halves are the same memory.
+ *  @details An anonymous memory file is made one half long and mapped
+ *           twice, into two neighboring ranges of addresses which are first
+ *           reserved together so that nothing else can take the second.
+ *  @param   items The smallest number of items the ring may hold
+ *  @returns @c true if the buffer was set up, @c false if it couldn't be
+ */
+template <class DataType>
+bool MirrorRing<DataType>::map_twice (uint32_t items)
+{
+#ifdef __linux__
+    // Each half must be whole pages and a whole number of items
+    size_t page = (size_t)sysconf (_SC_PAGESIZE);
+    size_t bytes = ((items * sizeof (DataType) + page - 1) / page) * page;
+    while (bytes % sizeof (DataType) != 0)
+    {
+        bytes += page;
+    }
+
+    int fd = memfd_create ("mirror_ring", 0);
+    if (fd < 0 || ftruncate (fd, bytes) != 0)
+    {
+        if (fd >= 0)
+        {
+            close (fd);
+        }
+        return false;
+    }
+    uint8_t* p_base = (uint8_t*)mmap (NULL, 2 * bytes, PROT_NONE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    bool good = (p_base != MAP_FAILED)
+        && mmap (p_base, bytes, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+        && mmap (p_base + bytes, bytes, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+    close (fd);
+    if (!good)
+    {
+        if (p_base != MAP_FAILED)
+        {
+            munmap (p_base, 2 * bytes);
+        }
+        return false;
+    }
+    p_data = (DataType*)p_base;
+    ring_size = bytes / sizeof (DataType);
+    return true;
+#else
+    (void)items;
+    return false;
+#endif
+}
+
+#endif // _MIRRORRING_H_
@@ -0,0 +1,346 @@
+//*****************************************************************************
+/** @file    recorder.cpp
+ *  @brief   Source code for a recorder which logs every item put into chosen
+ *           shares and queues, with the time it was put in.
+ *  @details See @c recorder.h for a description of the recorder.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "recorder.h"
+
+
+/** @brief   Log an item which was put into the share.
+ *  @param   p_from Pointer to the share, which is ignored as each channel
+ *           listens to one share only
+ *  @param   p_value Pointer to the item
+ */
+void RecorderChannel::on_put (BaseShare* p_from, const void* p_value)
+{
+    (void)p_from;
+    p_recorder->record (this, p_value);
+}
+
+
+/** @brief   Create a recorder which writes to the given file or device.
+ *  @param   output The file or serial port to which the recording is
+ *           written; it should be open before recording starts
+ *  @param   n_entries The number of items the buffer can hold, rounded up to
+ *           a power of two; each takes 24 bytes (default 512)
+ *  @param   p_name A name for the recorder, shown by @c print_all_shares()
+ */
+ShareRecorder::ShareRecorder (Print& output, uint32_t n_entries,
+                              const char* p_name)
+    : BaseShare (p_name), device (output)
+{
+    uint32_t size = 16;
+    while (size < n_entries)
+    {
+        size <<= 1;
+    }
+    p_ring = new RecorderSlot[size];
+    mask = (p_ring != NULL) ? size - 1 : 0;
+    for (uint32_t index = 0; p_ring != NULL && index < size; index++)
+    {
+        p_ring[index].sequence = index;
+    }
+    head = 0;
+    tail = 0;
+    dropped = 0;
+    dropped_written = 0;
+    n_channels = 0;
+    recording = false;
+    header_due = false;
+    events = 0;
+    frames = 0;
+    bytes = 0;
+    period_ticks = 1;
+}
+
+
+/** @brief   Record the items put into a share or queue.
+ *  @details Shares should be added while setting things up, before
+ *           recording starts. The recorder's own channel numbers are given
+ *           in the order shares are added.
+ *  @param   share The share or queue to be recorded
+ *  @returns @c true if it was added, @c false if its items aren't plain
+ *           numbers or there are already @c RECORDING_MAX_CHANNELS channels
+ */
+bool ShareRecorder::add (BaseShare& share)
+{
+    uint8_t type = share.get_value_type ();
+    if (mask == 0 || !framer.add_channel (type))
+    {
+        return false;
+    }
+    RecorderChannel& channel = channels[n_channels];
+    channel.p_recorder = this;
+    channel.p_share = &share;
+    channel.index = n_channels;
+    channel.type = type;
+    n_channels++;
+    share.add_listener (&channel);
+    return true;
+}
+
+
+/** @brief   Record the items put into a share or queue found by its name.
+ *  @param   p_share_name The name of the share or queue
+ *  @returns @c true if it was found and added
+ */
+bool ShareRecorder::add (const char* p_share_name)
+{
+    BaseShare* p_share = BaseShare::find (p_share_name);
+    return p_share != NULL && add (*p_share);
+}
+
+
+/** @brief   Record every share and queue of plain numbers.
+ *  @details Shares are added oldest first, so their channel numbers are the
+ *           same from one run of a program to the next.
+ *  @returns The number of shares and queues added
+ */
+uint8_t ShareRecorder::add_all (void)
+{
+    // The list of shares runs newest first, so count back from the end
+    uint16_t total = 0;
+    for (BaseShare* p_share = BaseShare::get_newest (); p_share != NULL;
+         p_share = p_share->get_next ())
+    {
+        total++;
+    }
+    uint8_t added = 0;
+    for (uint16_t position = total; position > 0; position--)
+    {
+        BaseShare* p_share = BaseShare::get_newest ();
+        for (uint16_t step = 1; step < position; step++)
+        {
+            p_share = p_share->get_next ();
+        }
+        if (p_share != this && p_share->get_value_type () != SHARE_NONE
+            && add (*p_share))
+        {
+            added++;
+        }
+    }
+    return added;
+}
+
+
+/** @brief   Log one item from a channel.
+ *  @details This method runs in whichever task or ISR put the item in. It
+ *           claims the next slot in the ring with a compare-and-swap, fills
+ *           it, and marks it full by setting its sequence number, so that
+ *           any number of tasks and ISR's can record at once while the
+ *           recorder's task empties the ring.
+ *  @param   p_channel Pointer to the channel whose share got the item
+ *  @param   p_value Pointer to the item
+ */
+void ShareRecorder::record (RecorderChannel* p_channel, const void* p_value)
+{
+    if (!recording)
+    {
+        return;
+    }
+
+    uint32_t position = head.load (std::memory_order_relaxed);
+    RecorderSlot* p_slot;
+    for (;;)
+    {
+        p_slot = &p_ring[position & mask];
+        int32_t lap = (int32_t)(p_slot->sequence.load 
+                                (std::memory_order_acquire) - position);
+        if (lap == 0)
+        {
+            if (head.compare_exchange_weak (position, position + 1,
+                                            std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (lap < 0)
+        {
+            dropped.fetch_add (1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = head.load (std::memory_order_relaxed);
+        }
+    }
+
+    p_slot->time_us = micros ();
+    p_slot->value = share_type_widen (p_channel->type, p_value);
+    p_slot->channel = p_channel->index;
+    p_slot->sequence.store (position + 1, std::memory_order_release);
+}
+
+
+/** @brief   Write out a header frame listing the channels.
+ */
+void ShareRecorder::write_header (void)
+{
+    const char* names[RECORDING_MAX_CHANNELS];
+    uint8_t frame[RECORDING_MAX_FRAME];
+
+    for (uint8_t index = 0; index < n_channels; index++)
+    {
+        names[index] = channels[index].p_share->get_name ();
+    }
+    size_t length = framer.header (names, frame);
+    device.write (frame, length);
+    bytes += length;
+    header_due = false;
+}
+
+
+/** @brief   Write out all the items in the buffer.
+ *  @details This method is run by the recorder's task. It may instead be
+ *           called from a program's own low priority task, but only from
+ *           one task. Events are packed into frames as they're taken from
+ *           the buffer; a frame which isn't full is written out too, so
+ *           nothing is held back when recording stops.
+ */
+void ShareRecorder::flush (void)
+{
+    uint8_t frame[RECORDING_MAX_FRAME];
+    size_t length;
+
+    if (header_due)
+    {
+        write_header ();
+    }
+    uint32_t dropped_now = dropped.load ();
+    framer.add_dropped (dropped_now - dropped_written);
+    dropped_written = dropped_now;
+
+    for (;;)
+    {
+        RecorderSlot* p_slot = &p_ring[tail & mask];
+        if (p_slot->sequence.load (std::memory_order_acquire) != tail + 1)
+        {
+            break;
+        }
+        uint8_t channel = p_slot->channel;
+        uint32_t time_us = p_slot->time_us;
+        uint64_t value = p_slot->value;
+        p_slot->sequence.store (tail + mask + 1, std::memory_order_release);
+        tail++;
+
+        if (!framer.add_event (channel, time_us, value))
+        {
+            length = framer.finish (frame);
+            device.write (frame, length);
+            bytes += length;
+            if (++frames % RECORDER_HEADER_EVERY == 0)
+            {
+                write_header ();
+            }
+            framer.add_event (channel, time_us, value);
+        }
+        events++;
+    }
+
+    length = framer.finish (frame);
+    if (length > 0)
+    {
+        device.write (frame, length);
+        bytes += length;
+        if (++frames % RECORDER_HEADER_EVERY == 0)
+        {
+            header_due = true;
+        }
+    }
+}
+
+
+/** @brief   Start recording.
+ *  @details A header frame listing the channels is written out first. All
+ *           the shares to be recorded must have been added.
+ */
+void ShareRecorder::start (void)
+{
+    header_due = true;
+    recording = true;
+}
+
+
+/** @brief   Stop recording.
+ *  @details Items already in the buffer are still written out by the next
+ *           @c flush().
+ */
+void ShareRecorder::stop (void)
+{
+    recording = false;
+}
+
+
+/** @brief   Task function which writes out the buffer regularly.
+ *  @param   p_recorder Pointer to the @c ShareRecorder object
+ */
+void ShareRecorder::record_task (void* p_recorder)
+{
+    ShareRecorder* p_this = (ShareRecorder*)p_recorder;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        p_this->flush ();
+        vTaskDelayUntil (&wake_time, p_this->period_ticks);
+    }
+}
+
+
+/** @brief   Start a task which writes out the buffer regularly.
+ *  @details The buffer should hold at least as many items as are put into
+ *           the recorded shares in one period, with room to spare for the
+ *           times the output is slow, such as when an SD card is busy.
+ *  @param   period_ms The time between writes in milliseconds (default 10)
+ *  @param   priority The priority of the recorder's task (default 1)
+ *  @param   stack_size The size of the task's stack (default 3072)
+ *  @returns @c true if the task was created, @c false if not
+ */
+bool ShareRecorder::begin (uint16_t period_ms, UBaseType_t priority,
+                           uint32_t stack_size)
+{
+    period_ticks = pdMS_TO_TICKS (period_ms);
+    if (period_ticks < 1)
+    {
+        period_ticks = 1;
+    }
+    return xTaskCreate (record_task, name, stack_size, this, priority, NULL)
+           == pdPASS;
+}
+
+
+/** @brief   Print the recorder's status within a list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void ShareRecorder::print_in_list (Print& printer)
+{
+    printer.printf ("%-16srecorder\t", name);
+    if (mask == 0)
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << n_channels << " ch., " << (recording ? "on, " : "off, ")
+            << events << " events, " << dropped.load () << " dropped, "
+            << bytes << " bytes" << endl;
+}
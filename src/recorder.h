@@ -0,0 +1,194 @@
+//*****************************************************************************
+/** @file    recorder.h
+ *  @brief   Headers for a recorder which logs every item put into chosen
+ *           shares and queues, with the time it was put in.
+ *  @details Bugs which depend on when messages pass between tasks are hard
+ *           to reproduce at the bench. A @c ShareRecorder writes the traffic
+ *           through shares and queues into a compact binary stream, on an 
+ *           SD card file or a serial port, while the program runs in the
+ *           field. The recording can then be turned into CSV on a PC with 
+ *           @c host/recording_dump.cpp, or played back into the same tasks 
+ *           with a @c ShareReplay from @c replay.h. The format is described
+ *           in @c recording_codec.h.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+#include "recording_codec.h"
+
+
+/// The number of event frames between header frames
+#define RECORDER_HEADER_EVERY   64
+
+
+class ShareRecorder;
+
+
+/** @brief   Listener which passes items put into one share or queue to a
+ *           recorder.
+ *  @details Objects of this class are made by @c ShareRecorder::add();
+ *           programs needn't use them directly.
+ */
+class RecorderChannel : public ShareListener
+{
+    friend class ShareRecorder;
+
+protected:
+    ShareRecorder* p_recorder;            ///< The recorder to log into
+    BaseShare* p_share;                   ///< The share being recorded
+    uint8_t index;                        ///< This channel's number
+    uint8_t type;                         ///< Type of the share's items
+
+public:
+    // Log an item which was put into the share
+    void on_put (BaseShare* p_from, const void* p_value);
+};
+
+
+/// One slot in a recorder's buffer
+struct RecorderSlot
+{
+    std::atomic<uint32_t> sequence;       ///< Which lap of the ring it's on
+    uint32_t time_us;                     ///< Time the item was put in
+    uint64_t value;                       ///< The item, widened
+    uint8_t channel;                      ///< Index of the channel
+};
+
+
+/** @brief   Class which records every item put into chosen shares and
+ *           queues.
+ *  @details Each item put into a recorded share is copied, with the time in
+ *           microseconds, into a ring buffer by the task or ISR which put it
+ *           in; this takes a few atomic operations and no waiting, so
+ *           recording changes the timing of the program being recorded as
+ *           little as it can. The recorder's task empties the buffer every
+ *           few milliseconds, packing the items into frames which it writes
+ *           to a file or serial port. If the buffer fills because the output
+ *           is too slow, new items are dropped and the number dropped is 
+ *           written into the recording, so a reader knows there is a gap.
+ *
+ *           Any share or queue of plain numbers can be recorded: @c Share,
+ *           @c Queue, and shares such as @c RemoteShare derived from them. 
+ *           A @c CounterShare's atomic operations aren't recorded, as they
+ *           don't tell listeners about changes.
+ *
+ *           @section usage_recorder Usage
+ *           @code
+ *           #include "recorder.h"
+ *           ...
+ *           File log_file = SD.open ("/traffic.rec", FILE_WRITE);
+ *           ShareRecorder recorder (log_file, 1024);
+ *           ...
+ *           // In setup(), after the shares and queues have been created
+ *           recorder.add_all ();
+ *           recorder.begin ();
+ *           recorder.start ();
+ *           @endcode
+ */
+class ShareRecorder : public BaseShare
+{
+    friend class RecorderChannel;
+
+protected:
+    Print& device;                        ///< Where the recording goes
+    RecordingFramer framer;               ///< Packs events into frames
+    RecorderSlot* p_ring;                 ///< The ring buffer
+    uint32_t mask;                        ///< Buffer size minus one
+    std::atomic<uint32_t> head;           ///< Next slot to be claimed
+    uint32_t tail;                        ///< Next slot to be written out
+    std::atomic<uint32_t> dropped;        ///< Items dropped, buffer full
+    uint32_t dropped_written;             ///< Drops noted in the recording
+    RecorderChannel channels[RECORDING_MAX_CHANNELS];  ///< The channels
+    uint8_t n_channels;                   ///< Number of channels
+    volatile bool recording;              ///< Items are being recorded
+    volatile bool header_due;             ///< A header should be written
+    uint32_t events;                      ///< Items written out
+    uint32_t frames;                      ///< Event frames written out
+    uint32_t bytes;                       ///< Bytes written out
+    TickType_t period_ticks;              ///< Ticks between writes
+
+    // Log one item from a channel
+    void record (RecorderChannel* p_channel, const void* p_value);
+
+    // Write out a header frame listing the channels
+    void write_header (void);
+
+    // The task function which writes out the buffer
+    static void record_task (void* p_recorder);
+
+public:
+    // Create a recorder which writes to the given file or device
+    ShareRecorder (Print& output, uint32_t n_entries = 512, 
+                   const char* p_name = "Recorder");
+
+    // Record the items put into a share or queue
+    bool add (BaseShare& share);
+
+    // Record the items put into a share or queue found by its name
+    bool add (const char* p_share_name);
+
+    // Record every share and queue of plain numbers
+    uint8_t add_all (void);
+
+    // Start recording
+    void start (void);
+
+    // Stop recording
+    void stop (void);
+
+    // Write out all the items in the buffer
+    void flush (void);
+
+    // Start a task which writes out the buffer regularly
+    bool begin (uint16_t period_ms = 10, UBaseType_t priority = 1,
+                uint32_t stack_size = 3072);
+
+    /** @brief   Return the number of items written out so far.
+     *  @returns The number of events in the recording
+     */
+    uint32_t get_events (void)
+    {
+        return events;
+    }
+
+    /** @brief   Return the number of items dropped because the buffer was
+     *           full.
+     *  @returns The number of items dropped
+     */
+    uint32_t get_dropped (void)
+    {
+        return dropped.load ();
+    }
+
+    // Print the recorder's status within a list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _RECORDER_H_
@@ -0,0 +1,467 @@
+//*****************************************************************************
+/** @file    recording_codec.h
+ *  @brief   Classes which pack records of data put into shares and queues 
+ *           into compact, checked binary frames, and unpack them again.
+ *  @details A recording holds every item put into chosen shares and queues,
+ *           with the time at which it was put in, so the traffic between
+ *           tasks can be looked at or played back later. This file holds
+ *           the parts of the format used both by the recorder on a 
+ *           microcontroller and by programs which read recordings, so it 
+ *           uses no Arduino or FreeRTOS code. The CRC, COBS framing, varints
+ *           and deltas are the same as for telemetry, from 
+ *           @c telemetry_codec.h.
+ *
+ *           @section recording_format Frame Format
+ *           A @e header frame (@c 'H') lists the channels, each of which is
+ *           one share or queue:
+ *           - The number of channels, as a varint
+ *           - For each channel, its @c ShareValueType code, the length of its
+ *             name, and the name without a terminating null
+ *
+ *           An @e event frame (@c 'E') holds items put into the channels, in
+ *           the order in which they were put in:
+ *           - The frame's sequence number, as a varint
+ *           - The time in microseconds of the first event, as a varint
+ *           - The number of events which were dropped, because the recorder
+ *             couldn't keep up, since the frame before, as a varint
+ *           - Then the events until the payload ends. Each is the channel's
+ *             number, one byte; a varint holding the time since the event
+ *             before (0 for the first); and a varint holding the change in
+ *             the channel's value since its last event in the same frame, as
+ *             for telemetry. A channel's first value in each frame is taken
+ *             as a change from zero.
+ *
+ *           The frames are checked and framed as telemetry frames are. A
+ *           header frame is sent when recording starts and now and then
+ *           after, so a recording can be read from any header onwards.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _RECORDING_CODEC_H_
+#define _RECORDING_CODEC_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "sharetype.h"
+#include "telemetry_codec.h"
+
+
+/// The most channels a recording can have
+#define RECORDING_MAX_CHANNELS  32
+
+/// The most bytes in the payload of an event frame
+#define RECORDING_MAX_PAYLOAD   250
+
+/// The most bytes in the payload of a header frame
+#define RECORDING_MAX_HEADER    (2 + 17 * RECORDING_MAX_CHANNELS)
+
+/// The most bytes in an encoded frame, with its CRC, COBS overhead and the
+/// zero which ends it
+#define RECORDING_MAX_FRAME     (RECORDING_MAX_HEADER + 2 + 4 + 1)
+
+/// The first byte of the payload of a header frame
+#define RECORDING_HEADER        'H'
+
+/// The first byte of the payload of an event frame
+#define RECORDING_EVENTS        'E'
+
+
+/** @brief   Finish a payload: add its CRC, COBS encode it and end it with a
+ *           zero.
+ *  @param   p_payload Pointer to the payload, with two bytes free after it
+ *  @param   length The number of bytes in the payload
+ *  @param   p_out Pointer to a buffer of @c RECORDING_MAX_FRAME bytes
+ *  @returns The number of bytes in the encoded frame
+ */
+inline size_t recording_seal (uint8_t* p_payload, size_t length,
+                              uint8_t* p_out)
+{
+    uint16_t crc = crc16_ccitt (p_payload, length);
+    p_payload[length++] = (uint8_t)crc;
+    p_payload[length++] = (uint8_t)(crc >> 8);
+    size_t out_length = cobs_encode (p_payload, length, p_out);
+    p_out[out_length++] = 0;
+    return out_length;
+}
+
+
+/** @brief   Class which packs events into recording frames.
+ *  @details Channels are added first with @c add_channel(). Events are then
+ *           added one at a time with @c add_event(); when one won't fit, the
+ *           frame is finished with @c finish() and the event added again.
+ */
+class RecordingFramer
+{
+protected:
+    uint8_t payload[RECORDING_MAX_PAYLOAD + 2];   ///< Frame being built
+    size_t length;                        ///< Bytes in @c payload, or 0
+    uint8_t n_channels;                   ///< Number of channels
+    uint8_t types[RECORDING_MAX_CHANNELS];      ///< Type of each channel
+    uint64_t previous[RECORDING_MAX_CHANNELS];  ///< Last value in frame
+    uint32_t previous_us;                 ///< Time of the last event
+    uint32_t sequence;                    ///< Number of the next frame
+    uint32_t dropped;                     ///< Drops to report in next frame
+
+public:
+    /// Create a framer with no channels
+    RecordingFramer (void)
+        : length (0), n_channels (0), previous_us (0), sequence (0),
+          dropped (0)
+    {
+    }
+
+    /** @brief   Add a channel.
+     *  @param   type The channel's @c ShareValueType code
+     *  @returns @c true if it was added, @c false if there are too many
+     *           channels or the type has no size
+     */
+    bool add_channel (uint8_t type)
+    {
+        if (n_channels >= RECORDING_MAX_CHANNELS
+            || share_type_size (type) == 0)
+        {
+            return false;
+        }
+        types[n_channels++] = type;
+        return true;
+    }
+
+    /** @brief   Note events which were dropped, to be reported in the next
+     *           frame.
+     *  @param   count The number of events dropped
+     */
+    void add_dropped (uint32_t count)
+    {
+        dropped += count;
+    }
+
+    /** @brief   Check whether the frame being built has any events.
+     *  @returns @c true if it has none
+     */
+    bool is_empty (void)
+    {
+        return length == 0;
+    }
+
+    /** @brief   Add an event to the frame being built.
+     *  @param   channel The channel's number
+     *  @param   time_us The time at which the item was put in
+     *  @param   value The item, widened by @c share_type_widen()
+     *  @returns @c true if the event was added, @c false if there wasn't
+     *           room or the channel doesn't exist
+     */
+    bool add_event (uint8_t channel, uint32_t time_us, uint64_t value)
+    {
+        if (channel >= n_channels)
+        {
+            return false;
+        }
+        uint8_t event[4 * VARINT_MAX_BYTES + 2];
+        uint8_t* p_event = event;
+
+        // The first event of a frame starts with the frame's header
+        bool first = (length == 0);
+        if (first)
+        {
+            *p_event++ = RECORDING_EVENTS;
+            p_event = varint_put (p_event, sequence);
+            p_event = varint_put (p_event, time_us);
+            p_event = varint_put (p_event, dropped);
+            previous_us = time_us;
+        }
+        uint64_t last = first ? 0 : previous[channel];
+        if (first)
+        {
+            memset (previous, 0, sizeof (previous));
+        }
+        *p_event++ = channel;
+        p_event = varint_put (p_event, time_us - previous_us);
+        p_event = varint_put (p_event, 
+                              telemetry_delta (types[channel], value, last));
+
+        size_t event_length = p_event - event;
+        if (length + event_length > RECORDING_MAX_PAYLOAD)
+        {
+            return false;
+        }
+        memcpy (payload + length, event, event_length);
+        length += event_length;
+        previous[channel] = value;
+        previous_us = time_us;
+        if (first)
+        {
+            dropped = 0;
+        }
+        return true;
+    }
+
+    /** @brief   Encode the frame being built and start another.
+     *  @param   p_out Pointer to a buffer of @c RECORDING_MAX_FRAME bytes
+     *  @returns The number of bytes in the frame, or 0 if it had no events
+     */
+    size_t finish (uint8_t* p_out)
+    {
+        if (length == 0)
+        {
+            return 0;
+        }
+        size_t out_length = recording_seal (payload, length, p_out);
+        length = 0;
+        sequence++;
+        return out_length;
+    }
+
+    /** @brief   Encode a header frame which lists the channels.
+     *  @param   p_names Pointer to an array of the channels' names
+     *  @param   p_out Pointer to a buffer of @c RECORDING_MAX_FRAME bytes
+     *  @returns The number of bytes in the frame
+     */
+    size_t header (const char* const* p_names, uint8_t* p_out)
+    {
+        uint8_t frame[RECORDING_MAX_HEADER + 2];
+        uint8_t* p_frame = frame;
+        *p_frame++ = RECORDING_HEADER;
+        p_frame = varint_put (p_frame, n_channels);
+        for (uint8_t index = 0; index < n_channels; index++)
+        {
+            size_t name_length = strlen (p_names[index]);
+            name_length = (name_length > 15) ? 15 : name_length;
+            *p_frame++ = types[index];
+            *p_frame++ = (uint8_t)name_length;
+            memcpy (p_frame, p_names[index], name_length);
+            p_frame += name_length;
+        }
+        return recording_seal (frame, p_frame - frame, p_out);
+    }
+};
+
+
+/** @brief   Class which finds recording frames in a stream of bytes and
+ *           unpacks them.
+ *  @details Bytes are fed in one at a time as they're read. When @c feed()
+ *           returns @c RECORDING_HEADER, the channels can be looked at with
+ *           @c get_channels(), @c get_type() and @c get_name(); when it
+ *           returns @c RECORDING_EVENTS, the frame's events can be read with
+ *           @c next_event() until it returns @c false. Event frames which
+ *           come before the first header are skipped, as their channels
+ *           aren't known.
+ */
+class RecordingParser
+{
+protected:
+    uint8_t frame[RECORDING_MAX_FRAME];   ///< Bytes of the frame arriving
+    size_t frame_length;                  ///< Bytes in @c frame
+    bool too_long;                        ///< Frame overflowed the buffer
+    const uint8_t* p_read;                ///< Next event to be read
+    const uint8_t* p_end;                 ///< End of the payload
+    uint8_t n_channels;                   ///< Number of channels, or 0
+    uint8_t types[RECORDING_MAX_CHANNELS];     ///< Type of each channel
+    char names[RECORDING_MAX_CHANNELS][16];    ///< Name of each channel
+    uint64_t previous[RECORDING_MAX_CHANNELS]; ///< Last value in frame
+    uint32_t previous_us;                 ///< Time of the last event
+    uint32_t next_sequence;               ///< Sequence number expected
+    bool in_step;                         ///< An event frame has been seen
+    uint32_t bad_frames;                  ///< Frames which failed checks
+    uint32_t lost_frames;                 ///< Frames missed, by sequence
+    uint32_t dropped;                     ///< Events dropped by recorder
+
+    /// Check and decode the frame which has been collected
+    char decode_frame (void)
+    {
+        size_t length = cobs_decode (frame, frame_length, frame);
+        if (length < 3)
+        {
+            return 0;
+        }
+        length -= 2;
+        uint16_t crc = frame[length] | (uint16_t)frame[length + 1] << 8;
+        if (crc != crc16_ccitt (frame, length))
+        {
+            return 0;
+        }
+        const uint8_t* p_in = frame + 1;
+        const uint8_t* p_stop = frame + length;
+        uint64_t number;
+
+        if (frame[0] == RECORDING_HEADER)
+        {
+            p_in = varint_get (p_in, p_stop, number);
+            if (p_in == NULL || number > RECORDING_MAX_CHANNELS)
+            {
+                return 0;
+            }
+            for (uint8_t index = 0; index < number; index++)
+            {
+                if (p_in + 2 > p_stop || p_in + 2 + p_in[1] > p_stop
+                    || p_in[1] > 15 || share_type_size (p_in[0]) == 0)
+                {
+                    n_channels = 0;
+                    return 0;
+                }
+                types[index] = p_in[0];
+                memcpy (names[index], p_in + 2, p_in[1]);
+                names[index][p_in[1]] = '\0';
+                p_in += 2 + p_in[1];
+            }
+            n_channels = (uint8_t)number;
+            return RECORDING_HEADER;
+        }
+
+        if (frame[0] != RECORDING_EVENTS)
+        {
+            return 0;
+        }
+        uint64_t sequence, time_us, drops;
+        p_in = varint_get (p_in, p_stop, sequence);
+        p_in = p_in ? varint_get (p_in, p_stop, time_us) : NULL;
+        p_in = p_in ? varint_get (p_in, p_stop, drops) : NULL;
+        if (p_in == NULL)
+        {
+            return 0;
+        }
+        if (in_step)
+        {
+            lost_frames += (uint32_t)sequence - next_sequence;
+        }
+        next_sequence = (uint32_t)sequence + 1;
+        in_step = true;
+        dropped += (uint32_t)drops;
+        if (n_channels == 0)
+        {
+            return 0;
+        }
+        p_read = p_in;
+        p_end = p_stop;
+        previous_us = (uint32_t)time_us;
+        memset (previous, 0, sizeof (previous));
+        return RECORDING_EVENTS;
+    }
+
+public:
+    /// Create a parser which waits for the start of a frame
+    RecordingParser (void)
+        : frame_length (0), too_long (false), p_read (NULL), p_end (NULL),
+          n_channels (0), previous_us (0), next_sequence (0),
+          in_step (false), bad_frames (0), lost_frames (0), dropped (0)
+    {
+    }
+
+    /** @brief   Feed one byte of a recording to the parser.
+     *  @param   byte The byte
+     *  @returns @c RECORDING_HEADER or @c RECORDING_EVENTS if the byte
+     *           finished a good frame of that kind, or 0 if not
+     */
+    char feed (uint8_t byte)
+    {
+        if (byte != 0)
+        {
+            if (frame_length < sizeof (frame))
+            {
+                frame[frame_length++] = byte;
+            }
+            else
+            {
+                too_long = true;
+            }
+            return 0;
+        }
+        char kind = 0;
+        if (frame_length > 0 || too_long)
+        {
+            kind = too_long ? 0 : decode_frame ();
+            if (kind == 0)
+            {
+                bad_frames++;
+            }
+        }
+        frame_length = 0;
+        too_long = false;
+        return kind;
+    }
+
+    /** @brief   Read the next event from the event frame just decoded.
+     *  @param   channel Set to the channel's number
+     *  @param   time_us Set to the time at which the item was put in
+     *  @param   value Set to the item, widened as by @c share_type_widen()
+     *  @returns @c true if an event was read, @c false if there are no more
+     *           or the frame was malformed
+     */
+    bool next_event (uint8_t& channel, uint32_t& time_us, uint64_t& value)
+    {
+        uint64_t delta_us, delta;
+        if (p_read == NULL || p_read >= p_end || *p_read >= n_channels)
+        {
+            p_read = NULL;
+            return false;
+        }
+        channel = *p_read++;
+        p_read = varint_get (p_read, p_end, delta_us);
+        p_read = p_read ? varint_get (p_read, p_end, delta) : NULL;
+        if (p_read == NULL)
+        {
+            return false;
+        }
+        previous_us += (uint32_t)delta_us;
+        previous[channel] = telemetry_undelta (types[channel], delta,
+                                               previous[channel]);
+        time_us = previous_us;
+        value = previous[channel];
+        return true;
+    }
+
+    /// Return the number of channels in the last header, or 0 if none yet
+    uint8_t get_channels (void)
+    {
+        return n_channels;
+    }
+
+    /// Return a channel's @c ShareValueType code
+    uint8_t get_type (uint8_t channel)
+    {
+        return types[channel];
+    }
+
+    /// Return a channel's name
+    const char* get_name (uint8_t channel)
+    {
+        return names[channel];
+    }
+
+    /// Return the number of frames which failed their checks
+    uint32_t get_bad_frames (void)
+    {
+        return bad_frames;
+    }
+
+    /// Return the number of event frames missed, judged by sequence numbers
+    uint32_t get_lost_frames (void)
+    {
+        return lost_frames;
+    }
+
+    /// Return the number of events the recorder dropped
+    uint32_t get_dropped (void)
+    {
+        return dropped;
+    }
+};
+
+#endif // _RECORDING_CODEC_H_
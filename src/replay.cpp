@@ -0,0 +1,203 @@
+//*****************************************************************************
+/** @file    replay.cpp
+ *  @brief   Source code for a player which puts recorded items back into
+ *           shares and queues.
+ *  @details See @c replay.h for a description of the player.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "replay.h"
+
+
+/** @brief   Create a player which reads a recording from the given stream.
+ *  @param   recording The file or stream holding the recording, open for
+ *           reading
+ *  @param   play_speed How many times as fast as it was recorded to play
+ *           the recording, or 0 to play it as fast as the tasks which read
+ *           the shares can go (default 0)
+ *  @param   p_name A name for the player, shown by @c print_all_shares()
+ */
+ShareReplay::ShareReplay (Stream& recording, float play_speed,
+                          const char* p_name)
+    : BaseShare (p_name), input (recording)
+{
+    for (uint8_t index = 0; index < RECORDING_MAX_CHANNELS; index++)
+    {
+        p_targets[index] = NULL;
+    }
+    speed = (play_speed > 0.0f) ? play_speed : 0.0f;
+    started = false;
+    last_us = 0;
+    elapsed_us = 0;
+    first_tick = 0;
+    replayed = 0;
+    skipped = 0;
+    done = false;
+}
+
+
+/** @brief   Match the channels in a header with shares in this program.
+ */
+void ShareReplay::match_channels (void)
+{
+    for (uint8_t index = 0; index < parser.get_channels (); index++)
+    {
+        BaseShare* p_share = BaseShare::find (parser.get_name (index));
+        if (p_share != NULL && p_share != this
+            && p_share->get_value_type () == parser.get_type (index))
+        {
+            p_targets[index] = p_share;
+        }
+        else
+        {
+            p_targets[index] = NULL;
+        }
+    }
+}
+
+
+/** @brief   Wait until it's time to put in an item recorded at the given
+ *           time.
+ *  @details When playing as fast as possible, this just lets other tasks
+ *           of the same priority run.
+ *  @param   time_us The time at which the item was recorded
+ */
+void ShareReplay::wait_for (uint32_t time_us)
+{
+    if (!started)
+    {
+        started = true;
+        last_us = time_us;
+        first_tick = xTaskGetTickCount ();
+    }
+    if (speed == 0.0f)
+    {
+        taskYIELD ();
+        return;
+    }
+
+    // The time since the first event is added up from the steps between
+    // events, so it neither turns negative after 2^31 us nor goes wrong when
+    // the recorded clock wraps. Items recorded by an ISR during a task's put
+    // may be a little out of order in time, so steps are taken as signed,
+    // and an item from a little before the latest one is put in at once
+    int32_t step_us = (int32_t)(time_us - last_us);
+    if (step_us < 0)
+    {
+        return;
+    }
+    elapsed_us += (uint32_t)step_us;
+    last_us = time_us;
+
+    // The tick count wraps too, so only the low bits of the due tick matter
+    TickType_t due = first_tick + (TickType_t)(uint64_t)((double)elapsed_us
+                     * configTICK_RATE_HZ / 1.0e6 / speed);
+    TickType_t now = xTaskGetTickCount ();
+    if ((int32_t)(due - now) > 0)
+    {
+        vTaskDelay (due - now);
+    }
+}
+
+
+/** @brief   Play the whole recording.
+ *  @details This method returns when the stream has no more bytes. It's
+ *           run by the player's task; it may instead be called from a
+ *           program's own task.
+ *  @returns The number of items put into shares and queues
+ */
+uint32_t ShareReplay::play (void)
+{
+    while (input.available () > 0)
+    {
+        int ch = input.read ();
+        if (ch < 0)
+        {
+            break;
+        }
+        char kind = parser.feed ((uint8_t)ch);
+        if (kind == RECORDING_HEADER)
+        {
+            match_channels ();
+        }
+        else if (kind == RECORDING_EVENTS)
+        {
+            uint8_t channel;
+            uint32_t time_us;
+            uint64_t value;
+            while (parser.next_event (channel, time_us, value))
+            {
+                BaseShare* p_share = p_targets[channel];
+                if (p_share == NULL)
+                {
+                    skipped++;
+                    continue;
+                }
+                wait_for (time_us);
+
+                // A full queue is waited on rather than losing the item
+                while (!p_share->put_value (&value))
+                {
+                    vTaskDelay (1);
+                }
+                replayed++;
+            }
+        }
+    }
+    done = true;
+    return replayed;
+}
+
+
+/** @brief   Task function which plays the recording, then deletes itself.
+ *  @param   p_replay Pointer to the @c ShareReplay object
+ */
+void ShareReplay::replay_task (void* p_replay)
+{
+    ((ShareReplay*)p_replay)->play ();
+    vTaskDelete (NULL);
+}
+
+
+/** @brief   Start a task which plays the recording.
+ *  @details When playing as fast as possible, the task's priority should be
+ *           no higher than that of the tasks which read the played shares,
+ *           so they get to deal with each item before the next is put in.
+ *  @param   priority The priority of the player's task (default 1)
+ *  @param   stack_size The size of the task's stack (default 3072)
+ *  @returns @c true if the task was created, @c false if not
+ */
+bool ShareReplay::begin (UBaseType_t priority, uint32_t stack_size)
+{
+    return xTaskCreate (replay_task, name, stack_size, this, priority, NULL)
+           == pdPASS;
+}
+
+
+/** @brief   Print the player's status within a list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void ShareReplay::print_in_list (Print& printer)
+{
+    printer.printf ("%-16sreplay\t", name);
+    printer << replayed << " played, " << skipped << " skipped, "
+            << parser.get_dropped () << " dropped in recording"
+            << (done ? ", done" : "") << endl;
+}
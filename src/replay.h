@@ -0,0 +1,133 @@
+//*****************************************************************************
+/** @file    replay.h
+ *  @brief   Headers for a player which puts recorded items back into shares
+ *           and queues, so the tasks which use them see the same traffic.
+ *  @details A recording made by a @c ShareRecorder can be played back into
+ *           a program built from the same task code, on the bench or on a
+ *           PC running FreeRTOS, so a bug which showed up in the field can
+ *           be run again as often as needed. Playback may follow the 
+ *           recorded timing, run faster, or put items in as quickly as the
+ *           tasks which read them can take them.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include "baseshare.h"
+#include "recording_codec.h"
+
+
+/** @brief   Class which plays a recording back into shares and queues.
+ *  @details Each channel in the recording is matched by name with a share
+ *           or queue in this program, which must hold the same type of item;
+ *           channels with no match are skipped. Items are put in with
+ *           @c BaseShare::put_value(), in the order they were recorded. A
+ *           queue which is full is waited on, so no item is lost.
+ *
+ *           The speed sets the timing. At 1.0 items are put in at the times
+ *           they were recorded, to the nearest RTOS tick; at 10.0, ten times
+ *           as fast. At 0 (the default) each item is put in as soon as the
+ *           one before has been dealt with: the player yields after each
+ *           item, so tasks of the same or higher priority which were
+ *           waiting for it run before the next item is put in. That gives
+ *           the same sequence of events every time, as fast as the tasks
+ *           can go, which suits regression tests and profiling.
+ *
+ *           The tasks which normally put data into the played shares, such
+ *           as those reading sensors, shouldn't be started during playback.
+ *           A share holds its value until the first item is played into it,
+ *           so shares should start out as they were when recording began
+ *           if a run is to match the recorded one exactly.
+ *
+ *           @section usage_replay Usage
+ *           @code
+ *           #include "replay.h"
+ *           ...
+ *           File recording = SD.open ("/traffic.rec");
+ *           ShareReplay replay (recording);
+ *           ...
+ *           // In setup(), after the shares and queues have been created
+ *           // and the tasks which read them have been started
+ *           replay.begin ();
+ *           @endcode
+ */
+class ShareReplay : public BaseShare
+{
+protected:
+    Stream& input;                        ///< Where the recording comes from
+    RecordingParser parser;               ///< Unpacks the recording
+    BaseShare* p_targets[RECORDING_MAX_CHANNELS];  ///< Share per channel
+    float speed;                          ///< Playback speed, or 0
+    bool started;                         ///< The first event has been put
+    uint32_t last_us;                     ///< Recorded time of latest event
+    uint64_t elapsed_us;                  ///< Recorded time since first event
+    TickType_t first_tick;                ///< Tick count at first event
+    uint32_t replayed;                    ///< Items put into shares
+    uint32_t skipped;                     ///< Items with no share to go to
+    volatile bool done;                   ///< The recording has ended
+
+    // Match the channels in a header with shares in this program
+    void match_channels (void);
+
+    // Wait until it's time to put in an item recorded at the given time
+    void wait_for (uint32_t time_us);
+
+    // The task function which plays the recording
+    static void replay_task (void* p_replay);
+
+public:
+    // Create a player which reads a recording from the given stream
+    ShareReplay (Stream& recording, float play_speed = 0.0f,
+                 const char* p_name = "Replay");
+
+    // Play the whole recording
+    uint32_t play (void);
+
+    // Start a task which plays the recording
+    bool begin (UBaseType_t priority = 1, uint32_t stack_size = 3072);
+
+    /** @brief   Check whether the whole recording has been played.
+     *  @returns @c true once the end of the recording has been reached
+     */
+    bool is_done (void)
+    {
+        return done;
+    }
+
+    /** @brief   Return the number of items put into shares and queues.
+     *  @returns The number of items played so far
+     */
+    uint32_t get_replayed (void)
+    {
+        return replayed;
+    }
+
+    // Print the player's status within a list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _REPLAY_H_
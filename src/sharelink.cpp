@@ -0,0 +1,245 @@
+//*****************************************************************************
+/** @file    sharelink.cpp
+ *  @brief   Source code for a link which keeps shares on two processors
+ *           equal by sending their changes over a serial line.
+ *  @details See @c sharelink.h for a description of the link.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "sharelink.h"
+
+
+/** @brief   Mark the share as changed, unless the link itself changed it.
+ *  @details Values which arrive from the peer are put into the share by the
+ *           link's task; sending them back would bounce them between the
+ *           processors forever. Data put in by any other task or by an ISR,
+ *           even one which interrupts the link's task, is marked.
+ *  @param   p_from Pointer to the share, which is ignored as each channel
+ *           listens to one share only
+ *  @param   p_value Pointer to the value, which is read later by the link
+ */
+void ShareLinkChannel::on_put (BaseShare* p_from, const void* p_value)
+{
+    (void)p_from;
+    (void)p_value;
+    if (CHECK_IF_IN_ISR ()
+        || xTaskGetCurrentTaskHandle () != p_link->applying_task)
+    {
+        p_link->changed.fetch_or (1UL << (this - p_link->channels));
+    }
+}
+
+
+/** @brief   Create a link which talks to its peer on the given serial line.
+ *  @details The serial port should be set up with @c begin() by the program
+ *           before the link starts. Nothing else may use the port.
+ *  @param   serial_device The serial port connected to the other processor
+ *  @param   p_name A name for the link, shown by @c print_all_shares()
+ */
+ShareLink::ShareLink (Stream& serial_device, const char* p_name)
+    : BaseShare (p_name), device (serial_device)
+{
+    for (uint8_t id = 0; id < SHARE_LINK_MAX_SHARES; id++)
+    {
+        channels[id].p_link = this;
+        channels[id].p_share = NULL;
+    }
+    changed = 0;
+    applying_task = NULL;
+    period_ticks = 1;
+    refresh_ticks = 0;
+    last_refresh = 0;
+    frames_sent = 0;
+    updates_sent = 0;
+    updates_received = 0;
+}
+
+
+/** @brief   Link a share, giving it an ID number.
+ *  @details Shares should be linked while setting things up, before the
+ *           link starts. A @c RemoteShare links itself.
+ *  @param   share The share to be linked
+ *  @param   id The share's ID number, which must be the same on both
+ *           processors
+ *  @returns @c true if the share was linked, @c false if the ID number is
+ *           too large or taken, the share is a queue, whose head item isn't
+ *           a current value, or the share's values can't be read
+ */
+bool ShareLink::add (BaseShare& share, uint8_t id)
+{
+    if (id >= SHARE_LINK_MAX_SHARES || channels[id].p_share != NULL
+        || share.is_queue () || share.get_value_type () == SHARE_NONE)
+    {
+        return false;
+    }
+    channels[id].p_share = &share;
+    share.add_listener (&channels[id]);
+    return true;
+}
+
+
+/** @brief   Send the values of the shares whose bits are set.
+ *  @details Shares which have no value yet are skipped. A frame can hold
+ *           every share, so all the values go in one frame.
+ *  @param   which A bit for each share to be sent, the least significant for
+ *           ID number 0
+ */
+void ShareLink::send (uint32_t which)
+{
+    uint64_t value;
+    uint8_t out[SHARE_LINK_MAX_FRAME];
+
+    for (uint8_t id = 0; which != 0; id++, which >>= 1)
+    {
+        BaseShare* p_share = channels[id].p_share;
+        if ((which & 1) && p_share != NULL && p_share->peek_value (&value))
+        {
+            framer.add (id, p_share->get_value_type (), &value);
+            updates_sent++;
+        }
+    }
+    size_t length = framer.finish (out);
+    if (length > 0)
+    {
+        device.write (out, length);
+        frames_sent++;
+    }
+}
+
+
+/** @brief   Read arriving frames and send the values of changed shares.
+ *  @details This method is run by the link's task; a program which would
+ *           rather not have another task may call it regularly from one of
+ *           its own instead. Values received are put into their shares 
+ *           through @c BaseShare::put_value(), so listeners such as captures
+ *           see them. The method never waits for a share.
+ */
+void ShareLink::poll (void)
+{
+    applying_task = xTaskGetCurrentTaskHandle ();
+
+    // Put every update from each good frame into its share
+    while (device.available () > 0)
+    {
+        int ch = device.read ();
+        if (ch < 0)
+        {
+            break;
+        }
+        if (parser.feed ((uint8_t)ch))
+        {
+            uint8_t id, type;
+            const uint8_t* p_value;
+            uint64_t value;
+            while (parser.next (id, type, p_value))
+            {
+                BaseShare* p_share = channels[id].p_share;
+                if (p_share != NULL && p_share->get_value_type () == type)
+                {
+                    memcpy (&value, p_value, share_type_size (type));
+                    p_share->put_value (&value);
+                    updates_received++;
+                }
+            }
+        }
+    }
+
+    // Send changed shares, or all of them when a refresh is due
+    uint32_t which = changed.exchange (0);
+    TickType_t now = xTaskGetTickCount ();
+    if (refresh_ticks > 0 && now - last_refresh >= refresh_ticks)
+    {
+        last_refresh = now;
+        which = 0xFFFFFFFF;
+    }
+    if (which != 0)
+    {
+        send (which);
+    }
+}
+
+
+/** @brief   Task function which runs the link.
+ *  @param   p_link Pointer to the @c ShareLink object
+ */
+void ShareLink::link_task (void* p_link)
+{
+    ShareLink* p_this = (ShareLink*)p_link;
+
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        p_this->poll ();
+        vTaskDelayUntil (&wake_time, p_this->period_ticks);
+    }
+}
+
+
+/** @brief   Start a task which runs the link.
+ *  @details The period is the longest time a changed value waits before
+ *           being sent, and the time over which changes are gathered into
+ *           one frame. It should be long enough for a frame of all the
+ *           shares which often change to be sent at the serial line's baud
+ *           rate; at 921600 baud, 10 four-byte values take under 1 ms. The
+ *           task should have a higher priority than tasks which merely print
+ *           but needn't outrank control tasks, as it never holds up a share.
+ *  @param   period_ms The time between frames in milliseconds (default 5)
+ *  @param   refresh_ms The time between sending every share, changed or
+ *           not, in milliseconds, or 0 to send only changes (default 500)
+ *  @param   priority The priority of the link's task (default 3)
+ *  @param   stack_size The size of the task's stack (default 3072)
+ *  @returns @c true if the task was created, @c false if not
+ */
+bool ShareLink::begin (uint16_t period_ms, uint16_t refresh_ms,
+                       UBaseType_t priority, uint32_t stack_size)
+{
+    period_ticks = pdMS_TO_TICKS (period_ms);
+    if (period_ticks < 1)
+    {
+        period_ticks = 1;
+    }
+    refresh_ticks = pdMS_TO_TICKS (refresh_ms);
+    return xTaskCreate (link_task, name, stack_size, this, priority, NULL)
+           == pdPASS;
+}
+
+
+/** @brief   Print the link's status within a list of shares.
+ *  @details This method prints the number of linked shares, the numbers of
+ *           frames and values sent, and the numbers of values received and
+ *           of frames which were damaged or lost on the way in.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void ShareLink::print_in_list (Print& printer)
+{
+    uint8_t linked = 0;
+    for (uint8_t id = 0; id < SHARE_LINK_MAX_SHARES; id++)
+    {
+        if (channels[id].p_share != NULL)
+        {
+            linked++;
+        }
+    }
+    printer.printf ("%-16slink\t", name);
+    printer << linked << " shares, " << frames_sent << " frames/"
+            << updates_sent << " values sent, " << updates_received
+            << " values received, " << parser.get_lost_frames ()
+            << " frames lost" << endl;
+}
@@ -0,0 +1,195 @@
+//*****************************************************************************
+/** @file    sharelink.h
+ *  @brief   Headers for a link which keeps shares on two processors equal by
+ *           sending their changes over a serial line.
+ *  @details Robots with two microcontrollers often need the same state, such
+ *           as a setpoint or a measured position, on both. Each processor
+ *           creates a @c ShareLink on its end of a UART and @c RemoteShare
+ *           objects with matching ID numbers; a value put into a remote
+ *           share on either processor soon appears in the same share on the
+ *           other. The frame format is described in @c sharelink_codec.h.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SHARELINK_H_
+#define _SHARELINK_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "taskshare.h"
+#include "sharelink_codec.h"
+
+
+class ShareLink;
+
+
+/** @brief   Listener which tells a share link when a linked share changes.
+ *  @details Objects of this class are made by @c ShareLink::add(); programs
+ *           needn't use them directly.
+ */
+class ShareLinkChannel : public ShareListener
+{
+    friend class ShareLink;
+
+protected:
+    ShareLink* p_link;                    ///< The link carrying the share
+    BaseShare* p_share;                   ///< The linked share
+
+public:
+    // Mark the share as changed, unless the link itself changed it
+    void on_put (BaseShare* p_from, const void* p_value);
+};
+
+
+/** @brief   Class which sends changes in shares to another processor and
+ *           puts changes which arrive from it into the same shares.
+ *  @details Each linked share has an ID number, from 0 to 
+ *           @c SHARE_LINK_MAX_SHARES - 1, which must be the same on both
+ *           processors, as must the share's type. When data is put into a
+ *           linked share, its listener marks the share as changed; no more
+ *           work is done in the task or ISR which put the data. The link's
+ *           task wakes every few milliseconds, reads any frames which have
+ *           arrived, and sends the latest values of all the changed shares
+ *           together in one frame. A share which changes many times between
+ *           frames is sent once, so a fast control loop can't flood the
+ *           line, and no value waits longer than the link's period plus the
+ *           time to send a frame. Every share is also sent now and then even
+ *           if it hasn't changed, so a frame lost to noise is made good.
+ *
+ *           If both processors put data into the same share at nearly the
+ *           same time, each ends up with the other's value; shares are best
+ *           written on one side only. Changes are noticed through the
+ *           listeners which @c Share::put() calls. A @c CounterShare or
+ *           @c FlagShare may be linked too, but since their atomic
+ *           operations don't call listeners, their changes travel only with
+ *           the periodic refresh.
+ */
+class ShareLink : public BaseShare
+{
+    friend class ShareLinkChannel;
+
+protected:
+    Stream& device;                       ///< The serial line to the peer
+    ShareLinkFramer framer;               ///< Builds outgoing frames
+    ShareLinkParser parser;               ///< Unpacks incoming frames
+    ShareLinkChannel channels[SHARE_LINK_MAX_SHARES];  ///< Linked shares
+    std::atomic<uint32_t> changed;        ///< Bit per share to be sent
+    TaskHandle_t applying_task;           ///< Task putting received data
+    TickType_t period_ticks;              ///< Ticks between frames
+    TickType_t refresh_ticks;             ///< Ticks between full refreshes
+    TickType_t last_refresh;              ///< Tick count at last refresh
+    uint32_t frames_sent;                 ///< Frames sent
+    uint32_t updates_sent;                ///< Share values sent
+    uint32_t updates_received;            ///< Share values received
+
+    // Send the values of the shares whose bits are set
+    void send (uint32_t which);
+
+    // The task function which runs the link
+    static void link_task (void* p_link);
+
+public:
+    // Create a link which talks to its peer on the given serial line
+    ShareLink (Stream& serial_device, const char* p_name = "Share Link");
+
+    // Link a share, giving it an ID number
+    bool add (BaseShare& share, uint8_t id);
+
+    // Read arriving frames and send the values of changed shares
+    void poll (void);
+
+    // Start a task which runs the link
+    bool begin (uint16_t period_ms = 5, uint16_t refresh_ms = 500,
+                UBaseType_t priority = 3, uint32_t stack_size = 3072);
+
+    /** @brief   Return the number of share values received from the peer.
+     *  @returns The number of values put into shares by this link
+     */
+    uint32_t get_updates_received (void)
+    {
+        return updates_received;
+    }
+
+    /** @brief   Return the number of frames which arrived damaged or never
+     *           arrived.
+     *  @returns The number of frames missed, judged by sequence numbers
+     */
+    uint32_t get_lost_frames (void)
+    {
+        return parser.get_lost_frames ();
+    }
+
+    // Print the link's status within a list of shares
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Class for a share whose value is copied to and from another
+ *           processor.
+ *  @details A remote share is used just like a @c Share, and it is one; it
+ *           just links itself to a @c ShareLink when it's created. The same
+ *           remote share, with the same type and ID number, should be made
+ *           on both processors.
+ *
+ *           @section usage_remote Usage
+ *           On both processors:
+ *           @code
+ *           #include "sharelink.h"
+ *           ...
+ *           ShareLink link (Serial2);
+ *           RemoteShare<float> wheel_speed (link, 0, "Wheel Speed");
+ *           RemoteShare<int16_t> steering (link, 1, "Steering");
+ *           ...
+ *           // In setup()
+ *           Serial2.begin (921600);
+ *           link.begin ();
+ *           @endcode
+ *           Then the processor which measures wheel speed puts it into
+ *           @c wheel_speed, and the other gets it from @c wheel_speed.
+ */
+template <class DataType> class RemoteShare : public Share<DataType>
+{
+    static_assert (ShareType<DataType>::code != SHARE_NONE,
+                   "RemoteShare needs a plain numeric type");
+
+public:
+    /** @brief   Create a share and link it to the other processor.
+     *  @details The link must have been created first, so it should be
+     *           defined above its remote shares in the same source file. If
+     *           the ID number is in use or too large, the share works only
+     *           locally; the link's printout shows how many shares are
+     *           linked.
+     *  @param   link The link to the other processor
+     *  @param   id The share's ID number, the same on both processors
+     *  @param   p_name A name to be shown in the list of task shares
+     */
+    RemoteShare (ShareLink& link, uint8_t id, const char* p_name = NULL)
+        : Share<DataType> (p_name)
+    {
+        link.add (*this, id);
+    }
+};
+
+#endif // _SHARELINK_H_
@@ -0,0 +1,294 @@
+//*****************************************************************************
+/** @file    sharelink_codec.h
+ *  @brief   Classes which pack updates of shared values into checked frames
+ *           for sending between processors, and unpack them again.
+ *  @details This file holds the parts of the share link protocol which are
+ *           the same on every node, so it uses no Arduino or FreeRTOS code
+ *           and programs on a PC can use it to talk to a microcontroller or
+ *           to test the protocol. The CRC and COBS framing are the same as
+ *           for telemetry, from @c telemetry_codec.h.
+ *
+ *           @section sharelink_format Frame Format
+ *           An update frame's payload holds:
+ *           - The byte @c 'U'
+ *           - An 8-bit sequence number, one more than the frame before; a
+ *             gap shows that frames were lost
+ *           - One or more updates, each of which is the share's ID number,
+ *             its @c ShareValueType code, and its value in as many bytes as
+ *             the type needs, least significant first
+ *
+ *           The payload is followed by its CRC-16/CCITT-FALSE, least 
+ *           significant byte first; then the whole thing is COBS encoded and
+ *           a zero byte is sent to end it. A receiver checks the CRC and the
+ *           form of the whole frame before using any of its updates, so a
+ *           damaged frame changes nothing.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SHARELINK_CODEC_H_
+#define _SHARELINK_CODEC_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "sharetype.h"
+#include "telemetry_codec.h"
+
+
+/// The number of different shares a link can carry; ID's are below this
+#define SHARE_LINK_MAX_SHARES   32
+
+/// The most bytes in the payload of one frame, enough for every share
+#define SHARE_LINK_MAX_PAYLOAD  (2 + 10 * SHARE_LINK_MAX_SHARES)
+
+/// The most bytes in an encoded frame, including its CRC, COBS overhead and
+/// the zero which ends it
+#define SHARE_LINK_MAX_FRAME    (SHARE_LINK_MAX_PAYLOAD + 2 + 3 + 1)
+
+/// The first byte of the payload of an update frame
+#define SHARE_LINK_UPDATE       'U'
+
+
+/** @brief   Class which packs updates of shared values into a frame.
+ *  @details Updates are added one at a time with @c add(), then
+ *           @c finish() encodes the frame ready to send and starts the next
+ *           one. Each share should be added at most once per frame.
+ */
+class ShareLinkFramer
+{
+protected:
+    uint8_t payload[SHARE_LINK_MAX_PAYLOAD];   ///< The frame being built
+    size_t length;                        ///< Bytes in @c payload
+    uint8_t sequence;                     ///< Sequence number of the frame
+
+public:
+    /// Create a framer and start the first frame
+    ShareLinkFramer (void) : length (2), sequence (0)
+    {
+        payload[0] = SHARE_LINK_UPDATE;
+        payload[1] = 0;
+    }
+
+    /** @brief   Add an update to the frame.
+     *  @param   id The share's ID number, below @c SHARE_LINK_MAX_SHARES
+     *  @param   type The share's @c ShareValueType code
+     *  @param   p_value Pointer to the value
+     *  @returns @c true if the update was added, @c false if the type has no
+     *           size or the frame is full
+     */
+    bool add (uint8_t id, uint8_t type, const void* p_value)
+    {
+        uint8_t size = share_type_size (type);
+        if (size == 0 || length + 2 + size > SHARE_LINK_MAX_PAYLOAD)
+        {
+            return false;
+        }
+        payload[length++] = id;
+        payload[length++] = type;
+        memcpy (payload + length, p_value, size);
+        length += size;
+        return true;
+    }
+
+    /** @brief   Check whether any updates have been added to the frame.
+     *  @returns @c true if the frame holds no updates
+     */
+    bool is_empty (void)
+    {
+        return length <= 2;
+    }
+
+    /** @brief   Encode the frame for sending and start the next one.
+     *  @param   p_out Pointer to a buffer of @c SHARE_LINK_MAX_FRAME bytes
+     *  @returns The number of bytes to send, or 0 if the frame was empty
+     */
+    size_t finish (uint8_t* p_out)
+    {
+        if (is_empty ())
+        {
+            return 0;
+        }
+        uint16_t crc = crc16_ccitt (payload, length);
+        payload[length++] = (uint8_t)crc;
+        payload[length++] = (uint8_t)(crc >> 8);
+        size_t out_length = cobs_encode (payload, length, p_out);
+        p_out[out_length++] = 0;
+
+        payload[1] = ++sequence;
+        length = 2;
+        return out_length;
+    }
+};
+
+
+/** @brief   Class which finds update frames in a stream of bytes and checks
+ *           and unpacks them.
+ *  @details Bytes are fed in one at a time as they arrive. When @c feed()
+ *           returns @c true, a good frame has arrived and its updates can be
+ *           read with @c next() until it returns @c false.
+ */
+class ShareLinkParser
+{
+protected:
+    uint8_t frame[SHARE_LINK_MAX_FRAME];  ///< Bytes of the frame arriving
+    size_t frame_length;                  ///< Bytes in @c frame
+    bool too_long;                        ///< Frame overflowed the buffer
+    size_t payload_length;                ///< Bytes in the decoded payload
+    size_t read_index;                    ///< Next update for @c next()
+    uint8_t next_sequence;                ///< Sequence number expected
+    bool in_step;                         ///< A good frame has been seen
+    uint32_t good_frames;                 ///< Frames which were used
+    uint32_t bad_frames;                  ///< Frames which were thrown out
+    uint32_t lost_frames;                 ///< Frames missed or damaged
+
+    /** @brief   Check and decode the frame whose bytes have been collected.
+     *  @returns @c true if the frame is good
+     */
+    bool decode_frame (void)
+    {
+        size_t length = cobs_decode (frame, frame_length, frame);
+        if (length < 4)
+        {
+            return false;
+        }
+        length -= 2;
+        uint16_t crc = frame[length] | (uint16_t)frame[length + 1] << 8;
+        if (crc != crc16_ccitt (frame, length)
+            || frame[0] != SHARE_LINK_UPDATE)
+        {
+            return false;
+        }
+
+        // Check that the updates fill the payload exactly
+        size_t index = 2;
+        while (index < length)
+        {
+            if (index + 2 > length || frame[index] >= SHARE_LINK_MAX_SHARES)
+            {
+                return false;
+            }
+            uint8_t size = share_type_size (frame[index + 1]);
+            if (size == 0 || index + 2 + size > length)
+            {
+                return false;
+            }
+            index += 2 + size;
+        }
+
+        if (in_step)
+        {
+            lost_frames += (uint8_t)(frame[1] - next_sequence);
+        }
+        next_sequence = frame[1] + 1;
+        in_step = true;
+        payload_length = length;
+        read_index = 2;
+        return true;
+    }
+
+public:
+    /// Create a parser which waits for the start of a frame
+    ShareLinkParser (void)
+        : frame_length (0), too_long (false), payload_length (0),
+          read_index (0), next_sequence (0), in_step (false), 
+          good_frames (0), bad_frames (0), lost_frames (0)
+    {
+    }
+
+    /** @brief   Feed one received byte to the parser.
+     *  @param   byte The byte
+     *  @returns @c true if the byte finished a good frame, whose updates
+     *           may now be read with @c next()
+     */
+    bool feed (uint8_t byte)
+    {
+        if (byte != 0)
+        {
+            if (frame_length < sizeof (frame))
+            {
+                frame[frame_length++] = byte;
+            }
+            else
+            {
+                too_long = true;
+            }
+            return false;
+        }
+
+        // A zero ends the frame; an empty one is just a gap between frames
+        bool good = false;
+        if (frame_length > 0 || too_long)
+        {
+            good = !too_long && decode_frame ();
+            if (good)
+            {
+                good_frames++;
+            }
+            else
+            {
+                bad_frames++;
+            }
+        }
+        frame_length = 0;
+        too_long = false;
+        return good;
+    }
+
+    /** @brief   Read the next update from the frame which just arrived.
+     *  @param   id Set to the share's ID number
+     *  @param   type Set to the share's @c ShareValueType code
+     *  @param   p_value Set to point to the value's bytes in the frame,
+     *           which may not be aligned; they're valid until the next call
+     *           to @c feed()
+     *  @returns @c true if an update was read, @c false if there are no more
+     */
+    bool next (uint8_t& id, uint8_t& type, const uint8_t*& p_value)
+    {
+        if (read_index >= payload_length)
+        {
+            return false;
+        }
+        id = frame[read_index];
+        type = frame[read_index + 1];
+        p_value = frame + read_index + 2;
+        read_index += 2 + share_type_size (type);
+        return true;
+    }
+
+    /// Return the number of good frames received
+    uint32_t get_good_frames (void)
+    {
+        return good_frames;
+    }
+
+    /// Return the number of frames thrown out as damaged
+    uint32_t get_bad_frames (void)
+    {
+        return bad_frames;
+    }
+
+    /// Return the number of frames missed or damaged, by sequence number
+    uint32_t get_lost_frames (void)
+    {
+        return lost_frames;
+    }
+};
+
+#endif // _SHARELINK_CODEC_H_
@@ -0,0 +1,372 @@
+//*****************************************************************************
+/** @file    shareshell.cpp
+ *  @brief   Source code for a command shell which reads and writes shares
+ *           over a serial port while a program runs.
+ *  @details See @c shareshell.h for a description of the commands.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "shareshell.h"
+
+
+/** @brief   Create a shell which talks on the given serial port.
+ *  @details The serial port should be set up with @c begin() by the program
+ *           before the shell starts.
+ *  @param   serial_device The serial port from which commands are read and
+ *           to which replies are written
+ */
+ShareShell::ShareShell (Stream& serial_device)
+    : device (serial_device)
+{
+    line_length = 0;
+    n_watched = 0;
+    watch_ticks = 0;
+    last_watch = 0;
+    commands = 0;
+}
+
+
+/** @brief   Find a share by name, complaining if there's no such share.
+ *  @param   p_name The name of the share
+ *  @returns A pointer to the share, or @c NULL if none has that name
+ */
+BaseShare* ShareShell::find_share (const char* p_name)
+{
+    if (*p_name == '\0')
+    {
+        device << "A share's name is needed" << endl;
+        return NULL;
+    }
+    BaseShare* p_share = BaseShare::find (p_name);
+    if (p_share == NULL)
+    {
+        device << "No share named \"" << p_name << '"' << endl;
+    }
+    return p_share;
+}
+
+
+/** @brief   Print a share's value, or why it can't be printed.
+ *  @param   p_share Pointer to the share
+ */
+void ShareShell::print_value (BaseShare* p_share)
+{
+    uint8_t type = p_share->get_value_type ();
+    uint64_t value;
+    char text[24];
+
+    if (type == SHARE_NONE)
+    {
+        device << "(not a number)";
+    }
+    else if (!p_share->peek_value (&value))
+    {
+        device << "(empty)";
+    }
+    else
+    {
+        device << share_type_format (type, &value, text, sizeof (text));
+    }
+}
+
+
+/** @brief   Print a line with the values of the watched shares.
+ */
+void ShareShell::print_watched (void)
+{
+    device << millis ();
+    for (uint8_t index = 0; index < n_watched; index++)
+    {
+        device << ' ' << p_watched[index]->get_name () << '=';
+        print_value (p_watched[index]);
+    }
+    device << endl;
+}
+
+
+/** @brief   Run one command line.
+ *  @details The first word on the line is the command. Share names are
+ *           taken from the rest of the line, so they may contain spaces;
+ *           for @c set, the last word is the value.
+ *  @param   p_command The command line, which may be changed
+ */
+void ShareShell::run_command (char* p_command)
+{
+    // Split off the first word as the command, then trim the rest
+    while (*p_command == ' ')
+    {
+        p_command++;
+    }
+    char* p_rest = p_command;
+    while (*p_rest != '\0' && *p_rest != ' ')
+    {
+        p_rest++;
+    }
+    if (*p_rest != '\0')
+    {
+        *p_rest++ = '\0';
+    }
+    while (*p_rest == ' ')
+    {
+        p_rest++;
+    }
+    char* p_end = p_rest + strlen (p_rest);
+    while (p_end > p_rest && p_end[-1] == ' ')
+    {
+        *--p_end = '\0';
+    }
+
+    if (*p_command == '\0')
+    {
+        return;
+    }
+    commands++;
+
+    if (strcmp (p_command, "list") == 0)
+    {
+        print_all_shares (device);
+    }
+    else if (strcmp (p_command, "get") == 0
+             || strcmp (p_command, "peek") == 0)
+    {
+        BaseShare* p_share = find_share (p_rest);
+        if (p_share != NULL)
+        {
+            device << p_share->get_name () << " = ";
+            print_value (p_share);
+            device << endl;
+        }
+    }
+    else if (strcmp (p_command, "set") == 0)
+    {
+        // The value is the last word; the name is everything before it
+        char* p_value = strrchr (p_rest, ' ');
+        if (p_value == NULL)
+        {
+            device << "Usage: set name value" << endl;
+            return;
+        }
+        *p_value++ = '\0';
+        BaseShare* p_share = find_share (p_rest);
+        if (p_share == NULL)
+        {
+            return;
+        }
+        uint8_t type = p_share->get_value_type ();
+        uint64_t value;
+        if (type == SHARE_NONE)
+        {
+            device << p_share->get_name () << " isn't a number" << endl;
+        }
+        else if (!share_type_parse (type, p_value, &value))
+        {
+            device << '"' << p_value << "\" isn't a valid value for "
+                   << p_share->get_name () << endl;
+        }
+        else if (!p_share->put_value (&value))
+        {
+            device << p_share->get_name () << " didn't take the value"
+                   << endl;
+        }
+        else
+        {
+            device << p_share->get_name () << " = ";
+            print_value (p_share);
+            device << endl;
+        }
+    }
+    else if (strcmp (p_command, "stats") == 0)
+    {
+        if (*p_rest == '\0')
+        {
+            print_all_shares (device);
+        }
+        else
+        {
+            BaseShare* p_share = find_share (p_rest);
+            if (p_share != NULL)
+            {
+                p_share->print_in_list (device);
+            }
+        }
+    }
+    else if (strcmp (p_command, "reset-stats") == 0)
+    {
+        if (*p_rest == '\0')
+        {
+            for (BaseShare* p_share = BaseShare::get_newest ();
+                 p_share != NULL; p_share = p_share->get_next ())
+            {
+                p_share->reset_stats ();
+            }
+            device << "All statistics reset" << endl;
+        }
+        else
+        {
+            BaseShare* p_share = find_share (p_rest);
+            if (p_share != NULL)
+            {
+                p_share->reset_stats ();
+                device << p_share->get_name () << " statistics reset"
+                       << endl;
+            }
+        }
+    }
+    else if (strcmp (p_command, "watch") == 0)
+    {
+        if (*p_rest == '\0' || strcmp (p_rest, "off") == 0)
+        {
+            n_watched = 0;
+            return;
+        }
+        uint32_t rate = strtoul (p_rest, &p_rest, 10);
+        while (*p_rest == ' ')
+        {
+            p_rest++;
+        }
+        if (rate == 0)
+        {
+            device << "Usage: watch rate name" << endl;
+            return;
+        }
+        BaseShare* p_share = find_share (p_rest);
+        if (p_share == NULL)
+        {
+            return;
+        }
+        if (n_watched >= SHELL_MAX_WATCHED)
+        {
+            device << "Only " << SHELL_MAX_WATCHED
+                   << " shares can be watched" << endl;
+            return;
+        }
+        p_watched[n_watched++] = p_share;
+        watch_ticks = configTICK_RATE_HZ / rate;
+        if (watch_ticks == 0)
+        {
+            watch_ticks = 1;
+        }
+        last_watch = xTaskGetTickCount ();
+    }
+    else if (strcmp (p_command, "help") == 0)
+    {
+        device << "list                 Show all shares" << endl
+               << "get name             Show a share's value" << endl
+               << "peek name            Show a queue's head item" << endl
+               << "set name value       Put a value into a share" << endl
+               << "stats [name]         Show a share's status" << endl
+               << "reset-stats [name]   Reset statistics" << endl
+               << "watch rate name      Show values rate times/s" << endl
+               << "watch off            Stop watching" << endl;
+    }
+    else
+    {
+        device << "Unknown command \"" << p_command << "\"; try help"
+               << endl;
+    }
+}
+
+
+/** @brief   Read typed characters and run any command which has been
+ *           finished.
+ *  @details This method never waits for characters, so it can be called
+ *           from a program's own user interface task. Typed characters are
+ *           echoed. It also prints a line of watched values when one is due,
+ *           so it should be called at least as often as values are watched.
+ */
+void ShareShell::poll (void)
+{
+    while (device.available () > 0)
+    {
+        int ch = device.read ();
+        if (ch < 0)
+        {
+            break;
+        }
+        else if (ch == '\r' || ch == '\n')
+        {
+            if (line_length > 0 || ch == '\r')
+            {
+                device << endl;
+            }
+            line[line_length] = '\0';
+            line_length = 0;
+            run_command (line);
+        }
+        else if (ch == '\b' || ch == 0x7F)
+        {
+            if (line_length > 0)
+            {
+                line_length--;
+                device << "\b \b";
+            }
+        }
+        else if (ch >= ' ' && line_length < SHELL_LINE_LENGTH - 1)
+        {
+            line[line_length++] = (char)ch;
+            device.write ((uint8_t)ch);
+        }
+    }
+
+    if (n_watched > 0 && xTaskGetTickCount () - last_watch >= watch_ticks)
+    {
+        last_watch += watch_ticks;
+        print_watched ();
+    }
+}
+
+
+/** @brief   Task function which runs the shell.
+ *  @param   p_shell Pointer to the @c ShareShell object
+ */
+void ShareShell::shell_task (void* p_shell)
+{
+    ShareShell* p_this = (ShareShell*)p_shell;
+
+    p_this->device << "Share shell; type help for commands" << endl;
+    for (;;)
+    {
+        p_this->poll ();
+
+        // Wake often enough for both typing and watched values
+        TickType_t delay = SHELL_POLL_TICKS;
+        if (p_this->n_watched > 0 && p_this->watch_ticks < delay)
+        {
+            delay = p_this->watch_ticks;
+        }
+        vTaskDelay (delay);
+    }
+}
+
+
+/** @brief   Start a task which runs the shell.
+ *  @details The task should have a priority below that of every control
+ *           task. It never waits for a share, so it can't hold them up;
+ *           printing a long reply may make it wait for the serial port,
+ *           which only delays the shell itself.
+ *  @param   priority The priority of the shell task (default 1)
+ *  @param   stack_size The size of the task's stack (default 4096)
+ *  @returns @c true if the task was created, @c false if not
+ */
+bool ShareShell::begin (UBaseType_t priority, uint32_t stack_size)
+{
+    return xTaskCreate (shell_task, "Shell", stack_size, this, priority, NULL)
+           == pdPASS;
+}
@@ -0,0 +1,139 @@
+//*****************************************************************************
+/** @file    shareshell.h
+ *  @brief   Headers for a command shell which reads and writes shares over a
+ *           serial port while a program runs.
+ *  @details The shell runs in a low priority task. It looks shares up by
+ *           name and reads and writes their values through the generic
+ *           methods in @c BaseShare, using the type codes in @c sharetype.h
+ *           to parse and print values of each share's own type. Every read
+ *           and write it makes returns at once, so it never holds up the
+ *           tasks which use the shares.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SHARESHELL_H_
+#define _SHARESHELL_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include "baseshare.h"
+
+
+/// The longest command line, in characters, which the shell accepts
+#define SHELL_LINE_LENGTH       64
+
+/// The most shares which can be watched at once
+#define SHELL_MAX_WATCHED       4
+
+/// The number of RTOS ticks between checks for typed characters
+#define SHELL_POLL_TICKS        20
+
+
+/** @brief   Class which runs a command shell for looking at and changing
+ *           shares while a program runs.
+ *  @details The shell understands these commands, where @c name is the name
+ *           of a share or queue as shown by @c list; names may contain
+ *           spaces and needn't be quoted.
+ *           - @c list prints the status of every share, as
+ *             @c print_all_shares() does
+ *           - @c get @c name prints a share's value
+ *           - @c peek @c name prints the item at the head of a queue without
+ *             taking it out, so the task which reads the queue still gets it
+ *             (@c get does the same; the shell never takes items from queues)
+ *           - @c set @c name @c value puts a value into a share or the back
+ *             of a queue
+ *           - @c stats @c name prints a share's status line, such as how
+ *             full a queue has been or a share's running statistics
+ *           - @c reset-stats @c name starts a share's statistics over again;
+ *             without a name, every share's statistics are reset
+ *           - @c watch @c rate @c name prints a share's value @c rate times
+ *             per second, along with those of any others being watched;
+ *             @c watch @c off stops watching
+ *           - @c help lists the commands
+ *
+ *           Values are parsed and printed in each share's own type, which
+ *           the share reports through @c BaseShare::get_value_type(), so
+ *           @c Share<int16_t> refuses @c 40000 and @c Share<float> prints
+ *           decimals. Shares whose data isn't a plain number can be listed
+ *           but not read or written.
+ *
+ *           @section usage_shell Usage
+ *           @code
+ *           #include "shareshell.h"
+ *           ...
+ *           ShareShell shell (Serial);
+ *           ...
+ *           // In setup()
+ *           shell.begin ();
+ *           @endcode
+ *           A program which already has a low priority user interface task
+ *           may call @c poll() from it instead of calling @c begin().
+ */
+class ShareShell
+{
+protected:
+    Stream& device;                       ///< The serial port to talk on
+    char line[SHELL_LINE_LENGTH];         ///< The command being typed
+    uint8_t line_length;                  ///< Characters in @c line
+    BaseShare* p_watched[SHELL_MAX_WATCHED];   ///< Shares being watched
+    uint8_t n_watched;                    ///< Number of shares watched
+    TickType_t watch_ticks;               ///< Ticks between watch lines
+    TickType_t last_watch;                ///< Tick count at last watch line
+    uint32_t commands;                    ///< Commands run so far
+
+    // Run one command line
+    void run_command (char* p_command);
+
+    // Find a share by name, complaining if there's no such share
+    BaseShare* find_share (const char* p_name);
+
+    // Print a share's value, or why it can't be printed
+    void print_value (BaseShare* p_share);
+
+    // Print a line with the values of the watched shares
+    void print_watched (void);
+
+    // The task function which runs the shell
+    static void shell_task (void* p_shell);
+
+public:
+    // Create a shell which talks on the given serial port
+    ShareShell (Stream& serial_device);
+
+    // Read typed characters and run any command which has been finished
+    void poll (void);
+
+    // Start a task which runs the shell
+    bool begin (UBaseType_t priority = 1, uint32_t stack_size = 4096);
+
+    /** @brief   Return the number of commands which have been run.
+     *  @returns The number of command lines run, including invalid ones
+     */
+    uint32_t get_commands (void)
+    {
+        return commands;
+    }
+};
+
+#endif // _SHARESHELL_H_
@@ -0,0 +1,322 @@
+//*****************************************************************************
+/** @file    sharetype.h
+ *  @brief   Codes which tell what type of value a shared data item holds.
+ *  @details Programs which handle the values in many different shares, such
+ *           as a telemetry sender which streams them to a PC, need to know
+ *           how large each value is and how to interpret its bits without
+ *           knowing the template type of each share. Shares report one of the
+ *           codes here through @c BaseShare::get_value_type(), and the
+ *           @c ShareType template works out the right code for a C++ type.
+ *
+ *           This file uses no Arduino or FreeRTOS code, so programs on a PC
+ *           which decode data sent by a microcontroller can use it too.
+ *
+ *  @date 2026-Oct-17 Original file
+ *  @date 2026-Oct-17 Added @c share_type_parse() and @c share_type_format()
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SHARETYPE_H_
+#define _SHARETYPE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+
+/** @brief   Codes for the types of values held by shared data items.
+ *  @details These numbers are sent in telemetry and logs, so they mustn't be
+ *           changed; new types may be added at the end.
+ */
+enum ShareValueType : uint8_t
+{
+    SHARE_NONE = 0,                       ///< Value can't be read generically
+    SHARE_BOOL,                           ///< @c bool
+    SHARE_U8,                             ///< @c uint8_t
+    SHARE_I8,                             ///< @c int8_t
+    SHARE_U16,                            ///< @c uint16_t
+    SHARE_I16,                            ///< @c int16_t
+    SHARE_U32,                            ///< @c uint32_t
+    SHARE_I32,                            ///< @c int32_t
+    SHARE_U64,                            ///< @c uint64_t
+    SHARE_I64,                            ///< @c int64_t
+    SHARE_FLOAT,                          ///< 32-bit @c float
+    SHARE_DOUBLE                          ///< 64-bit @c double
+};
+
+
+/** @brief   Template which finds the type code for a C++ type.
+ *  @details The code is worked out from the size and signedness of the type
+ *           rather than by listing types, because @c int32_t is an @c int on
+ *           some processors and a @c long on others. Types which aren't
+ *           plain numbers get @c SHARE_NONE. For example,
+ *           @c ShareType<uint16_t>::code is @c SHARE_U16.
+ *  @tparam  DataType The type whose code is wanted
+ */
+template <class DataType>
+struct ShareType
+{
+    /// The code for values of type @c DataType
+    static const uint8_t code =
+        std::is_same<DataType, bool>::value ? SHARE_BOOL
+      : std::is_floating_point<DataType>::value
+        ? (sizeof (DataType) == 4 ? SHARE_FLOAT
+         : sizeof (DataType) == 8 ? SHARE_DOUBLE : SHARE_NONE)
+      : !std::is_integral<DataType>::value ? SHARE_NONE
+      : sizeof (DataType) == 1
+        ? (std::is_signed<DataType>::value ? SHARE_I8 : SHARE_U8)
+      : sizeof (DataType) == 2
+        ? (std::is_signed<DataType>::value ? SHARE_I16 : SHARE_U16)
+      : sizeof (DataType) == 4
+        ? (std::is_signed<DataType>::value ? SHARE_I32 : SHARE_U32)
+      : sizeof (DataType) == 8
+        ? (std::is_signed<DataType>::value ? SHARE_I64 : SHARE_U64)
+      : SHARE_NONE;
+};
+
+
+/** @brief   Return the number of bytes in a value of the given type.
+ *  @param   type One of the @c ShareValueType codes
+ *  @returns The size of the value in bytes, or 0 for @c SHARE_NONE and
+ *           unknown codes
+ */
+inline uint8_t share_type_size (uint8_t type)
+{
+    switch (type)
+    {
+        case SHARE_BOOL:
+        case SHARE_U8:
+        case SHARE_I8:
+            return 1;
+        case SHARE_U16:
+        case SHARE_I16:
+            return 2;
+        case SHARE_U32:
+        case SHARE_I32:
+        case SHARE_FLOAT:
+            return 4;
+        case SHARE_U64:
+        case SHARE_I64:
+        case SHARE_DOUBLE:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+
+/** @brief   Return @c true if the given type is a signed integer.
+ *  @param   type One of the @c ShareValueType codes
+ *  @returns @c true for the signed integer types only
+ */
+inline bool share_type_is_signed (uint8_t type)
+{
+    return type == SHARE_I8 || type == SHARE_I16 || type == SHARE_I32
+           || type == SHARE_I64;
+}
+
+
+/** @brief   Widen a value of any share type into 64 bits.
+ *  @details Integers are extended to 64 bits, with their signs if they are
+ *           signed; the bits of @c float and @c double values are copied
+ *           without conversion. Values of all types can then be handled the
+ *           same way, for instance when computing differences between them.
+ *  @param   type One of the @c ShareValueType codes
+ *  @param   p_value Pointer to the value, which needn't be aligned
+ *  @returns The widened value
+ */
+inline uint64_t share_type_widen (uint8_t type, const void* p_value)
+{
+    uint8_t size = share_type_size (type);
+    uint64_t raw = 0;
+    memcpy (&raw, p_value, size);             // Processors are little endian
+
+    // Extend the sign of signed integers shorter than 64 bits
+    if (share_type_is_signed (type) && size < 8)
+    {
+        uint64_t sign_bit = 1ULL << (8 * size - 1);
+        raw = (raw ^ sign_bit) - sign_bit;
+    }
+    return raw;
+}
+
+
+/** @brief   Turn a widened value back into a value of its own type.
+ *  @param   type One of the @c ShareValueType codes
+ *  @param   raw A value from @c share_type_widen()
+ *  @param   p_value Pointer to where the value is to be put
+ */
+inline void share_type_narrow (uint8_t type, uint64_t raw, void* p_value)
+{
+    memcpy (p_value, &raw, share_type_size (type));
+}
+
+
+/** @brief   Read a value of the given type from text.
+ *  @details Integers may be written in decimal or, beginning with @c 0x, in
+ *           hexadecimal; a value which doesn't fit in the type is refused
+ *           rather than cut off. A @c bool may be written as @c 0, @c 1,
+ *           @c true or @c false.
+ *  @param   type One of the @c ShareValueType codes
+ *  @param   p_text The text, which must hold nothing but the value
+ *  @param   p_value Pointer to where the value is to be put
+ *  @returns @c true if the text held a valid value of the type
+ */
+inline bool share_type_parse (uint8_t type, const char* p_text,
+                              void* p_value)
+{
+    char* p_end = NULL;
+    uint8_t size = share_type_size (type);
+
+    if (size == 0 || p_text == NULL || *p_text == '\0')
+    {
+        return false;
+    }
+    if (type == SHARE_BOOL)
+    {
+        bool flag;
+        if (strcmp (p_text, "1") == 0 || strcmp (p_text, "true") == 0)
+        {
+            flag = true;
+        }
+        else if (strcmp (p_text, "0") == 0 || strcmp (p_text, "false") == 0)
+        {
+            flag = false;
+        }
+        else
+        {
+            return false;
+        }
+        memcpy (p_value, &flag, 1);
+        return true;
+    }
+    if (type == SHARE_FLOAT)
+    {
+        float number = strtof (p_text, &p_end);
+        memcpy (p_value, &number, sizeof (float));
+        return *p_end == '\0';
+    }
+    if (type == SHARE_DOUBLE)
+    {
+        double number = strtod (p_text, &p_end);
+        memcpy (p_value, &number, sizeof (double));
+        return *p_end == '\0';
+    }
+
+    uint64_t raw;
+    if (share_type_is_signed (type))
+    {
+        int64_t number = strtoll (p_text, &p_end, 0);
+        int64_t limit = (int64_t)(((uint64_t)1 << (8 * size - 1)) - 1);
+        if (size < 8 && (number > limit || number < -limit - 1))
+        {
+            return false;
+        }
+        raw = (uint64_t)number;
+    }
+    else
+    {
+        if (*p_text == '-')
+        {
+            return false;
+        }
+        raw = strtoull (p_text, &p_end, 0);
+        if (size < 8 && (raw >> (8 * size)) != 0)
+        {
+            return false;
+        }
+    }
+    if (*p_end != '\0')
+    {
+        return false;
+    }
+    share_type_narrow (type, raw, p_value);
+    return true;
+}
+
+
+/** @brief   Write a value of the given type as text.
+ *  @details Integers are converted here rather than with @c printf(), whose
+ *           small versions in some microcontroller libraries can't print
+ *           64-bit numbers.
+ *  @param   type One of the @c ShareValueType codes
+ *  @param   p_value Pointer to the value, which needn't be aligned
+ *  @param   p_text A buffer for the text; 24 characters are always enough
+ *  @param   length The size of the buffer
+ *  @returns @c p_text, for convenience
+ */
+inline char* share_type_format (uint8_t type, const void* p_value,
+                                char* p_text, size_t length)
+{
+    char digits[24];
+    char* p_digit = digits + sizeof (digits);
+    *--p_digit = '\0';
+
+    uint64_t raw = share_type_widen (type, p_value);
+    if (type == SHARE_NONE)
+    {
+        *--p_digit = '?';
+    }
+    else if (type == SHARE_BOOL)
+    {
+        *--p_digit = (raw & 1) ? '1' : '0';
+    }
+    else if (type == SHARE_FLOAT || type == SHARE_DOUBLE)
+    {
+        double number;
+        if (type == SHARE_FLOAT)
+        {
+            float single;
+            memcpy (&single, &raw, sizeof (float));
+            number = single;
+        }
+        else
+        {
+            memcpy (&number, &raw, sizeof (double));
+        }
+        snprintf (p_text, length, (type == SHARE_FLOAT) ? "%.7g" : "%.15g",
+                  number);
+        return p_text;
+    }
+    else
+    {
+        bool negative = share_type_is_signed (type) && (int64_t)raw < 0;
+        uint64_t magnitude = negative ? 0 - raw : raw;
+        do
+        {
+            *--p_digit = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        }
+        while (magnitude != 0);
+        if (negative)
+        {
+            *--p_digit = '-';
+        }
+    }
+    strncpy (p_text, p_digit, length);
+    if (length > 0)
+    {
+        p_text[length - 1] = '\0';
+    }
+    return p_text;
+}
+
+#endif // _SHARETYPE_H_
@@ -0,0 +1,143 @@
+//*****************************************************************************
+/** @file    span.h
+ *  @brief   A small view of a block of items in memory, for passing blocks of
+ *           data around without copying them.
+ *  @details This file contains a simple version of C++20's @c std::span,
+ *           which isn't available with the C++ standards used by most
+ *           microcontroller toolchains. A span holds a pointer to the first
+ *           item in a block and the number of items; it doesn't own the
+ *           memory, so copying a span doesn't copy the data.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SPAN_H_
+#define _SPAN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/** @brief   A view of a block of items which are stored somewhere else.
+ *  @details A span can be used much like an array, with @c [] and with
+ *           range-based @c for loops:
+ *           @code
+ *           Span<int16_t> samples = channel.acquire ();
+ *           int32_t sum = 0;
+ *           for (int16_t sample : samples)
+ *           {
+ *               sum += sample;
+ *           }
+ *           @endcode
+ *           An empty span, whose @c data() is @c NULL, is used to show that
+ *           no block was available.
+ */
+template <class DataType> class Span
+{
+protected:
+    DataType* p_data;                     ///< Pointer to the first item
+    size_t length;                        ///< Number of items
+
+public:
+    /// Create an empty span which refers to no data
+    Span (void) : p_data (NULL), length (0)
+    {
+    }
+
+    /** @brief   Create a span which refers to a block of items.
+     *  @param   p_first A pointer to the first item in the block
+     *  @param   count The number of items in the block
+     */
+    Span (DataType* p_first, size_t count) : p_data (p_first), length (count)
+    {
+    }
+
+    /** @brief   Create a span which refers to a whole array.
+     *  @param   array The array
+     */
+    template <size_t count> Span (DataType (&array)[count])
+        : p_data (array), length (count)
+    {
+    }
+
+    /// Return a pointer to the first item
+    DataType* data (void) const
+    {
+        return p_data;
+    }
+
+    /// Return the number of items in the span
+    size_t size (void) const
+    {
+        return length;
+    }
+
+    /// Return the number of bytes taken up by the items in the span
+    size_t size_bytes (void) const
+    {
+        return length * sizeof (DataType);
+    }
+
+    /// Return @c true if the span has no items
+    bool empty (void) const
+    {
+        return length == 0;
+    }
+
+    /// Return a reference to an item; the index isn't checked
+    DataType& operator [] (size_t index) const
+    {
+        return p_data[index];
+    }
+
+    /// Return a pointer to the first item, for range-based @c for loops
+    DataType* begin (void) const
+    {
+        return p_data;
+    }
+
+    /// Return a pointer just past the last item, for range-based @c for loops
+    DataType* end (void) const
+    {
+        return p_data + length;
+    }
+
+    /** @brief   Return a span which refers to part of this span.
+     *  @details The part is cut off at the end of this span if it would run
+     *           past it.
+     *  @param   offset The index of the first item in the part
+     *  @param   count The number of items in the part
+     *  @returns A span referring to the part
+     */
+    Span<DataType> subspan (size_t offset, size_t count) const
+    {
+        if (offset >= length)
+        {
+            return Span<DataType> (p_data + length, 0);
+        }
+        if (count > length - offset)
+        {
+            count = length - offset;
+        }
+        return Span<DataType> (p_data + offset, count);
+    }
+};
+
+#endif // _SPAN_H_
@@ -0,0 +1,381 @@
+//*****************************************************************************
+/** @file    statsshare.h
+ *  @brief   Shares which keep running statistics of a stream of samples.
+ *  @details A task which only needs the minimum, maximum, mean and standard
+ *           deviation of a signal needn't be sent every sample through a
+ *           queue. The classes in this file fold each sample into a few
+ *           running sums as it is put in. The memory used per signal is the
+ *           same no matter how many samples are taken.
+ *
+ *           @c StatsShare does its arithmetic in @c float, using Welford's
+ *           algorithm, which doesn't lose accuracy as the number of samples
+ *           grows the way a sum of squares in @c float does. On the ESP32,
+ *           code in ISR's mustn't use the floating point unit, so samples
+ *           taken in ISR's there should go into a @c FixedStatsShare, which
+ *           adds samples up in exact integers. Both may be given samples from
+ *           tasks or ISR's and both give readers a @c Stats snapshot in which
+ *           all the numbers come from the same set of samples.
+ *
+ *  @date 2026-Oct-17 Original file
+ *  @date 2026-Oct-17 Keep exact integer sums in @c FixedStatsShare
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _STATSSHARE_H_
+#define _STATSSHARE_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <math.h>
+#include <type_traits>
+#include "baseshare.h"
+#include "critical.h"
+
+
+/** @brief   Statistics of a set of samples, as read from a statistics share.
+ *  @tparam  DataType The type of the samples
+ */
+template <class DataType>
+struct Stats
+{
+    uint32_t count;                       ///< Number of samples
+    DataType min;                         ///< Smallest sample
+    DataType max;                         ///< Largest sample
+    float mean;                           ///< Mean of the samples
+    float variance;                       ///< Sample variance (over n - 1)
+
+    /** @brief   Compute the standard deviation of the samples.
+     *  @returns The sample standard deviation, or 0 if there are fewer than
+     *           two samples
+     */
+    float std_dev (void) const
+    {
+        return sqrtf (variance);
+    }
+};
+
+
+/** @brief   Print the statistics from a statistics share.
+ *  @details This function is used by the statistics shares' methods which
+ *           print in the list of shares, and may be used to print snapshots.
+ *  @param   printer Reference to a serial device on which to print
+ *  @param   stats The statistics to be printed
+ */
+template <class DataType>
+void print_stats (Print& printer, const Stats<DataType>& stats)
+{
+    printer << "n=" << stats.count;
+    if (stats.count > 0)
+    {
+        printer << " min=" << stats.min << " max=" << stats.max
+                << " mean=" << stats.mean << " sd=" << stats.std_dev ();
+    }
+}
+
+
+/** @brief   Class which keeps running statistics of samples using floating
+ *           point arithmetic.
+ *  @details Each call to @c put() updates the count, minimum, maximum, mean
+ *           and sum of squared deviations inside a critical section, so a
+ *           reader never sees a sample half added in. 
+ *
+ *           @section usage_stats Usage
+ *           @code
+ *           #include "statsshare.h"
+ *           ...
+ *           /// Statistics of the time taken by each run of the control loop
+ *           StatsShare<float> loop_time ("Loop us");
+ *           @endcode
+ *           In the control task:
+ *           @code
+ *           loop_time.put (micros () - start_time);
+ *           @endcode
+ *           In a monitoring task, every second or so:
+ *           @code
+ *           Stats<float> last_second = loop_time.get (true);  // and reset
+ *           Serial << "Mean " << last_second.mean << " us, sd " 
+ *                  << last_second.std_dev () << endl;
+ *           @endcode
+ *  @tparam  DataType The type of the samples, which must be convertible to
+ *           and comparable as @c float
+ */
+template <class DataType = float>
+class StatsShare : public BaseShare
+{
+protected:
+    CriticalSection guard;                ///< Protects the running sums
+    uint32_t count;                       ///< Number of samples so far
+    DataType min;                         ///< Smallest sample so far
+    DataType max;                         ///< Largest sample so far
+    float mean;                           ///< Running mean
+    float m2;                             ///< Sum of squared deviations
+
+public:
+    /** @brief   Create a statistics share with no samples in it.
+     *  @param   p_name A name for the share, shown by @c print_all_shares()
+     */
+    StatsShare (const char* p_name = NULL)
+        : BaseShare (p_name)
+    {
+        reset ();
+    }
+
+    /** @brief   Add a sample to the statistics.
+     *  @details This method may be called from a task or an ISR, except an
+     *           ESP32 ISR; use a @c FixedStatsShare there.
+     *  @param   sample The sample to be added
+     */
+    void put (DataType sample)
+    {
+        UBaseType_t saved = guard.enter ();
+        if (count == 0 || sample < min)
+        {
+            min = sample;
+        }
+        if (count == 0 || sample > max)
+        {
+            max = sample;
+        }
+        count++;
+        float delta = (float)sample - mean;
+        mean += delta / count;
+        m2 += delta * ((float)sample - mean);
+        guard.exit (saved);
+    }
+
+    /** @brief   Operator which adds a sample to the statistics.
+     *  @param   sample The sample to be added
+     */
+    void operator << (DataType sample)
+    {
+        put (sample);
+    }
+
+    /** @brief   Get a snapshot of the statistics.
+     *  @param   and_reset @c true to start the statistics over again, in the
+     *           same critical section, so no samples are missed (default
+     *           @c false)
+     *  @returns The statistics of the samples so far
+     */
+    Stats<DataType> get (bool and_reset = false)
+    {
+        Stats<DataType> stats;
+
+        UBaseType_t saved = guard.enter ();
+        stats.count = count;
+        stats.min = min;
+        stats.max = max;
+        stats.mean = mean;
+        float sum_sq = m2;
+        if (and_reset)
+        {
+            count = 0;
+            mean = 0.0f;
+            m2 = 0.0f;
+        }
+        guard.exit (saved);
+
+        stats.variance = (stats.count > 1) ? sum_sq / (stats.count - 1) : 0.0f;
+        return stats;
+    }
+
+    /** @brief   Throw away all the samples taken so far.
+     */
+    void reset (void)
+    {
+        UBaseType_t saved = guard.enter ();
+        count = 0;
+        min = max = DataType ();
+        mean = 0.0f;
+        m2 = 0.0f;
+        guard.exit (saved);
+    }
+
+    /// Throw away the samples, as @c reset() does, for generic code
+    void reset_stats (void)
+    {
+        reset ();
+    }
+
+    /** @brief   Print the share's name, type and statistics within a list.
+     *  @param   printer Reference to a serial device on which to print
+     */
+    void print_in_list (Print& printer)
+    {
+        printer.printf ("%-16sstats\t", name);
+        print_stats (printer, get ());
+        printer << endl;
+    }
+};
+
+
+/** @brief   Class which keeps running statistics of integer samples using
+ *           only integer arithmetic.
+ *  @details Each sample's difference from the first sample is added to a
+ *           sum, and its square to a sum of squares, both exact 64-bit
+ *           integers; subtracting the first sample keeps the squares small
+ *           for a signal which stays near where it began. Adding a sample
+ *           takes one multiplication and no division, which is quick on both
+ *           the Cortex-M4 and the ESP32 and safe in any ISR. The mean and
+ *           variance are worked out from the sums only when they're read,
+ *           so they're as accurate as a @c double allows however many
+ *           samples have been taken.
+ *
+ *           The square of each sample's difference from the first, times
+ *           the number of samples, must fit in 63 bits. That allows over two
+ *           billion samples of a 16-bit signal swinging across its whole
+ *           range between resets.
+ *  @tparam  DataType An integer type of at most 32 bits
+ */
+template <class DataType = int32_t>
+class FixedStatsShare : public BaseShare
+{
+    static_assert (std::is_integral<DataType>::value,
+                   "FixedStatsShare holds integer samples only");
+    static_assert (sizeof (DataType) <= sizeof (int32_t),
+                   "FixedStatsShare samples must be 32 bits or smaller");
+
+protected:
+    CriticalSection guard;                ///< Protects the running sums
+    uint32_t count;                       ///< Number of samples so far
+    DataType min;                         ///< Smallest sample so far
+    DataType max;                         ///< Largest sample so far
+    DataType first;                       ///< First sample, subtracted
+    int64_t sum;                          ///< Sum of differences from first
+    int64_t sum_sq;                       ///< Sum of squared differences
+
+public:
+    /** @brief   Create an integer statistics share with no samples in it.
+     *  @param   p_name A name for the share, shown by @c print_all_shares()
+     */
+    FixedStatsShare (const char* p_name = NULL)
+        : BaseShare (p_name)
+    {
+        reset ();
+    }
+
+    /** @brief   Add a sample to the statistics.
+     *  @details This method may be called from a task or any ISR.
+     *  @param   sample The sample to be added
+     */
+    void put (DataType sample)
+    {
+        UBaseType_t saved = guard.enter ();
+        if (count == 0)
+        {
+            first = min = max = sample;
+        }
+        else if (sample < min)
+        {
+            min = sample;
+        }
+        else if (sample > max)
+        {
+            max = sample;
+        }
+        count++;
+        int64_t diff = (int64_t)sample - (int64_t)first;
+        sum += diff;
+        sum_sq += diff * diff;
+        guard.exit (saved);
+    }
+
+    /** @brief   Operator which adds a sample to the statistics.
+     *  @param   sample The sample to be added
+     */
+    void operator << (DataType sample)
+    {
+        put (sample);
+    }
+
+    /** @brief   Get a snapshot of the statistics.
+     *  @details The sums are copied in a critical section and divided
+     *           afterwards in @c double, so this method should be called from
+     *           a task rather than an ISR.
+     *  @param   and_reset @c true to start the statistics over again, in the
+     *           same critical section, so no samples are missed (default
+     *           @c false)
+     *  @returns The statistics of the samples so far
+     */
+    Stats<DataType> get (bool and_reset = false)
+    {
+        Stats<DataType> stats;
+
+        UBaseType_t saved = guard.enter ();
+        stats.count = count;
+        stats.min = min;
+        stats.max = max;
+        DataType offset = first;
+        int64_t total = sum;
+        int64_t total_sq = sum_sq;
+        if (and_reset)
+        {
+            count = 0;
+            sum = 0;
+            sum_sq = 0;
+        }
+        guard.exit (saved);
+
+        if (stats.count == 0)
+        {
+            stats.mean = 0.0f;
+            stats.variance = 0.0f;
+            return stats;
+        }
+        double mean_diff = (double)total / stats.count;
+        stats.mean = (float)((double)offset + mean_diff);
+        double m2 = (double)total_sq - mean_diff * (double)total;
+        stats.variance = (stats.count > 1 && m2 > 0.0)
+                       ? (float)(m2 / (stats.count - 1)) : 0.0f;
+        return stats;
+    }
+
+    /** @brief   Throw away all the samples taken so far.
+     */
+    void reset (void)
+    {
+        UBaseType_t saved = guard.enter ();
+        count = 0;
+        min = max = first = 0;
+        sum = 0;
+        sum_sq = 0;
+        guard.exit (saved);
+    }
+
+    /// Throw away the samples, as @c reset() does, for generic code
+    void reset_stats (void)
+    {
+        reset ();
+    }
+
+    /** @brief   Print the share's name, type and statistics within a list.
+     *  @param   printer Reference to a serial device on which to print
+     */
+    void print_in_list (Print& printer)
+    {
+        printer.printf ("%-16sstats\t", name);
+        print_stats (printer, get ());
+        printer << endl;
+    }
+};
+
+#endif // _STATSSHARE_H_
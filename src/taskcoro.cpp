@@ -0,0 +1,231 @@
+//*****************************************************************************
+/** @file    taskcoro.cpp
+ *  @brief   Source code for a scheduler which runs many C++20 coroutines in
+ *           one FreeRTOS task.
+ *  @details See @c taskcoro.h for a description of how coroutines are written
+ *           and scheduled.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "taskcoro.h"
+
+#if defined __cpp_impl_coroutine
+
+
+// The total size of coroutine frames is kept for all schedulers together
+uint32_t CoScheduler::frame_bytes = 0;
+
+
+/** @brief   Allocate memory for a coroutine's frame.
+ *  @details The compiler calls this function when a coroutine is created. It
+ *           uses the ordinary heap, but keeps track of how much memory the
+ *           frames take so that it can be shown by @c print_all_shares().
+ *  @param   size The number of bytes needed for the frame
+ *  @returns A pointer to the newly allocated frame
+ */
+void* CoTask::promise_type::operator new (size_t size)
+{
+    CoScheduler::frame_bytes += size;
+    return ::operator new (size);
+}
+
+
+/** @brief   Free the memory used by a finished coroutine's frame.
+ *  @param   p_frame A pointer to the frame
+ *  @param   size The number of bytes which were allocated for the frame
+ */
+void CoTask::promise_type::operator delete (void* p_frame, size_t size)
+{
+    CoScheduler::frame_bytes -= size;
+    ::operator delete (p_frame);
+}
+
+
+/** @brief   Create a scheduler for coroutines.
+ *  @details The scheduler starts out with no coroutines; they're added with
+ *           @c spawn(). 
+ *  @param   p_name A name for the scheduler, shown in the list of shares
+ */
+CoScheduler::CoScheduler (const char* p_name)
+    : BaseShare (p_name)
+{
+    p_first = NULL;
+    task = NULL;
+    n_coroutines = 0;
+    resumes = 0;
+}
+
+
+/** @brief   Add a coroutine to the list of those being run.
+ *  @details The coroutine starts running the next time the scheduler checks
+ *           its list. This method should be called from the scheduler's own
+ *           task, either before @c run() is called or from within one of the
+ *           coroutines, as the list isn't protected from other tasks. 
+ *  @param   coroutine The newly created coroutine
+ */
+void CoScheduler::spawn (CoTask coroutine)
+{
+    CoTask::Handle handle = coroutine.release ();
+    if (!handle)
+    {
+        return;
+    }
+    CoTask::promise_type* p_promise = &handle.promise ();
+    p_promise->wake_tick = xTaskGetTickCount ();
+    p_promise->forever = false;
+    p_promise->p_wait = NULL;
+    p_promise->p_next = NULL;
+
+    // New coroutines go at the end of the list, so a coroutine can spawn
+    // others while the scheduler is walking through the list
+    CoTask::promise_type** pp_link = &p_first;
+    while (*pp_link != NULL)
+    {
+        pp_link = &((*pp_link)->p_next);
+    }
+    *pp_link = p_promise;
+    n_coroutines++;
+}
+
+
+/** @brief   Run each coroutine which is ready to run, once.
+ *  @details A coroutine is ready if its sleep time has ended, if the queue or
+ *           share for which it's waiting has data, or if its wait for a queue
+ *           has timed out. Each ready coroutine runs until it waits again or
+ *           finishes; finished coroutines are removed from the list and their
+ *           frames are freed. 
+ *  @returns @c true if any coroutine was run, @c false if none was ready
+ */
+bool CoScheduler::run_once (void)
+{
+    bool ran_any = false;
+    CoTask::promise_type** pp_link = &p_first;
+
+    while (*pp_link != NULL)
+    {
+        CoTask::promise_type* p_promise = *pp_link;
+        TickType_t now = xTaskGetTickCount ();
+        bool time_up = !p_promise->forever
+                       && (int32_t)(now - p_promise->wake_tick) >= 0;
+        bool ready;
+
+        if (p_promise->p_wait != NULL)
+        {
+            ready = p_promise->p_wait->poll ();
+            if (!ready && time_up)
+            {
+                p_promise->timed_out = true;
+                ready = true;
+            }
+        }
+        else
+        {
+            ready = time_up;
+        }
+
+        if (ready)
+        {
+            CoTask::Handle handle 
+                = CoTask::Handle::from_promise (*p_promise);
+            p_promise->p_wait = NULL;
+            resumes++;
+            ran_any = true;
+            handle.resume ();
+
+            if (handle.done ())
+            {
+                *pp_link = p_promise->p_next;
+                handle.destroy ();
+                n_coroutines--;
+                continue;
+            }
+        }
+        pp_link = &(p_promise->p_next);
+    }
+    return ran_any;
+}
+
+
+/** @brief   Run the coroutines forever.
+ *  @details This method is called at the end of the function for the task
+ *           in which the coroutines run, and it never returns. When no 
+ *           coroutine is ready, the task sleeps until the earliest time at
+ *           which one wants to wake up. If any coroutine is waiting for a
+ *           queue or share, the task wakes every tick to check on it, or 
+ *           sooner if another task or an ISR calls @c wake(). 
+ */
+void CoScheduler::run (void)
+{
+    task = xTaskGetCurrentTaskHandle ();
+
+    for (;;)
+    {
+        if (run_once ())
+        {
+            continue;
+        }
+
+        // Nothing is ready, so find out how long we may sleep
+        TickType_t now = xTaskGetTickCount ();
+        TickType_t sleep_ticks = portMAX_DELAY;
+        for (CoTask::promise_type* p_promise = p_first; p_promise != NULL;
+             p_promise = p_promise->p_next)
+        {
+            TickType_t ticks;
+            if (p_promise->p_wait != NULL)
+            {
+                ticks = 1;
+            }
+            else if (p_promise->forever)
+            {
+                continue;
+            }
+            else
+            {
+                // The tick count may have passed the wake time while other
+                // coroutines ran; then the coroutine is due now
+                ticks = ((int32_t)(p_promise->wake_tick - now) <= 0)
+                        ? 0 : p_promise->wake_tick - now;
+            }
+            if (ticks < sleep_ticks)
+            {
+                sleep_ticks = ticks;
+            }
+        }
+        ulTaskNotifyTake (pdTRUE, sleep_ticks);
+    }
+}
+
+
+/** @brief   Print the scheduler's status within a list of shares.
+ *  @details This method prints a line showing the scheduler's name, the 
+ *           number of coroutines it's running, the number of bytes used by
+ *           all coroutine frames, and the number of times coroutines have 
+ *           been resumed. 
+ *  @param   printer Reference to a serial device on which to print
+ */
+void CoScheduler::print_in_list (Print& printer)
+{
+    printer.printf ("%-16scoro\t", name);
+    printer << n_coroutines << " coros, " << frame_bytes << " B, "
+            << resumes << " runs" << endl;
+}
+
+#endif // __cpp_impl_coroutine
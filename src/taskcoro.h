@@ -0,0 +1,481 @@
+//*****************************************************************************
+/** @file    taskcoro.h
+ *  @brief   Lightweight C++20 coroutine tasks, many of which share one
+ *           FreeRTOS task.
+ *  @details Each FreeRTOS task needs its own stack, typically a couple of
+ *           kilobytes, even if it spends nearly all its time waiting. A
+ *           program with dozens of small, mostly idle state machines can
+ *           instead write each one as a C++20 coroutine and run them all in
+ *           a single FreeRTOS task with a @c CoScheduler. A coroutine keeps
+ *           only its local variables, in a frame of typically a few dozen to
+ *           a couple hundred bytes, while it waits.
+ *
+ *           Coroutines wait by using @c co_await with one of the awaitable
+ *           functions in this file:
+ *           * @c co_sleep() waits for a number of RTOS ticks
+ *           * @c co_sleep_until() waits until a regular period has elapsed, as
+ *             @c vTaskDelayUntil() does
+ *           * @c co_get() waits for an item from a @c Queue
+ *           * @c co_wait_update() waits until a @c Share has been written
+ *           * @c co_yield_now() lets the other coroutines run
+ *
+ *           Coroutines are scheduled cooperatively: one runs until it reaches
+ *           a @c co_await which must wait, and none may call blocking FreeRTOS
+ *           functions such as @c vTaskDelay() or @c Queue::get(), as these
+ *           would block every coroutine in the scheduler. Waits for sleeping
+ *           are exact to the tick; waits for queues and shares are checked
+ *           once each tick, as queues and shares don't signal the scheduler
+ *           when they're written.
+ *
+ *           This file needs a compiler with C++20 coroutine support, such as
+ *           GCC 10 or newer with @c -std=gnu++20 in @c build_flags and the
+ *           platform's default standard in @c build_unflags. With older
+ *           compilers or standards the file compiles to nothing.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TASKCORO_H_
+#define _TASKCORO_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include "baseshare.h"
+#include "taskqueue.h"
+#include "taskshare.h"
+
+#if defined __cpp_impl_coroutine
+
+#include <coroutine>
+
+
+class CoScheduler;
+
+
+/** @brief   Base class for the things a coroutine can wait for, other than
+ *           the passing of time.
+ *  @details The scheduler calls @c poll() once each tick for a coroutine
+ *           which is waiting on one of these; when @c poll() returns
+ *           @c true, the coroutine resumes.
+ */
+class CoWait
+{
+public:
+    /** @brief   Check whether the awaited thing has happened.
+     *  @returns @c true if the waiting coroutine may resume
+     */
+    virtual bool poll (void) = 0;
+};
+
+
+/** @brief   The return type of coroutines which are run by a @c CoScheduler.
+ *  @details A function becomes a coroutine when it returns a @c CoTask and
+ *           uses @c co_await. Calling the function only creates the
+ *           coroutine; it starts running when it's given to
+ *           @c CoScheduler::spawn(). For example, a blinker:
+ *           @code
+ *           CoTask blink (uint8_t pin, TickType_t period)
+ *           {
+ *               for (;;)
+ *               {
+ *                   digitalWrite (pin, !digitalRead (pin));
+ *                   co_await co_sleep (period);
+ *               }
+ *           }
+ *           ...
+ *           scheduler.spawn (blink (LED_BUILTIN, 500));
+ *           @endcode
+ */
+class CoTask
+{
+public:
+    /// The information which C++ keeps with each running coroutine; the
+    /// scheduler uses it to decide when the coroutine should resume
+    struct promise_type
+    {
+        TickType_t wake_tick = 0;          ///< Tick at which to resume
+        bool forever = false;              ///< No wake tick; wait for p_wait
+        CoWait* p_wait = NULL;             ///< Thing awaited, if any
+        bool timed_out = false;            ///< Wait ended by timeout
+        promise_type* p_next = NULL;       ///< Next coroutine in scheduler
+
+        CoTask get_return_object (void)
+        {
+            return CoTask (std::coroutine_handle<promise_type>::from_promise
+                           (*this));
+        }
+
+        /// Coroutines don't start until they're given to a scheduler
+        std::suspend_always initial_suspend (void) noexcept { return {}; }
+
+        /// The scheduler destroys coroutines which have finished
+        std::suspend_always final_suspend (void) noexcept { return {}; }
+
+        void return_void (void) { }
+
+        /// Exceptions are normally turned off on microcontrollers
+        void unhandled_exception (void) { }
+
+        // Allocate and free coroutine frames, keeping track of their size
+        static void* operator new (size_t size);
+        static void operator delete (void* p_frame, size_t size);
+    };
+
+    /// A handle which is used to resume or destroy the coroutine
+    typedef std::coroutine_handle<promise_type> Handle;
+
+protected:
+    Handle handle;                         ///< The coroutine's handle
+
+public:
+    /// Create a task object for a newly created coroutine
+    explicit CoTask (Handle a_handle) : handle (a_handle) { }
+
+    /// Take over the coroutine from another task object
+    CoTask (CoTask&& other) : handle (other.handle)
+    {
+        other.handle = Handle ();
+    }
+
+    /// Destroy the coroutine if it was never given to a scheduler
+    ~CoTask (void)
+    {
+        if (handle)
+        {
+            handle.destroy ();
+        }
+    }
+
+    /** @brief   Give up ownership of the coroutine to a scheduler.
+     *  @returns The coroutine's handle
+     */
+    Handle release (void)
+    {
+        Handle taken = handle;
+        handle = Handle ();
+        return taken;
+    }
+};
+
+
+/** @brief   Runs many coroutines within one FreeRTOS task.
+ *  @details The scheduler keeps a list of coroutines. Each time it runs
+ *           through the list, it resumes every coroutine whose sleep has
+ *           ended or whose awaited queue or share has data, each in turn,
+ *           until that coroutine waits again. When no coroutine can run, the
+ *           FreeRTOS task sleeps until the next coroutine's wake-up time, or
+ *           for one tick if any coroutine is waiting for a queue or a share.
+ *
+ *           A scheduler is a shared data item so that it shows up in the
+ *           list printed by @c print_all_shares(), along with the number of
+ *           coroutines it's running, the memory used by their frames, and the
+ *           number of times coroutines have been resumed.
+ *
+ *           @section coro_usage Usage
+ *           @code
+ *           #include "taskcoro.h"
+ *           ...
+ *           /// Runs all the small state machines in the robot's arm
+ *           CoScheduler arm_scheduler ("Arm SMs");
+ *
+ *           void task_arm (void* p_params)
+ *           {
+ *               arm_scheduler.spawn (blink (LED_BUILTIN, 500));
+ *               arm_scheduler.spawn (gripper_machine ());
+ *               arm_scheduler.run ();            // Never returns
+ *           }
+ *           @endcode
+ */
+class CoScheduler : public BaseShare
+{
+protected:
+    CoTask::promise_type* p_first;         ///< List of coroutines
+    TaskHandle_t task;                     ///< FreeRTOS task running us
+    uint16_t n_coroutines;                 ///< Number of coroutines in list
+    uint32_t resumes;                      ///< Times coroutines were resumed
+
+    /// Number of bytes in all coroutine frames, for every scheduler
+    static uint32_t frame_bytes;
+
+    friend struct CoTask::promise_type;
+
+public:
+    // Create an empty scheduler
+    CoScheduler (const char* p_name = NULL);
+
+    // Add a coroutine to the list of those to be run
+    void spawn (CoTask coroutine);
+
+    // Run every coroutine which is ready, once
+    bool run_once (void);
+
+    // Run the coroutines forever, sleeping when none is ready
+    void run (void);
+
+    /** @brief   Wake the scheduler's task so it checks its coroutines now.
+     *  @details The scheduler normally checks coroutines waiting for queues
+     *           and shares once per tick. An ISR or task which has just put
+     *           data where a coroutine is waiting for it can call this method
+     *           to have it checked right away. It must @b not be called within
+     *           an interrupt service routine; use @c ISR_wake() there.
+     */
+    void wake (void)
+    {
+        if (task != NULL)
+        {
+            xTaskNotifyGive (task);
+        }
+    }
+
+    /** @brief   Wake the scheduler's task from within an ISR.
+     */
+    void ISR_wake (void)
+    {
+        if (task != NULL)
+        {
+            BaseType_t wake_up;
+            vTaskNotifyGiveFromISR (task, &wake_up);
+        }
+    }
+
+    /** @brief   Return the number of coroutines being run.
+     *  @returns The number of coroutines which haven't finished
+     */
+    uint16_t get_count (void)
+    {
+        return n_coroutines;
+    }
+
+    /** @brief   Return the total size of all coroutine frames in use.
+     *  @details This is the memory which all coroutines, in all schedulers,
+     *           are using in place of the stacks they'd need as tasks.
+     *  @returns The number of bytes allocated for coroutine frames
+     */
+    static uint32_t get_frame_bytes (void)
+    {
+        return frame_bytes;
+    }
+
+    // Print the scheduler's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Awaitable which puts a coroutine to sleep until a given tick.
+ */
+struct CoSleep
+{
+    TickType_t wake_tick;                  ///< Tick at which to wake up
+
+    bool await_ready (void)
+    {
+        return (int32_t)(xTaskGetTickCount () - wake_tick) >= 0;
+    }
+    void await_suspend (CoTask::Handle handle)
+    {
+        handle.promise ().wake_tick = wake_tick;
+        handle.promise ().forever = false;
+        handle.promise ().p_wait = NULL;
+    }
+    void await_resume (void) { }
+};
+
+
+/** @brief   Put the coroutine to sleep for a number of RTOS ticks.
+ *  @details This is the coroutine version of @c vTaskDelay():
+ *           @code
+ *           co_await co_sleep (pdMS_TO_TICKS (100));
+ *           @endcode
+ *  @param   ticks The number of ticks to sleep
+ *  @returns An awaitable object for @c co_await
+ */
+inline CoSleep co_sleep (TickType_t ticks)
+{
+    return CoSleep { xTaskGetTickCount () + ticks };
+}
+
+
+/** @brief   Put the coroutine to sleep until a regular period has elapsed.
+ *  @details This is the coroutine version of @c vTaskDelayUntil(), used to
+ *           run code at a steady rate:
+ *           @code
+ *           TickType_t last_wake = xTaskGetTickCount ();
+ *           for (;;)
+ *           {
+ *               co_await co_sleep_until (last_wake, 10);   // Every 10 ticks
+ *               ...
+ *           }
+ *           @endcode
+ *  @param   last_wake A reference to the tick at which the previous period
+ *           began; it's updated to the tick at which this period ends
+ *  @param   period The period in RTOS ticks
+ *  @returns An awaitable object for @c co_await
+ */
+inline CoSleep co_sleep_until (TickType_t& last_wake, TickType_t period)
+{
+    last_wake += period;
+    return CoSleep { last_wake };
+}
+
+
+/** @brief   Awaitable which lets other coroutines run before this one goes on.
+ */
+struct CoYield
+{
+    bool await_ready (void)
+    {
+        return false;
+    }
+    void await_suspend (CoTask::Handle handle)
+    {
+        handle.promise ().wake_tick = xTaskGetTickCount ();
+        handle.promise ().forever = false;
+        handle.promise ().p_wait = NULL;
+    }
+    void await_resume (void) { }
+};
+
+
+/** @brief   Let the other coroutines in the scheduler run.
+ *  @details The calling coroutine resumes on the scheduler's next pass
+ *           through its list, without waiting for a tick.
+ *  @returns An awaitable object for @c co_await
+ */
+inline CoYield co_yield_now (void)
+{
+    return CoYield ();
+}
+
+
+/** @brief   Awaitable which waits for an item from a queue.
+ *  @details The item is taken from the queue without blocking. While the
+ *           queue is empty, the scheduler checks it once per tick.
+ */
+template <class DataType> struct CoQueueGet : public CoWait
+{
+    Queue<DataType>* p_queue;              ///< The queue being read
+    DataType* p_item;                      ///< Where to put the item
+    TickType_t timeout;                    ///< Ticks to wait at most
+    CoTask::promise_type* p_promise;       ///< The waiting coroutine
+
+    CoQueueGet (Queue<DataType>& queue, DataType& item, TickType_t ticks)
+        : p_queue (&queue), p_item (&item), timeout (ticks),
+          p_promise (NULL) { }
+
+    bool poll (void)
+    {
+        return xQueueReceive (p_queue->get_handle (), p_item, 0) == pdTRUE;
+    }
+    bool await_ready (void)
+    {
+        return poll ();
+    }
+    void await_suspend (CoTask::Handle handle)
+    {
+        p_promise = &handle.promise ();
+        p_promise->p_wait = this;
+        p_promise->timed_out = false;
+        p_promise->forever = (timeout == portMAX_DELAY);
+        p_promise->wake_tick = xTaskGetTickCount () + timeout;
+    }
+    bool await_resume (void)
+    {
+        return (p_promise == NULL || !p_promise->timed_out);
+    }
+};
+
+
+/** @brief   Wait for an item from a queue and take it.
+ *  @details This is the coroutine version of @c Queue::get():
+ *           @code
+ *           int16_t command;
+ *           if (co_await co_get (command_queue, command, 100))
+ *           {
+ *               ...                                   // Got a command
+ *           }
+ *           @endcode
+ *  @param   queue The queue from which to get an item
+ *  @param   item A reference to a variable in which to put the item
+ *  @param   ticks The maximum number of ticks to wait (default
+ *           @c portMAX_DELAY, which means forever)
+ *  @returns An awaitable object for @c co_await which gives @c true if an
+ *           item was received or @c false if the wait timed out
+ */
+template <class DataType>
+inline CoQueueGet<DataType> co_get (Queue<DataType>& queue, DataType& item,
+                                    TickType_t ticks = portMAX_DELAY)
+{
+    return CoQueueGet<DataType> (queue, item, ticks);
+}
+
+
+/** @brief   Awaitable which waits until a share has been written.
+ */
+template <class DataType> struct CoShareUpdate : public CoWait
+{
+    Share<DataType>* p_share;              ///< The share being watched
+    uint32_t last_count;                   ///< Update count when we began
+
+    CoShareUpdate (Share<DataType>& share)
+        : p_share (&share), last_count (share.get_update_count ()) { }
+
+    bool poll (void)
+    {
+        return p_share->get_update_count () != last_count;
+    }
+    bool await_ready (void)
+    {
+        return false;
+    }
+    void await_suspend (CoTask::Handle handle)
+    {
+        handle.promise ().p_wait = this;
+        handle.promise ().timed_out = false;
+        handle.promise ().forever = true;
+    }
+    DataType await_resume (void)
+    {
+        return p_share->get ();
+    }
+};
+
+
+/** @brief   Wait until new data has been put into a share.
+ *  @details The coroutine resumes after the next time any task or ISR puts
+ *           data into the share, even if the data is the same as before:
+ *           @code
+ *           float setpoint = co_await co_wait_update (setpoint_share);
+ *           @endcode
+ *  @param   share The share to be watched
+ *  @returns An awaitable object for @c co_await which gives the share's new
+ *           value
+ */
+template <class DataType>
+inline CoShareUpdate<DataType> co_wait_update (Share<DataType>& share)
+{
+    return CoShareUpdate<DataType> (share);
+}
+
+#endif // __cpp_impl_coroutine
+
+#endif // _TASKCORO_H_
@@ -11,6 +11,8 @@
  *  @date 2020-Nov-18 JRR Added @c << and @c >> operators for ESP32 and STM32
  *  @date 2021-Sep-19 JRR Added overloads of @c get(), @c ISR_get(), @c peek(), 
  *                        and @c ISR_peek() which return copies
+ *  @date 2026-Oct-17 Added methods which read and write items of any type
+ *  @date 2026-Oct-17 Listeners are told about each item put in
  *
  *  License:
  *    This file is copyright 2012-2020 by JR Ridgely and released under the 
@@ -168,7 +170,13 @@ public:
      */
     bool butt_in (const dataType item)
     {
-        return ((bool)(xQueueSendToFront (handle, &item, ticks_to_wait)));
+        bool return_value = (bool)(xQueueSendToFront (handle, &item,
+                                                      ticks_to_wait));
+        if (return_value)
+        {
+            notify_put (&item);
+        }
+        return return_value;
     }
 
     // This method puts an item into the front of the queue from within 
@@ -431,9 +439,7 @@ public:
 
     /** @brief   Print the queue's status to a serial device.
      *  @details This method makes a printout of the queue's status on 
-     *           the given serial device, then calls this same method 
-     *           for the next item of thread-safe data in the linked list
-     *           of items. 
+     *           the given serial device. 
      *  @param   print_dev Reference to the serial device on which to print
      */
     void print_in_list (Print& print_dev);
@@ -461,6 +467,62 @@ public:
     {
         return handle;
     }
+
+    /** @brief   Return the type of the items in this queue.
+     *  @returns A @c ShareValueType code, which is @c SHARE_NONE if the
+     *           items aren't plain numbers
+     */
+    uint8_t get_value_type (void)
+    {
+        return ShareType<dataType>::code;
+    }
+
+    /// Tell code which samples shares that this is a queue
+    bool is_queue (void)
+    {
+        return true;
+    }
+
+    /** @brief   Copy the item at the head of the queue without removing it.
+     *  @param   p_value Pointer to a buffer big enough for a @c dataType
+     *  @returns @c true if an item was copied, @c false if the queue is
+     *           empty or its items aren't plain numbers
+     */
+    bool peek_value (void* p_value)
+    {
+        if (ShareType<dataType>::code == SHARE_NONE)
+        {
+            return false;
+        }
+        return xQueuePeek (handle, p_value, 0) == pdTRUE;
+    }
+
+    /** @brief   Put an item into the back of the queue without waiting.
+     *  @param   p_value Pointer to a @c dataType item
+     *  @returns @c true if the item was queued, @c false if the queue is
+     *           full or its items aren't plain numbers
+     */
+    bool put_value (const void* p_value)
+    {
+        if (ShareType<dataType>::code == SHARE_NONE
+            || xQueueSendToBack (handle, p_value, 0) != pdTRUE)
+        {
+            return false;
+        }
+        uint16_t fillage = uxQueueMessagesWaiting (handle);
+        if (fillage > max_full)
+        {
+            max_full = fillage;
+        }
+        notify_put (p_value);
+        return true;
+    }
+
+    /// Forget the most items which have been in the queue at once
+    void reset_stats (void)
+    {
+        max_full = 0;
+    }
 }; // class Queue 
 
 
@@ -515,6 +577,12 @@ inline bool Queue<dataType>::put (const dataType item)
         max_full = fillage;
     }
 
+    // Tell any listeners, such as recorders, about the new item
+    if (return_value)
+    {
+        notify_put (&item);
+    }
+
     return (return_value);
 }
 
@@ -545,6 +613,10 @@ inline bool Queue<dataType>::ISR_put (const dataType item)
     {
         max_full = fillage;
     }
+    if (return_value)
+    {
+        notify_put (&item);
+    }
 
     // Return the return value saved from the call to xQueueSendToBackFromISR()
     return (return_value);
@@ -569,6 +641,10 @@ inline bool Queue<dataType>::ISR_butt_in (const dataType item)
     // Call the FreeRTOS function and save its return value
     return_value = (bool)(xQueueSendToFrontFromISR (handle, &item, 
                                                     &shouldSwitch));
+    if (return_value)
+    {
+        notify_put (&item);
+    }
 
     // Return the return value saved from the call to xQueueSendToBackFromISR()
     return (return_value);
@@ -577,8 +653,8 @@ inline bool Queue<dataType>::ISR_butt_in (const dataType item)
 
 /** @brief   Print the queue's status to a serial device.
  *  @details This method makes a printout of the queue's status on the given
- *           serial device, then calls this same method for the next item of 
- *           thread-safe data in the linked list of items. 
+ *           serial device. It's called by @c print_all_shares() for each 
+ *           queue in the system's list of shared data items. 
  *  @param   print_dev Reference to the serial device on which to print
  */
 template <class dataType>
@@ -597,12 +673,6 @@ void Queue<dataType>::print_in_list (Print& print_dev)
     {
         print_dev << "UNUSABLE" << endl;
     }
-
-    // Call the next item
-    if (p_next != NULL)
-    {
-        p_next->print_in_list (print_dev);
-    }
 }
 
 #endif  // _TASKQUEUE_H_
@@ -0,0 +1,549 @@
+//*****************************************************************************
+/** @file    taskrpc.h
+ *  @brief   Request and reply calls from client tasks to a server task, with
+ *           futures that hold the replies.
+ *  @details This file contains template classes which let tasks make remote
+ *           procedure calls to a server task. A client sends a request and
+ *           gets back a @c Future which will hold the server's reply; it can
+ *           wait for the reply right away, do other work first, or give up
+ *           after a timeout. Requests travel to the server through one queue,
+ *           and each reply goes back through one of a fixed set of reply
+ *           slots which are allocated when the endpoint is created, so no
+ *           memory is allocated for each call and the reply always goes to
+ *           the task which asked for it. This replaces the practice of making
+ *           a reply @c Queue for each client, which is never freed and which
+ *           can't tell a late reply to an old request from the reply to a new
+ *           one.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TASKRPC_H_
+#define _TASKRPC_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+/** @brief   States of a reply slot.
+ */
+enum RpcSlotState
+{
+    RPC_FREE,           ///< The slot isn't being used by any call
+    RPC_PENDING,        ///< A request has been sent; no reply has come yet
+    RPC_DONE,           ///< The reply is in the slot, waiting to be read
+    RPC_ABANDONED       ///< The client gave up; the server will free the slot
+};
+
+
+/** @brief   A place where the server puts the reply to one call.
+ *  @details Reply slots belong to an @c RpcEndpoint and are reused, one call
+ *           after another. Application code doesn't use them directly.
+ */
+template <class ReplyType> struct RpcSlot
+{
+    ReplyType reply;                      ///< The server's reply
+    std::atomic<uint8_t> state;           ///< An @c RpcSlotState
+    SemaphoreHandle_t done;               ///< Given when the reply is ready
+    uint32_t start_us;                    ///< Time at which the call began
+    std::atomic<uint32_t>* p_abandoned;   ///< Endpoint's count of give-ups
+};
+
+
+/** @brief   A request as it's sent through the queue to the server.
+ *  @details The server task receives one of these from
+ *           @c RpcEndpoint::receive(), reads the @c request member, and
+ *           passes the whole thing back to @c RpcEndpoint::reply() so that
+ *           the reply goes into the right slot.
+ */
+template <class RequestType> struct RpcRequest
+{
+    RequestType request;                  ///< The client's request
+    uint16_t slot;                        ///< Index of the reply slot
+};
+
+
+/** @brief   Holds the reply to a call which may not have been answered yet.
+ *  @details A future is returned by @c RpcEndpoint::call(). The client uses
+ *           @c get() to wait for the reply and take it. A future can't be
+ *           copied, as only one task may take each reply, but it can be moved
+ *           (for example, returned from a function). If a future is
+ *           destroyed or @c cancel() is called before the reply has been
+ *           taken, the call is abandoned: the reply slot is freed when the
+ *           server answers, and the reply is thrown away.
+ */
+template <class ReplyType> class Future
+{
+protected:
+    RpcSlot<ReplyType>* p_slot;           ///< Slot for reply, or NULL
+
+public:
+    /** @brief   Create a future which holds the reply from a reply slot.
+     *  @param   p_a_slot A pointer to the reply slot, or @c NULL if the call
+     *           couldn't be made
+     */
+    explicit Future (RpcSlot<ReplyType>* p_a_slot = NULL) : p_slot (p_a_slot)
+    {
+    }
+
+    /// Take over the call from another future
+    Future (Future&& other) : p_slot (other.p_slot)
+    {
+        other.p_slot = NULL;
+    }
+
+    /// Abandon this future's call, if any, and take over another's
+    Future& operator = (Future&& other)
+    {
+        if (this != &other)
+        {
+            cancel ();
+            p_slot = other.p_slot;
+            other.p_slot = NULL;
+        }
+        return *this;
+    }
+
+    Future (const Future&) = delete;
+    Future& operator = (const Future&) = delete;
+
+    /// Abandon the call if the reply hasn't been taken
+    ~Future (void)
+    {
+        cancel ();
+    }
+
+    /** @brief   Indicates whether this future belongs to a call.
+     *  @returns @c true if a request was sent and the reply hasn't been taken
+     *           yet, @c false if the call failed or the reply has been taken
+     */
+    bool valid (void)
+    {
+        return p_slot != NULL;
+    }
+
+    /** @brief   Check whether the reply has arrived, without waiting.
+     *  @returns @c true if @c get() will return the reply immediately
+     */
+    bool ready (void)
+    {
+        return p_slot != NULL
+            && p_slot->state.load (std::memory_order_acquire) == RPC_DONE;
+    }
+
+    /** @brief   Wait for the reply and take it.
+     *  @details If the reply doesn't arrive in time, the call is still
+     *           pending, so @c get() can be called again later. Once the reply
+     *           has been taken, the future is no longer valid.
+     *  @param   reply A reference to the variable into which the reply is put
+     *  @param   wait_time The longest time to wait, in RTOS ticks (default
+     *           @c portMAX_DELAY, which means forever)
+     *  @returns @c true if the reply was received, @c false if it didn't
+     *           arrive in time or this future doesn't belong to a call
+     */
+    bool get (ReplyType& reply, TickType_t wait_time = portMAX_DELAY)
+    {
+        if (p_slot == NULL || xSemaphoreTake (p_slot->done, wait_time) != pdTRUE)
+        {
+            return false;
+        }
+        reply = p_slot->reply;
+        p_slot->state.store (RPC_FREE, std::memory_order_release);
+        p_slot = NULL;
+        return true;
+    }
+
+    /** @brief   Give up on the call.
+     *  @details If the reply has arrived, it's thrown away and the slot is
+     *           freed now; if not, the server frees the slot when it replies.
+     *           Calls which are given up are counted by the endpoint. If the
+     *           server is just then sending the reply, this method waits the
+     *           moment it takes to finish.
+     */
+    void cancel (void)
+    {
+        if (p_slot == NULL)
+        {
+            return;
+        }
+        uint8_t expected = RPC_PENDING;
+        if (p_slot->state.compare_exchange_strong (expected, RPC_ABANDONED))
+        {
+            (*(p_slot->p_abandoned))++;
+        }
+        else
+        {
+            // The reply came after all; remove its signal and free the slot.
+            // The server marks the slot done just before it gives the signal,
+            // so wait for the signal: if it came after the slot was freed, it
+            // would wake the next call in this slot with this reply
+            xSemaphoreTake (p_slot->done, portMAX_DELAY);
+            p_slot->state.store (RPC_FREE, std::memory_order_release);
+        }
+        p_slot = NULL;
+    }
+};
+
+
+/** @brief   Implements a server endpoint to which client tasks make calls.
+ *  @details An endpoint has a queue of requests and a fixed number of reply
+ *           slots. Each call takes a free slot, sends the request with the
+ *           slot's number through the queue, and returns a @c Future which
+ *           waits on that slot. The server task receives requests, works out
+ *           the replies, and sends each reply to its slot, which wakes the
+ *           client waiting there. The number of slots limits how many calls
+ *           may be waiting for replies at one time; a call which finds no
+ *           free slot, or finds the request queue full, fails at once and
+ *           returns a future which isn't valid.
+ *
+ *           Every request which the server receives must be replied to, even
+ *           if its client has given up; otherwise its slot is never freed.
+ *
+ *           The endpoint keeps statistics on the time from each call until
+ *           its reply is sent, in microseconds, and counts calls which failed
+ *           and calls which the client gave up on before they were answered.
+ *           These are shown by @c print_all_shares(). The statistics are kept
+ *           by the server task, so there should be just one server task for
+ *           each endpoint. 
+ *
+ *           @section rpc_usage Usage
+ *           The endpoint is created near the top of the file containing
+ *           @c setup(), with the request queue size, the number of reply slots
+ *           and a name:
+ *           @code
+ *           #include "taskrpc.h"
+ *           ...
+ *           /// Calls to the arm task which ask it to move to a position
+ *           RpcEndpoint<ArmPosition, bool> arm_calls (4, 4, "Arm RPC");
+ *           @endcode
+ *           The server task gets each request, acts on it, and replies:
+ *           @code
+ *           RpcRequest<ArmPosition> call;
+ *           for (;;)
+ *           {
+ *               arm_calls.receive (call);
+ *               bool reached = move_arm_to (call.request);
+ *               arm_calls.reply (call, reached);
+ *           }
+ *           @endcode
+ *           A client which only needs the reply can call and wait at once:
+ *           @code
+ *           bool reached;
+ *           if (arm_calls.call (home_position, reached, 500)) ...
+ *           @endcode
+ *           A client which has other work to do keeps the future for later:
+ *           @code
+ *           Future<bool> arm_done = arm_calls.call (home_position);
+ *           ...                                    // Do other things
+ *           if (arm_done.get (reached, 100)) ...
+ *           @endcode
+ */
+template <class RequestType, class ReplyType> class RpcEndpoint
+    : public BaseShare
+{
+protected:
+    QueueHandle_t queue;                  ///< Queue of requests for server
+    RpcSlot<ReplyType>* p_slots;          ///< Array of reply slots
+    uint16_t n_slots;                     ///< Number of reply slots
+    std::atomic<uint16_t> next_slot;      ///< Where to look for a free slot
+    TickType_t ticks_to_wait;             ///< How long to wait for queue space
+    uint32_t replies;                     ///< Number of replies sent
+    uint64_t total_us;                    ///< Sum of call times, for average
+    uint32_t max_us;                      ///< Longest call time seen
+    std::atomic<uint32_t> failures;       ///< Calls which couldn't be made
+    std::atomic<uint32_t> abandoned;      ///< Calls given up by clients
+
+    /// Tag which identifies endpoints with these types; see
+    /// @c BaseShare::get_class_tag()
+    static const char class_tag;
+
+public:
+    // Create an endpoint with a request queue and a set of reply slots
+    RpcEndpoint (uint16_t queue_size, uint16_t slots,
+                 const char* p_name = NULL,
+                 TickType_t wait_time = 0);
+
+    // Send a request to the server and return a future for its reply
+    Future<ReplyType> call (const RequestType& request);
+
+    /** @brief   Send a request to the server and wait for its reply.
+     *  @details If the reply doesn't arrive within the given time, the call
+     *           is given up, and the server's reply will be thrown away.
+     *  @param   request The request to send
+     *  @param   reply A reference to the variable into which the reply is put
+     *  @param   wait_time The longest time to wait, in RTOS ticks (default
+     *           @c portMAX_DELAY, which means forever)
+     *  @returns @c true if a reply was received, @c false if not
+     */
+    bool call (const RequestType& request, ReplyType& reply,
+               TickType_t wait_time = portMAX_DELAY)
+    {
+        Future<ReplyType> result = call (request);
+        return result.get (reply, wait_time);
+    }
+
+    /** @brief   Get the next request, waiting for one if necessary.
+     *  @details This method is called by the server task.
+     *  @param   call A reference to the variable into which the request is
+     *           put; it must be passed back to @c reply() later
+     *  @param   wait_time The longest time to wait, in RTOS ticks (default
+     *           @c portMAX_DELAY, which means forever)
+     *  @returns @c true if a request was received, @c false if none came
+     */
+    bool receive (RpcRequest<RequestType>& call,
+                  TickType_t wait_time = portMAX_DELAY)
+    {
+        return xQueueReceive (queue, &call, wait_time) == pdTRUE;
+    }
+
+    // Send the reply to a request back to the client which made it
+    void reply (const RpcRequest<RequestType>& call, const ReplyType& reply);
+
+    /** @brief   Indicates whether this endpoint is usable.
+     *  @details This method returns @c true if memory for the queue, the
+     *           reply slots and their semaphores was successfully allocated.
+     *  @returns @c true if this endpoint is usable, @c false if not
+     */
+    bool usable (void)
+    {
+        return (queue != NULL && p_slots != NULL);
+    }
+
+    /** @brief   Return the average time taken to answer calls.
+     *  @returns The average time from each call to its reply, in
+     *           microseconds, or 0 if no calls have been answered
+     */
+    uint32_t get_average_us (void)
+    {
+        return replies ? (uint32_t)(total_us / replies) : 0;
+    }
+
+    /** @brief   Return the longest time taken to answer a call.
+     *  @returns The longest time from a call to its reply, in microseconds
+     */
+    uint32_t get_max_us (void)
+    {
+        return max_us;
+    }
+
+    /** @brief   Return the tag which identifies endpoints of these types.
+     *  @returns A pointer which is unique to this @c RpcEndpoint type
+     */
+    const void* get_class_tag (void)
+    {
+        return &class_tag;
+    }
+
+    /** @brief   Find an endpoint with these request and reply types by name.
+     *  @param   p_name The name given to the endpoint's constructor
+     *  @returns A pointer to the endpoint, or @c NULL if there is no endpoint
+     *           with that name and these types
+     */
+    static RpcEndpoint<RequestType, ReplyType>* find (const char* p_name)
+    {
+        return (RpcEndpoint<RequestType, ReplyType>*)BaseShare::find
+            (p_name, &class_tag);
+    }
+
+    // Print the endpoint's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+}; // class RpcEndpoint
+
+
+template <class RequestType, class ReplyType>
+const char RpcEndpoint<RequestType, ReplyType>::class_tag = 0;
+
+
+/** @brief   Create an RPC endpoint.
+ *  @details This constructor allocates the request queue and the reply slots
+ *           with their semaphores. All memory used by the endpoint is
+ *           allocated here, so none is needed when calls are made. 
+ *  @param   queue_size The number of requests which may wait in the queue
+ *           for the server
+ *  @param   slots The number of calls which may be waiting for replies at
+ *           the same time
+ *  @param   p_name A name for the endpoint, shown by @c print_all_shares()
+ *  @param   wait_time How long a client may wait for space in a full request
+ *           queue, in RTOS ticks (default 0, meaning don't wait)
+ */
+template <class RequestType, class ReplyType>
+RpcEndpoint<RequestType, ReplyType>::RpcEndpoint (uint16_t queue_size,
+                                                  uint16_t slots,
+                                                  const char* p_name,
+                                                  TickType_t wait_time)
+    : BaseShare (p_name)
+{
+    queue = xQueueCreate (queue_size, sizeof (RpcRequest<RequestType>));
+    n_slots = slots;
+    next_slot = 0;
+    ticks_to_wait = wait_time;
+    replies = 0;
+    total_us = 0;
+    max_us = 0;
+    failures = 0;
+    abandoned = 0;
+
+    p_slots = new RpcSlot<ReplyType>[slots];
+    if (p_slots != NULL)
+    {
+        for (uint16_t index = 0; index < slots; index++)
+        {
+            p_slots[index].state = RPC_FREE;
+            p_slots[index].p_abandoned = &abandoned;
+            p_slots[index].done = xSemaphoreCreateBinary ();
+            if (p_slots[index].done == NULL)
+            {
+                // Give back what was made so far; the endpoint is unusable
+                for (uint16_t made = 0; made < index; made++)
+                {
+                    vSemaphoreDelete (p_slots[made].done);
+                }
+                delete[] p_slots;
+                p_slots = NULL;
+                break;
+            }
+        }
+    }
+
+    // With no slots, call() and reply() won't look for any
+    if (p_slots == NULL)
+    {
+        n_slots = 0;
+    }
+}
+
+
+/** @brief   Send a request to the server and return a future for the reply.
+ *  @details This method takes a free reply slot and puts the request into
+ *           the server's queue. It doesn't wait for the reply; the caller
+ *           uses the future which is returned to get the reply later. If
+ *           there's no free slot, or if the queue is still full after the
+ *           wait time given to the constructor, the call fails.
+ *  @param   request The request to send
+ *  @returns A future which will hold the reply, or which isn't valid if the
+ *           call failed
+ */
+template <class RequestType, class ReplyType>
+Future<ReplyType> RpcEndpoint<RequestType, ReplyType>::call
+    (const RequestType& request)
+{
+    if (!usable ())
+    {
+        failures++;
+        return Future<ReplyType> ();
+    }
+
+    // Look for a free slot, starting after the one most recently taken
+    uint16_t start = next_slot.load (std::memory_order_relaxed);
+    for (uint16_t count = 0; count < n_slots; count++)
+    {
+        uint16_t index = (start + count) % n_slots;
+        uint8_t expected = RPC_FREE;
+        if (p_slots[index].state.compare_exchange_strong (expected,
+                                                          RPC_PENDING))
+        {
+            next_slot.store ((index + 1) % n_slots, std::memory_order_relaxed);
+
+            RpcRequest<RequestType> message;
+            message.request = request;
+            message.slot = index;
+            p_slots[index].start_us = micros ();
+            if (xQueueSendToBack (queue, &message, ticks_to_wait) != pdTRUE)
+            {
+                p_slots[index].state.store (RPC_FREE,
+                                            std::memory_order_release);
+                break;
+            }
+            return Future<ReplyType> (&p_slots[index]);
+        }
+    }
+    failures++;
+    return Future<ReplyType> ();
+}
+
+
+/** @brief   Send the reply to a request back to the client.
+ *  @details This method is called by the server task once for each request
+ *           it has received. The reply is put into the request's slot and
+ *           the client is woken up. If the client has given up on the call,
+ *           the reply is thrown away and the slot is freed for another call.
+ *  @param   call The request, as it was received from @c receive()
+ *  @param   reply The reply to be sent to the client
+ */
+template <class RequestType, class ReplyType>
+void RpcEndpoint<RequestType, ReplyType>::reply
+    (const RpcRequest<RequestType>& call, const ReplyType& reply)
+{
+    if (call.slot >= n_slots)
+    {
+        return;
+    }
+    RpcSlot<ReplyType>& slot = p_slots[call.slot];
+
+    uint32_t elapsed = micros () - slot.start_us;
+    replies++;
+    total_us += elapsed;
+    if (elapsed > max_us)
+    {
+        max_us = elapsed;
+    }
+
+    slot.reply = reply;
+    uint8_t expected = RPC_PENDING;
+    if (slot.state.compare_exchange_strong (expected, RPC_DONE))
+    {
+        xSemaphoreGive (slot.done);
+    }
+    else
+    {
+        slot.state.store (RPC_FREE, std::memory_order_release);
+    }
+}
+
+
+/** @brief   Print the endpoint's status within a list of shares.
+ *  @details This method prints a line showing the endpoint's name, the number
+ *           of calls answered, the average and longest times to answer them
+ *           in microseconds, the number of calls which clients gave up on, and
+ *           the number of calls which couldn't be made.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class RequestType, class ReplyType>
+void RpcEndpoint<RequestType, ReplyType>::print_in_list (Print& printer)
+{
+    // Print this endpoint's name and pad it to 16 characters
+    printer.printf ("%-16srpc\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << replies << " calls, " << get_average_us () << '/' << max_us
+            << " us, " << abandoned.load () << " late, " << failures.load ()
+            << " failed" << endl;
+}
+
+#endif // _TASKRPC_H_
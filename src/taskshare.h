@@ -21,6 +21,11 @@
  *  @date 2020-Nov-18 JRR Critical sections not reliable; changed to a queue
  *  @date 2021-Sep-17 JRR Changed some @c put params from references to copies
  *  @date 2021-Sep-19 JRR Added overloads for @c get() which return values
+ *  @date 2026-Oct-17 Added a count of updates for tasks waiting on new data
+ *  @date 2026-Oct-17 Added @c get_value_type() and @c peek_value()
+ *  @date 2026-Oct-17 Listeners are told about each put
+ *  @date 2026-Oct-17 Added @c put_value() and @c reset_stats()
+ *  @date 2026-Oct-17 Made the count of updates atomic
  *
  *  @copyright This file is copyright 2014 -- 2021 by JR Ridgely and released 
  *    under the Lesser GNU Public License, version 2. It intended for 
@@ -41,6 +46,7 @@
 #ifndef _TASKSHARE_H_
 #define _TASKSHARE_H_
 
+#include <atomic>
 #include "baseshare.h"                      // Base class for shared data items
 #if (defined STM32F4xx || defined STM32L4xx)
     #include "FreeRTOS.h"                       // Main header for FreeRTOS
@@ -125,6 +131,10 @@ protected:
     /// A queue is used to hold the data, as it's portable to different CPU's
     QueueHandle_t queue;
 
+    /// Counts the number of times data has been put into the share. It's
+    /// atomic so that puts from several tasks and ISR's are all counted
+    std::atomic<uint32_t> updates;
+
 public:
     /** @brief   Construct a shared data item.
      *  @details This constructor for a shared data item creates a queue in 
@@ -133,7 +143,7 @@ public:
      *  @param   p_name A name to be shown in the list of task shares 
      *           (default @c NULL)
      */
-    Share<DataType> (const char* p_name = NULL) : BaseShare (p_name)
+    Share (const char* p_name = NULL) : BaseShare (p_name), updates (0)
     {
         queue = xQueueCreate (1, sizeof (DataType));
     }
@@ -145,6 +155,8 @@ public:
     void put (DataType new_data)
     {
         xQueueOverwrite (queue, &new_data);
+        updates.fetch_add (1, std::memory_order_release);
+        notify_put (&new_data);
     }
 
     /** @brief   Put data into the shared data item from within an ISR.
@@ -157,6 +169,8 @@ public:
     {
         BaseType_t wake_up;
         xQueueOverwriteFromISR (queue, &new_data, &wake_up);
+        updates.fetch_add (1, std::memory_order_release);
+        notify_put (&new_data);
     }
 
     /** @brief   Operator which inserts data into the share.
@@ -179,6 +193,8 @@ public:
         {
             xQueueOverwrite (queue, &new_data);
         }
+        updates.fetch_add (1, std::memory_order_release);
+        notify_put (&new_data);
     }
 
     /** @brief   Read data from the shared data item.
@@ -267,6 +283,65 @@ public:
         return return_this;
     }
 
+    /** @brief   Return the number of times data has been put into the share.
+     *  @details A task which wants to know whether the share has been 
+     *           updated, even with the same value as before, can compare this
+     *           count with the count it saw the last time it looked. The count
+     *           wraps around after 2<sup>32</sup> updates.
+     *  @returns The number of times @c put(), @c ISR_put() or @c << has been
+     *           used to put data into the share
+     */
+    uint32_t get_update_count (void)
+    {
+        return updates.load (std::memory_order_acquire);
+    }
+
+    /** @brief   Return the type of value this share holds.
+     *  @returns A @c ShareValueType code, which is @c SHARE_NONE if the
+     *           share's data isn't a plain number
+     */
+    uint8_t get_value_type (void)
+    {
+        return ShareType<DataType>::code;
+    }
+
+    /** @brief   Copy the share's current value without waiting.
+     *  @param   p_value Pointer to a buffer big enough for a @c DataType
+     *  @returns @c true if a value was copied, @c false if no data has been
+     *           put into the share yet or its type isn't a plain number
+     */
+    bool peek_value (void* p_value)
+    {
+        if (ShareType<DataType>::code == SHARE_NONE)
+        {
+            return false;
+        }
+        return xQueuePeek (queue, p_value, 0) == pdTRUE;
+    }
+
+    /** @brief   Put a value into the share.
+     *  @param   p_value Pointer to a @c DataType value
+     *  @returns @c true if the value was put in, @c false if the share's
+     *           type isn't a plain number
+     */
+    bool put_value (const void* p_value)
+    {
+        if (ShareType<DataType>::code == SHARE_NONE)
+        {
+            return false;
+        }
+        DataType value;
+        memcpy (&value, p_value, sizeof (DataType));
+        put (value);
+        return true;
+    }
+
+    /// Set the count of times data has been put into the share to zero
+    void reset_stats (void)
+    {
+        updates.store (0, std::memory_order_relaxed);
+    }
+
     // Print the share's status within a list of all shares' statuses
     void print_in_list (Print& printer);
 
@@ -276,9 +351,7 @@ public:
 /** @brief   Print the name and type (share) of this data item.
  *  @details This method prints the share's name and a word indicating that it
  *           is a shared data item, as opposed to a queue, formatted to match
- *           similar printouts from other task shares such as queues. After
- *           printing this share's information, it looks in the linked list of
- *           shares for the next one and asks it to print its information too.
+ *           similar printouts from other task shares such as queues. 
  *  @param   printer Reference to a serial device on which to print the status
  */
 template <class DataType>
@@ -287,14 +360,8 @@ void Share<DataType>::print_in_list (Print& printer)
     // Print this task's name and pad it to 16 characters
     printer.printf ("%-16sshare\t", name);
 
-    // End the line
-    printer << endl;
-
-    // Call the next item
-    if (p_next != NULL)
-    {
-        p_next->print_in_list (printer);
-    }
+    // Show how many times data has been put in, then end the line
+    printer << updates.load (std::memory_order_relaxed) << " puts" << endl;
 }
 
 #endif  // _TASKSHARE_H_
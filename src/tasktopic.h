@@ -0,0 +1,756 @@
+//*****************************************************************************
+/** @file    tasktopic.h
+ *  @brief   A publish/subscribe topic which delivers every message from one
+ *           publishing task to any number of subscribing tasks.
+ *  @details This file contains template classes for a topic, which is a ring
+ *           buffer into which one task publishes messages, and for the
+ *           subscribers which read those messages. Each message is copied
+ *           into the topic's buffer once, no matter how many subscribers
+ *           there are; each subscriber keeps its own read cursor into the
+ *           buffer, in the style of the LMAX Disruptor. This replaces the
+ *           practice of making one @c Queue for each receiving task and
+ *           putting every item into all of those queues.
+ *
+ *  @date 2026-Oct-17 Original file
+ *  @date 2026-Oct-17 Buffer sizes are powers of two, so slots survive a wrap
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TASKTOPIC_H_
+#define _TASKTOPIC_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <atomic>
+#include "baseshare.h"
+
+
+/** @brief   What a topic does when a subscriber falls a whole buffer behind.
+ */
+enum TopicPolicy
+{
+    TOPIC_BLOCK,        ///< The publisher waits for the slowest subscriber
+    TOPIC_DROP,         ///< The new message is thrown away
+    TOPIC_OVERWRITE     ///< The oldest message is overwritten and any slow
+                        ///< subscriber skips ahead, losing messages
+};
+
+
+template <class DataType> class Subscriber;
+
+
+/** @brief   Implements a topic into which one task publishes messages that
+ *           are read by any number of subscribing tasks.
+ *  @details A topic holds a ring buffer of messages. The publisher writes
+ *           each message into the buffer once and advances a sequence count;
+ *           each @c Subscriber has its own cursor which follows the sequence
+ *           count. Messages are therefore not copied once per receiver as
+ *           they would be if each receiving task had its own @c Queue, and
+ *           the publisher only makes a kernel call for each subscriber which
+ *           is actually blocked waiting for data.
+ *
+ *           When the slowest subscriber is a whole buffer behind, the topic
+ *           follows its @c TopicPolicy:
+ *           * @c TOPIC_BLOCK makes the publisher wait, up to the wait time
+ *             given to the constructor, until the slowest subscriber has read
+ *             a message; if it times out, the message is counted as lost
+ *           * @c TOPIC_DROP throws the new message away and counts it as lost
+ *           * @c TOPIC_OVERWRITE never makes the publisher wait; a subscriber
+ *             which has been lapped skips ahead to the oldest message still
+ *             in the buffer, and the messages it missed are counted as lost
+ *
+ *           The policy, the deepest backlog seen and the number of lost
+ *           messages are shown by @c print_all_shares().
+ *
+ *           Only one task (or one ISR) may publish to each topic. If several
+ *           tasks must publish, they should take turns using a @c Mutex.
+ *
+ *           @section topic_usage Usage
+ *           The topic is created near the top of the file containing
+ *           @c setup(), with a buffer size, a name and a policy:
+ *           @code
+ *           #include "tasktopic.h"
+ *           ...
+ *           /// Filtered wheel speeds for the controller, logger and display
+ *           Topic<float> speed_topic (16, "Speed", TOPIC_OVERWRITE);
+ *           @endcode
+ *           The publishing task calls @c publish() for each new message:
+ *           @code
+ *           speed_topic.publish (wheel_speed);
+ *           @endcode
+ *           Each receiving task makes its own subscriber, either from a
+ *           reference to the topic or from the topic's name, and reads
+ *           messages from the subscriber just as it would from a queue:
+ *           @code
+ *           Subscriber<float> speeds ("Speed");    // Inside the task function
+ *           float speed;
+ *           for (;;)
+ *           {
+ *               speeds.get (speed);                // Waits for a message
+ *               ...
+ *           }
+ *           @endcode
+ */
+template <class DataType> class Topic : public BaseShare
+{
+    friend class Subscriber<DataType>;
+
+protected:
+    DataType* p_buffer;                   ///< Ring buffer of messages
+    uint16_t buf_size;                    ///< Number of messages in buffer
+    uint16_t mask;                        ///< Buffer size minus one
+    TopicPolicy policy;                   ///< What to do when a buffer fills
+    TickType_t ticks_to_wait;             ///< How long publishers may wait
+    std::atomic<uint32_t> claimed;        ///< Messages begun being written
+    std::atomic<uint32_t> published;      ///< Messages completely written
+    std::atomic<Subscriber<DataType>*> p_first_sub;  ///< List of subscribers
+    std::atomic<bool> publisher_waiting;  ///< Publisher is blocked for space
+    SemaphoreHandle_t space_signal;       ///< Wakes a blocked publisher
+    std::atomic<uint32_t> lost_count;     ///< Messages dropped by publisher
+    uint16_t max_lag;                     ///< Deepest backlog seen so far
+
+    /// Tag which identifies topics holding this data type; see
+    /// @c BaseShare::get_class_tag()
+    static const char class_tag;
+
+    // Find how many messages the slowest subscriber has yet to read
+    uint32_t slowest_lag (uint32_t sequence);
+
+    // Write a message into the buffer and wake any waiting subscribers
+    void write_message (const DataType& item, bool in_ISR);
+
+public:
+    // Create a topic with a ring buffer of the given size
+    Topic (uint16_t size, const char* p_name = NULL,
+           TopicPolicy policy = TOPIC_OVERWRITE,
+           TickType_t wait_time = portMAX_DELAY);
+
+    // Publish a message to all subscribers
+    bool publish (const DataType& item);
+
+    // Publish a message from within an interrupt service routine
+    bool ISR_publish (const DataType& item);
+
+    /** @brief   Operator which publishes a message to the topic.
+     *  @details This operator checks whether it's running in an interrupt
+     *           service routine and calls @c ISR_publish() or @c publish()
+     *           as appropriate.
+     *  @param   item The message to be published
+     */
+    void operator << (const DataType& item)
+    {
+        if (CHECK_IF_IN_ISR ())
+        {
+            ISR_publish (item);
+        }
+        else
+        {
+            publish (item);
+        }
+    }
+
+    /** @brief   Return the number of messages published so far.
+     *  @details The count wraps around after 2<sup>32</sup> messages.
+     *  @returns The number of messages which have been published
+     */
+    uint32_t get_published_count (void)
+    {
+        return published.load (std::memory_order_acquire);
+    }
+
+    /** @brief   Indicates whether this topic is usable.
+     *  @details This method returns @c true if memory for the topic's buffer
+     *           and its semaphore were successfully allocated.
+     *  @returns @c true if this topic is usable, @c false if not
+     */
+    bool usable (void)
+    {
+        return (p_buffer != NULL && space_signal != NULL);
+    }
+
+    /** @brief   Return the tag which identifies topics of this data type.
+     *  @returns A pointer which is unique to @c Topic<DataType>
+     */
+    const void* get_class_tag (void)
+    {
+        return &class_tag;
+    }
+
+    /** @brief   Find a topic carrying this data type by its name.
+     *  @param   p_name The name given to the topic's constructor
+     *  @returns A pointer to the topic, or @c NULL if there is no topic with
+     *           that name which carries @c DataType messages
+     */
+    static Topic<DataType>* find (const char* p_name)
+    {
+        return (Topic<DataType>*)BaseShare::find (p_name, &class_tag);
+    }
+
+    // Print the topic's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+}; // class Topic
+
+
+/** @brief   Reads every message published to a @c Topic, at its own pace.
+ *  @details Each subscriber has its own read cursor into the topic's ring
+ *           buffer. Messages are read with methods that work like those of
+ *           @c Queue: @c get() removes the next message from this subscriber's
+ *           view of the topic, waiting for one to be published if necessary.
+ *           For large messages, @c look_at() and @c release() allow a message
+ *           to be used where it sits in the topic's buffer without being
+ *           copied at all; this is only safe for topics whose policy is
+ *           @c TOPIC_BLOCK or @c TOPIC_DROP, as with @c TOPIC_OVERWRITE the
+ *           publisher may write over the message while it's being used.
+ *
+ *           A subscriber only receives messages published after it was
+ *           created. Subscribers which find their topic by name must be
+ *           created after the topic, normally inside a task function; the
+ *           order in which global objects in different files are created
+ *           isn't predictable. Subscribers are expected to last as long as
+ *           the program runs, just as tasks do.
+ */
+template <class DataType> class Subscriber
+{
+    friend class Topic<DataType>;
+
+protected:
+    Topic<DataType>* p_topic;             ///< The topic being read
+    std::atomic<uint32_t> cursor;         ///< Sequence number of next message
+    std::atomic<bool> waiting;            ///< Subscriber is blocked for data
+    SemaphoreHandle_t data_signal;        ///< Wakes a blocked subscriber
+    TickType_t ticks_to_wait;             ///< How long to wait for messages
+    uint32_t lost;                        ///< Messages skipped when lapped
+    Subscriber<DataType>* p_next_sub;     ///< Next subscriber of the topic
+
+    // Attach this subscriber to its topic
+    void subscribe (void);
+
+    // Wait until a message is available at the cursor or time runs out
+    bool wait_for_message (void);
+
+public:
+    // Create a subscriber to the given topic
+    Subscriber (Topic<DataType>& topic, TickType_t wait_time = portMAX_DELAY);
+
+    // Create a subscriber to the topic with the given name
+    Subscriber (const char* p_topic_name,
+                TickType_t wait_time = portMAX_DELAY);
+
+    // Copy the next message into the given variable and move past it
+    bool get (DataType& recv_item);
+
+    /** @brief   Retrieve and return the next message.
+     *  @details If no message arrives within the wait time given to the
+     *           constructor, a default-constructed @c DataType is returned.
+     *  @returns A copy of the next message
+     */
+    DataType get (void)
+    {
+        DataType return_this = DataType ();
+        get (return_this);
+        return return_this;
+    }
+
+    /** @brief   Operator which gets the next message from the topic.
+     *  @param   put_here A reference to the variable in which to put the
+     *           message
+     */
+    void operator >> (DataType& put_here)
+    {
+        get (put_here);
+    }
+
+    // Return a pointer to the next message without copying or removing it
+    const DataType* look_at (void);
+
+    // Move past a message which was used in place with look_at()
+    void release (void);
+
+    /** @brief   Return the number of messages this subscriber hasn't read.
+     *  @returns The number of unread messages; when a subscriber to an
+     *           overwriting topic has been lapped, this may exceed the size
+     *           of the topic's buffer until the next message is read
+     */
+    uint32_t available (void)
+    {
+        if (p_topic == NULL)
+        {
+            return 0;
+        }
+        return p_topic->published.load (std::memory_order_acquire)
+               - cursor.load (std::memory_order_relaxed);
+    }
+
+    /** @brief   Return true if there are messages waiting to be read.
+     *  @return  @c true if there's something to read, @c false if not
+     */
+    bool any (void)
+    {
+        return (available () != 0);
+    }
+
+    /** @brief   Return the number of messages this subscriber has missed.
+     *  @details Messages are only missed when the topic's policy is
+     *           @c TOPIC_OVERWRITE and this subscriber falls so far behind
+     *           that the publisher writes over messages it hasn't read.
+     *  @returns The number of messages skipped over
+     */
+    uint32_t get_lost_count (void)
+    {
+        return lost;
+    }
+
+    /** @brief   Indicates whether this subscriber is usable.
+     *  @returns @c true if the topic was found and the subscriber's
+     *           semaphore could be created, @c false if not
+     */
+    bool usable (void)
+    {
+        return (p_topic != NULL && data_signal != NULL);
+    }
+}; // class Subscriber
+
+
+template <class DataType>
+const char Topic<DataType>::class_tag = 0;
+
+
+/** @brief   Create a topic, allocating memory for its ring buffer.
+ *  @param   size The number of messages which the ring buffer can hold. It's
+ *           rounded up to a power of two, at most 32768, so that each
+ *           message's slot stays in order when the sequence numbers wrap
+ *  @param   p_name A name for the topic, shown in the list of task shares
+ *           and used by subscribers to find the topic (default @c NULL)
+ *  @param   policy What to do when a subscriber is a whole buffer behind
+ *           (default @c TOPIC_OVERWRITE)
+ *  @param   wait_time How long, in RTOS ticks, the publisher may wait for
+ *           space in a @c TOPIC_BLOCK topic (default @c portMAX_DELAY, which
+ *           means forever)
+ */
+template <class DataType>
+Topic<DataType>::Topic (uint16_t size, const char* p_name,
+                        TopicPolicy policy, TickType_t wait_time)
+    : BaseShare (p_name), claimed (0), published (0), p_first_sub (NULL),
+      publisher_waiting (false), lost_count (0)
+{
+    buf_size = 1;
+    while (buf_size < size && buf_size < 0x8000)
+    {
+        buf_size <<= 1;
+    }
+    mask = buf_size - 1;
+    p_buffer = new DataType[buf_size];
+    this->policy = policy;
+    ticks_to_wait = wait_time;
+    space_signal = xSemaphoreCreateBinary ();
+    max_lag = 0;
+}
+
+
+/** @brief   Find how many messages the slowest subscriber has yet to read.
+ *  @param   sequence The sequence number of the next message to be published
+ *  @returns The largest number of unread messages of any subscriber
+ */
+template <class DataType>
+uint32_t Topic<DataType>::slowest_lag (uint32_t sequence)
+{
+    uint32_t worst = 0;
+    for (Subscriber<DataType>* p_sub
+             = p_first_sub.load (std::memory_order_acquire);
+         p_sub != NULL; p_sub = p_sub->p_next_sub)
+    {
+        uint32_t lag = sequence - p_sub->cursor.load (std::memory_order_acquire);
+        if (lag > worst)
+        {
+            worst = lag;
+        }
+    }
+    return worst;
+}
+
+
+/** @brief   Write a message into the ring buffer and wake up any subscribers
+ *           which are waiting for it.
+ *  @details The claimed count is advanced before the message is written and
+ *           the published count after, so a subscriber copying a message can
+ *           tell if the publisher started to write over it in the meantime.
+ *  @param   item The message to be written
+ *  @param   in_ISR @c true if this method is being called within an ISR
+ */
+template <class DataType>
+void Topic<DataType>::write_message (const DataType& item, bool in_ISR)
+{
+    uint32_t sequence = published.load (std::memory_order_relaxed);
+
+    claimed.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    p_buffer[sequence & mask] = item;
+    published.store (sequence + 1, std::memory_order_release);
+
+    // Only subscribers which are blocked waiting for data need a kernel call
+    for (Subscriber<DataType>* p_sub
+             = p_first_sub.load (std::memory_order_acquire);
+         p_sub != NULL; p_sub = p_sub->p_next_sub)
+    {
+        if (p_sub->waiting.exchange (false))
+        {
+            if (in_ISR)
+            {
+                BaseType_t wake_up;
+                xSemaphoreGiveFromISR (p_sub->data_signal, &wake_up);
+            }
+            else
+            {
+                xSemaphoreGive (p_sub->data_signal);
+            }
+        }
+    }
+
+    // Keep track of the deepest backlog any subscriber has had. BUG: This
+    // isn't exact for overwriting topics, whose subscribers may be lapped
+    uint32_t lag = slowest_lag (sequence + 1);
+    lag = (lag < buf_size) ? lag : buf_size;
+    if (lag > max_lag)
+    {
+        max_lag = lag;
+    }
+}
+
+
+/** @brief   Publish a message to all subscribers of this topic.
+ *  @details The message is copied into the topic's ring buffer once. If the
+ *           slowest subscriber is a whole buffer behind, what happens depends
+ *           on the topic's policy; see the documentation for @c Topic. This
+ *           method must @b not be used within an interrupt service routine.
+ *  @param   item The message to be published
+ *  @returns @c true if the message was published, @c false if it was dropped
+ *           or the wait for space in the buffer timed out
+ */
+template <class DataType>
+bool Topic<DataType>::publish (const DataType& item)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+
+    if (policy != TOPIC_OVERWRITE)
+    {
+        uint32_t sequence = published.load (std::memory_order_relaxed);
+        TickType_t start_tick = xTaskGetTickCount ();
+        while (slowest_lag (sequence) >= buf_size)
+        {
+            if (policy == TOPIC_DROP)
+            {
+                lost_count.fetch_add (1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Each wait is only for what's left of the time allowed, so that
+            // subscribers which read one message at a time can't make the
+            // publisher wait longer than that
+            TickType_t remaining = portMAX_DELAY;
+            if (ticks_to_wait != portMAX_DELAY)
+            {
+                TickType_t waited = xTaskGetTickCount () - start_tick;
+                remaining = (waited < ticks_to_wait) ? ticks_to_wait - waited
+                                                     : 0;
+            }
+
+            // Set the flag, then check again so that a subscriber which read
+            // a message in between can't be missed
+            publisher_waiting.store (true);
+            if (slowest_lag (sequence) >= buf_size
+                && xSemaphoreTake (space_signal, remaining) != pdTRUE)
+            {
+                publisher_waiting.store (false);
+                lost_count.fetch_add (1, std::memory_order_relaxed);
+                return false;
+            }
+            publisher_waiting.store (false);
+        }
+    }
+
+    write_message (item, false);
+    return true;
+}
+
+
+/** @brief   Publish a message from within an interrupt service routine.
+ *  @details An ISR can't wait, so if the topic's policy is @c TOPIC_BLOCK and
+ *           the slowest subscriber is a whole buffer behind, the message is
+ *           dropped just as it would be with @c TOPIC_DROP. This method must
+ *           @b only be used within an interrupt service routine.
+ *  @param   item The message to be published
+ *  @returns @c true if the message was published, @c false if it was dropped
+ */
+template <class DataType>
+bool Topic<DataType>::ISR_publish (const DataType& item)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+
+    if (policy != TOPIC_OVERWRITE
+        && slowest_lag (published.load (std::memory_order_relaxed))
+           >= buf_size)
+    {
+        lost_count.fetch_add (1, std::memory_order_relaxed);
+        return false;
+    }
+
+    write_message (item, true);
+    return true;
+}
+
+
+/** @brief   Print the topic's status within a list of all shares' statuses.
+ *  @details This method prints the topic's name, the deepest backlog seen
+ *           and the buffer size, the policy for slow subscribers, the number
+ *           of subscribers, and the number of messages lost, whether dropped
+ *           by the publisher or skipped by lapped subscribers.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class DataType>
+void Topic<DataType>::print_in_list (Print& printer)
+{
+    // Print this topic's name and pad it to 16 characters
+    printer.printf ("%-16stopic\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+
+    uint16_t n_subs = 0;
+    uint32_t lost = lost_count.load (std::memory_order_relaxed);
+    for (Subscriber<DataType>* p_sub
+             = p_first_sub.load (std::memory_order_acquire);
+         p_sub != NULL; p_sub = p_sub->p_next_sub)
+    {
+        n_subs++;
+        lost += p_sub->lost;
+    }
+
+    const char* policy_name = (policy == TOPIC_BLOCK) ? "block"
+                            : (policy == TOPIC_DROP) ? "drop" : "overwrite";
+    printer << max_lag << '/' << buf_size << ' ' << policy_name << ", "
+            << n_subs << " subs, " << lost << " lost" << endl;
+}
+
+
+/** @brief   Create a subscriber to the given topic.
+ *  @param   topic The topic whose messages this subscriber will read
+ *  @param   wait_time How long, in RTOS ticks, @c get() waits for a message
+ *           to be published (default @c portMAX_DELAY, which means forever)
+ */
+template <class DataType>
+Subscriber<DataType>::Subscriber (Topic<DataType>& topic, TickType_t wait_time)
+    : p_topic (&topic), cursor (0), waiting (false)
+{
+    ticks_to_wait = wait_time;
+    subscribe ();
+}
+
+
+/** @brief   Create a subscriber to the topic with the given name.
+ *  @details The topic is looked up in the system's list of shared data items.
+ *           If there's no topic carrying @c DataType with that name, the
+ *           subscriber is unusable and its @c usable() method returns
+ *           @c false.
+ *  @param   p_topic_name The name of the topic to which to subscribe
+ *  @param   wait_time How long, in RTOS ticks, @c get() waits for a message
+ *           to be published (default @c portMAX_DELAY, which means forever)
+ */
+template <class DataType>
+Subscriber<DataType>::Subscriber (const char* p_topic_name,
+                                  TickType_t wait_time)
+    : p_topic (Topic<DataType>::find (p_topic_name)), cursor (0),
+      waiting (false)
+{
+    ticks_to_wait = wait_time;
+    subscribe ();
+}
+
+
+/** @brief   Attach this subscriber to its topic's list of subscribers.
+ *  @details The subscriber starts reading at the next message to be
+ *           published. It's put at the front of the topic's list with a
+ *           compare-and-swap so that a subscriber can be added while the
+ *           publisher is running.
+ */
+template <class DataType>
+void Subscriber<DataType>::subscribe (void)
+{
+    lost = 0;
+    p_next_sub = NULL;
+    data_signal = NULL;
+    if (p_topic == NULL)
+    {
+        return;
+    }
+    data_signal = xSemaphoreCreateBinary ();
+    cursor.store (p_topic->published.load (std::memory_order_acquire));
+
+    Subscriber<DataType>* p_head
+        = p_topic->p_first_sub.load (std::memory_order_relaxed);
+    do
+    {
+        p_next_sub = p_head;
+    }
+    while (!p_topic->p_first_sub.compare_exchange_weak (p_head, this,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+}
+
+
+/** @brief   Wait until a message is available at this subscriber's cursor.
+ *  @returns @c true if a message is available, @c false if the wait timed
+ *           out or the subscriber isn't usable
+ */
+template <class DataType>
+bool Subscriber<DataType>::wait_for_message (void)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+    while (available () == 0)
+    {
+        // Set the flag, then check again so that a message published in
+        // between can't be missed
+        waiting.store (true);
+        if (available () != 0)
+        {
+            waiting.store (false);
+            break;
+        }
+        if (xSemaphoreTake (data_signal, ticks_to_wait) != pdTRUE)
+        {
+            waiting.store (false);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** @brief   Copy the next message into the given variable and move past it.
+ *  @details If there's no unread message, this method waits, blocking the
+ *           calling task, for up to the wait time given to the constructor.
+ *           If the topic's policy is @c TOPIC_OVERWRITE and this subscriber
+ *           has been lapped by the publisher, it first skips ahead to the
+ *           oldest message still in the buffer; if the publisher writes over
+ *           a message while it's being copied, the copy is made again. This
+ *           method must @b not be used within an interrupt service routine.
+ *  @param   recv_item A reference to the variable in which to put the message
+ *  @returns @c true if a message was received, @c false if none arrived
+ *           within the wait time
+ */
+template <class DataType>
+bool Subscriber<DataType>::get (DataType& recv_item)
+{
+    for (;;)
+    {
+        if (!wait_for_message ())
+        {
+            return false;
+        }
+
+        uint32_t position = cursor.load (std::memory_order_relaxed);
+        uint32_t newest = p_topic->published.load (std::memory_order_acquire);
+        if (newest - position > p_topic->buf_size)
+        {
+            // We've been lapped; skip to the oldest message still buffered
+            lost += newest - position - p_topic->buf_size;
+            position = newest - p_topic->buf_size;
+        }
+
+        recv_item = p_topic->p_buffer[position & p_topic->mask];
+
+        // If the publisher began writing over this slot during the copy, the
+        // copy may be torn and must be made again
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (p_topic->claimed.load (std::memory_order_relaxed) - position
+            > p_topic->buf_size)
+        {
+            cursor.store (position, std::memory_order_release);
+            continue;
+        }
+
+        cursor.store (position + 1, std::memory_order_release);
+        break;
+    }
+
+    // If the publisher is waiting for buffer space, we may have just made some
+    if (p_topic->publisher_waiting.load ())
+    {
+        xSemaphoreGive (p_topic->space_signal);
+    }
+    return true;
+}
+
+
+/** @brief   Return a pointer to the next message without copying it.
+ *  @details This method waits, as @c get() does, for a message to become
+ *           available, then returns a pointer to the message where it sits
+ *           in the topic's buffer. The message stays in place, and the
+ *           publisher can't write over it, until @c release() is called. It
+ *           may only be used with topics whose policy is @c TOPIC_BLOCK or
+ *           @c TOPIC_DROP; for @c TOPIC_OVERWRITE topics it returns @c NULL.
+ *  @returns A pointer to the next message, or @c NULL if none arrived within
+ *           the wait time
+ */
+template <class DataType>
+const DataType* Subscriber<DataType>::look_at (void)
+{
+    if (p_topic == NULL || p_topic->policy == TOPIC_OVERWRITE
+        || !wait_for_message ())
+    {
+        return NULL;
+    }
+    return &(p_topic->p_buffer[cursor.load (std::memory_order_relaxed)
+                               & p_topic->mask]);
+}
+
+
+/** @brief   Move past a message which was used in place with @c look_at().
+ *  @details The pointer which @c look_at() returned must not be used after
+ *           this method has been called.
+ */
+template <class DataType>
+void Subscriber<DataType>::release (void)
+{
+    if (available () == 0)
+    {
+        return;
+    }
+    cursor.fetch_add (1, std::memory_order_release);
+    if (p_topic->publisher_waiting.load ())
+    {
+        xSemaphoreGive (p_topic->space_signal);
+    }
+}
+
+#endif // _TASKTOPIC_H_
@@ -0,0 +1,237 @@
+//*****************************************************************************
+/** @file    telemetry.cpp
+ *  @brief   Source code for a class which streams share values as binary
+ *           telemetry.
+ *  @details See @c telemetry.h for a description of the class and
+ *           @c telemetry_codec.h for the format of the data.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "telemetry.h"
+
+
+/** @brief   Create a telemetry sender with no channels.
+ *  @param   serial_device The serial device or other @c Print object to
+ *           which the frames are written
+ *  @param   p_name A name for the sender, shown by @c print_all_shares()
+ */
+Telemetry::Telemetry (Print& serial_device, const char* p_name)
+    : BaseShare (p_name), device (serial_device)
+{
+    out_length = 0;
+    last_write_us = 0;
+    data_frames = 0;
+    rows = 0;
+    bytes = 0;
+    period_ticks = 1;
+}
+
+
+/** @brief   Add a share, found by its name, as a channel.
+ *  @param   p_share_name The name of the share
+ *  @returns @c true if the share was added, @c false if no share has that
+ *           name, it's a queue, its values can't be read, or there are
+ *           already @c TELEMETRY_MAX_CHANNELS channels
+ */
+bool Telemetry::add (const char* p_share_name)
+{
+    BaseShare* p_share = BaseShare::find (p_share_name);
+    if (p_share == NULL)
+    {
+        return false;
+    }
+    return add (*p_share);
+}
+
+
+/** @brief   Add a share as a channel.
+ *  @details All channels must be added before sampling starts. 
+ *  @param   share The share to be sampled
+ *  @returns @c true if the share was added, @c false if it's a queue, its
+ *           values can't be read or there are already
+ *           @c TELEMETRY_MAX_CHANNELS channels
+ */
+bool Telemetry::add (BaseShare& share)
+{
+    uint8_t index = framer.get_channels ();
+    if (share.is_queue () || !framer.add_channel (share.get_value_type ()))
+    {
+        return false;
+    }
+    p_channels[index] = &share;
+    return true;
+}
+
+
+/** @brief   Sample every channel and add the values to the stream.
+ *  @details When a frame fills up it is put into the output buffer, and the
+ *           buffer is written out when it fills or when it has been held for
+ *           @c TELEMETRY_MAX_HOLD_US. Calls to this method, @c flush() and
+ *           @c send_schema() must all be made from one task.
+ */
+void Telemetry::sample (void)
+{
+    uint8_t value[8];
+    uint64_t values[TELEMETRY_MAX_CHANNELS];
+    uint32_t now = micros ();
+
+    for (uint8_t index = 0; index < framer.get_channels (); index++)
+    {
+        BaseShare* p_share = p_channels[index];
+        if (p_share->peek_value (value))
+        {
+            values[index] = share_type_widen (p_share->get_value_type (),
+                                              value);
+        }
+        else
+        {
+            values[index] = 0;
+        }
+    }
+
+    // If the frame being built is full, send it and start another one
+    if (!framer.add_row (now, values))
+    {
+        uint8_t frame[TELEMETRY_MAX_FRAME];
+        queue_frame (frame, framer.finish (frame));
+        if (++data_frames % TELEMETRY_SCHEMA_EVERY == 0)
+        {
+            send_schema ();
+        }
+        framer.add_row (now, values);
+    }
+    rows++;
+
+    if (out_length > 0 && now - last_write_us >= TELEMETRY_MAX_HOLD_US)
+    {
+        flush ();
+    }
+}
+
+
+/** @brief   Send any frames and samples waiting to be sent.
+ *  @details The rows in the frame being built are sent in a short frame.
+ */
+void Telemetry::flush (void)
+{
+    if (framer.get_rows () > 0)
+    {
+        uint8_t frame[TELEMETRY_MAX_FRAME];
+        queue_frame (frame, framer.finish (frame));
+        data_frames++;
+    }
+    if (out_length > 0)
+    {
+        bytes += device.write (out_buffer, out_length);
+        out_length = 0;
+    }
+    last_write_us = micros ();
+}
+
+
+/** @brief   Send a frame which lists the channels' names and types.
+ *  @details This is done by @c begin() and then every 
+ *           @c TELEMETRY_SCHEMA_EVERY data frames; a program which calls
+ *           @c sample() itself should call this method before sampling.
+ */
+void Telemetry::send_schema (void)
+{
+    const char* p_names[TELEMETRY_MAX_CHANNELS];
+    for (uint8_t index = 0; index < framer.get_channels (); index++)
+    {
+        p_names[index] = p_channels[index]->get_name ();
+    }
+
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    queue_frame (frame, framer.schema (p_names, frame));
+}
+
+
+/** @brief   Put a frame in the output buffer, writing the buffer out first
+ *           if there isn't room for the frame.
+ *  @param   p_frame Pointer to the encoded frame
+ *  @param   length The number of bytes in the frame
+ */
+void Telemetry::queue_frame (const uint8_t* p_frame, size_t length)
+{
+    if (out_length + length > TELEMETRY_OUT_BUFFER)
+    {
+        bytes += device.write (out_buffer, out_length);
+        out_length = 0;
+        last_write_us = micros ();
+    }
+    memcpy (out_buffer + out_length, p_frame, length);
+    out_length += length;
+}
+
+
+/** @brief   Task function which samples the channels at a steady rate.
+ *  @param   p_telemetry Pointer to the @c Telemetry object
+ */
+void Telemetry::sample_task (void* p_telemetry)
+{
+    Telemetry* p_this = (Telemetry*)p_telemetry;
+
+    p_this->send_schema ();
+    TickType_t wake_time = xTaskGetTickCount ();
+    for (;;)
+    {
+        p_this->sample ();
+        vTaskDelayUntil (&wake_time, p_this->period_ticks);
+    }
+}
+
+
+/** @brief   Start a task which samples the channels at a steady rate.
+ *  @details The sample rate is rounded to a whole number of RTOS ticks
+ *           between samples. The task should have a low priority so it
+ *           doesn't delay control tasks; sampling doesn't wait for any
+ *           share, so it won't be held up by them.
+ *  @param   rate_hz The number of samples per second
+ *  @param   priority The priority of the sampling task (default 2)
+ *  @param   stack_size The size of the task's stack (default 3072)
+ *  @returns @c true if the task was created, @c false if not
+ */
+bool Telemetry::begin (uint16_t rate_hz, UBaseType_t priority,
+                       uint32_t stack_size)
+{
+    period_ticks = configTICK_RATE_HZ / (rate_hz > 0 ? rate_hz : 1);
+    if (period_ticks < 1)
+    {
+        period_ticks = 1;
+    }
+    return xTaskCreate (sample_task, name, stack_size, this, priority, NULL)
+           == pdPASS;
+}
+
+
+/** @brief   Print the telemetry sender's status within a list of shares.
+ *  @details This method prints the number of channels, the number of rows
+ *           sampled, the number of data frames and the number of bytes sent.
+ *           It shouldn't be used when the same serial port carries the
+ *           telemetry.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void Telemetry::print_in_list (Print& printer)
+{
+    printer.printf ("%-16stelemetry\t", name);
+    printer << framer.get_channels () << " ch., " << rows << " rows, "
+            << data_frames << " frames, " << bytes << " bytes" << endl;
+}
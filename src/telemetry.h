@@ -0,0 +1,155 @@
+//*****************************************************************************
+/** @file    telemetry.h
+ *  @brief   A class which streams the values of chosen shares to a PC in a
+ *           compact binary form.
+ *  @details Printing share values as text at 115200 baud gets a few hundred
+ *           values per second to the PC. A @c Telemetry object samples the
+ *           shares it's given at a steady rate and sends only the changes in
+ *           their values, packed into checked frames (see
+ *           @c telemetry_codec.h), so many times more values fit through the
+ *           same serial line. Frames are collected in a buffer and written
+ *           a few at a time, so the serial driver gets a few large writes
+ *           rather than many small ones.
+ *
+ *           On the PC, the program @c host/telemetry_decode.cpp turns the
+ *           frames back into numbers and writes them as CSV.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include "baseshare.h"
+#include "telemetry_codec.h"
+
+
+/// The number of bytes of frames collected before they're written out
+#define TELEMETRY_OUT_BUFFER    512
+
+/// The longest time in microseconds for which frames are held before being
+/// written, so a slow stream still reaches the PC promptly
+#define TELEMETRY_MAX_HOLD_US   50000UL
+
+/// The number of data frames between schema frames, which let a PC program
+/// which starts in the middle of a stream find out what the channels are
+#define TELEMETRY_SCHEMA_EVERY  64
+
+
+/** @brief   Class which samples shares and sends their values to a PC as
+ *           binary telemetry.
+ *  @details Shares are added as channels by name or by reference, before
+ *           sampling starts. Any share whose @c get_value_type() gives a
+ *           numeric type may be added: @c Share of a number, @c CounterShare
+ *           and @c FlagShare. A queue can't be sampled, as taking a value
+ *           from it would take that value away from the task it was meant
+ *           for, and its head item isn't a current value; @c add() refuses
+ *           queues. A share which has not yet had data put into it is sent as
+ *           zero.
+ *
+ *           @c begin() starts a task which samples all the channels at a
+ *           fixed rate of up to one sample per RTOS tick. A program which
+ *           needs another rate, or wants to sample at a particular point in
+ *           its own loop, may call @c sample() itself instead. 
+ *
+ *           @section usage_telemetry Usage
+ *           @code
+ *           #include "telemetry.h"
+ *           ...
+ *           Telemetry telemetry (Serial);
+ *           ...
+ *           // In setup(), after the shares have been created
+ *           Serial.begin (921600);
+ *           telemetry.add ("Motor Speed");
+ *           telemetry.add (position_share);
+ *           telemetry.begin (500);                 // 500 samples/second
+ *           @endcode
+ *           Nothing else should print to the same serial port while
+ *           telemetry is running.
+ */
+class Telemetry : public BaseShare
+{
+protected:
+    Print& device;                        ///< Where frames are written
+    TelemetryFramer framer;               ///< Builds the frames
+    BaseShare* p_channels[TELEMETRY_MAX_CHANNELS]; ///< The shares sampled
+    uint8_t out_buffer[TELEMETRY_OUT_BUFFER];  ///< Frames waiting to go
+    size_t out_length;                    ///< Bytes in @c out_buffer
+    uint32_t last_write_us;               ///< Time of the last write
+    uint32_t data_frames;                 ///< Data frames sent
+    uint32_t rows;                        ///< Rows of samples taken
+    uint32_t bytes;                       ///< Bytes written to the device
+    uint32_t period_ticks;                ///< Ticks between samples in task
+
+    // Put a frame in the output buffer, writing the buffer first if full
+    void queue_frame (const uint8_t* p_frame, size_t length);
+
+    // The task function which samples the shares at a steady rate
+    static void sample_task (void* p_telemetry);
+
+public:
+    // Create a telemetry sender which writes to the given device
+    Telemetry (Print& serial_device, const char* p_name = "Telemetry");
+
+    // Add a share, found by its name, as a channel
+    bool add (const char* p_share_name);
+
+    // Add a share as a channel
+    bool add (BaseShare& share);
+
+    // Sample every channel and add the values to the stream
+    void sample (void);
+
+    // Send any frames and samples waiting to be sent
+    void flush (void);
+
+    // Send a frame which lists the channels
+    void send_schema (void);
+
+    // Start a task which samples the channels at a steady rate
+    bool begin (uint16_t rate_hz, UBaseType_t priority = 2,
+                uint32_t stack_size = 3072);
+
+    /** @brief   Return the number of rows of samples taken so far.
+     *  @returns The number of times @c sample() has run
+     */
+    uint32_t get_rows (void)
+    {
+        return rows;
+    }
+
+    /** @brief   Return the number of bytes written so far.
+     *  @returns The number of bytes written to the serial device
+     */
+    uint32_t get_bytes (void)
+    {
+        return bytes;
+    }
+
+    // Print the telemetry sender's status within a list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _TELEMETRY_H_
@@ -0,0 +1,484 @@
+//*****************************************************************************
+/** @file    telemetry_codec.h
+ *  @brief   Functions and a class which pack samples of shared data into
+ *           compact, checked binary frames for sending over a serial line.
+ *  @details This file holds the parts of the telemetry protocol which are
+ *           the same on the microcontroller which sends data and on the PC
+ *           which receives it, so it uses no Arduino or FreeRTOS code. 
+ *
+ *           @section telemetry_format Frame Format
+ *           A frame's payload begins with a byte which says what kind of
+ *           frame it is. A @e schema frame (@c 'S') lists the channels:
+ *           - The number of channels, as a varint
+ *           - For each channel, its @c ShareValueType code, the length of its
+ *             name, and the name without a terminating null
+ *
+ *           A @e data frame (@c 'D') holds one or more rows of samples:
+ *           - The frame's sequence number, as a varint; a gap shows that
+ *             frames were lost
+ *           - The time in microseconds at which the first row was sampled,
+ *             as a varint
+ *           - Then the rows until the payload ends. Each row begins with a
+ *             varint holding the time since the row before (0 for the first
+ *             row), then one varint per channel holding the change in that
+ *             channel's value since the row before. Integer changes are 
+ *             zigzag encoded so small negative changes stay small; for
+ *             @c float and @c double values the bits are XOR'ed with the 
+ *             previous bits, so an unchanged value takes one byte. In the 
+ *             first row of each frame the previous values are taken as zero,
+ *             so each frame can be decoded without the ones before it.
+ *
+ *           A varint is an unsigned number sent 7 bits per byte, least
+ *           significant first, with the top bit set in every byte but the
+ *           last. The payload is followed by its CRC-16/CCITT-FALSE, least
+ *           significant byte first. Then the whole thing is COBS encoded, so
+ *           it contains no zero bytes, and a zero byte is sent to end it. A
+ *           receiver which starts listening in the middle of a frame, or
+ *           which loses bytes, need only wait for the next zero to get back
+ *           in step, and the CRC catches frames which were damaged.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TELEMETRY_CODEC_H_
+#define _TELEMETRY_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "sharetype.h"
+
+
+/// The most channels which one telemetry stream may carry
+#define TELEMETRY_MAX_CHANNELS  16
+
+/// The most bytes in a frame's payload, not counting its CRC; this keeps a
+/// COBS encoded frame within one COBS block
+#define TELEMETRY_MAX_PAYLOAD   250
+
+/// The most bytes in the payload of a schema frame, which has a type, a
+/// channel count, and a type, name length and name of up to 15 characters
+/// for each channel
+#define TELEMETRY_MAX_SCHEMA    (2 + 17 * TELEMETRY_MAX_CHANNELS)
+
+/// The most bytes in a frame after adding the CRC, COBS encoding, and adding
+/// the final zero. Schema frames are the longest
+#define TELEMETRY_MAX_FRAME     (TELEMETRY_MAX_SCHEMA + 2 + 2 + 1)
+
+/// The most bytes a varint can take
+#define VARINT_MAX_BYTES        10
+
+/// The first byte of the payload of a schema frame
+#define TELEMETRY_SCHEMA        'S'
+
+/// The first byte of the payload of a data frame
+#define TELEMETRY_DATA          'D'
+
+
+/** @brief   Compute the CRC-16/CCITT-FALSE of a block of bytes.
+ *  @details This is the CRC with polynomial 0x1021 and starting value 0xFFFF.
+ *           It is computed a bit at a time, which takes no table but is fast
+ *           enough for frames of a few hundred bytes. A CRC can be computed
+ *           over several blocks by passing the result for each block in as
+ *           @c crc for the next.
+ *  @param   p_data Pointer to the bytes
+ *  @param   length The number of bytes
+ *  @param   crc The starting value (default 0xFFFF)
+ *  @returns The CRC
+ */
+inline uint16_t crc16_ccitt (const uint8_t* p_data, size_t length,
+                             uint16_t crc = 0xFFFF)
+{
+    while (length--)
+    {
+        crc ^= (uint16_t)(*p_data++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+
+/** @brief   Encode a block of bytes with Consistent Overhead Byte Stuffing.
+ *  @details The output holds no zero bytes and is at most one byte longer
+ *           than the input for each 254 input bytes, plus one. The zero
+ *           which marks the end of a frame is not added.
+ *  @param   p_in Pointer to the bytes to be encoded
+ *  @param   length The number of bytes to be encoded
+ *  @param   p_out Pointer to a buffer with room for 
+ *           @c length + @c length / 254 + 1 bytes
+ *  @returns The number of bytes written to @c p_out
+ */
+inline size_t cobs_encode (const uint8_t* p_in, size_t length, uint8_t* p_out)
+{
+    size_t out_index = 1;
+    size_t code_index = 0;
+    uint8_t code = 1;
+
+    for (size_t in_index = 0; in_index < length; in_index++)
+    {
+        if (p_in[in_index] == 0)
+        {
+            p_out[code_index] = code;
+            code_index = out_index++;
+            code = 1;
+        }
+        else
+        {
+            p_out[out_index++] = p_in[in_index];
+            if (++code == 0xFF)
+            {
+                p_out[code_index] = code;
+                code_index = out_index++;
+                code = 1;
+            }
+        }
+    }
+    p_out[code_index] = code;
+    return out_index;
+}
+
+
+/** @brief   Decode a block of bytes encoded with COBS.
+ *  @details The block must not include the zero which ended the frame. The
+ *           output may be written over the input, as it is never longer.
+ *  @param   p_in Pointer to the encoded bytes
+ *  @param   length The number of encoded bytes
+ *  @param   p_out Pointer to a buffer with room for @c length bytes
+ *  @returns The number of decoded bytes, or 0 if the input was not valid
+ */
+inline size_t cobs_decode (const uint8_t* p_in, size_t length, uint8_t* p_out)
+{
+    size_t in_index = 0;
+    size_t out_index = 0;
+
+    while (in_index < length)
+    {
+        uint8_t code = p_in[in_index++];
+        if (code == 0 || in_index + code - 1 > length)
+        {
+            return 0;
+        }
+        for (uint8_t count = 1; count < code; count++)
+        {
+            p_out[out_index++] = p_in[in_index++];
+        }
+        if (code != 0xFF && in_index < length)
+        {
+            p_out[out_index++] = 0;
+        }
+    }
+    return out_index;
+}
+
+
+/** @brief   Write an unsigned number as a varint.
+ *  @param   p_out Pointer to a buffer with room for @c VARINT_MAX_BYTES
+ *  @param   value The number to be written
+ *  @returns A pointer to the byte after the varint
+ */
+inline uint8_t* varint_put (uint8_t* p_out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *p_out++ = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    *p_out++ = (uint8_t)value;
+    return p_out;
+}
+
+
+/** @brief   Read a varint.
+ *  @param   p_in Pointer to the first byte of the varint
+ *  @param   p_end Pointer to the byte after the last one which may be read
+ *  @param   value Reference to a variable into which the number is put
+ *  @returns A pointer to the byte after the varint, or @c NULL if the varint
+ *           ran past @c p_end or was too long
+ */
+inline const uint8_t* varint_get (const uint8_t* p_in, const uint8_t* p_end,
+                                  uint64_t& value)
+{
+    value = 0;
+    for (uint8_t shift = 0; shift < 7 * VARINT_MAX_BYTES; shift += 7)
+    {
+        if (p_in >= p_end)
+        {
+            return NULL;
+        }
+        uint8_t byte = *p_in++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return p_in;
+        }
+    }
+    return NULL;
+}
+
+
+/** @brief   Map a signed number to an unsigned one so that numbers near zero,
+ *           negative or positive, become small.
+ *  @details 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+ *  @param   value The signed number
+ *  @returns The zigzag encoded number
+ */
+inline uint64_t zigzag_encode (int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+
+/** @brief   Undo @c zigzag_encode().
+ *  @param   value The zigzag encoded number
+ *  @returns The signed number
+ */
+inline int64_t zigzag_decode (uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+
+/** @brief   Compute the code sent for the change in a value.
+ *  @param   type The value's @c ShareValueType code
+ *  @param   value The value, widened by @c share_type_widen()
+ *  @param   previous The value before, also widened
+ *  @returns The number to be sent as a varint
+ */
+inline uint64_t telemetry_delta (uint8_t type, uint64_t value,
+                                 uint64_t previous)
+{
+    if (type == SHARE_FLOAT || type == SHARE_DOUBLE)
+    {
+        return value ^ previous;
+    }
+    return zigzag_encode ((int64_t)(value - previous));
+}
+
+
+/** @brief   Undo @c telemetry_delta().
+ *  @param   type The value's @c ShareValueType code
+ *  @param   delta The number which was sent
+ *  @param   previous The value before, widened
+ *  @returns The new value, widened
+ */
+inline uint64_t telemetry_undelta (uint8_t type, uint64_t delta,
+                                   uint64_t previous)
+{
+    if (type == SHARE_FLOAT || type == SHARE_DOUBLE)
+    {
+        return delta ^ previous;
+    }
+    return previous + (uint64_t)zigzag_decode (delta);
+}
+
+
+/** @brief   Class which builds telemetry frames from rows of samples.
+ *  @details Rows are added one at a time with @c add_row(). When a row won't
+ *           fit in the frame being built, @c add_row() returns @c false; the
+ *           frame is then finished with @c finish(), which returns the
+ *           encoded frame ready to send, and the row added again. This class
+ *           doesn't read shares or send anything itself, so it works the 
+ *           same on a microcontroller and on a PC.
+ */
+class TelemetryFramer
+{
+protected:
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD + 2];   ///< Frame being built
+    size_t length;                        ///< Bytes in @c payload so far
+    uint8_t n_channels;                   ///< Number of channels
+    uint8_t types[TELEMETRY_MAX_CHANNELS];     ///< Type of each channel
+    uint64_t previous[TELEMETRY_MAX_CHANNELS]; ///< Last row's values
+    uint32_t previous_us;                 ///< Time of the last row
+    uint32_t sequence;                    ///< Number of the next data frame
+    uint16_t rows;                        ///< Rows in the frame being built
+
+public:
+    /** @brief   Create a framer with no channels.
+     */
+    TelemetryFramer (void)
+    {
+        n_channels = 0;
+        length = 0;
+        previous_us = 0;
+        sequence = 0;
+        rows = 0;
+    }
+
+    /** @brief   Add a channel to the rows which will be framed.
+     *  @details Channels must all be added before the first row is.
+     *  @param   type The channel's @c ShareValueType code
+     *  @returns @c true if the channel was added, @c false if there are
+     *           already @c TELEMETRY_MAX_CHANNELS channels or the type has no
+     *           size
+     */
+    bool add_channel (uint8_t type)
+    {
+        if (n_channels >= TELEMETRY_MAX_CHANNELS
+            || share_type_size (type) == 0)
+        {
+            return false;
+        }
+        types[n_channels++] = type;
+        return true;
+    }
+
+    /** @brief   Return the number of channels.
+     *  @returns The number of channels which have been added
+     */
+    uint8_t get_channels (void)
+    {
+        return n_channels;
+    }
+
+    /** @brief   Return the number of rows in the frame being built.
+     *  @returns The number of rows added since the last frame was finished
+     */
+    uint16_t get_rows (void)
+    {
+        return rows;
+    }
+
+    /** @brief   Add a row of samples to the frame being built.
+     *  @param   time_us The time at which the samples were taken
+     *  @param   p_values Pointer to an array holding one value for each
+     *           channel, each widened by @c share_type_widen()
+     *  @returns @c true if the row was added, @c false if there wasn't room;
+     *           the frame should then be finished and the row added again
+     */
+    bool add_row (uint32_t time_us, const uint64_t* p_values)
+    {
+        uint8_t row[VARINT_MAX_BYTES * (TELEMETRY_MAX_CHANNELS + 3) + 1];
+        uint8_t* p_row = row;
+
+        // The first row of a frame starts with the frame's header
+        if (rows == 0)
+        {
+            *p_row++ = TELEMETRY_DATA;
+            p_row = varint_put (p_row, sequence);
+            p_row = varint_put (p_row, time_us);
+            p_row = varint_put (p_row, 0);
+            for (uint8_t index = 0; index < n_channels; index++)
+            {
+                p_row = varint_put (p_row, telemetry_delta (types[index],
+                                    p_values[index], 0));
+            }
+        }
+        else
+        {
+            p_row = varint_put (p_row, time_us - previous_us);
+            for (uint8_t index = 0; index < n_channels; index++)
+            {
+                p_row = varint_put (p_row, telemetry_delta (types[index],
+                                    p_values[index], previous[index]));
+            }
+        }
+
+        size_t row_length = p_row - row;
+        if (length + row_length > TELEMETRY_MAX_PAYLOAD)
+        {
+            return false;
+        }
+        memcpy (payload + length, row, row_length);
+        length += row_length;
+        memcpy (previous, p_values, n_channels * sizeof (uint64_t));
+        previous_us = time_us;
+        rows++;
+        return true;
+    }
+
+    /** @brief   Finish the data frame being built and encode it for sending.
+     *  @param   p_out Pointer to a buffer with room for 
+     *           @c TELEMETRY_MAX_FRAME bytes
+     *  @returns The number of bytes to be sent, including the final zero, or
+     *           0 if there were no rows to send
+     */
+    size_t finish (uint8_t* p_out)
+    {
+        if (rows == 0)
+        {
+            return 0;
+        }
+        size_t encoded = encode (p_out);
+        sequence++;
+        rows = 0;
+        length = 0;
+        return encoded;
+    }
+
+    /** @brief   Build and encode a schema frame which lists the channels.
+     *  @details The frame being built, if any, isn't affected.
+     *  @param   p_names Pointer to an array of the channels' names
+     *  @param   p_out Pointer to a buffer with room for 
+     *           @c TELEMETRY_MAX_FRAME bytes
+     *  @returns The number of bytes to be sent, including the final zero
+     */
+    size_t schema (const char* const* p_names, uint8_t* p_out)
+    {
+        uint8_t frame[TELEMETRY_MAX_SCHEMA + 2];
+        uint8_t* p_frame = frame;
+        *p_frame++ = TELEMETRY_SCHEMA;
+        p_frame = varint_put (p_frame, n_channels);
+        for (uint8_t index = 0; index < n_channels; index++)
+        {
+            size_t name_length = strlen (p_names[index]);
+            if (name_length > 15)
+            {
+                name_length = 15;
+            }
+            *p_frame++ = types[index];
+            *p_frame++ = (uint8_t)name_length;
+            memcpy (p_frame, p_names[index], name_length);
+            p_frame += name_length;
+        }
+        return encode_block (frame, p_frame - frame, p_out);
+    }
+
+protected:
+    /** @brief   Add a CRC to the payload and encode it as a frame.
+     *  @param   p_out Pointer to the buffer for the encoded frame
+     *  @returns The number of bytes in the encoded frame
+     */
+    size_t encode (uint8_t* p_out)
+    {
+        return encode_block (payload, length, p_out);
+    }
+
+    /** @brief   Add a CRC to a block and encode it as a frame.
+     *  @param   p_block Pointer to the block, with room for two more bytes
+     *  @param   block_length The number of bytes in the block
+     *  @param   p_out Pointer to the buffer for the encoded frame
+     *  @returns The number of bytes in the encoded frame
+     */
+    static size_t encode_block (uint8_t* p_block, size_t block_length,
+                                uint8_t* p_out)
+    {
+        uint16_t crc = crc16_ccitt (p_block, block_length);
+        p_block[block_length++] = (uint8_t)crc;
+        p_block[block_length++] = (uint8_t)(crc >> 8);
+        size_t encoded = cobs_encode (p_block, block_length, p_out);
+        p_out[encoded++] = 0;
+        return encoded;
+    }
+};
+
+#endif // _TELEMETRY_CODEC_H_
@@ -0,0 +1,490 @@
+//*****************************************************************************
+/** @file    timejoin.h
+ *  @brief   A stage which lines up timestamped samples from several queues,
+ *           giving one value from each queue for any chosen time.
+ *  @details Sensors which run at different rates send their readings through
+ *           separate queues, and code which fuses the readings needs values
+ *           from all the sensors for the same moment. This file contains a
+ *           class which reads timestamped samples from several queues into
+ *           small ring buffers and, when asked for a given time, gives each
+ *           queue's sample nearest that time or a value linearly interpolated
+ *           between the samples just before and after it. Values are only
+ *           given if samples within a tolerance of the time are available.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TIMEJOIN_H_
+#define _TIMEJOIN_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include <math.h>
+#include <type_traits>
+#include "baseshare.h"
+#include "taskqueue.h"
+
+
+/// The number of samples from each queue which a join stage keeps. It must
+/// cover the time between calls to @c TimeJoin::join() for the fastest queue
+#ifndef TIMEJOIN_HISTORY
+    #define TIMEJOIN_HISTORY 8
+#endif
+
+
+/** @brief   A sample with the time, in microseconds, at which it was taken.
+ *  @details Tasks and ISRs which send data to a @c TimeJoin put these into
+ *           their queues, normally with the time from @c micros():
+ *           @code
+ *           Queue<Stamped<float>> pressure_queue (10, "Pressure");
+ *           ...
+ *           pressure_queue.put (Stamped<float> (micros (), pressure));
+ *           @endcode
+ */
+template <class DataType> struct Stamped
+{
+    uint32_t time_us;                     ///< When the sample was taken
+    DataType value;                       ///< The sample itself
+
+    /// Create a sample with no particular time or value
+    Stamped (void) : time_us (0), value ()
+    {
+    }
+
+    /// Create a sample with the given time and value
+    Stamped (uint32_t a_time, const DataType& a_value)
+        : time_us (a_time), value (a_value)
+    {
+    }
+};
+
+
+/** @brief   How a join stage finds the value for a given time.
+ */
+enum JoinMode
+{
+    JOIN_NEAREST,       ///< Use the sample whose time is nearest
+    JOIN_LINEAR         ///< Interpolate between the samples on either side
+};
+
+
+/** @brief   Interpolates between two values of a type, if that can be done.
+ *  @details Numbers are interpolated linearly: floating point numbers in
+ *           their own precision, and integers in 64 bits and rounded to the
+ *           nearest whole number. Other types, such as structs,
+ *           aren't, and a join stage uses the nearest sample for them. A
+ *           program can interpolate its own types by specializing this
+ *           template for them:
+ *           @code
+ *           template <> struct JoinInterpolate<Vector3, false>
+ *           {
+ *               static bool calc (const Vector3& a, const Vector3& b,
+ *                                 double fraction, Vector3& result)
+ *               {
+ *                   result.x = a.x + (b.x - a.x) * fraction;
+ *                   ...
+ *                   return true;
+ *               }
+ *           };
+ *           @endcode
+ */
+template <class DataType,
+          bool is_number = std::is_arithmetic<DataType>::value>
+struct JoinInterpolate
+{
+    /** @brief   Try to interpolate between two values.
+     *  @param   a The earlier value
+     *  @param   b The later value
+     *  @param   fraction How far from @c a to @c b the result should be, from
+     *           0.0 to 1.0
+     *  @param   result A reference to a variable in which to put the result
+     *  @returns @c true if the result was interpolated, @c false if this type
+     *           can't be interpolated
+     */
+    static bool calc (const DataType& a, const DataType& b, double fraction,
+                      DataType& result)
+    {
+        (void)b;
+        (void)fraction;
+        result = a;
+        return false;
+    }
+};
+
+
+/// Interpolation for numbers; see the general template
+template <class DataType> struct JoinInterpolate<DataType, true>
+{
+    static bool calc (const DataType& a, const DataType& b, double fraction,
+                      DataType& result)
+    {
+        result = between (a, b, fraction, std::is_integral<DataType> ());
+        return true;
+    }
+
+    /// Integers: the difference is found in 64 bits, so a 32 bit value loses
+    /// nothing, and the step from @c a is rounded
+    static DataType between (const DataType& a, const DataType& b,
+                             double fraction, std::true_type)
+    {
+        int64_t step = llround ((double)((int64_t)b - (int64_t)a)
+                                * fraction);
+        return (DataType)((int64_t)a + step);
+    }
+
+    /// Floating point numbers are interpolated in their own precision
+    static DataType between (const DataType& a, const DataType& b,
+                             double fraction, std::false_type)
+    {
+        return a + (b - a) * (DataType)fraction;
+    }
+};
+
+
+/** @brief   Statistics kept by a join stage.
+ */
+struct JoinStats
+{
+    uint32_t joined;                      ///< Times values were given
+    uint32_t missed;                      ///< Times a queue had no sample
+    uint32_t interpolated;                ///< Values which were interpolated
+    uint32_t dropped;                     ///< Samples lost before being used
+};
+
+
+/// The end of the chain of inputs, which has nothing to do
+template <class... Types> class JoinInputs
+{
+protected:
+    void pull (JoinStats& stats, uint32_t last_us)
+    {
+        (void)stats;
+        (void)last_us;
+    }
+
+    bool find (uint32_t time_us, uint32_t tolerance, JoinMode mode,
+               JoinStats& stats)
+    {
+        (void)time_us;
+        (void)tolerance;
+        (void)mode;
+        (void)stats;
+        return true;
+    }
+
+    void take (void)
+    {
+    }
+};
+
+
+/** @brief   One input queue of a join stage, with its ring of samples.
+ *  @details A join stage inherits a chain of these, one for each queue; each
+ *           handles its own queue and passes calls on to the rest of the
+ *           chain. Application code doesn't use this class directly.
+ */
+template <class First, class... Rest> class JoinInputs<First, Rest...>
+    : public JoinInputs<Rest...>
+{
+protected:
+    Queue<Stamped<First>>* p_queue;       ///< Queue from which samples come
+    Stamped<First> ring[TIMEJOIN_HISTORY];  ///< Recent samples
+    uint8_t oldest;                       ///< Index of oldest sample in ring
+    uint8_t count;                        ///< Number of samples in ring
+    uint8_t use_before;                   ///< Found sample at or before time
+    int8_t use_after;                     ///< Found sample after time, or -1
+    First result;                         ///< The value found for the time
+
+    /** @brief   Return a sample from the ring, counting from the oldest.
+     *  @param   index 0 for the oldest sample, 1 for the next, and so on
+     */
+    Stamped<First>& at (uint8_t index)
+    {
+        return ring[(oldest + index) % TIMEJOIN_HISTORY];
+    }
+
+    /** @brief   Move all samples waiting in each queue into the rings.
+     *  @details If a ring is full, its oldest sample is thrown away. It's
+     *           counted as dropped if it was taken after the last time for
+     *           which values were given, as it never had a chance to be used.
+     *  @param   stats The join stage's statistics
+     *  @param   last_us The last time for which values were given
+     */
+    void pull (JoinStats& stats, uint32_t last_us)
+    {
+        Stamped<First> sample;
+        while (p_queue->any ())
+        {
+            p_queue->get (sample);
+            if (count == TIMEJOIN_HISTORY)
+            {
+                if ((int32_t)(at (0).time_us - last_us) > 0)
+                {
+                    stats.dropped++;
+                }
+                oldest = (oldest + 1) % TIMEJOIN_HISTORY;
+                count--;
+            }
+            ring[(oldest + count) % TIMEJOIN_HISTORY] = sample;
+            count++;
+        }
+        JoinInputs<Rest...>::pull (stats, last_us);
+    }
+
+    /** @brief   Find each queue's value for the given time.
+     *  @details The sample at or just before the time and the one just after
+     *           it are found. The nearest of them is used if it's within the
+     *           tolerance; in @c JOIN_LINEAR mode, if both are within the
+     *           tolerance, the value is interpolated between them.
+     *  @param   time_us The time for which values are wanted
+     *  @param   tolerance The greatest difference, in microseconds, between
+     *           the time and the time of a sample which may be used
+     *  @param   mode Whether to use the nearest sample or interpolate
+     *  @param   stats The join stage's statistics
+     *  @returns @c true if every queue had a value for the time
+     */
+    bool find (uint32_t time_us, uint32_t tolerance, JoinMode mode,
+               JoinStats& stats)
+    {
+        // Samples are in the order in which they were sent, so find the last
+        // one at or before the time and the first one after it
+        int16_t before = -1;
+        use_after = -1;
+        for (uint8_t index = 0; index < count; index++)
+        {
+            if ((int32_t)(at (index).time_us - time_us) <= 0)
+            {
+                before = index;
+            }
+            else
+            {
+                use_after = index;
+                break;
+            }
+        }
+
+        uint32_t before_gap = (before >= 0)
+            ? time_us - at (before).time_us : 0xFFFFFFFFUL;
+        uint32_t after_gap = (use_after >= 0)
+            ? at (use_after).time_us - time_us : 0xFFFFFFFFUL;
+        if (before_gap > tolerance && after_gap > tolerance)
+        {
+            return false;
+        }
+
+        if (mode == JOIN_LINEAR && before_gap <= tolerance
+            && after_gap <= tolerance && before_gap != 0)
+        {
+            double fraction = (double)before_gap
+                              / ((double)before_gap + (double)after_gap);
+            if (JoinInterpolate<First>::calc (at (before).value,
+                                              at (use_after).value,
+                                              fraction, result))
+            {
+                stats.interpolated++;
+            }
+            else
+            {
+                result = (before_gap <= after_gap) ? at (before).value
+                                                   : at (use_after).value;
+            }
+        }
+        else
+        {
+            result = (before_gap <= after_gap) ? at (before).value
+                                               : at (use_after).value;
+        }
+        use_before = (before >= 0) ? before : 0;
+
+        return JoinInputs<Rest...>::find (time_us, tolerance, mode, stats);
+    }
+
+    /** @brief   Throw away samples which are too old to be used again.
+     *  @details Times asked for are expected to increase, so only the sample
+     *           at or just before the last time asked for, and those after
+     *           it, are kept.
+     */
+    void take (void)
+    {
+        oldest = (oldest + use_before) % TIMEJOIN_HISTORY;
+        count -= use_before;
+        JoinInputs<Rest...>::take ();
+    }
+
+    /// Copy the values found into the caller's variables, one per queue
+    void copy_results (First& first, Rest&... rest)
+    {
+        first = result;
+        copy_rest (rest...);
+    }
+
+    template <class... Others> void copy_rest (Others&... others)
+    {
+        JoinInputs<Rest...>::copy_results (others...);
+    }
+
+    void copy_rest (void)
+    {
+    }
+
+public:
+    /// Set up the chain of inputs, given their queues in order
+    JoinInputs (Queue<Stamped<First>>& queue, Queue<Stamped<Rest>>&... rest)
+        : JoinInputs<Rest...> (rest...), p_queue (&queue), oldest (0),
+          count (0), use_before (0), use_after (-1), result ()
+    {
+    }
+};
+
+
+/** @brief   Implements a stage which joins samples from several queues by
+ *           their timestamps.
+ *  @details A join stage reads @c Stamped samples from several queues, each
+ *           of which may carry a different type of data at a different rate.
+ *           A task calls @c join() with a time, normally on a steady schedule
+ *           and a little in the past so that all the sensors have had a chance
+ *           to report; the stage gives one value from each queue for that
+ *           time. In @c JOIN_NEAREST mode the value is that of the sample
+ *           nearest the time; in @c JOIN_LINEAR mode it's interpolated between
+ *           the samples on either side of the time if both are close enough,
+ *           which is done for number types and for types for which
+ *           @c JoinInterpolate has been specialized. Samples more than the
+ *           tolerance away from the time aren't used, and if some queue has no
+ *           usable sample, no values are given and a miss is counted. 
+ *
+ *           Each queue's recent samples are kept in a ring of 
+ *           @c TIMEJOIN_HISTORY samples, so no memory is allocated as the
+ *           stage runs. The ring must hold all the samples a queue sends
+ *           between the last time asked for and the next one; samples which
+ *           overflow the ring before they could be used are counted as 
+ *           dropped. The number of joins, interpolations, misses and dropped
+ *           samples are shown by @c print_all_shares(). Only one task may use
+ *           each join stage.
+ *
+ *           @section join_usage Usage
+ *           @code
+ *           #include "timejoin.h"
+ *           ...
+ *           Queue<Stamped<ImuData>> imu_queue (20, "IMU");       // 400 Hz
+ *           Queue<Stamped<int32_t>> encoder_queue (20, "Enc");   // 1 kHz
+ *           Queue<Stamped<float>> baro_queue (5, "Baro");        // 50 Hz
+ *
+ *           /// Gives IMU, encoder and pressure data for the same moment
+ *           TimeJoin<ImuData, int32_t, float> fusion_join 
+ *               ("Fusion", 10000, JOIN_LINEAR,
+ *                imu_queue, encoder_queue, baro_queue);
+ *           @endcode
+ *           In the fusion task, which runs every 10 ms:
+ *           @code
+ *           ImuData imu;
+ *           int32_t position;
+ *           float pressure;
+ *           if (fusion_join.join (micros () - 5000, imu, position, pressure))
+ *           {
+ *               ...                                // Fuse the data
+ *           }
+ *           @endcode
+ */
+template <class... Types> class TimeJoin
+    : public BaseShare, protected JoinInputs<Types...>
+{
+protected:
+    uint32_t tolerance;                   ///< Greatest time difference, us
+    JoinMode mode;                        ///< Nearest sample or interpolate
+    uint32_t last_us;                     ///< Last time values were given
+    JoinStats stats;                      ///< Counts of what has happened
+
+public:
+    /** @brief   Create a join stage for the given queues.
+     *  @param   p_name A name for the stage, shown by @c print_all_shares()
+     *  @param   tolerance_us The greatest difference, in microseconds,
+     *           between a time asked for and a sample which may be used
+     *  @param   join_mode @c JOIN_NEAREST or @c JOIN_LINEAR
+     *  @param   queues The queues from which samples are read, in the same
+     *           order as the types in the template parameters
+     */
+    TimeJoin (const char* p_name, uint32_t tolerance_us, JoinMode join_mode,
+              Queue<Stamped<Types>>&... queues)
+        : BaseShare (p_name), JoinInputs<Types...> (queues...),
+          tolerance (tolerance_us), mode (join_mode), last_us (0)
+    {
+        stats.joined = 0;
+        stats.missed = 0;
+        stats.interpolated = 0;
+        stats.dropped = 0;
+    }
+
+    /** @brief   Get one value from each queue for the given time.
+     *  @details All samples waiting in the queues are read first, without
+     *           waiting for any more. Then the value for the time is found
+     *           for each queue. Samples older than those used are thrown away,
+     *           so the times given in successive calls should increase.
+     *  @param   time_us The time, from @c micros(), for which values are
+     *           wanted
+     *  @param   values References to variables, one for each queue in order,
+     *           into which the values are put
+     *  @returns @c true if every queue had a value for the time, @c false if
+     *           not, in which case the variables aren't changed
+     */
+    bool join (uint32_t time_us, Types&... values)
+    {
+        JoinInputs<Types...>::pull (stats, last_us);
+        if (!JoinInputs<Types...>::find (time_us, tolerance, mode, stats))
+        {
+            stats.missed++;
+            return false;
+        }
+        JoinInputs<Types...>::take ();
+        JoinInputs<Types...>::copy_results (values...);
+        last_us = time_us;
+        stats.joined++;
+        return true;
+    }
+
+    /** @brief   Return the statistics kept by this join stage.
+     *  @returns A copy of the statistics
+     */
+    JoinStats get_stats (void)
+    {
+        return stats;
+    }
+
+    /** @brief   Print the stage's status within a list of shares.
+     *  @details This method prints a line showing the stage's name, the
+     *           number of times values were given, how many values were
+     *           interpolated, how many times some queue had no usable
+     *           sample, and how many samples were dropped because a ring
+     *           overflowed.
+     *  @param   printer Reference to a serial device on which to print
+     */
+    void print_in_list (Print& printer)
+    {
+        // Print this stage's name and pad it to 16 characters
+        printer.printf ("%-16sjoin\t", name);
+        printer << stats.joined << " joined, " << stats.interpolated
+                << " interp., " << stats.missed << " missed, " 
+                << stats.dropped << " dropped" << endl;
+    }
+}; // class TimeJoin
+
+#endif // _TIMEJOIN_H_
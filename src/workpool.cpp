@@ -0,0 +1,249 @@
+//*****************************************************************************
+/** @file    workpool.cpp
+ *  @brief   Source code for a pool of worker tasks which run parallel loops.
+ *  @details See @c workpool.h for a description of the worker pool and
+ *           @c worksteal.h for the way work is split among the workers.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include "workpool.h"
+
+
+/** @brief   Create a pool of worker tasks.
+ *  @details The memory for the pool is allocated here, but the worker tasks
+ *           aren't created until @c begin() is called, as tasks shouldn't be
+ *           created by the constructors of global objects. 
+ *  @param   workers The number of worker tasks, normally one for each core
+ *  @param   p_name A name for the pool, shown by @c print_all_shares()
+ */
+WorkPool::WorkPool (uint8_t workers, const char* p_name)
+    : BaseShare (p_name), WorkStealer (workers)
+{
+    n_workers = workers;
+    p_info = new WorkerInfo[workers];
+    p_tasks = new TaskHandle_t[workers];
+    p_job_signals = new SemaphoreHandle_t[workers + 1];
+    wake_signal = xSemaphoreCreateCounting (workers, 0);
+    outside_mutex = xSemaphoreCreateMutex ();
+
+    // Each task which can start a job has a semaphore to wait for its end
+    if (p_job_signals != NULL)
+    {
+        for (uint8_t index = 0; index <= workers; index++)
+        {
+            p_job_signals[index] = xSemaphoreCreateBinary ();
+            if (p_job_signals[index] == NULL)
+            {
+                // Give back what was made so far; the pool is unusable
+                for (uint8_t made = 0; made < index; made++)
+                {
+                    vSemaphoreDelete (p_job_signals[made]);
+                }
+                delete[] p_job_signals;
+                p_job_signals = NULL;
+                break;
+            }
+        }
+    }
+
+    if (p_info != NULL && p_tasks != NULL)
+    {
+        for (uint8_t index = 0; index < workers; index++)
+        {
+            p_info[index].p_pool = this;
+            p_info[index].index = index;
+            p_tasks[index] = NULL;
+        }
+    }
+}
+
+
+/** @brief   Create and start the worker tasks.
+ *  @details This method is called once, in @c setup() or in a task function.
+ *           On a multi-core processor, worker tasks may be pinned to cores so
+ *           that worker 0 runs on core 0, worker 1 on core 1, and so on.
+ *  @param   priority The priority of the worker tasks (default 2)
+ *  @param   stack_size The stack size of each worker task (default 2048)
+ *  @param   pin_to_cores @c true to pin each worker to one core, or 
+ *           @c false to let workers run on any core (default @c true)
+ *  @returns @c true if all the worker tasks were created, @c false if not
+ */
+bool WorkPool::begin (UBaseType_t priority, uint32_t stack_size,
+                      bool pin_to_cores)
+{
+    if (!usable ())
+    {
+        return false;
+    }
+    for (uint8_t index = 0; index < n_workers; index++)
+    {
+        if (p_tasks[index] != NULL)
+        {
+            continue;
+        }
+        BaseType_t result;
+        #ifdef ESP32
+            BaseType_t core = pin_to_cores ? (index % portNUM_PROCESSORS)
+                                           : tskNO_AFFINITY;
+            result = xTaskCreatePinnedToCore (worker_task, name, stack_size,
+                                              &p_info[index], priority,
+                                              &p_tasks[index], core);
+        #else
+            (void)pin_to_cores;
+            result = xTaskCreate (worker_task, name, stack_size,
+                                  &p_info[index], priority, &p_tasks[index]);
+        #endif
+        if (result != pdPASS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** @brief   The function run by each worker task.
+ *  @details A worker does pieces of work as long as it can find them, and
+ *           sleeps when it can't. 
+ *  @param   p_params A pointer to the worker's @c WorkerInfo
+ */
+void WorkPool::worker_task (void* p_params)
+{
+    WorkerInfo* p_me = (WorkerInfo*)p_params;
+
+    for (;;)
+    {
+        p_me->p_pool->work (p_me->index);
+    }
+}
+
+
+/** @brief   Block a worker until there's work to do.
+ *  @param   self The index of the worker (unused, as all workers share one
+ *           semaphore)
+ */
+void WorkPool::sleep_worker (uint8_t self)
+{
+    (void)self;
+    xSemaphoreTake (wake_signal, portMAX_DELAY);
+}
+
+
+/** @brief   Wake a sleeping worker because work has been pushed.
+ *  @details This may be called from any task which is working on a job.
+ */
+void WorkPool::wake_worker (void)
+{
+    xSemaphoreGive (wake_signal);
+}
+
+
+/** @brief   Block a task which started a job until the job is done.
+ *  @param   self The index of the waiting task
+ */
+void WorkPool::wait_for_job (uint8_t self)
+{
+    xSemaphoreTake (p_job_signals[self], portMAX_DELAY);
+}
+
+
+/** @brief   Wake the task which started a job because the job is done.
+ *  @param   owner The index of the task which started the job
+ */
+void WorkPool::job_done (uint8_t owner)
+{
+    xSemaphoreGive (p_job_signals[owner]);
+}
+
+
+/** @brief   Find the index which the calling task uses in the scheduler.
+ *  @returns The worker's index if the caller is one of this pool's workers,
+ *           or the scheduler's outside index if it isn't
+ */
+uint8_t WorkPool::index_of_caller (void)
+{
+    TaskHandle_t me = xTaskGetCurrentTaskHandle ();
+    for (uint8_t index = 0; index < n_workers; index++)
+    {
+        if (p_tasks[index] == me)
+        {
+            return index;
+        }
+    }
+    return get_outside_index ();
+}
+
+
+/** @brief   Run a loop in parallel, returning when all of it has been done.
+ *  @details The function is called for pieces of the range from @c begin up
+ *           to @c end, each piece no bigger than @c grain, by the workers and
+ *           by the calling task. Because pieces run in different tasks at the
+ *           same time, the function must not write to anything which other
+ *           pieces also use, except through thread-safe means. The grain size
+ *           should make each piece take at least tens of microseconds.
+ *  @param   begin The first loop index
+ *  @param   end One past the last loop index
+ *  @param   grain The largest piece which isn't split further
+ *  @param   function The function which does each piece of the loop
+ *  @param   p_context A pointer which is passed to the function, normally
+ *           pointing to the data on which the loop works
+ */
+void WorkPool::parallel_for (uint32_t begin, uint32_t end, uint32_t grain,
+                             WorkFunction function, void* p_context)
+{
+    if (!usable ())
+    {
+        return;
+    }
+    uint8_t self = index_of_caller ();
+    bool outside = (self == get_outside_index ());
+
+    if (outside)
+    {
+        xSemaphoreTake (outside_mutex, portMAX_DELAY);
+    }
+    WorkStealer::parallel_for (self, begin, end, grain, function, p_context);
+    if (outside)
+    {
+        xSemaphoreGive (outside_mutex);
+    }
+}
+
+
+/** @brief   Print the pool's status within a list of shares.
+ *  @details This method prints a line showing the pool's name, the number
+ *           of workers, the number of loops run, the number of pieces of work
+ *           done, and the number of those which were stolen.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void WorkPool::print_in_list (Print& printer)
+{
+    // Print this pool's name and pad it to 16 characters
+    printer.printf ("%-16spool\t", name);
+
+    if (!usable ())
+    {
+        printer << "UNUSABLE" << endl;
+        return;
+    }
+    printer << n_workers << " workers, " << get_jobs () << " jobs, "
+            << get_done () << " pieces, " << get_stolen () << " stolen"
+            << endl;
+}
@@ -0,0 +1,161 @@
+//*****************************************************************************
+/** @file    workpool.h
+ *  @brief   A pool of worker tasks, spread across the processor's cores,
+ *           which share the work of parallel loops.
+ *  @details This file contains a class which runs batch computations such as
+ *           FFT's of vibration data or trajectory planning on several worker
+ *           tasks at once. On a dual-core ESP32 the workers can be pinned to
+ *           both cores, so a loop runs on both cores at once instead of
+ *           leaving one idle. The work is shared out by the work-stealing 
+ *           scheduler in @c worksteal.h, which can be tested on a PC.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _WORKPOOL_H_
+#define _WORKPOOL_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#if (defined STM32F4xx || defined STM32L4xx)
+    #include "FreeRTOS.h"                       // Main header for FreeRTOS
+#endif
+#include "baseshare.h"
+#include "worksteal.h"
+
+
+class WorkPool;
+
+
+/** @brief   What each worker task is told about itself when it's created.
+ */
+struct WorkerInfo
+{
+    WorkPool* p_pool;                     ///< The pool to which it belongs
+    uint8_t index;                        ///< Its index in the pool
+};
+
+
+/** @brief   Implements a pool of worker tasks which run parallel loops.
+ *  @details A task calls @c parallel_for() with a range of loop indices and a
+ *           function which does the work for part of that range. The range is
+ *           split into pieces, which the workers and the calling task do at
+ *           the same time; @c parallel_for() returns when every piece has been
+ *           done. A piece of work may itself call @c parallel_for() to start a
+ *           nested loop, which gives fork-join parallelism. The number of
+ *           workers is fixed when the pool is created, and no memory is
+ *           allocated when loops are run. 
+ *
+ *           Workers which find no work to do sleep until more is pushed,
+ *           and the calling task sleeps once it has nothing left to do but
+ *           wait for the workers to finish, so lower priority tasks still run
+ *           while a loop is waiting. Only one task outside the pool may run a
+ *           loop at a time; others wait their turn. 
+ *
+ *           A pool is a shared data item so that it shows up in the list
+ *           printed by @c print_all_shares(), along with the number of loops
+ *           it has run, the number of pieces done and the number stolen by
+ *           one worker from another. 
+ *
+ *           @section workpool_usage Usage
+ *           @code
+ *           #include "workpool.h"
+ *           ...
+ *           /// Two workers, one on each core of the ESP32
+ *           WorkPool fft_pool (2, "FFT Pool");
+ *
+ *           void magnitude (void* p_context, uint32_t begin, uint32_t end)
+ *           {
+ *               Spectrum* p_spectrum = (Spectrum*)p_context;
+ *               for (uint32_t bin = begin; bin < end; bin++)
+ *               {
+ *                   ...                   // Compute one bin of the spectrum
+ *               }
+ *           }
+ *
+ *           void setup (void)
+ *           {
+ *               ...
+ *               fft_pool.begin ();        // Start the worker tasks
+ *           }
+ *           ...
+ *           // In a task function, 16 bins in each piece of work
+ *           fft_pool.parallel_for (0, N_BINS, 16, magnitude, &spectrum);
+ *           @endcode
+ */
+class WorkPool : public BaseShare, protected WorkStealer
+{
+protected:
+    WorkerInfo* p_info;                   ///< Information for each worker
+    TaskHandle_t* p_tasks;                ///< Handles of the worker tasks
+    SemaphoreHandle_t* p_job_signals;     ///< Wake each task when job done
+    uint8_t n_workers;                    ///< Number of worker tasks
+    SemaphoreHandle_t wake_signal;        ///< Wakes sleeping workers
+    SemaphoreHandle_t outside_mutex;      ///< One outside caller at a time
+
+    // The function run by each worker task
+    static void worker_task (void* p_params);
+
+    // Find the index which the calling task uses in the scheduler
+    uint8_t index_of_caller (void);
+
+    // Block a worker until there's work to do
+    void sleep_worker (uint8_t self);
+
+    // Wake a worker because there's work to do
+    void wake_worker (void);
+
+    // Block a task which has started a job until the job is done
+    void wait_for_job (uint8_t self);
+
+    // Wake the task which started a job because it's done
+    void job_done (uint8_t owner);
+
+public:
+    // Create a pool with the given number of workers
+    WorkPool (uint8_t workers, const char* p_name = NULL);
+
+    // Create and start the worker tasks
+    bool begin (UBaseType_t priority = 2, uint32_t stack_size = 2048,
+                bool pin_to_cores = true);
+
+    // Run a loop in parallel and return when all of it has been done
+    void parallel_for (uint32_t begin, uint32_t end, uint32_t grain,
+                       WorkFunction function, void* p_context);
+
+    /** @brief   Indicates whether this pool is usable.
+     *  @details This method returns @c true if memory for the pool was
+     *           successfully allocated. The workers run only after @c begin()
+     *           has been called, though loops can be run before then by the
+     *           calling task alone.
+     *  @returns @c true if this pool is usable, @c false if not
+     */
+    bool usable (void)
+    {
+        return WorkStealer::usable () && p_info != NULL && p_tasks != NULL
+               && p_job_signals != NULL && wake_signal != NULL
+               && outside_mutex != NULL;
+    }
+
+    // Print the pool's status within a list of all shares' statuses
+    void print_in_list (Print& printer);
+};
+
+#endif // _WORKPOOL_H_
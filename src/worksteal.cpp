@@ -0,0 +1,277 @@
+//*****************************************************************************
+/** @file    worksteal.cpp
+ *  @brief   Source code for a portable work-stealing scheduler.
+ *  @details See @c worksteal.h for a description of how work is split among
+ *           workers. This file uses no FreeRTOS or Arduino functions, so it
+ *           can be compiled into host programs as well as microcontroller
+ *           programs.
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+#include <new>
+#include "worksteal.h"
+
+
+/** @brief   Create a work-stealing scheduler.
+ *  @details The deques for the workers and for the outside thread are 
+ *           allocated here; no memory is allocated afterwards.
+ *  @param   n_workers The number of worker threads which the platform code
+ *           will create
+ */
+WorkStealer::WorkStealer (uint8_t n_workers)
+    : sleepers (0), jobs_run (0)
+{
+    n_deques = n_workers + 1;
+    p_deques = new (std::nothrow) WorkDeque<WORK_DEQUE_SIZE>[n_deques];
+    p_done = new (std::nothrow) uint32_t[n_deques];
+    p_stolen = new (std::nothrow) uint32_t[n_deques];
+    p_seeds = new (std::nothrow) uint32_t[n_deques];
+    if (usable ())
+    {
+        for (uint8_t index = 0; index < n_deques; index++)
+        {
+            p_done[index] = 0;
+            p_stolen[index] = 0;
+            p_seeds[index] = 2463534242UL + index * 7919UL;
+        }
+    }
+}
+
+
+/** @brief   Destroy the scheduler, freeing its memory.
+ *  @details The worker threads must have been stopped first. 
+ */
+WorkStealer::~WorkStealer (void)
+{
+    delete [] p_deques;
+    delete [] p_done;
+    delete [] p_stolen;
+    delete [] p_seeds;
+}
+
+
+/** @brief   Do one piece of work.
+ *  @details If the piece is bigger than its job's grain size, it's cut in 
+ *           half and the upper half is pushed onto this thread's deque, where
+ *           another worker may steal it; this repeats until the remaining
+ *           piece is small enough, which is then done. If the deque fills up,
+ *           the rest of the piece is simply done without further splitting.
+ *  @param   self The index of the calling thread
+ *  @param   item The piece of work
+ */
+void WorkStealer::run_item (uint8_t self, WorkItem item)
+{
+    WorkJob* p_job = item.p_job;
+    bool pushed = false;
+
+    while (item.end - item.begin > p_job->grain)
+    {
+        uint32_t middle = item.begin + (item.end - item.begin) / 2;
+        WorkItem upper = {p_job, middle, item.end};
+        p_job->pending.fetch_add (1, std::memory_order_relaxed);
+        if (!p_deques[self].push (upper))
+        {
+            p_job->pending.fetch_sub (1, std::memory_order_relaxed);
+            break;
+        }
+        pushed = true;
+        item.end = middle;
+    }
+
+    // If workers are asleep, wake one to steal what was just pushed; the
+    // fence makes sure a worker going to sleep either sees the new pieces or
+    // is counted here
+    if (pushed)
+    {
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        if (sleepers.load (std::memory_order_relaxed) != 0)
+        {
+            wake_worker ();
+        }
+    }
+
+    p_job->function (p_job->p_context, item.begin, item.end);
+    p_done[self]++;
+
+    // After the count reaches zero the job may be gone, as its caller may
+    // have returned, so the owner's index is saved first
+    uint8_t owner = p_job->owner;
+    if (p_job->pending.fetch_sub (1, std::memory_order_acq_rel) == 1
+        && owner != self)
+    {
+        job_done (owner);
+    }
+}
+
+
+/** @brief   Find a piece of work to do.
+ *  @details The calling thread first looks in its own deque, then tries to
+ *           steal from each of the others in turn, starting at a randomly
+ *           chosen one so that thieves don't all pick on the same victim.
+ *  @param   self The index of the calling thread
+ *  @param   item A reference to a variable in which to put the piece
+ *  @returns @c true if a piece of work was found, @c false if not
+ */
+bool WorkStealer::find_work (uint8_t self, WorkItem& item)
+{
+    if (p_deques[self].pop (item))
+    {
+        return true;
+    }
+
+    // A xorshift random number generator picks the first victim
+    uint32_t seed = p_seeds[self];
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    p_seeds[self] = seed;
+
+    uint8_t first = seed % n_deques;
+    for (uint8_t count = 0; count < n_deques; count++)
+    {
+        uint8_t victim = (first + count) % n_deques;
+        if (victim != self && p_deques[victim].steal (item))
+        {
+            p_stolen[self]++;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** @brief   Run a loop in parallel, returning when all of it has been done.
+ *  @details The function is called for pieces of the range from @c begin up
+ *           to @c end, each piece no bigger than @c grain, by whichever 
+ *           threads get to them. While waiting for the other threads, the
+ *           calling thread does pieces of this job or of any other job, and
+ *           when there are none left it waits for the others to finish. The
+ *           grain size should be large enough that each piece takes much
+ *           longer than stealing it does, a few microseconds at least.
+ *  @param   self The index of the calling thread
+ *  @param   begin The first loop index
+ *  @param   end One past the last loop index
+ *  @param   grain The largest piece which isn't split further
+ *  @param   function The function which does each piece of the loop
+ *  @param   p_context A pointer which is passed to the function
+ */
+void WorkStealer::parallel_for (uint8_t self, uint32_t begin, uint32_t end,
+                                uint32_t grain, WorkFunction function,
+                                void* p_context)
+{
+    if (begin >= end || !usable ())
+    {
+        return;
+    }
+
+    WorkJob job;
+    job.function = function;
+    job.p_context = p_context;
+    job.grain = (grain > 0) ? grain : 1;
+    job.owner = self;
+    job.pending.store (1, std::memory_order_relaxed);
+
+    WorkItem whole = {&job, begin, end};
+    run_item (self, whole);
+
+    while (job.pending.load (std::memory_order_acquire) != 0)
+    {
+        WorkItem item;
+        if (find_work (self, item))
+        {
+            run_item (self, item);
+        }
+        else
+        {
+            wait_for_job (self);
+        }
+    }
+    jobs_run.fetch_add (1, std::memory_order_relaxed);
+}
+
+
+/** @brief   Do a piece of work, or sleep if no work can be found.
+ *  @details Each worker thread calls this method over and over. A worker
+ *           which finds no work is counted as a sleeper and looks once more,
+ *           so that work pushed while it was getting ready to sleep isn't
+ *           missed, before it calls @c sleep_worker(). 
+ *  @param   self The index of the calling worker
+ *  @returns @c true if a piece of work was done, @c false if the worker slept
+ */
+bool WorkStealer::work (uint8_t self)
+{
+    WorkItem item;
+    if (!usable ())
+    {
+        return false;
+    }
+    if (!find_work (self, item))
+    {
+        sleepers.fetch_add (1, std::memory_order_seq_cst);
+        bool found = find_work (self, item);
+        if (!found)
+        {
+            sleep_worker (self);
+        }
+        sleepers.fetch_sub (1, std::memory_order_relaxed);
+        if (!found)
+        {
+            return false;
+        }
+    }
+    run_item (self, item);
+    return true;
+}
+
+
+/** @brief   Return the number of pieces of work which have been done.
+ *  @param   self The index of a thread, or 0xFF for the total of all threads
+ *  @returns The number of pieces done
+ */
+uint32_t WorkStealer::get_done (uint8_t self)
+{
+    uint32_t total = 0;
+    for (uint8_t index = 0; index < n_deques; index++)
+    {
+        if (self == 0xFF || self == index)
+        {
+            total += p_done[index];
+        }
+    }
+    return total;
+}
+
+
+/** @brief   Return the number of pieces of work which have been stolen.
+ *  @param   self The index of a thread, or 0xFF for the total of all threads
+ *  @returns The number of pieces stolen
+ */
+uint32_t WorkStealer::get_stolen (uint8_t self)
+{
+    uint32_t total = 0;
+    for (uint8_t index = 0; index < n_deques; index++)
+    {
+        if (self == 0xFF || self == index)
+        {
+            total += p_stolen[index];
+        }
+    }
+    return total;
+}
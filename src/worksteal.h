@@ -0,0 +1,297 @@
+//*****************************************************************************
+/** @file    worksteal.h
+ *  @brief   A portable work-stealing scheduler which splits loops into pieces
+ *           and shares the pieces among several worker threads.
+ *  @details This file contains the scheduling logic used by @c WorkPool. It
+ *           uses only standard C++ atomics, with no FreeRTOS or Arduino calls,
+ *           so that the same code can be run with @c std::thread on a PC to
+ *           test it and to measure how well it scales with more workers; see
+ *           @c host/workpool_bench.cpp. Application code on a microcontroller
+ *           should use @c WorkPool in @c workpool.h rather than this file.
+ *
+ *           Each worker has a double-ended queue (deque) of pieces of work.
+ *           A worker pushes and pops pieces at the bottom of its own deque,
+ *           and an idle worker steals pieces from the top of another worker's
+ *           deque. A loop run by @c parallel_for() is split in half over and
+ *           over, with one half pushed for others to steal, so big pieces are
+ *           stolen first and each worker mostly works on its own small
+ *           pieces. The deques have a fixed size and the job's bookkeeping is
+ *           kept on the calling thread's stack, so no memory is allocated
+ *           while jobs run. The deque is the one described by Chase and Lev
+ *           (2005), with the memory ordering given by Le et al. (2013). 
+ *
+ *  @date 2026-Oct-17 Original file
+ *
+ *  License:
+ *    This file is copyright 2026 by JR Ridgely and released under the Lesser
+ *    GNU Public License, version 2. It intended for educational use only,
+ *    but its use is not limited thereto. */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *    THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIB-
+ *    UTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *    OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE. */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _WORKSTEAL_H_
+#define _WORKSTEAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+
+/// The number of pieces of work each worker's deque can hold. Because loops
+/// are split in halves, this only needs to be about log2(pieces) plus a few
+#ifndef WORK_DEQUE_SIZE
+    #define WORK_DEQUE_SIZE 32
+#endif
+
+
+/** @brief   The type of function which does one piece of a parallel loop.
+ *  @details The function is given the context pointer which was given to
+ *           @c parallel_for() and a range of loop indices; it should do the
+ *           work for indices from @c begin up to, but not including, @c end.
+ */
+typedef void (*WorkFunction) (void* p_context, uint32_t begin, uint32_t end);
+
+
+/** @brief   The bookkeeping for one call to @c parallel_for().
+ *  @details A job is kept on the stack of the thread which called
+ *           @c parallel_for(), which doesn't return until every piece of the
+ *           job has been done.
+ */
+struct WorkJob
+{
+    WorkFunction function;                ///< Function which does the work
+    void* p_context;                      ///< Pointer given to the function
+    uint32_t grain;                       ///< Pieces this size aren't split
+    uint8_t owner;                        ///< Index of the calling thread
+    std::atomic<uint32_t> pending;        ///< Pieces not yet finished
+};
+
+
+/** @brief   One piece of a job: a range of loop indices.
+ */
+struct WorkItem
+{
+    WorkJob* p_job;                       ///< The job this piece belongs to
+    uint32_t begin;                       ///< First index in the range
+    uint32_t end;                         ///< One past the last index
+};
+
+
+/** @brief   A fixed-size deque of pieces of work, which one worker owns and
+ *           from which other workers may steal.
+ *  @details Only the owning worker may call @c push() and @c pop(); any
+ *           worker may call @c steal(). The size must be a power of 2.
+ */
+template <uint16_t size> class WorkDeque
+{
+protected:
+    WorkItem items[size];                 ///< Ring buffer of pieces
+    std::atomic<int32_t> top;             ///< Index where thieves steal
+    std::atomic<int32_t> bottom;          ///< Index where the owner works
+
+public:
+    /// Create an empty deque
+    WorkDeque (void) : top (0), bottom (0)
+    {
+    }
+
+    /** @brief   Push a piece of work onto the bottom of the deque.
+     *  @param   item The piece of work
+     *  @returns @c true if the piece was pushed, @c false if the deque is full
+     */
+    bool push (const WorkItem& item)
+    {
+        int32_t b = bottom.load (std::memory_order_relaxed);
+        int32_t t = top.load (std::memory_order_acquire);
+        if (b - t >= (int32_t)size)
+        {
+            return false;
+        }
+        items[b & (size - 1)] = item;
+        std::atomic_thread_fence (std::memory_order_release);
+        bottom.store (b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /** @brief   Pop the most recently pushed piece of work from the bottom.
+     *  @param   item A reference to a variable in which to put the piece
+     *  @returns @c true if a piece was popped, @c false if the deque is empty
+     *           or a thief took the last piece first
+     */
+    bool pop (WorkItem& item)
+    {
+        int32_t b = bottom.load (std::memory_order_relaxed) - 1;
+        bottom.store (b, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int32_t t = top.load (std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store (b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = items[b & (size - 1)];
+        if (t == b)
+        {
+            // This is the last piece, so race any thieves for it
+            bool won = top.compare_exchange_strong (t, t + 1,
+                                                    std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom.store (b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /** @brief   Steal the oldest piece of work from the top of the deque.
+     *  @param   item A reference to a variable in which to put the piece
+     *  @returns @c true if a piece was stolen, @c false if the deque is empty
+     *           or another worker got the piece first
+     */
+    bool steal (WorkItem& item)
+    {
+        int32_t t = top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int32_t b = bottom.load (std::memory_order_acquire);
+        if (t >= b)
+        {
+            return false;
+        }
+        item = items[t & (size - 1)];
+        return top.compare_exchange_strong (t, t + 1,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+};
+
+
+/** @brief   Shares the pieces of parallel loops among a set of workers.
+ *  @details The scheduler has one deque for each worker thread and one more
+ *           for the thread which starts jobs from outside the pool. Each
+ *           thread identifies itself by its index: 0 through
+ *           @c n_workers - 1 for the workers, and @c get_outside_index() for
+ *           the outside thread. Only one outside thread may call
+ *           @c parallel_for() at a time; workers may call it from within a
+ *           piece of work to start nested jobs.
+ *
+ *           The scheduler doesn't create threads. The platform code creates
+ *           the workers, each of which calls @c work() over and over, and it
+ *           decides how threads sleep by overriding the virtual methods
+ *           @c sleep_worker(), @c wake_worker(), @c wait_for_job() and 
+ *           @c job_done(). The versions of those methods in this class just
+ *           yield or do nothing, so threads which are waiting keep checking
+ *           for work; that's fine for tests on a PC, but on a microcontroller
+ *           waiting threads must block so lower priority tasks can run.
+ */
+class WorkStealer
+{
+protected:
+    WorkDeque<WORK_DEQUE_SIZE>* p_deques; ///< One deque for each thread
+    uint32_t* p_done;                     ///< Pieces done by each thread
+    uint32_t* p_stolen;                   ///< Pieces stolen by each thread
+    uint32_t* p_seeds;                    ///< Random numbers for each thread
+    uint8_t n_deques;                     ///< Workers plus one outside
+    std::atomic<uint8_t> sleepers;        ///< Workers which are asleep
+    std::atomic<uint32_t> jobs_run;       ///< Jobs finished so far
+
+    // Do one piece of work, splitting off halves for others to steal
+    void run_item (uint8_t self, WorkItem item);
+
+    // Pop work from our own deque or steal it from someone else's
+    bool find_work (uint8_t self, WorkItem& item);
+
+    /** @brief   Put a worker to sleep because it found no work.
+     *  @details The worker should sleep until @c wake_worker() is called; it
+     *           does no harm if it sometimes wakes up without being called.
+     *  @param   self The index of the worker which is going to sleep
+     */
+    virtual void sleep_worker (uint8_t self)
+    {
+        (void)self;
+    }
+
+    /** @brief   Wake a sleeping worker because new work is available.
+     */
+    virtual void wake_worker (void)
+    {
+    }
+
+    /** @brief   Wait while other threads finish the pieces of a job.
+     *  @details The thread which called @c parallel_for() calls this method
+     *           when it has no more work to do but other threads are still
+     *           working on its job. It should wait until @c job_done() is
+     *           called with the same index; waking up early does no harm.
+     *  @param   self The index of the thread which is waiting
+     */
+    virtual void wait_for_job (uint8_t self)
+    {
+        (void)self;
+    }
+
+    /** @brief   Tell the thread which started a job that it's finished.
+     *  @param   owner The index of the thread which called @c parallel_for()
+     */
+    virtual void job_done (uint8_t owner)
+    {
+        (void)owner;
+    }
+
+public:
+    // Create a scheduler for the given number of worker threads
+    WorkStealer (uint8_t n_workers);
+
+    // Free the memory used by the deques
+    virtual ~WorkStealer (void);
+
+    // Run a loop in parallel and return when all of it has been done
+    void parallel_for (uint8_t self, uint32_t begin, uint32_t end,
+                       uint32_t grain, WorkFunction function, 
+                       void* p_context);
+
+    // Do a piece of work, or sleep if there's none to be found
+    bool work (uint8_t self);
+
+    /** @brief   Indicates whether memory for the deques was allocated.
+     *  @returns @c true if the scheduler can be used, @c false if not
+     */
+    bool usable (void)
+    {
+        return p_deques != NULL && p_done != NULL && p_stolen != NULL
+               && p_seeds != NULL;
+    }
+
+    /** @brief   Return the index used by a thread outside the pool.
+     *  @returns The index of the deque for threads which aren't workers
+     */
+    uint8_t get_outside_index (void)
+    {
+        return n_deques - 1;
+    }
+
+    /** @brief   Return the number of jobs which have been finished.
+     *  @returns The number of calls to @c parallel_for() which have returned
+     */
+    uint32_t get_jobs (void)
+    {
+        return jobs_run.load (std::memory_order_relaxed);
+    }
+
+    // Return the number of pieces done by one thread, or by all if 0xFF
+    uint32_t get_done (uint8_t self = 0xFF);
+
+    // Return the number of pieces stolen by one thread, or by all if 0xFF
+    uint32_t get_stolen (uint8_t self = 0xFF);
+};
+
+#endif // _WORKSTEAL_H_